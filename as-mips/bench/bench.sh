@@ -0,0 +1,20 @@
+#!/bin/sh
+# Assemble des sources synthétiques de taille croissante et mesure le débit et le pic de mémoire.
+# Usage : bench/bench.sh [NOMBRES_DE_LIGNES...] depuis le répertoire de as-mips
+#         (1000 10000 100000 1000000 10000000 par défaut)
+# Les paramètres du générateur peuvent être passés par la variable GENERATEUR_OPTIONS (ex. "-e 20 -d 50 -g 7").
+
+TAILLES=${*:-1000 10000 100000 1000000 10000000}
+SOURCE=${TMPDIR:-/tmp}/bench_$$.s
+EXEC=./as-mips
+
+for f in $EXEC bench/generateur bench/mesure; do
+	[ -x $f ] || { echo "Compilez d'abord as-mips et les outils de mesure (make bench)" >&2; exit 1; }
+done
+trap 'rm -f $SOURCE' EXIT INT TERM
+
+printf "%10s %12s %9s %12s %9s %10s %4s\n" lignes octets secondes lignes/s Mo/s RSS_Ko rc
+for n in $TAILLES; do
+	bench/generateur -n $n $GENERATEUR_OPTIONS -o $SOURCE || exit 1
+	bench/mesure $n $SOURCE $EXEC -q $SOURCE
+done
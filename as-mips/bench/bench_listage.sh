@@ -0,0 +1,41 @@
+#!/bin/sh
+# Compare le temps d'assemblage seul (-q) au temps d'assemblage avec écriture du listage.
+# Usage : bench/bench_listage.sh [NOMBRE_DE_LIGNES] (200000 par défaut), depuis le répertoire de as-mips
+
+NB_LIGNES=${1:-200000}
+SOURCE=${TMPDIR:-/tmp}/bench_listage_$$.s
+EXEC=./as-mips
+
+[ -x $EXEC ] || { echo "Compilez d'abord as-mips (make release)" >&2; exit 1; }
+
+# source synthétique : une étiquette toutes les 8 lignes, sauts et branchements vers les étiquettes
+awk -v n=$NB_LIGNES 'BEGIN {
+	print ".text"
+	for (i=0; i<n; i++) {
+		if (i%8==0) print "e" i ":"
+		else if (i%8==3) print "    BEQ $t0, $t1, e" (i-i%8)
+		else if (i%8==5) print "    J e" (i-i%8)
+		else if (i%8==6) print "    LW $t0, 8($sp)"
+		else print "    ADD $t0, $t1, $t2 # commentaire"
+	}
+}' > $SOURCE
+
+duree() {
+	debut=$(date +%s%N)
+	"$@" > /dev/null 2>&1
+	fin=$(date +%s%N)
+	echo $(( (fin-debut)/1000000 ))
+}
+
+# une exécution à blanc pour chauffer le cache disque
+$EXEC -q $SOURCE > /dev/null 2>&1
+
+SANS=$(duree $EXEC -q $SOURCE)
+AVEC=$(duree $EXEC $SOURCE)
+TAILLE=$($EXEC $SOURCE 2>/dev/null | wc -c)
+rm -f $SOURCE
+
+echo "lignes source        : $NB_LIGNES"
+echo "assemblage seul      : $SANS ms"
+echo "assemblage + listage : $AVEC ms ($TAILLE octets de listage)"
+awk -v a=$AVEC -v s=$SANS 'BEGIN { if (s>0) printf "rapport              : %.2f\n", a/s }'
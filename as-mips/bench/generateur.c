@@ -0,0 +1,346 @@
+/**
+ * @file generateur.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Générateur déterministe de sources assembleur MIPS synthétiques pour les mesures de performance
+ *
+ * Le source produit utilise toutes les instructions du dictionnaire, avec des opérandes valides pour chacune
+ * (registres nommés ou numérotés, nombres ou étiquettes déjà définies). A graine égale, le source est identique.
+ *
+ * Usage : generateur [-n lignes] [-e %étiquettes] [-d %données] [-c %commentaires] [-s %symboles]
+ *                    [-r %registres nommés] [-g graine] [-i dictionnaire_instructions] [-R dictionnaire_registres]
+ *                    [-o fichier]
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#define LONGUEUR_NOM		32		/**< Longueur maximale d'un nom d'instruction ou de registre */
+#define NB_MAX_DEFINITIONS	256		/**< Nombre maximal d'instructions ou de registres lus dans un dictionnaire */
+#define LIGNES_PAR_BLOC		32		/**< Nombre de lignes consécutives dans une même section */
+#define FENETRE_BRANCHEMENTS	64		/**< Un branchement symbolique vise l'une des dernières étiquettes de .text */
+
+/**
+ * @struct Definition_s
+ * @brief Instruction du dictionnaire : nom, type d'opérandes et placement des champs
+ */
+struct Definition_s {
+	char nom[LONGUEUR_NOM];
+	int nb_ops;
+	char type;					/**< R, N ou B (base + décalage) */
+	char champs[4];				/**< d, s, t, h, i, o, a ou "-" */
+};
+
+/**
+ * @struct Generateur_s
+ * @brief Paramètres et état du générateur
+ */
+struct Generateur_s {
+	unsigned long nb_lignes;			/**< Nombre de lignes à produire */
+	unsigned int pct_etiquettes;		/**< Pourcentage de lignes portant une étiquette */
+	unsigned int pct_donnees;			/**< Pourcentage de blocs de lignes en section de données */
+	unsigned int pct_commentaires;		/**< Pourcentage de lignes portant un commentaire */
+	unsigned int pct_symboles;			/**< Pourcentage d'opérandes immédiats, branchements et sauts symboliques */
+	unsigned int pct_noms_registres;	/**< Pourcentage de registres écrits par leur nom plutôt que par leur numéro */
+	uint64_t etat;						/**< Etat du générateur pseudo-aléatoire */
+
+	struct Definition_s instructions[NB_MAX_DEFINITIONS];
+	int nb_instructions;
+	char registres[NB_MAX_DEFINITIONS][LONGUEUR_NOM];
+	int nb_registres;
+
+	unsigned long nb_etiquettes_text;	/**< Etiquettes déjà définies en .text */
+	unsigned long nb_etiquettes_data;	/**< Etiquettes déjà définies en .data */
+	unsigned long nb_etiquettes_bss;	/**< Etiquettes déjà définies en .bss */
+};
+
+/**
+ * @param gen_p pointeur sur le générateur
+ * @return nombre pseudo-aléatoire sur 32 bits
+ * @brief Tirage xorshift64*, identique sur toutes les plates-formes
+ */
+uint32_t tirer(struct Generateur_s *gen_p)
+{
+	gen_p->etat^=gen_p->etat >> 12;
+	gen_p->etat^=gen_p->etat << 25;
+	gen_p->etat^=gen_p->etat >> 27;
+	return (uint32_t)((gen_p->etat * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+/**
+ * @param gen_p pointeur sur le générateur
+ * @param n borne exclue
+ * @return nombre pseudo-aléatoire dans [0, n[
+ */
+uint32_t tirer_borne(struct Generateur_s *gen_p, uint32_t n)
+{
+	return n ? tirer(gen_p) % n : 0;
+}
+
+/**
+ * @param gen_p pointeur sur le générateur
+ * @param pourcentage probabilité en pourcents
+ * @return 1 avec la probabilité donnée, 0 sinon
+ */
+int tirer_pourcentage(struct Generateur_s *gen_p, unsigned int pourcentage)
+{
+	return tirer_borne(gen_p, 100) < pourcentage;
+}
+
+/**
+ * @param gen_p pointeur sur le générateur
+ * @param fichier dictionnaire des instructions
+ * @return 0 si le dictionnaire a été lu, -1 sinon
+ * @brief Lit le dictionnaire des instructions de l'assembleur (nom, nombre et type d'opérandes, motif, champs)
+ */
+int lire_instructions(struct Generateur_s *gen_p, const char *fichier)
+{
+	FILE *f_p=fopen(fichier, "r");
+	unsigned int motif;
+	int nb, i;
+
+	if ((!f_p) || (1!=fscanf(f_p, "%d", &nb))) return -1;
+	for (i=0; (i<nb) && (i<NB_MAX_DEFINITIONS); i++) {
+		struct Definition_s *def_p=gen_p->instructions+i;
+		if (5!=fscanf(f_p, "%31s %d%c %x %3s", def_p->nom, &def_p->nb_ops, &def_p->type, &motif, def_p->champs)) break;
+	}
+	gen_p->nb_instructions=i;
+	fclose(f_p);
+	return i ? 0 : -1;
+}
+
+/**
+ * @param gen_p pointeur sur le générateur
+ * @param fichier dictionnaire des registres
+ * @return 0 si le dictionnaire a été lu, -1 sinon
+ * @brief Lit les noms de registres du dictionnaire des registres
+ */
+int lire_registres(struct Generateur_s *gen_p, const char *fichier)
+{
+	FILE *f_p=fopen(fichier, "r");
+	int nb, valeur, i;
+
+	if ((!f_p) || (1!=fscanf(f_p, "%d", &nb))) return -1;
+	for (i=0; (i<nb) && (i<NB_MAX_DEFINITIONS); i++)
+		if (2!=fscanf(f_p, "%31s %d", gen_p->registres[i], &valeur)) break;
+	gen_p->nb_registres=i;
+	fclose(f_p);
+	return i ? 0 : -1;
+}
+
+void ecrire_registre(struct Generateur_s *gen_p, FILE *f_p)
+{
+	if ((gen_p->nb_registres) && (tirer_pourcentage(gen_p, gen_p->pct_noms_registres)))
+		fputs(gen_p->registres[tirer_borne(gen_p, gen_p->nb_registres)], f_p);
+	else
+		fprintf(f_p, "$%u", tirer_borne(gen_p, 32));
+}
+
+/**
+ * @param gen_p pointeur sur le générateur
+ * @param f_p fichier de sortie
+ * @param champ lettre du champ de l'opérande (cf. dictionnaire)
+ * @return Rien
+ * @brief Ecrit un opérande valide pour le champ donné
+ */
+void ecrire_operande(struct Generateur_s *gen_p, FILE *f_p, char champ)
+{
+	switch (champ) {
+	case 'd': case 's': case 't':
+		ecrire_registre(gen_p, f_p);
+		break;
+	case 'h':
+		fprintf(f_p, "%u", tirer_borne(gen_p, 32));
+		break;
+	case 'i':
+		if ((gen_p->nb_etiquettes_data) && (tirer_pourcentage(gen_p, gen_p->pct_symboles)))
+			fprintf(f_p, "D%lu", (unsigned long)tirer_borne(gen_p, gen_p->nb_etiquettes_data));
+		else if (tirer_borne(gen_p, 2))
+			fprintf(f_p, "0x%x", tirer_borne(gen_p, 0x8000));
+		else
+			fprintf(f_p, "%u", tirer_borne(gen_p, 32768));
+		break;
+	case 'o':
+		/* branchement vers une étiquette récente, pour rester dans les 16 bits du déplacement */
+		if ((gen_p->nb_etiquettes_text) && (tirer_pourcentage(gen_p, gen_p->pct_symboles)))
+			fprintf(f_p, "T%lu", gen_p->nb_etiquettes_text-1-(unsigned long)tirer_borne(gen_p,
+					gen_p->nb_etiquettes_text<FENETRE_BRANCHEMENTS ? gen_p->nb_etiquettes_text : FENETRE_BRANCHEMENTS));
+		else
+			fprintf(f_p, "%u", tirer_borne(gen_p, 1024));
+		break;
+	case 'a':
+		if ((gen_p->nb_etiquettes_text) && (tirer_pourcentage(gen_p, gen_p->pct_symboles)))
+			fprintf(f_p, "T%lu", (unsigned long)tirer_borne(gen_p, gen_p->nb_etiquettes_text));
+		else
+			fprintf(f_p, "%u", tirer_borne(gen_p, 0x100000));
+		break;
+	}
+}
+
+/**
+ * @param gen_p pointeur sur le générateur
+ * @param f_p fichier de sortie
+ * @return Rien
+ * @brief Ecrit une instruction tirée uniformément dans le dictionnaire
+ */
+void ecrire_instruction(struct Generateur_s *gen_p, FILE *f_p)
+{
+	struct Definition_s *def_p=gen_p->instructions+tirer_borne(gen_p, gen_p->nb_instructions);
+	int i;
+
+	fprintf(f_p, "    %s", def_p->nom);
+	if (def_p->type=='B') {
+		/* registre, décalage(base) */
+		fputc(' ', f_p);
+		ecrire_registre(gen_p, f_p);
+		fprintf(f_p, ", %u(", 4*tirer_borne(gen_p, 256));
+		ecrire_registre(gen_p, f_p);
+		fputc(')', f_p);
+		return;
+	}
+	for (i=0; i<def_p->nb_ops; i++) {
+		fputs(i ? ", " : " ", f_p);
+		ecrire_operande(gen_p, f_p, def_p->champs[i]);
+	}
+}
+
+/**
+ * @param gen_p pointeur sur le générateur
+ * @param f_p fichier de sortie
+ * @param bss TRUE en section .bss (seulement des réservations)
+ * @return Rien
+ * @brief Ecrit une directive de données : .word, .byte ou .space
+ */
+void ecrire_donnee(struct Generateur_s *gen_p, FILE *f_p, int bss)
+{
+	uint32_t choix=bss ? 3 : tirer_borne(gen_p, 4);
+	uint32_t i, nb;
+
+	if (choix<2) {
+		nb=1+tirer_borne(gen_p, 4);
+		fputs("    .word ", f_p);
+		for (i=0; i<nb; i++) {
+			if (i) fputs(", ", f_p);
+			if ((gen_p->nb_etiquettes_text) && (tirer_pourcentage(gen_p, gen_p->pct_symboles)))
+				fprintf(f_p, "T%lu", (unsigned long)tirer_borne(gen_p, gen_p->nb_etiquettes_text));
+			else
+				fprintf(f_p, "%u", tirer(gen_p));
+		}
+	} else if (choix==2) {
+		nb=1+tirer_borne(gen_p, 8);
+		fputs("    .byte ", f_p);
+		for (i=0; i<nb; i++)
+			fprintf(f_p, i ? ", %u" : "%u", tirer_borne(gen_p, 256));
+	} else
+		fprintf(f_p, "    .space %u", 1+tirer_borne(gen_p, 64));
+}
+
+/**
+ * @param gen_p pointeur sur le générateur
+ * @param f_p fichier de sortie
+ * @return Rien
+ * @brief Produit le source complet
+ */
+void generer(struct Generateur_s *gen_p, FILE *f_p)
+{
+	enum { TEXT, DATA, BSS } section=TEXT, nouvelle;
+	unsigned long ligne=0;
+
+	fputs(".text\n", f_p);
+	ligne++;
+	while (ligne<gen_p->nb_lignes) {
+		/* changement de section au début d'un bloc */
+		if (ligne%LIGNES_PAR_BLOC==0) {
+			nouvelle=TEXT;
+			if (tirer_pourcentage(gen_p, gen_p->pct_donnees)) nouvelle=tirer_borne(gen_p, 4) ? DATA : BSS;
+			if (nouvelle!=section) {
+				section=nouvelle;
+				fputs(section==TEXT ? ".text\n" : section==DATA ? ".data\n" : ".bss\n", f_p);
+				ligne++;
+				continue;
+			}
+		}
+
+		/* ligne de commentaire seul */
+		if ((tirer_pourcentage(gen_p, gen_p->pct_commentaires)) && (tirer_borne(gen_p, 2))) {
+			fprintf(f_p, "# commentaire de la ligne %lu\n", ligne+1);
+			ligne++;
+			continue;
+		}
+
+		if (tirer_pourcentage(gen_p, gen_p->pct_etiquettes)) {
+			if (section==TEXT) fprintf(f_p, "T%lu:", gen_p->nb_etiquettes_text++);
+			else if (section==DATA) fprintf(f_p, "D%lu:", gen_p->nb_etiquettes_data++);
+			else fprintf(f_p, "B%lu:", gen_p->nb_etiquettes_bss++);
+		}
+
+		if (section==TEXT) ecrire_instruction(gen_p, f_p);
+		else ecrire_donnee(gen_p, f_p, section==BSS);
+
+		if ((tirer_pourcentage(gen_p, gen_p->pct_commentaires)) && (tirer_borne(gen_p, 2)))
+			fputs("    # commentaire en fin de ligne", f_p);
+		fputc('\n', f_p);
+		ligne++;
+	}
+}
+
+void usage(char *exec)
+{
+	fprintf(stderr, "Usage: %s [-n lignes] [-e %%étiquettes] [-d %%données] [-c %%commentaires] [-s %%symboles]\n"
+			"          [-r %%registres nommés] [-g graine] [-i dictionnaire_instructions] [-R dictionnaire_registres] [-o fichier]\n", exec);
+}
+
+int main(int argc, char *argv[])
+{
+	struct Generateur_s *gen_p=calloc(1, sizeof(*gen_p));
+	const char *dico_instructions="src/dictionnaire_instructions.txt";
+	const char *dico_registres="src/dictionnaire_registres.txt";
+	const char *sortie=NULL;
+	FILE *f_p=stdout;
+	int option;
+
+	if (!gen_p) return EXIT_FAILURE;
+	gen_p->nb_lignes=10000;
+	gen_p->pct_etiquettes=10;
+	gen_p->pct_donnees=20;
+	gen_p->pct_commentaires=10;
+	gen_p->pct_symboles=50;
+	gen_p->pct_noms_registres=50;
+	gen_p->etat=1;
+
+	while ((option=getopt(argc, argv, "n:e:d:c:s:r:g:i:R:o:h"))!=-1)
+		switch (option) {
+		case 'n': gen_p->nb_lignes=strtoul(optarg, NULL, 0); break;
+		case 'e': gen_p->pct_etiquettes=strtoul(optarg, NULL, 0); break;
+		case 'd': gen_p->pct_donnees=strtoul(optarg, NULL, 0); break;
+		case 'c': gen_p->pct_commentaires=strtoul(optarg, NULL, 0); break;
+		case 's': gen_p->pct_symboles=strtoul(optarg, NULL, 0); break;
+		case 'r': gen_p->pct_noms_registres=strtoul(optarg, NULL, 0); break;
+		case 'g': gen_p->etat=strtoull(optarg, NULL, 0); break;
+		case 'i': dico_instructions=optarg; break;
+		case 'R': dico_registres=optarg; break;
+		case 'o': sortie=optarg; break;
+		default: usage(argv[0]); return EXIT_FAILURE;
+		}
+	if (!gen_p->etat) gen_p->etat=1; /* xorshift ne doit pas partir de 0 */
+
+	if (lire_instructions(gen_p, dico_instructions)) {
+		fprintf(stderr, "Impossible de lire le dictionnaire des instructions \"%s\"\n", dico_instructions);
+		return EXIT_FAILURE;
+	}
+	if (lire_registres(gen_p, dico_registres))
+		gen_p->nb_registres=0; /* registres numérotés seulement */
+
+	if ((sortie) && (!(f_p=fopen(sortie, "w")))) {
+		fprintf(stderr, "Impossible de créer \"%s\"\n", sortie);
+		return EXIT_FAILURE;
+	}
+	setvbuf(f_p, NULL, _IOFBF, 1<<20);
+	generer(gen_p, f_p);
+	if (sortie) fclose(f_p);
+	free(gen_p);
+	return EXIT_SUCCESS;
+}
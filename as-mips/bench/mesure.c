@@ -0,0 +1,67 @@
+/**
+ * @file mesure.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Exécute une commande et mesure son temps d'exécution et son pic de mémoire résidente
+ *
+ * Usage : mesure NB_LIGNES FICHIER_SOURCE commande [arguments...]
+ * Ecrit une ligne : lignes, octets, secondes, lignes/s, Mo/s, pic de mémoire résidente (Ko), code de retour.
+ * La sortie standard de la commande est redirigée vers /dev/null.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#define _DEFAULT_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+int main(int argc, char *argv[])
+{
+	struct timespec debut, fin;
+	struct rusage ressources;
+	struct stat etat;
+	unsigned long nb_lignes;
+	double secondes;
+	int statut, nul;
+	pid_t pid;
+
+	if (argc<4) {
+		fprintf(stderr, "Usage: %s NB_LIGNES FICHIER_SOURCE commande [arguments...]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	nb_lignes=strtoul(argv[1], NULL, 0);
+	if (stat(argv[2], &etat)) {
+		perror(argv[2]);
+		return EXIT_FAILURE;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &debut);
+	pid=fork();
+	if (pid<0) {
+		perror("fork");
+		return EXIT_FAILURE;
+	}
+	if (!pid) {
+		if ((nul=open("/dev/null", O_WRONLY))>=0) dup2(nul, STDOUT_FILENO);
+		execvp(argv[3], argv+3);
+		perror(argv[3]);
+		_exit(127);
+	}
+	if (wait4(pid, &statut, 0, &ressources)<0) {
+		perror("wait4");
+		return EXIT_FAILURE;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &fin);
+
+	secondes=(fin.tv_sec-debut.tv_sec)+(fin.tv_nsec-debut.tv_nsec)*1e-9;
+	printf("%10lu %12lu %9.3f %12.0f %9.2f %10ld %4d\n", nb_lignes, (unsigned long)etat.st_size, secondes,
+			nb_lignes/secondes, etat.st_size/secondes/1e6, ressources.ru_maxrss,
+			WIFEXITED(statut) ? WEXITSTATUS(statut) : -1);
+	return EXIT_SUCCESS;
+}
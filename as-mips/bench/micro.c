@@ -0,0 +1,68 @@
+/**
+ * @file micro.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions du banc de mesure des micro-bancs d'essai
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <micro.h>
+
+static int nb_repetitions=NB_REPETITIONS;
+
+/**
+ * @param argc nombre d'arguments de la ligne de commande
+ * @param argv arguments : le premier, facultatif, est le nombre de répétitions mesurées
+ * @return Rien
+ * @brief Lit les paramètres communs des micro-bancs et écrit l'entête du rapport
+ */
+void initialiser_micro(int argc, char *argv[])
+{
+	if (argc>1) nb_repetitions=atoi(argv[1]);
+	if (nb_repetitions<1) nb_repetitions=1;
+	if (nb_repetitions>NB_MAX_REPETITIONS) nb_repetitions=NB_MAX_REPETITIONS;
+	printf("%-44s %12s %13s %13s\n", "banc", "min (ns/op)", "médiane", "opérations");
+}
+
+/**
+ * @return temps de l'horloge monotone en nanosecondes
+ */
+double horloge_ns(void)
+{
+	struct timespec temps;
+
+	clock_gettime(CLOCK_MONOTONIC, &temps);
+	return temps.tv_sec*1e9 + temps.tv_nsec;
+}
+
+int comparer_durees(const void *a_p, const void *b_p)
+{
+	double a=*(const double *)a_p, b=*(const double *)b_p;
+	return (a>b)-(a<b);
+}
+
+/**
+ * @param banc_p pointeur sur le banc d'essai
+ * @return Rien
+ * @brief Chauffe puis mesure le banc et écrit une ligne de rapport
+ */
+void mesurer_banc(struct Banc_s *banc_p)
+{
+	double durees[NB_MAX_REPETITIONS];
+	double debut;
+	int i;
+
+	for (i=-NB_ECHAUFFEMENTS; i<nb_repetitions; i++) {
+		if (banc_p->preparer_p) banc_p->preparer_p(banc_p->contexte_p);
+		debut=horloge_ns();
+		banc_p->executer_p(banc_p->contexte_p);
+		if (i>=0) durees[i]=(horloge_ns()-debut)/banc_p->nb_operations;
+		if (banc_p->nettoyer_p) banc_p->nettoyer_p(banc_p->contexte_p);
+	}
+	qsort(durees, nb_repetitions, sizeof(*durees), comparer_durees);
+	printf("%-44s %12.2f %12.2f %12lu\n", banc_p->nom, durees[0], durees[nb_repetitions/2], banc_p->nb_operations);
+	fflush(stdout);
+}
@@ -0,0 +1,37 @@
+/**
+ * @file micro.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des types et des prototypes du banc de mesure des micro-bancs d'essai
+ *
+ * Chaque banc est exécuté quelques fois à blanc pour chauffer les caches, puis mesuré sur plusieurs répétitions.
+ * La préparation et le nettoyage d'une répétition (création d'une table vide...) ne sont pas chronométrés.
+ * Le résultat est donné en nanosecondes par opération : minimum et médiane des répétitions.
+ */
+
+#ifndef _MICRO_H_
+#define _MICRO_H_
+
+#define NB_ECHAUFFEMENTS	2		/**< Exécutions à blanc avant les mesures */
+#define NB_REPETITIONS		7		/**< Répétitions mesurées par défaut */
+#define NB_MAX_REPETITIONS	101		/**< Nombre maximal de répétitions mesurées */
+
+/* Définition commune des étapes d'un banc d'essai : elles reçoivent le contexte du banc */
+typedef void (fonctionBanc)(void *);
+
+/**
+ * @struct Banc_s
+ * @brief Banc d'essai : opération mesurée, préparation et nettoyage de chaque répétition
+ */
+struct Banc_s {
+	const char *nom;				/**< Nom du banc dans le rapport */
+	fonctionBanc *preparer_p;		/**< Préparation non chronométrée d'une répétition, NULL si aucune */
+	fonctionBanc *executer_p;		/**< Exécution chronométrée de nb_operations opérations */
+	fonctionBanc *nettoyer_p;		/**< Nettoyage non chronométré après une répétition, NULL si aucun */
+	void *contexte_p;				/**< Contexte passé aux trois fonctions */
+	unsigned long nb_operations;	/**< Nombre d'opérations d'une exécution */
+};
+
+void initialiser_micro(int argc, char *argv[]);
+void mesurer_banc(struct Banc_s *banc_p);
+
+#endif /* _MICRO_H_ */
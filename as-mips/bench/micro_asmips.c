@@ -0,0 +1,125 @@
+/**
+ * @file micro_asmips.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Micro-bancs d'essai de la bibliothèque libasmips : assemblage d'un petit source en mémoire
+ *
+ * Le même source est assemblé par un contexte réutilisé, puis par un contexte créé pour chaque assemblage
+ * (dictionnaires partagés), ce qui mesure ce que la réutilisation évite. A lancer depuis le répertoire d'as-mips :
+ * le banc lit lui-même les dictionnaires par défaut et en donne les textes à la bibliothèque.
+ *
+ * Usage : micro_asmips [répétitions]
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <micro.h>
+#include <global.h>
+#include <asmips.h>
+
+#define NB_ASSEMBLAGES	200		/**< Nombre d'assemblages par exécution */
+
+static const char SOURCE[]=
+	".text\n"
+	"debut:  ADDI $t0, $zero, 10\n"
+	"        LW $t1, 4($gp)\n"
+	"boucle: ADD $t2, $t2, $t1\n"
+	"        ADDI $t0, $t0, -1\n"
+	"        BNE $t0, $zero, boucle\n"
+	"        NOP\n"
+	"        SW $t2, 0($sp)\n"
+	"        J debut\n"
+	"        NOP\n"
+	".data\n"
+	"valeurs: .word 1, 2, 3, boucle\n"
+	"octets:  .byte 0x1A, 023\n"
+	".bss\n"
+	"tampon: .space 64\n";
+
+/**
+ * @struct BancAsmMips_s
+ * @brief Contexte des bancs de la bibliothèque
+ */
+struct BancAsmMips_s {
+	struct AsmMips_s *modele_p;		/**< Contexte réutilisé, dont les dictionnaires sont partagés */
+	unsigned long somme;			/**< Résultat cumulé, pour que les appels ne soient pas éliminés */
+};
+
+/**
+ * @param nom nom du fichier
+ * @return contenu du fichier terminé par '\0', à libérer par free, NULL s'il n'a pas pu être lu
+ */
+char *lire_texte(const char *nom)
+{
+	FILE *fp=fopen(nom, "rb");
+	char *texte_p=NULL;
+	long taille;
+
+	if (!fp) return NULL;
+	if ((!fseek(fp, 0, SEEK_END)) && ((taille=ftell(fp))>=0) && (!fseek(fp, 0, SEEK_SET))
+			&& ((texte_p=malloc(taille+1))) && (fread(texte_p, 1, taille, fp)==(size_t)taille))
+		texte_p[taille]='\0';
+	else {
+		free(texte_p);
+		texte_p=NULL;
+	}
+	fclose(fp);
+	return texte_p;
+}
+
+void executer_reutilise(void *contexte_p)
+{
+	struct BancAsmMips_s *banc_p=contexte_p;
+	int i;
+
+	for (i=0; i<NB_ASSEMBLAGES; i++) {
+		if (SUCCESS!=asmips_assembler(banc_p->modele_p, SOURCE, sizeof(SOURCE)-1, "micro.s")) exit(EXIT_FAILURE);
+		banc_p->somme+=banc_p->modele_p->sections[S_TEXT].taille;
+	}
+}
+
+void executer_neuf(void *contexte_p)
+{
+	struct BancAsmMips_s *banc_p=contexte_p;
+	struct AsmMips_s *asmips_p;
+	int i;
+
+	for (i=0; i<NB_ASSEMBLAGES; i++) {
+		asmips_p=creer_asmips_partage(banc_p->modele_p);
+		if (SUCCESS!=asmips_assembler(asmips_p, SOURCE, sizeof(SOURCE)-1, "micro.s")) exit(EXIT_FAILURE);
+		banc_p->somme+=asmips_p->sections[S_TEXT].taille;
+		asmips_p=detruire_asmips(asmips_p);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	static struct BancAsmMips_s contexte;
+	struct Banc_s banc;
+	char *instructions=lire_texte(DICTIONNAIRE_INSTRUCTIONS), *registres=lire_texte(DICTIONNAIRE_REGISTRES);
+
+	initialiser_micro(argc, argv);
+	contexte.modele_p=creer_asmips(instructions, registres);
+	free(instructions);
+	free(registres);
+	if (!contexte.modele_p) {
+		fprintf(stderr, "Impossible de charger les dictionnaires\n");
+		return EXIT_FAILURE;
+	}
+	banc.contexte_p=&contexte;
+	banc.preparer_p=NULL;
+	banc.nettoyer_p=NULL;
+	banc.nb_operations=NB_ASSEMBLAGES;
+
+	banc.nom="asmips_assembler, contexte réutilisé (par source)";
+	banc.executer_p=executer_reutilise;
+	mesurer_banc(&banc);
+
+	banc.nom="asmips_assembler, contexte neuf (par source)";
+	banc.executer_p=executer_neuf;
+	mesurer_banc(&banc);
+
+	contexte.modele_p=detruire_asmips(contexte.modele_p);
+	return (contexte.somme ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,117 @@
+/**
+ * @file micro_lex.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Micro-bancs d'essai de l'analyse lexicale : mise en forme des lignes et machine à états finis
+ *
+ * Les lignes mesurées sont représentatives d'un source : instructions de chaque forme d'opérandes, directives,
+ * étiquettes, commentaires, espaces et tabulations irrégulières.
+ *
+ * Usage : micro_lex [répétitions]
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <micro.h>
+#include <global.h>
+#include <str_utils.h>
+#include <lex.h>
+
+#define NB_PASSES	2000	/**< Nombre de passages sur l'échantillon de lignes par exécution */
+
+static const char *LIGNES[]={
+	"boucle:  ADD $t0,$t1,$t2   # somme",
+	"\tADDI $2, $3, -200",
+	"    LW $31, 0x60($10)",
+	"SW $t0,8( $sp )",
+	"\t\tBEQ $s0 , $s1 , boucle",
+	"J 0x3847",
+	"    ROTR $20,$21,31",
+	".data",
+	"tab:\t.word -1000,-0400,-0x1",
+	"   .byte 0x1A,023 # octets",
+	".space 05",
+	"# une ligne de commentaire seul",
+	"fin: NOP",
+	"  SYSTCALL"
+};
+#define NB_LIGNES	(sizeof(LIGNES)/sizeof(*LIGNES))
+
+/**
+ * @struct BancLex_s
+ * @brief Contexte des bancs de l'analyse lexicale
+ */
+struct BancLex_s {
+	char entrees[NB_LIGNES][2*STRLEN];		/**< Lignes brutes */
+	char sorties[NB_LIGNES][2*STRLEN];		/**< Lignes mises en forme */
+	char *lexemes[NB_LIGNES*16];			/**< Lexèmes des lignes mises en forme */
+	int nb_lexemes;
+	unsigned long nb_caracteres;			/**< Nombre de caractères de tous les lexèmes */
+	unsigned long somme;					/**< Résultat cumulé, pour que les appels ne soient pas éliminés */
+};
+
+void executer_standardise(void *contexte_p)
+{
+	struct BancLex_s *banc_p=contexte_p;
+	size_t i;
+	int passe;
+
+	for (passe=0; passe<NB_PASSES; passe++)
+		for (i=0; i<NB_LIGNES; i++) {
+			lex_standardise(banc_p->entrees[i], banc_p->sorties[i]);
+			banc_p->somme+=banc_p->sorties[i][0];
+		}
+}
+
+void executer_machine_etats(void *contexte_p)
+{
+	struct BancLex_s *banc_p=contexte_p;
+	enum Etat_lex_e etat;
+	const char *c_p;
+	int i, passe;
+
+	for (passe=0; passe<NB_PASSES; passe++)
+		for (i=0; i<banc_p->nb_lexemes; i++) {
+			etat=INIT;
+			for (c_p=banc_p->lexemes[i]; *c_p; c_p++) etat=machine_etats_finis_lexicale(etat, *c_p);
+			banc_p->somme+=etat;
+		}
+}
+
+int main(int argc, char *argv[])
+{
+	static struct BancLex_s contexte;
+	struct Banc_s banc;
+	char *lexeme_p;
+	size_t i;
+
+	initialiser_micro(argc, argv);
+	banc.contexte_p=&contexte;
+	banc.preparer_p=NULL;
+	banc.nettoyer_p=NULL;
+
+	/* découpe une fois pour toutes les lignes mises en forme en lexèmes, comme lex_read_line */
+	for (i=0; i<NB_LIGNES; i++) {
+		strcpy(contexte.entrees[i], LIGNES[i]);
+		lex_standardise(contexte.entrees[i], contexte.sorties[i]);
+		for (lexeme_p=strtok(contexte.sorties[i], " "); lexeme_p; lexeme_p=strtok(NULL, " ")) {
+			if (*lexeme_p=='#') break;
+			contexte.lexemes[contexte.nb_lexemes++]=strdup(lexeme_p);
+			contexte.nb_caracteres+=strlen(lexeme_p);
+		}
+	}
+
+	banc.nom="lex_standardise (par ligne)";
+	banc.executer_p=executer_standardise;
+	banc.nb_operations=NB_PASSES*NB_LIGNES;
+	mesurer_banc(&banc);
+
+	banc.nom="machine_etats_finis_lexicale (par caractère)";
+	banc.executer_p=executer_machine_etats;
+	banc.nb_operations=NB_PASSES*contexte.nb_caracteres;
+	mesurer_banc(&banc);
+
+	for (i=0; i<(size_t)contexte.nb_lexemes; i++) free(contexte.lexemes[i]);
+	return (contexte.somme ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,112 @@
+/**
+ * @file micro_liste.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Micro-bancs d'essai des listes génériques : ajout en fin de liste et parcours
+ *
+ * Usage : micro_liste [répétitions]
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <micro.h>
+#include <global.h>
+#include <liste.h>
+
+/**
+ * @struct BancListe_s
+ * @brief Contexte des bancs d'une liste
+ */
+struct BancListe_s {
+	size_t nb_elements;			/**< Nombre d'éléments de la liste */
+	struct Liste_s *liste_p;	/**< Liste de la répétition en cours */
+	size_t somme;				/**< Résultat cumulé des parcours, pour qu'ils ne soient pas éliminés */
+};
+
+/* les données sont des entiers déguisés en pointeurs : rien à libérer */
+void ne_rien_detruire(void *donnee_p)
+{
+	(void)donnee_p;
+}
+
+void remplir_liste(struct BancListe_s *banc_p)
+{
+	size_t i;
+
+	for (i=0; i<banc_p->nb_elements; i++) ajouter_fin_liste(banc_p->liste_p, (void *)(i+1));
+}
+
+void preparer_liste_vide(void *contexte_p)
+{
+	struct BancListe_s *banc_p=contexte_p;
+	banc_p->liste_p=creer_liste(ne_rien_detruire);
+}
+
+void preparer_liste_pleine(void *contexte_p)
+{
+	preparer_liste_vide(contexte_p);
+	remplir_liste(contexte_p);
+}
+
+void nettoyer_liste(void *contexte_p)
+{
+	struct BancListe_s *banc_p=contexte_p;
+	banc_p->liste_p=detruire_liste(banc_p->liste_p);
+}
+
+void executer_ajout(void *contexte_p)
+{
+	remplir_liste(contexte_p);
+}
+
+void executer_parcours(void *contexte_p)
+{
+	struct BancListe_s *banc_p=contexte_p;
+	struct NoeudListe_s *noeud_p;
+
+	for (noeud_p=banc_p->liste_p->debut_liste_p; noeud_p; noeud_p=noeud_p->suivant_p)
+		banc_p->somme+=(size_t)noeud_p->donnee_p;
+}
+
+/* la destruction est elle aussi mesurée : c'est la moitié du coût d'une liste de lexèmes */
+void executer_destruction(void *contexte_p)
+{
+	nettoyer_liste(contexte_p);
+}
+
+int main(int argc, char *argv[])
+{
+	static const size_t NB_ELEMENTS[]={1000, 100000, 1000000};
+	struct BancListe_s contexte;
+	struct Banc_s banc;
+	char nom[64];
+	size_t t;
+
+	initialiser_micro(argc, argv);
+	memset(&contexte, 0, sizeof(contexte));
+	banc.contexte_p=&contexte;
+	banc.nom=nom;
+
+	for (t=0; t<sizeof(NB_ELEMENTS)/sizeof(*NB_ELEMENTS); t++) {
+		contexte.nb_elements=NB_ELEMENTS[t];
+		banc.nb_operations=contexte.nb_elements;
+
+		sprintf(nom, "liste ajout en fin   n=%lu", (unsigned long)contexte.nb_elements);
+		banc.preparer_p=preparer_liste_vide;
+		banc.executer_p=executer_ajout;
+		banc.nettoyer_p=nettoyer_liste;
+		mesurer_banc(&banc);
+
+		sprintf(nom, "liste parcours       n=%lu", (unsigned long)contexte.nb_elements);
+		banc.preparer_p=preparer_liste_pleine;
+		banc.executer_p=executer_parcours;
+		mesurer_banc(&banc);
+
+		sprintf(nom, "liste destruction    n=%lu", (unsigned long)contexte.nb_elements);
+		banc.executer_p=executer_destruction;
+		banc.nettoyer_p=NULL;
+		mesurer_banc(&banc);
+	}
+	return (contexte.somme ? EXIT_SUCCESS : EXIT_FAILURE);
+}
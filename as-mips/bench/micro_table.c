@@ -0,0 +1,165 @@
+/**
+ * @file micro_table.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Micro-bancs d'essai des tables de hachage génériques : insertion, recherche réussie ou non, suppression
+ *
+ * Les clefs sont des chaines préparées à l'avance qui sont leur propre clef (pas de fonction clef). Chaque banc
+ * est mesuré pour plusieurs nombres d'éléments et plusieurs facteurs de charge, la taille de la table étant fixée
+ * à la création pour que l'insertion ne déclenche pas d'agrandissement.
+ *
+ * Usage : micro_table [répétitions]
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <micro.h>
+#include <global.h>
+#include <notify.h>
+#include <table.h>
+
+#define LONGUEUR_CLEF	12		/**< Longueur maximale d'une clef, zéro final compris */
+
+/**
+ * @struct BancTable_s
+ * @brief Contexte des bancs d'une table
+ */
+struct BancTable_s {
+	size_t nb_elements;				/**< Nombre d'éléments insérés */
+	double charge;					/**< Facteur de charge visé */
+	char (*presentes)[LONGUEUR_CLEF];	/**< Clefs insérées */
+	char (*absentes)[LONGUEUR_CLEF];	/**< Clefs jamais insérées */
+	struct Table_s *table_p;		/**< Table de la répétition en cours */
+	size_t nb_trouvees;				/**< Résultat cumulé des recherches, pour qu'elles ne soient pas éliminées */
+};
+
+/* les clefs appartiennent au banc : la table ne doit rien libérer */
+void ne_rien_detruire(void *donnee_p)
+{
+	(void)donnee_p;
+}
+
+/**
+ * @param banc_p pointeur sur le contexte du banc
+ * @return Rien
+ * @brief Crée une table vide dont la taille donne le facteur de charge visé une fois tous les éléments insérés
+ */
+void creer_table_vide(struct BancTable_s *banc_p)
+{
+	banc_p->table_p=creer_table(2, NULL, ne_rien_detruire);
+	free(banc_p->table_p->table);
+	banc_p->table_p->nbEltsMax=nombrePremierGET((size_t)(banc_p->nb_elements/banc_p->charge)+1);
+	if (!(banc_p->table_p->table=calloc(banc_p->table_p->nbEltsMax, sizeof(*banc_p->table_p->table))))
+		ERROR_MSG("Impossible de créer la table du banc");
+}
+
+void remplir_table(struct BancTable_s *banc_p)
+{
+	size_t i;
+
+	for (i=0; i<banc_p->nb_elements; i++) ajouter_table(banc_p->table_p, banc_p->presentes[i]);
+}
+
+void preparer_table_vide(void *contexte_p)
+{
+	creer_table_vide(contexte_p);
+}
+
+void preparer_table_pleine(void *contexte_p)
+{
+	creer_table_vide(contexte_p);
+	remplir_table(contexte_p);
+}
+
+void nettoyer_table(void *contexte_p)
+{
+	struct BancTable_s *banc_p=contexte_p;
+	banc_p->table_p=detruire_table(banc_p->table_p);
+}
+
+void executer_insertion(void *contexte_p)
+{
+	remplir_table(contexte_p);
+}
+
+void executer_recherche_presente(void *contexte_p)
+{
+	struct BancTable_s *banc_p=contexte_p;
+	size_t i;
+
+	for (i=0; i<banc_p->nb_elements; i++)
+		banc_p->nb_trouvees+=(NULL!=donnee_table(banc_p->table_p, banc_p->presentes[i]));
+}
+
+void executer_recherche_absente(void *contexte_p)
+{
+	struct BancTable_s *banc_p=contexte_p;
+	size_t i;
+
+	for (i=0; i<banc_p->nb_elements; i++)
+		banc_p->nb_trouvees+=(NULL!=donnee_table(banc_p->table_p, banc_p->absentes[i]));
+}
+
+/* supprime dans l'ordre inverse des insertions */
+void executer_suppression(void *contexte_p)
+{
+	struct BancTable_s *banc_p=contexte_p;
+	size_t i;
+
+	for (i=banc_p->nb_elements; i>0; i--)
+		supprimer_table(banc_p->table_p, banc_p->presentes[i-1]);
+}
+
+int main(int argc, char *argv[])
+{
+	static const size_t NB_ELEMENTS[]={1000, 100000, 1000000};
+	static const double CHARGES[]={0.25, 0.5, 0.65};
+	struct BancTable_s contexte;
+	struct Banc_s banc;
+	char nom[64];
+	size_t i, t, c;
+
+	initialiser_micro(argc, argv);
+	memset(&contexte, 0, sizeof(contexte));
+	banc.contexte_p=&contexte;
+
+	for (t=0; t<sizeof(NB_ELEMENTS)/sizeof(*NB_ELEMENTS); t++) {
+		contexte.nb_elements=NB_ELEMENTS[t];
+		contexte.presentes=malloc(contexte.nb_elements*sizeof(*contexte.presentes));
+		contexte.absentes=malloc(contexte.nb_elements*sizeof(*contexte.absentes));
+		if ((!contexte.presentes) || (!contexte.absentes)) ERROR_MSG("Impossible de créer les clefs du banc");
+		for (i=0; i<contexte.nb_elements; i++) {
+			sprintf(contexte.presentes[i], "e%lu", (unsigned long)i);
+			sprintf(contexte.absentes[i], "x%lu", (unsigned long)i);
+		}
+		banc.nb_operations=contexte.nb_elements;
+
+		for (c=0; c<sizeof(CHARGES)/sizeof(*CHARGES); c++) {
+			contexte.charge=CHARGES[c];
+			banc.nom=nom;
+			banc.nettoyer_p=nettoyer_table;
+
+			sprintf(nom, "table insertion      n=%-7lu charge=%.2f", (unsigned long)contexte.nb_elements, contexte.charge);
+			banc.preparer_p=preparer_table_vide;
+			banc.executer_p=executer_insertion;
+			mesurer_banc(&banc);
+
+			sprintf(nom, "table recherche ok   n=%-7lu charge=%.2f", (unsigned long)contexte.nb_elements, contexte.charge);
+			banc.preparer_p=preparer_table_pleine;
+			banc.executer_p=executer_recherche_presente;
+			mesurer_banc(&banc);
+
+			sprintf(nom, "table recherche ko   n=%-7lu charge=%.2f", (unsigned long)contexte.nb_elements, contexte.charge);
+			banc.executer_p=executer_recherche_absente;
+			mesurer_banc(&banc);
+
+			sprintf(nom, "table suppression    n=%-7lu charge=%.2f", (unsigned long)contexte.nb_elements, contexte.charge);
+			banc.executer_p=executer_suppression;
+			mesurer_banc(&banc);
+		}
+		free(contexte.presentes);
+		free(contexte.absentes);
+	}
+	return (contexte.nb_trouvees ? EXIT_SUCCESS : EXIT_FAILURE);
+}
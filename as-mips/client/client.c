@@ -0,0 +1,127 @@
+/**
+ * @file client.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Client léger du mode serveur : s'utilise comme as-mips, mais fait assembler par un serveur déjà prêt
+ *
+ * Les arguments sont transmis tels quels avec le répertoire courant ; le listage, les diagnostics et le code de
+ * sortie du serveur sont rendus comme si as-mips avait été lancé. Le socket est donné par la variable
+ * d'environnement AS_MIPS_SERVEUR. Si le serveur ne répond pas et que la variable AS_MIPS désigne un
+ * assembleur, c'est lui qui est lancé à la place.
+ *
+ * Usage : as-mips-client [options d'as-mips] source.s
+ *         as-mips-client --stop
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <global.h>
+#include <serveur.h>
+
+#define TAILLE_REPERTOIRE	4096	/**< Longueur maximale du répertoire courant */
+
+/**
+ * @param fp flux de la connexion
+ * @param nom nom du champ
+ * @param donnees données du champ
+ * @param taille nombre d'octets des données
+ * @return Rien
+ */
+void envoyer(FILE *fp, const char *nom, const char *donnees, size_t taille)
+{
+	fprintf(fp, "%s %lu\n", nom, (unsigned long)taille);
+	fwrite(donnees, 1, taille, fp);
+}
+
+/**
+ * @param fp flux de la connexion
+ * @param descripteur descripteur sur lequel recopier les données du champ
+ * @param nom nom du champ reçu
+ * @param statut_p pointeur sur le code de sortie, mis à jour par le champ STATUT
+ * @return SUCCESS si un champ a été lu, FAILURE sinon
+ * @brief Lit un champ de la réponse et recopie ses données
+ */
+int recevoir(FILE *fp, char *nom, int *statut_p)
+{
+	char donnees[4096];
+	unsigned long taille;
+	size_t morceau;
+	FILE *destination_p;
+
+	if (2!=fscanf(fp, "%16s %lu", nom, &taille) || (fgetc(fp)!='\n')) return FAILURE;
+	destination_p=(!strcmp(nom, SERVEUR_SORTIE)) ? stdout : ((!strcmp(nom, SERVEUR_ERREURS)) ? stderr : NULL);
+
+	while (taille) {
+		morceau=(taille<sizeof(donnees)-1) ? taille : sizeof(donnees)-1;
+		if (fread(donnees, 1, morceau, fp)!=morceau) return FAILURE;
+		donnees[morceau]='\0';
+		if (destination_p) fwrite(donnees, 1, morceau, destination_p);
+		else if (!strcmp(nom, SERVEUR_STATUT)) *statut_p=atoi(donnees);
+		taille-=morceau;
+	}
+	return SUCCESS;
+}
+
+/**
+ * @param argv arguments du client
+ * @return Ne revient que si l'assembleur de secours ne peut pas être lancé
+ * @brief Lance l'assembleur désigné par AS_MIPS avec les mêmes arguments
+ */
+void secours(char *argv[])
+{
+	char *assembleur=getenv("AS_MIPS");
+
+	if (!assembleur) return;
+	argv[0]=assembleur;
+	execv(assembleur, argv);
+}
+
+int main(int argc, char *argv[])
+{
+	struct sockaddr_un adresse;
+	char repertoire[TAILLE_REPERTOIRE];
+	char nom[SERVEUR_NOM_MAX+1];
+	char *chemin=getenv("AS_MIPS_SERVEUR");
+	int statut=EXIT_FAILURE;
+	int arret=((argc==2) && (!strcmp(argv[1], "--stop")));
+	int connexion;
+	int i;
+	FILE *fp;
+
+	if ((!chemin) || (strlen(chemin)>=sizeof(adresse.sun_path))) {
+		secours(argv);
+		fprintf(stderr, "%s : la variable AS_MIPS_SERVEUR doit donner le socket du serveur\n", argv[0]);
+		exit(EXIT_FAILURE);
+	}
+	memset(&adresse, 0, sizeof(adresse));
+	adresse.sun_family=AF_UNIX;
+	strcpy(adresse.sun_path, chemin);
+	if (((connexion=socket(AF_UNIX, SOCK_STREAM, 0))<0) || (connect(connexion, (struct sockaddr *)&adresse, sizeof(adresse)))) {
+		secours(argv);
+		fprintf(stderr, "%s : pas de serveur sur \"%s\" (%s)\n", argv[0], chemin, strerror(errno));
+		exit(EXIT_FAILURE);
+	}
+	if (!(fp=fdopen(connexion, "r+"))) exit(EXIT_FAILURE);
+
+	if (arret)
+		envoyer(fp, SERVEUR_ARRET, "", 0);
+	else {
+		if (!getcwd(repertoire, sizeof(repertoire))) strcpy(repertoire, ".");
+		envoyer(fp, SERVEUR_REP, repertoire, strlen(repertoire));
+		envoyer(fp, SERVEUR_TERMINAUX, isatty(STDOUT_FILENO) ? (isatty(STDERR_FILENO) ? "11" : "10") : (isatty(STDERR_FILENO) ? "01" : "00"), 2);
+		for (i=1; i<argc; i++) envoyer(fp, SERVEUR_ARG, argv[i], strlen(argv[i]));
+	}
+	envoyer(fp, SERVEUR_FIN, "", 0);
+	fflush(fp);
+
+	while (SUCCESS==recevoir(fp, nom, &statut))
+		if (!strcmp(nom, SERVEUR_FIN)) break;
+	fclose(fp);
+	exit(arret ? EXIT_SUCCESS : statut);
+}
@@ -0,0 +1,98 @@
+/**
+ * @file asmips.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des types et des prototypes de la bibliothèque libasmips (make lib)
+ *
+ * Un contexte assemble un source en mémoire et rend le contenu des sections, les étiquettes et les diagnostics.
+ * La bibliothèque n'accède à aucun fichier, n'écrit rien et ne termine jamais le programme : une erreur fatale
+ * devient un diagnostic DIAG_FATALE. Les textes des dictionnaires des instructions et des registres sont donc
+ * fournis par l'appelant à creer_asmips (contenu de src/dictionnaire_instructions.txt et de
+ * src/dictionnaire_registres.txt, lu ou compilé dans le programme), qui rend NULL si l'un d'eux manque. Un
+ * contexte est réutilisé d'un assemblage à l'autre sans réallouer ses tampons ; plusieurs contextes peuvent
+ * travailler en même temps dans des threads différents.
+ *
+ * Exemple :
+ *   struct AsmMips_s *asmips_p=creer_asmips(texte_instructions, texte_registres);
+ *   if (SUCCESS==asmips_assembler(asmips_p, texte, strlen(texte), "essai.s"))
+ *       utiliser(asmips_p->sections[S_TEXT].contenu, asmips_p->sections[S_TEXT].taille);
+ *   asmips_p=detruire_asmips(asmips_p);
+ */
+
+#ifndef _ASMIPS_H_
+#define _ASMIPS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+
+#include <global.h>
+#include <diag.h>
+#include <syn.h>
+#include <image.h>
+#include <assemblage.h>
+
+/**
+ * @struct SectionAsmMips_s
+ * @brief Section produite par l'assemblage
+ */
+struct SectionAsmMips_s {
+	uint32_t adresse;					/**< Adresse de début de la section */
+	uint32_t taille;					/**< Taille de la section en octets */
+	uint8_t *contenu;					/**< Contenu de la section (taille octets), NULL pour .bss */
+	size_t capacite;					/**< Taille allouée du contenu, conservée d'un assemblage à l'autre */
+};
+
+/**
+ * @struct SymboleAsmMips_s
+ * @brief Etiquette définie par le source
+ */
+struct SymboleAsmMips_s {
+	const char *nom;					/**< Nom de l'étiquette */
+	enum Section_e section;				/**< Section de l'étiquette */
+	uint32_t adresse;					/**< Adresse de l'étiquette, section placée */
+	unsigned int ligne;					/**< Ligne de définition dans le source */
+};
+
+/**
+ * @struct DiagnosticAsmMips_s
+ * @brief Diagnostic de l'assemblage
+ */
+struct DiagnosticAsmMips_s {
+	enum Severite_e severite;			/**< Gravité du diagnostic */
+	unsigned int ligne;					/**< Ligne concernée, 0 si sans objet */
+	const char *code;					/**< Identifiant court et stable du diagnostic */
+	const char *message;				/**< Texte du diagnostic */
+};
+
+/**
+ * @struct AsmMips_s
+ * @brief Contexte d'assemblage réutilisable
+ *
+ * Les résultats restent valables jusqu'à l'assemblage suivant ou la destruction du contexte. Les paramètres
+ * (boutisme, adresses fixées des sections) peuvent être changés entre deux assemblages.
+ */
+struct AsmMips_s {
+	struct ParametresImage_s parametres;			/**< Boutisme et placement des sections */
+
+	struct SectionAsmMips_s sections[4];			/**< Sections produites, indicées par Section_e */
+	struct SymboleAsmMips_s *symboles;				/**< Etiquettes définies, par adresse croissante */
+	size_t nb_symboles;								/**< Nombre d'étiquettes */
+	struct DiagnosticAsmMips_s *diagnostics;		/**< Diagnostics, dans l'ordre où ils ont été signalés */
+	size_t nb_diagnostics;							/**< Nombre de diagnostics */
+
+	size_t capacite_symboles;						/**< Taille allouée des étiquettes */
+	size_t capacite_diagnostics;					/**< Taille allouée des diagnostics */
+	struct Dictionnaires_s dictionnaires;			/**< Dictionnaires chargés par le contexte */
+	const struct Dictionnaires_s *dictionnaires_p;	/**< Dictionnaires utilisés, les siens ou ceux d'un modèle */
+	struct OptionsAssemblage_s options;				/**< Options d'assemblage */
+	struct Assemblage_s *assemblage_p;				/**< Assemblage réutilisé */
+	struct Diag_s *diag_p;							/**< Collecteur des diagnostics, qui ne les écrit pas */
+	jmp_buf reprise;								/**< Point de reprise après une erreur fatale */
+};
+
+struct AsmMips_s *creer_asmips(const char *instructions, const char *registres);
+struct AsmMips_s *creer_asmips_partage(const struct AsmMips_s *modele_p);
+struct AsmMips_s *detruire_asmips(struct AsmMips_s *asmips_p);
+int asmips_assembler(struct AsmMips_s *asmips_p, const char *texte, size_t taille, const char *nom);
+
+#endif /* _ASMIPS_H_ */
@@ -0,0 +1,106 @@
+/**
+ * @file assemblage.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des types et des prototypes de l'assemblage complet d'un fichier source
+ *
+ * Les dictionnaires sont chargés une fois et ne sont ensuite que lus : plusieurs assemblages peuvent les
+ * partager en même temps. Tout le reste (lexèmes, sections, étiquettes) appartient à un assemblage.
+ */
+
+#ifndef _ASSEMBLAGE_H_
+#define _ASSEMBLAGE_H_
+
+#include <stdio.h>
+
+#include <liste.h>
+#include <table.h>
+#include <image.h>
+#include <sortie.h>
+#include <diag.h>
+#include <empreinte.h>
+
+#define DICTIONNAIRE_INSTRUCTIONS	"src/dictionnaire_instructions.txt"	/**< Dictionnaire des instructions par défaut */
+#define DICTIONNAIRE_REGISTRES		"src/dictionnaire_registres.txt"	/**< Dictionnaire des registres par défaut */
+
+/**
+ * @struct Dictionnaires_s
+ * @brief Définitions des instructions et des registres, partagées en lecture seule
+ */
+struct Dictionnaires_s {
+	struct Table_s *instructions_p;		/**< Table des définitions d'instructions */
+	struct Table_s *registres_p;		/**< Table des définitions de registres */
+	unsigned char empreinte[TAILLE_EMPREINTE];	/**< Empreinte des deux fichiers de définitions (clefs du cache des résultats) */
+};
+
+/**
+ * @struct OptionsAssemblage_s
+ * @brief Options communes à tous les fichiers assemblés
+ */
+struct OptionsAssemblage_s {
+	int pipeline;						/**< TRUE pour faire travailler les étages en parallèle */
+	const char *cache_sorties;			/**< Répertoire du cache des résultats (--cache), NULL sinon */
+	int lucarne;						/**< TRUE pour appliquer l'optimisation à lucarne (-O1, --peephole) */
+	int ordonnancement;					/**< TRUE pour réordonner les instructions de chaque bloc de base (--schedule) */
+	int sans_inclusion;					/**< TRUE si .include ne doit lire aucun fichier */
+	struct ParametresImage_s image;		/**< Forme du fichier produit et placement des sections */
+};
+
+/**
+ * @struct LigneCommande_s
+ * @brief Ligne de commande analysée, celle du programme ou celle d'une requête du serveur
+ */
+struct LigneCommande_s {
+	struct OptionsAssemblage_s options;	/**< Options d'assemblage */
+	char **sources;						/**< Fichiers sources, dans l'ordre */
+	size_t nb_sources;					/**< Nombre de fichiers sources */
+	char *fichier_objet;				/**< Fichier produit (-o), NULL sinon */
+	unsigned int nb_threads;			/**< Nombre de threads du lot (-j), 0 si non précisé */
+	int listage;						/**< FALSE si le listage n'est pas demandé (-q) */
+	int estimation;						/**< TRUE pour écrire l'estimation des cycles de .text (--estimate) */
+	int simulation;						/**< TRUE pour exécuter le programme assemblé (--run) */
+	unsigned long limite_simulation;	/**< Nombre maximal d'instructions exécutées (--run-limit), 0 sans limite */
+	char *graphe;						/**< Fichier du graphe de flot de contrôle en DOT (--cfg), NULL sinon */
+	char *graphe_json;					/**< Fichier du graphe de flot de contrôle en JSON (--cfg-json), NULL sinon */
+	int profilage;						/**< TRUE pour écrire le profil */
+	int profilage_json;					/**< TRUE pour écrire le profil en JSON */
+	char *serveur;						/**< Socket du mode serveur (--serve), "-" pour l'entrée et la sortie standard */
+};
+
+/**
+ * @struct Assemblage_s
+ * @brief Résultats de l'assemblage d'un fichier
+ *
+ * Les listes et la table des étiquettes sont toujours dans un état cohérent, même si l'assemblage est
+ * interrompu par une erreur fatale : detruire_assemblage peut alors libérer ce qui a déjà été construit.
+ */
+struct Assemblage_s {
+	FILE *source_p;						/**< Source en cours de lecture, NULL en dehors d'un assemblage */
+	struct Sortie_s *listage_cache_p;	/**< Listage en mémoire en attente de rangement dans le cache des résultats, NULL sinon */
+	struct Liste_s *lexemes_p;			/**< Lexèmes du source */
+	struct Liste_s *text_p;				/**< Instructions de la section .text */
+	struct Liste_s *data_p;				/**< Données de la section .data */
+	struct Liste_s *bss_p;				/**< Données de la section .bss */
+	struct Table_s *etiquettes_p;		/**< Table des étiquettes */
+	unsigned int nb_lignes;				/**< Nombre de lignes du source */
+	unsigned int nb_etiquettes;			/**< Nombre d'étiquettes repérées par l'analyse lexicale */
+	unsigned int nb_instructions;		/**< Nombre d'instructions repérées par l'analyse lexicale */
+};
+
+int charger_dictionnaires(struct Dictionnaires_s *dictionnaires_p);
+void liberer_dictionnaires(struct Dictionnaires_s *dictionnaires_p);
+
+int analyser_ligne_commande(int argc, char *argv[], struct LigneCommande_s *ligne_p, struct Diag_s *diag_p);
+int analyses_demandees(const struct LigneCommande_s *ligne_p);
+void liberer_ligne_commande(struct LigneCommande_s *ligne_p);
+
+struct Assemblage_s *creer_assemblage(void);
+void reinitialiser_assemblage(struct Assemblage_s *assemblage_p);
+struct Assemblage_s *detruire_assemblage(struct Assemblage_s *assemblage_p);
+
+int assembler_fichier(struct Assemblage_s *assemblage_p, char *source, const char *fichier_objet,
+		const struct OptionsAssemblage_s *options_p, const struct Dictionnaires_s *dictionnaires_p, struct Sortie_s *listage_p);
+int assembler_flux(struct Assemblage_s *assemblage_p, FILE *fp, const char *source, const char *fichier_objet,
+		const struct OptionsAssemblage_s *options_p, const struct Dictionnaires_s *dictionnaires_p, struct Sortie_s *listage_p);
+char *nom_fichier_objet(const char *source, enum FormatSortie_e format);
+
+#endif /* _ASSEMBLAGE_H_ */
@@ -0,0 +1,32 @@
+/**
+ * @file cache_sorties.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des prototypes du cache des résultats adressé par leur contenu (--cache)
+ *
+ * La clef d'une entrée est l'empreinte SHA-256 du source, des deux dictionnaires, de l'exécutable d'as-mips et
+ * des options qui changent les résultats (forme du fichier produit, boutisme, placement des sections, listage
+ * demandé et en couleur, nom du fichier S-record). L'entrée contient le listage et le fichier produit. Seuls les
+ * assemblages réussis et sans aucun diagnostic sont rangés : une entrée reprise donne exactement ce qu'aurait
+ * donné l'assemblage, quel que soit le nom du source. Les entrées sont écrites dans un fichier temporaire renommé
+ * à la fin, plusieurs assemblages peuvent donc partager le même répertoire.
+ */
+
+#ifndef _CACHE_SORTIES_H_
+#define _CACHE_SORTIES_H_
+
+#include <stdio.h>
+
+#include <empreinte.h>
+#include <sortie.h>
+#include <assemblage.h>
+
+#define CACHE_SORTIES_MAGIQUE	"ASMSORT1"		/**< Entête d'une entrée du cache (et version de son format) */
+
+int calculer_clef_sorties(FILE *fp, const char *fichier_objet, const struct OptionsAssemblage_s *options_p,
+		const struct Dictionnaires_s *dictionnaires_p, const struct Sortie_s *listage_p, unsigned char clef[TAILLE_EMPREINTE]);
+int reprendre_sorties(const char *repertoire, const unsigned char clef[TAILLE_EMPREINTE], const char *fichier_objet,
+		struct Sortie_s *listage_p);
+int ranger_sorties(const char *repertoire, const unsigned char clef[TAILLE_EMPREINTE], const char *fichier_objet,
+		const struct Sortie_s *listage_p);
+
+#endif /* _CACHE_SORTIES_H_ */
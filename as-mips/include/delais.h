@@ -0,0 +1,27 @@
+/**
+ * @file delais.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des prototypes du remplissage des délais de branchement
+ *
+ * L'instruction qui suit un branchement ou un saut (son délai) est toujours exécutée. En mode reorder (par
+ * défaut), l'assembleur y place lui-même une instruction : une instruction du même bloc de base qui précède
+ * le branchement y est déplacée si elle ne dépend ni du branchement, ni des instructions qu'elle franchit, ou
+ * à défaut un NOP y est inséré. Après .set noreorder, le délai est l'instruction écrite après le branchement.
+ */
+
+#ifndef _DELAIS_H_
+#define _DELAIS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <table.h>
+#include <syn.h>
+
+#define DELAIS_FENETRE	8		/**< Nombre d'instructions précédant un branchement examinées pour remplir son délai */
+
+uint32_t *decalages_etiquettes_text(struct Table_s *table_etiquettes_p, size_t *nb_p);
+uint32_t octets_avant(const uint32_t *decalages, size_t nb, uint32_t decalage);
+int remplir_delais(struct AnalyseSyntaxe_s *analyse_p, int recoder);
+
+#endif /* _DELAIS_H_ */
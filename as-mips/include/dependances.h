@@ -0,0 +1,71 @@
+/**
+ * @file dependances.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des types et des prototypes des effets des instructions (registres lus et écrits, mémoire)
+ *
+ * Le dictionnaire ne décrit que la syntaxe et le codage des instructions. Les passes qui déplacent des
+ * instructions ont besoin de savoir ce que chacune lit et écrit : une table, indexée par le nom de l'instruction
+ * réelle et rattachée à sa définition au chargement du dictionnaire, donne le champ du registre écrit, les
+ * registres lus ou écrits implicitement ($ra, HI, LO), la nature de l'instruction et sa latence. Une instruction
+ * absente de la table n'est jamais déplacée.
+ */
+
+#ifndef _DEPENDANCES_H_
+#define _DEPENDANCES_H_
+
+#include <stdint.h>
+
+#include <table.h>
+#include <dico.h>
+#include <syn.h>
+
+#define REGISTRE_RA		31		/**< Registre de retour, écrit par JAL */
+#define REGISTRE_HI		32		/**< Numéro donné au registre HI dans les masques */
+#define REGISTRE_LO		33		/**< Numéro donné au registre LO dans les masques */
+#define NB_REGISTRES_EFFETS	34		/**< Nombre de registres des masques : 0 à 31, HI et LO */
+
+/** Masque d'un registre (0 à 31, REGISTRE_HI, REGISTRE_LO) */
+#define BIT_REGISTRE(r)	((uint64_t)1 << (r))
+
+#define EFFET_CHARGEMENT	0x01	/**< Lit la mémoire */
+#define EFFET_RANGEMENT		0x02	/**< Ecrit la mémoire */
+#define EFFET_BRANCHEMENT	0x04	/**< Branchement conditionnel, suivi d'un délai */
+#define EFFET_SAUT			0x08	/**< Saut, suivi d'un délai */
+#define EFFET_SYSTEME		0x10	/**< Appel système */
+#define EFFET_INCONNU		0x20	/**< Effets inconnus (instruction hors table, registre invalide) */
+
+#define EFFET_MEMOIRE		(EFFET_CHARGEMENT | EFFET_RANGEMENT)	/**< Accède à la mémoire */
+#define EFFET_DELAI			(EFFET_BRANCHEMENT | EFFET_SAUT)		/**< Suivie d'un délai de branchement */
+#define EFFET_BARRIERE		(EFFET_DELAI | EFFET_SYSTEME | EFFET_INCONNU)	/**< Ne peut être ni déplacée, ni franchie */
+
+/**
+ * @struct DescriptionEffets_s
+ * @brief Effets d'une instruction réelle, communs à toutes ses occurrences
+ */
+struct DescriptionEffets_s {
+	const char *nom;				/**< Nom de l'instruction */
+	char champ_ecrit;				/**< Champ du registre écrit ('d' ou 't'), 0 si aucun */
+	uint64_t lus;					/**< Registres lus implicitement */
+	uint64_t ecrits;				/**< Registres écrits implicitement */
+	unsigned int nature;			/**< Combinaison de EFFET_xxx */
+	unsigned int latence;			/**< Cycles entre son début et celui d'une instruction qui lit ce qu'elle écrit sans attendre */
+};
+
+/**
+ * @struct EffetsInstruction_s
+ * @brief Effets d'une occurrence d'instruction, ses opérandes compris
+ */
+struct EffetsInstruction_s {
+	uint64_t lus;					/**< Registres lus ($zero exclu) */
+	uint64_t ecrits;				/**< Registres écrits ($zero exclu) */
+	unsigned int nature;			/**< Combinaison de EFFET_xxx */
+	unsigned int latence;			/**< Latence de ses registres écrits (1 : lisibles par l'instruction suivante) */
+};
+
+const struct DescriptionEffets_s *description_effets(const char *nom);
+unsigned int nature_instruction(const struct DefinitionInstruction_s *definition_p);
+void effets_instruction(const struct Instruction_s *instruction_p, struct Table_s *table_def_registres_p, struct EffetsInstruction_s *effets_p);
+void cumuler_effets(struct EffetsInstruction_s *cumul_p, const struct EffetsInstruction_s *effets_p);
+int effets_independants(const struct EffetsInstruction_s *a_p, const struct EffetsInstruction_s *b_p);
+
+#endif /* _DEPENDANCES_H_ */
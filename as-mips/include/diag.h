@@ -0,0 +1,99 @@
+/**
+ * @file diag.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des types et des prototypes du collecteur de diagnostics (erreurs, avertissements)
+ *
+ * Les diagnostics sont enregistrés sous forme structurée puis écrits par paquets, ce qui évite une écriture
+ * non tamponnée par message et permet de limiter les répétitions d'un même diagnostic.
+ */
+
+#ifndef _DIAG_H_
+#define _DIAG_H_
+
+#include <stddef.h>
+
+#include <sortie.h>
+
+#define DIAG_MAX_REPETITIONS	20		/**< Nombre d'occurrences affichées par défaut pour un même diagnostic */
+#define DIAG_TAILLE_PAQUET		256		/**< Nombre de diagnostics en attente déclenchant une écriture */
+
+/**
+ * @enum Severite_e
+ * @brief Gravité d'un diagnostic
+ */
+enum Severite_e {
+	DIAG_INFO=0,			/**< Simple information */
+	DIAG_AVERTISSEMENT=1,	/**< Le traitement continue normalement */
+	DIAG_ERREUR=2,			/**< Le résultat de l'assemblage ne sera pas valide */
+	DIAG_FATALE=3			/**< Le traitement ne peut pas continuer */
+};
+
+/**
+ * @enum FormatDiag_e
+ * @brief Forme sous laquelle les diagnostics sont écrits
+ */
+enum FormatDiag_e {
+	DIAG_TEXTE=0,			/**< Texte simple "fichier:ligne: gravité: message [code]" */
+	DIAG_COULEUR=1,			/**< Texte avec séquences de couleur ANSI */
+	DIAG_JSON=2				/**< Un objet JSON par ligne */
+};
+
+/* Fonction appelée sur un diagnostic fatal, elle ne doit pas revenir (exit, longjmp...) */
+typedef void (fonctionFatale)(void *contexte_p);
+
+/**
+ * @struct Diagnostic_s
+ * @brief Diagnostic en attente d'écriture
+ */
+struct Diagnostic_s {
+	const char *fichier;		/**< Fichier concerné (source assembleur ou source C pour les erreurs internes) */
+	unsigned int ligne;			/**< Ligne concernée, 0 si sans objet */
+	enum Severite_e severite;	/**< Gravité du diagnostic */
+	const char *code;			/**< Identifiant court et stable du diagnostic */
+	size_t message;				/**< Position du message dans le texte du collecteur */
+};
+
+/**
+ * @struct Diag_s
+ * @brief Collecteur de diagnostics
+ */
+struct Diag_s {
+	enum FormatDiag_e format;				/**< Forme d'écriture des diagnostics */
+	int descripteur;						/**< Descripteur de fichier sur lequel écrire, -1 pour ne rien écrire */
+	struct Sortie_s *sortie_p;				/**< Sortie recevant les diagnostics à la place du descripteur, NULL sinon */
+	unsigned int max_repetitions;			/**< Nombre d'occurrences écrites d'un même diagnostic, 0 pour illimité */
+	const char *fichier_source;				/**< Fichier source par défaut des diagnostics */
+
+	struct Diagnostic_s *attente;			/**< Diagnostics en attente d'écriture */
+	size_t nb_attente;						/**< Nombre de diagnostics en attente */
+	size_t capacite_attente;				/**< Capacité du tableau des diagnostics en attente */
+	char *texte;							/**< Messages des diagnostics en attente */
+	size_t taille_texte;					/**< Taille utilisée du texte */
+	size_t capacite_texte;					/**< Capacité du texte */
+
+	struct Table_s *repetitions_p;			/**< Nombre d'occurrences de chaque diagnostic */
+	unsigned int nb_par_severite[4];		/**< Nombre de diagnostics reçus par gravité */
+	unsigned long nb_supprimes;				/**< Nombre de diagnostics non écrits car trop répétés */
+
+	fonctionFatale *fn_fatale_p;			/**< Fonction appelée après un diagnostic fatal, NULL pour exit() */
+	void *contexte_fatal_p;					/**< Paramètre de la fonction fatale */
+	void *verrou_p;							/**< Verrou protégeant le collecteur partagé entre threads */
+};
+
+struct Diag_s *creer_diag(enum FormatDiag_e format, int descripteur);
+struct Diag_s *detruire_diag(struct Diag_s *diag_p);
+void vider_diag(struct Diag_s *diag_p);
+void reinitialiser_diag(struct Diag_s *diag_p);
+
+void diag_signaler(struct Diag_s *diag_p, enum Severite_e severite, const char *fichier, unsigned int ligne,
+		const char *code, const char *format, ...);
+void diag_interne(enum Severite_e severite, const char *fichier, const char *fonction, unsigned int ligne,
+		const char *format, ...);
+void diag_interne_fatal(const char *fichier, const char *fonction, unsigned int ligne,
+		const char *format, ...) __attribute__((noreturn));
+
+struct Diag_s *diag_courant(void);
+struct Diag_s *diag_installer(struct Diag_s *diag_p);
+int diag_format(const char *nom, enum FormatDiag_e *format_p);
+
+#endif /* _DIAG_H_ */
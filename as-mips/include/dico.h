@@ -7,6 +7,9 @@
 #ifndef _DICO_H_
 #define _DICO_H_
 
+#include <stdio.h>
+#include <stdint.h>
+
 #include <table.h>
 
 /**
@@ -22,6 +25,9 @@ enum Operandes_e {
  	I_OP_B=2,		/**< Pour cette instruction, on attend "registre" "," "nombre" "(" "registre" ")" */
 };
 
+struct ExpansionPseudo_s;
+struct DescriptionEffets_s;
+
 /**
  * @struct DefinitionInstruction_s
  * @brief Structure permettant de stocker la définition d'une instruction
@@ -30,6 +36,11 @@ struct DefinitionInstruction_s {
 	char* nom;						/**< nom de l'instruction */
 	enum Operandes_e type_ops;		/**< nature de l'instruction */
 	unsigned int nb_ops;			/**< nombre d'opérandes de l'instruction */
+	uint32_t motif;					/**< code machine de l'instruction avant insertion des opérandes */
+	char champs[4];					/**< champ du code recevant chaque opérande ('d','s','t','h','i','o','a', et 'H'/'L'
+										pour %hi/%lo dans une expansion), "-" si aucun */
+	struct ExpansionPseudo_s *expansions_p;	/**< expansions d'une pseudo-instruction (cf. pseudo.h), NULL pour une instruction réelle */
+	const struct DescriptionEffets_s *effets_p;	/**< registres lus et écrits (cf. dependances.h), NULL si inconnus */
 };
 
 /**
@@ -47,7 +58,9 @@ void destruction_def_instruction(void *donnee_p);
 char *clef_def_registre(void *donnee_p);
 void destruction_def_registre(void *donnee_p);
 
+int charge_def_instruction_flux(struct Table_s **table_definition_pp, FILE *f_p);
 int charge_def_instruction(struct Table_s **table_definition_pp, char *nom_fichier);
+int charge_def_registre_flux(struct Table_s **table_definition_pp, FILE *f_p);
 int charge_def_registre(struct Table_s **table_definition_pp, char *nom_fichier);
 
 #endif /* _DICO_H_ */
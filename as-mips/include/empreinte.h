@@ -0,0 +1,32 @@
+/**
+ * @file empreinte.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des types et des prototypes du calcul d'empreinte SHA-256 (FIPS 180-4)
+ */
+
+#ifndef _EMPREINTE_H_
+#define _EMPREINTE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TAILLE_EMPREINTE	32		/**< Taille d'une empreinte SHA-256 en octets */
+
+/**
+ * @struct Empreinte_s
+ * @brief Calcul d'empreinte en cours : les données peuvent être ajoutées en plusieurs fois
+ */
+struct Empreinte_s {
+	uint32_t etat[8];				/**< Valeurs de hachage intermédiaires */
+	uint64_t nb_octets;				/**< Nombre d'octets ajoutés */
+	unsigned char bloc[64];			/**< Bloc en cours de remplissage */
+};
+
+void debuter_empreinte(struct Empreinte_s *empreinte_p);
+void ajouter_empreinte(struct Empreinte_s *empreinte_p, const void *donnees_p, size_t nb);
+void ajouter_entier_empreinte(struct Empreinte_s *empreinte_p, uint32_t valeur);
+void terminer_empreinte(struct Empreinte_s *empreinte_p, unsigned char resultat[TAILLE_EMPREINTE]);
+int empreinte_fichier(struct Empreinte_s *empreinte_p, const char *fichier);
+void empreinte_hex(const unsigned char empreinte[TAILLE_EMPREINTE], char hex[2*TAILLE_EMPREINTE+1]);
+
+#endif /* _EMPREINTE_H_ */
@@ -0,0 +1,85 @@
+/**
+ * @file estimation.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des types et des prototypes de l'estimation statique des cycles de .text (--estimate)
+ *
+ * Les instructions de .text sont jouées une fois, dans l'ordre de la liste, sur un pipeline classique à 5 étages
+ * (IF ID EX MEM WB) avec envoi des résultats vers EX : une instruction attend qu'un registre qu'elle lit soit
+ * prêt, d'après les latences de include/dependances.h (chargement lu par l'instruction suivante, MFHI/MFLO
+ * après MULT et DIV). Un branchement compare ses registres en ID, un cycle plus tôt. Les délais de
+ * branchement remplis par un NOP sont comptés à part.
+ *
+ * Un bloc de base commence à une étiquette ou après le délai d'un branchement. Une fonction commence au début de
+ * .text, à une étiquette visée par JAL ou à une étiquette qui n'est visée par aucun branchement conditionnel
+ * (point d'entrée), et s'étend jusqu'à la suivante. Chaque attente est rapportée à la ligne source de l'instruction qui attend.
+ */
+
+#ifndef _ESTIMATION_H_
+#define _ESTIMATION_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <liste.h>
+#include <table.h>
+#include <sortie.h>
+
+#define ESTIMATION_REMPLISSAGE	4		/**< Cycles de remplissage du pipeline avant la fin de la première instruction */
+
+/**
+ * @enum SourceAttente_e
+ * @brief Cause d'une attente du pipeline
+ */
+enum SourceAttente_e {
+	ATT_CHARGEMENT,			/**< Registre lu trop tôt après un LW */
+	ATT_MULDIV,				/**< HI ou LO lu trop tôt après MULT ou DIV */
+	ATT_BRANCHEMENT,		/**< Registre comparé en ID trop tôt après l'instruction qui l'écrit */
+	NB_SOURCES_ATTENTE
+};
+
+/**
+ * @struct AttenteEstimee_s
+ * @brief Attente d'une instruction
+ */
+struct AttenteEstimee_s {
+	unsigned int ligne;					/**< Ligne source de l'instruction qui attend */
+	enum SourceAttente_e source;		/**< Cause de l'attente */
+	unsigned long cycles;				/**< Nombre de cycles d'attente */
+};
+
+/**
+ * @struct BlocEstime_s
+ * @brief Estimation d'un bloc de base
+ */
+struct BlocEstime_s {
+	uint32_t decalage;					/**< Décalage de la première instruction */
+	const char *etiquette;				/**< Etiquette du bloc, NULL si aucune */
+	int debut_fonction;					/**< TRUE si le bloc commence une fonction */
+	unsigned int premiere_ligne;		/**< Plus petite ligne source des instructions du bloc */
+	unsigned int derniere_ligne;		/**< Plus grande ligne source des instructions du bloc */
+	unsigned long nb_instructions;		/**< Nombre d'instructions */
+	unsigned long attentes[NB_SOURCES_ATTENTE];	/**< Cycles d'attente par cause */
+	unsigned long delais_vides;			/**< Délais de branchement remplis par un NOP */
+	size_t premiere_attente;			/**< Indice de la première attente du bloc */
+	size_t nb_attentes;					/**< Nombre d'attentes du bloc */
+};
+
+/**
+ * @struct Estimation_s
+ * @brief Estimation des cycles de .text
+ */
+struct Estimation_s {
+	struct BlocEstime_s *blocs;			/**< Blocs de base, dans l'ordre de .text */
+	size_t nb_blocs;					/**< Nombre de blocs */
+	struct AttenteEstimee_s *attentes;	/**< Attentes, dans l'ordre de .text */
+	size_t nb_attentes;					/**< Nombre d'attentes */
+	size_t capacite_blocs;				/**< Taille allouée des blocs */
+	size_t capacite_attentes;			/**< Taille allouée des attentes */
+};
+
+struct Estimation_s *creer_estimation(struct Liste_s *liste_text_p, struct Table_s *table_def_registres_p, struct Table_s *table_etiquettes_p);
+struct Estimation_s *detruire_estimation(struct Estimation_s *estimation_p);
+unsigned long cycles_bloc(const struct BlocEstime_s *bloc_p);
+void ecrire_estimation(struct Sortie_s *sortie_p, const struct Estimation_s *estimation_p);
+
+#endif /* _ESTIMATION_H_ */
@@ -0,0 +1,109 @@
+/**
+ * @file expression.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des types et des prototypes des expressions d'opérandes
+ *
+ * Le dernier opérande d'une instruction de forme N et le décalage d'une instruction de forme B peuvent être une
+ * expression : nombres, étiquettes, parenthèses, opérateurs unaires - + ~, binaires * / % + - << >> & ^ | (par
+ * priorité décroissante, comme en C) et, en tête de l'opérande, %hi(expr) ou %lo(expr). Un opérande réduit à un
+ * nombre ou à une étiquette reste le lexème lui-même ; une expression est rangée en notation polonaise inverse
+ * dans un seul bloc, les sous-expressions constantes étant calculées dès l'analyse syntaxique.
+ *
+ * La valeur d'une expression est une constante, éventuellement relative à un symbole : la différence de deux
+ * étiquettes d'une même section est une constante, seule une expression relative à un symbole donne lieu à une
+ * relocation dans le fichier objet.
+ */
+
+#ifndef _EXPRESSION_H_
+#define _EXPRESSION_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <liste.h>
+#include <table.h>
+#include <lex.h>
+#include <syn.h>
+
+#define EXPRESSION_TERMES_MAX	64		/**< Nombre maximal de termes d'une expression */
+
+/**
+ * @enum TermeExpression_e
+ * @brief Nature des termes d'une expression en notation polonaise inverse
+ */
+enum TermeExpression_e {
+	E_NOMBRE,				/**< Constante */
+	E_SYMBOLE,				/**< Etiquette, définie ou non */
+	E_OPPOSE,				/**< - unaire */
+	E_NON,					/**< ~ unaire */
+	E_FOIS,					/**< * */
+	E_DIVISE,				/**< / */
+	E_MODULO,				/**< % */
+	E_PLUS,					/**< + */
+	E_MOINS,				/**< - */
+	E_DECALAGE_GAUCHE,		/**< << */
+	E_DECALAGE_DROITE,		/**< >> (logique) */
+	E_ET,					/**< & */
+	E_OU_EXCLUSIF,			/**< ^ */
+	E_OU					/**< | */
+};
+
+/**
+ * @enum PartieExpression_e
+ * @brief Partie de la valeur gardée par l'opérande
+ */
+enum PartieExpression_e {
+	P_TOUT,					/**< Valeur entière */
+	P_HI,					/**< %hi : 16 bits de poids fort, corrigés de la retenue de %lo */
+	P_LO					/**< %lo : 16 bits de poids faible */
+};
+
+/**
+ * @struct TermeExpression_s
+ * @brief Terme d'une expression
+ */
+struct TermeExpression_s {
+	enum TermeExpression_e nature;		/**< Nature du terme */
+	int32_t valeur;						/**< Valeur d'une constante */
+	const char *symbole;				/**< Nom d'une étiquette, rangé dans le bloc de l'expression */
+};
+
+/**
+ * @struct Expression_s
+ * @brief Expression d'un opérande : un seul bloc contient le lexème, les termes et les textes
+ *
+ * Le lexème (nature L_EXPRESSION, donnée : texte de l'expression) est le premier champ, c'est lui qui est rangé
+ * dans les opérandes de l'instruction ; l'expression appartient à l'instruction, ou aux instructions de
+ * l'expansion d'une pseudo-instruction qui la reprennent.
+ */
+struct Expression_s {
+	struct Lexeme_s lexeme;				/**< Lexème représentant l'expression dans l'instruction */
+	size_t taille;						/**< Taille du bloc, pour le bilan mémoire */
+	unsigned int references;			/**< Nombre d'instructions qui la partagent (expansion d'une pseudo-instruction) */
+	enum PartieExpression_e partie;		/**< %hi, %lo ou valeur entière */
+	size_t nb_termes;					/**< Nombre de termes */
+	struct TermeExpression_s termes[1];	/**< Termes en notation polonaise inverse (nb_termes cases) */
+};
+
+/**
+ * @struct ValeurExpression_s
+ * @brief Valeur d'une expression : constante, éventuellement relative à un symbole
+ */
+struct ValeurExpression_s {
+	uint32_t valeur;					/**< Valeur, adresse de l'étiquette comprise si elle est définie */
+	const char *symbole;				/**< Symbole dont dépend la valeur, NULL pour une constante */
+	struct Etiquette_s *etiquette_p;	/**< Etiquette du symbole, NULL s'il n'est pas défini */
+	uint32_t addenda;					/**< Valeur sans l'adresse de l'étiquette (valeur entière, avant %hi/%lo) */
+};
+
+int est_debut_expression(struct NoeudListe_s *noeud_lexeme_p, int forme_base);
+struct Lexeme_s *lire_expression(struct NoeudListe_s **noeud_lexeme_pp, struct Lexeme_s **lexeme_pp, int forme_base, char *msg_err);
+void detruire_expression(struct Expression_s *expression_p);
+struct Lexeme_s *partager_expression(struct Lexeme_s *lexeme_p);
+
+int expression_constante(const struct Lexeme_s *lexeme_p, long *valeur_p);
+int evaluer_expression(const struct Expression_s *expression_p, struct Table_s *table_etiquettes_p, const uint32_t *adresses_base,
+		struct ValeurExpression_s *valeur_p, char *msg_err);
+uint32_t partie_expression(enum PartieExpression_e partie, uint32_t valeur);
+
+#endif /* _EXPRESSION_H_ */
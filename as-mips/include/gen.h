@@ -0,0 +1,38 @@
+/**
+ * @file gen.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des prototypes de fonctions liées à la génération du code machine des instructions
+ */
+
+#ifndef _GEN_H_
+#define _GEN_H_
+
+#include <stdint.h>
+
+#include <liste.h>
+#include <table.h>
+#include <syn.h>
+
+int encoder_instruction(struct Instruction_s *instruction_p, struct Table_s *table_def_registres_p, char *msg_err);
+uint32_t adresse_etiquette(struct Etiquette_s *etiquette_p, const uint32_t *adresses_base);
+int placer_instruction(struct Instruction_s *instruction_p, struct Table_s *table_etiquettes_p, const uint32_t *adresses_base, uint32_t *code_p);
+int resoudre_instruction(struct Instruction_s *instruction_p, struct Table_s *table_etiquettes_p);
+
+int encoder_lot_instructions(struct NoeudListe_s *premier_p, struct NoeudListe_s *dernier_p, struct Table_s *table_def_registres_p);
+int resoudre_liste_instructions(struct Liste_s *liste_text_p, struct Table_s *table_etiquettes_p);
+int generer_code(struct Liste_s *liste_text_p, struct Table_s *table_def_registres_p, struct Table_s *table_etiquettes_p);
+
+uint32_t mot_cible(uint32_t mot, int gros_boutiste);
+uint16_t demi_mot_cible(uint16_t demi_mot, int gros_boutiste);
+uint32_t taille_donnee(struct Donnee_s *donnee_p);
+uint32_t taille_section(struct Liste_s *liste_p, enum Section_e section);
+int remplir_section_text(struct Liste_s *liste_text_p, struct Table_s *table_etiquettes_p, const uint32_t *adresses_base,
+		int gros_boutiste, uint8_t *contenu_p);
+void remplir_section_donnees(struct Liste_s *liste_data_p, struct Table_s *table_etiquettes_p, const uint32_t *adresses_base,
+		int gros_boutiste, uint8_t *contenu_p);
+uint8_t *construire_section_text(struct Liste_s *liste_text_p, struct Table_s *table_etiquettes_p, const uint32_t *adresses_base,
+		uint32_t taille, int gros_boutiste);
+uint8_t *construire_section_donnees(struct Liste_s *liste_data_p, struct Table_s *table_etiquettes_p, const uint32_t *adresses_base,
+		uint32_t taille, int gros_boutiste);
+
+#endif /* _GEN_H_ */
@@ -17,7 +17,23 @@
  *
  * Usage: <br/>
  * <br/>
- * ./as-mips source.asm
+ * ./as-mips [-p] [-q] [--cache REPERTOIRE] [-o sortie] [-O elf|binary|ihex|srec] [-EB|-EL] [--base-text|--base-data|--base-bss ADR] [--gap-fill OCTET] [--diag texte|couleur|json] [--diag-max N] [--profile|--profile-json] source.asm <br/>
+ * ./as-mips [-j N] [options sauf -o] source1.asm source2.asm ... <br/>
+ * ./as-mips --serve SOCKET|-
+ *
+ * -p ou --pipeline : les analyses lexicale, syntaxique et le codage s'exécutent en parallèle <br/>
+ * -j : assemble un lot de fichiers avec N threads (le nombre de processeurs par défaut), chacun vers son fichier objet <br/>
+ * -q ou --quiet : pas de listage sur la sortie standard (le listage n'est en couleur que sur un terminal) <br/>
+ * -o : écrit le fichier objet relogeable ELF32 (.text, .data, .bss, .symtab, .rel.text, .rel.data) <br/>
+ * -O : écrit à la place une image mémoire brute, Intel HEX ou S-record <br/>
+ * --base-text, --base-data, --base-bss : adresse d'une section dans l'image (.text en 0, les autres à la suite par défaut) <br/>
+ * --gap-fill : octet de remplissage des trous de l'image binaire <br/>
+ * -EB ou -EL : fichier objet gros-boutiste (par défaut) ou petit-boutiste <br/>
+ * --diag : forme des diagnostics, en couleur par défaut sur un terminal <br/>
+ * --diag-max : nombre d'occurrences écrites d'un même diagnostic, 0 pour illimité (20 par défaut) <br/>
+ * --cache REPERTOIRE : reprend les résultats d'un assemblage identique déjà fait (même source, dictionnaires, version et options) <br/>
+ * --profile ou --profile-json : temps réel et processeur de chaque étape et compteurs, sur la sortie d'erreur <br/>
+ * --serve : attend des requêtes d'assemblage sur un socket Unix ou sur l'entrée standard (client léger : as-mips-client) <br/>
  *
  *
  * @section sec3 What works
@@ -29,11 +45,22 @@
  * - loading of instructions for a dictionary file <br/>
  * - labels management <br/>
  * - code generation as a binary file and as a text file <br/>
+ * - generation of elf relocatable files (big or little endian) <br/>
+ * - in-memory assembly library libasmips (make lib, include/asmips.h) <br/>
+ * - .include and .macro/.endm expanded on tokens (include/pretraitement.h) <br/>
+ * - operand expressions with constant folding and %hi/%lo (include/expression.h) <br/>
+ * - pseudo-instructions expanded from dictionary templates (include/pseudo.h) <br/>
+ * - worklist relaxation of label-dependent pseudo-instructions (include/relaxation.h) <br/>
+ * - branch delay slots filled in reorder mode, .set noreorder (include/delais.h) <br/>
+ * - table-driven peephole optimisation, -O1/--peephole (include/lucarne.h) <br/>
+ * - load-use and HI/LO latency scheduling of basic blocks, --schedule (include/ordonnancement.h) <br/>
+ * - static cycle and stall estimation per basic block and function, --estimate (include/estimation.h) <br/>
+ * - pre-decoded instruction-set simulator with per-line execution histogram, --run (include/simulation.h) <br/>
+ * - control-flow graph of .text with DOT/JSON export and hot-block annotation, --cfg/--cfg-json (include/graphe.h) <br/>
  *
  * @section sec4 What is left for future happy hacking
  *
  * - management of all directives <br/>
- * - generation of elf relocatable files <br/>
  * - extensive testing.
  *
  */
@@ -44,6 +71,11 @@
  */
 #define STRLEN          256
 
+/*!
+  \brief INTERNALS: Version of the assembler (part of the --cache keys).
+ */
+#define VERSION_AS_MIPS "1.0"
+
 /*!
   \brief INTERNALS: Value for boolean FALSE.
  */
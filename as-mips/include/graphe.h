@@ -0,0 +1,87 @@
+/**
+ * @file graphe.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des types et des prototypes du graphe de flot de contrôle de .text (--cfg, --cfg-json)
+ *
+ * Un bloc de base commence au début de .text, à une étiquette (qui peut être la cible d'un JR), à la cible d'un
+ * branchement ou d'un saut, et après le délai d'un branchement ou d'un saut. Les cibles sont résolues par la table
+ * des étiquettes, ou par le code de l'instruction quand l'opérande n'est pas un symbole. Les arcs sont rangés dans
+ * des tableaux d'indices : ceux qui partent d'un bloc sont consécutifs, et un second tableau donne, bloc par bloc,
+ * les arcs qui y arrivent. La construction est linéaire en nombre d'instructions et d'étiquettes.
+ */
+
+#ifndef _GRAPHE_H_
+#define _GRAPHE_H_
+
+#include <stdint.h>
+
+#include <liste.h>
+#include <table.h>
+#include <syn.h>
+#include <simulation.h>
+
+#define GRAPHE_AUCUN	0xFFFFFFFFU		/**< Indice qui ne désigne aucun bloc ni aucune instruction */
+
+/**
+ * @enum NatureArc_e
+ * @brief Raison du passage d'un bloc à un autre
+ */
+enum NatureArc_e {
+	ARC_SUITE,				/**< Passage au bloc suivant (pas de saut, branchement non pris ou retour d'appel) */
+	ARC_BRANCHEMENT,		/**< Branchement conditionnel pris */
+	ARC_SAUT,				/**< Saut J */
+	ARC_APPEL				/**< Appel JAL, vers la fonction appelée */
+};
+
+/**
+ * @struct ArcGraphe_s
+ * @brief Arc du graphe
+ */
+struct ArcGraphe_s {
+	uint32_t origine;				/**< Indice du bloc de départ */
+	uint32_t destination;			/**< Indice du bloc d'arrivée */
+	enum NatureArc_e nature;		/**< Raison du passage */
+};
+
+/**
+ * @struct BlocGraphe_s
+ * @brief Bloc de base du graphe
+ */
+struct BlocGraphe_s {
+	uint32_t premiere_instruction;	/**< Indice de sa première instruction dans le tableau des instructions */
+	uint32_t nb_instructions;		/**< Nombre d'instructions */
+	uint32_t decalage;				/**< Décalage de la première instruction dans .text */
+	unsigned int premiere_ligne;	/**< Plus petite ligne source de ses instructions */
+	unsigned int derniere_ligne;	/**< Plus grande ligne source de ses instructions */
+	const char *etiquette;			/**< Etiquette du bloc (la première par ordre alphabétique), NULL si aucune */
+	uint32_t premier_successeur;	/**< Indice de son premier arc sortant */
+	uint32_t nb_successeurs;		/**< Nombre d'arcs sortants */
+	uint32_t premier_predecesseur;	/**< Indice, dans le tableau des prédécesseurs, de son premier arc entrant */
+	uint32_t nb_predecesseurs;		/**< Nombre d'arcs entrants */
+	int indirect;					/**< TRUE s'il se termine par JR (retour ou saut calculé), sans successeur connu */
+	int cible_inconnue;				/**< TRUE si la cible de son saut n'est pas dans .text (symbole externe) */
+	unsigned long executions;		/**< Nombre d'exécutions de sa première instruction (--run), 0 sinon */
+};
+
+/**
+ * @struct GrapheFlot_s
+ * @brief Graphe de flot de contrôle de .text
+ */
+struct GrapheFlot_s {
+	struct Instruction_s **instructions;	/**< Instructions de .text, dans l'ordre */
+	uint32_t nb_instructions;				/**< Nombre d'instructions */
+	uint32_t *blocs_instructions;			/**< Indice du bloc de chaque instruction */
+	struct BlocGraphe_s *blocs;				/**< Blocs, dans l'ordre de .text */
+	uint32_t nb_blocs;						/**< Nombre de blocs */
+	struct ArcGraphe_s *arcs;				/**< Arcs, groupés par bloc de départ */
+	uint32_t nb_arcs;						/**< Nombre d'arcs */
+	uint32_t *predecesseurs;				/**< Indices des arcs, groupés par bloc d'arrivée */
+	int annote;								/**< TRUE si les exécutions des blocs sont connues */
+};
+
+struct GrapheFlot_s *creer_graphe(struct Liste_s *liste_text_p, struct Table_s *table_etiquettes_p);
+struct GrapheFlot_s *detruire_graphe(struct GrapheFlot_s *graphe_p);
+void annoter_graphe(struct GrapheFlot_s *graphe_p, const struct Simulation_s *simulation_p);
+int ecrire_graphe(const char *nom_fichier, const struct GrapheFlot_s *graphe_p, int json, const char *source);
+
+#endif /* _GRAPHE_H_ */
@@ -0,0 +1,60 @@
+/**
+ * @file image.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des types et des prototypes de l'écriture d'images mémoire (binaire brut, Intel HEX, S-record)
+ */
+
+#ifndef _IMAGE_H_
+#define _IMAGE_H_
+
+#include <stdint.h>
+
+#include <liste.h>
+#include <table.h>
+#include <syn.h>
+
+#define OCTETS_PAR_ENREGISTREMENT	16		/**< Nombre d'octets de données par ligne Intel HEX ou S-record */
+#define ALIGNEMENT_SECTIONS_IMAGE	16		/**< Alignement d'une section placée à la suite de la précédente */
+
+/**
+ * @enum FormatSortie_e
+ * @brief Forme du fichier produit par l'option -O
+ */
+enum FormatSortie_e {
+	SORTIE_ELF=0,			/**< Fichier objet relogeable ELF32 */
+	SORTIE_BINAIRE=1,		/**< Image binaire brute, de la plus basse adresse à la fin du dernier contenu */
+	SORTIE_IHEX=2,			/**< Intel HEX avec adresses linéaires étendues (32 bits) */
+	SORTIE_SREC=3			/**< Motorola S-record avec adresses 32 bits (S3/S7) */
+};
+
+/**
+ * @struct ParametresImage_s
+ * @brief Placement des sections et options de l'image
+ */
+struct ParametresImage_s {
+	enum FormatSortie_e format;		/**< Forme du fichier produit */
+	uint32_t adresses_base[4];		/**< Adresse de début de chaque section, indicée par Section_e */
+	int base_fixee[4];				/**< TRUE si l'adresse de la section a été donnée, FALSE pour la placer à la suite */
+	uint8_t remplissage;			/**< Octet de remplissage des trous entre sections (image binaire) */
+	int gros_boutiste;				/**< TRUE pour une cible gros-boutiste */
+};
+
+/**
+ * @struct SectionImage_s
+ * @brief Section placée dans l'image
+ */
+struct SectionImage_s {
+	enum Section_e section;			/**< Section concernée */
+	uint32_t adresse;				/**< Adresse de début */
+	uint32_t taille;				/**< Taille en octets */
+	const uint8_t *contenu;			/**< Contenu, NULL pour .bss qui n'est jamais construit */
+};
+
+void initialiser_parametres_image(struct ParametresImage_s *parametres_p);
+int format_sortie(const char *nom, enum FormatSortie_e *format_p);
+int placer_sections_image(struct ParametresImage_s *parametres_p, uint32_t *tailles, const char *nom_fichier);
+int generer_image(const char *nom_fichier, struct ParametresImage_s *parametres_p,
+		struct Liste_s *liste_text_p, struct Liste_s *liste_data_p, struct Liste_s *liste_bss_p,
+		struct Table_s *table_etiquettes_p);
+
+#endif /* _IMAGE_H_ */
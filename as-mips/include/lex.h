@@ -10,7 +10,10 @@
 #ifndef _LEX_H_
 #define _LEX_H_
 
+#include <stdio.h>
+
 #include <liste.h>
+#include <sortie.h>
 
 /**
  * @enum Nature_lexeme_e
@@ -31,6 +34,7 @@ enum Nature_lexeme_e {
  	L_VIRGULE,				/**< ',' permettant de séparer les opérandes. */
  	L_PARENTHESE_OUVRANTE,	/**< '(' utilisé pour adressage indirect. */
  	L_PARENTHESE_FERMANTE,	/**< ')' utilisé pour finir adressage indirect. */
+ 	L_OPERATEUR,			/**< Opérateur d'expression : + - * / % << >> & | ^ ~ %hi %lo */
 
 	L_NOMBRE,				/**< Nombre */
 	L_NOMBRE_DECIMAL,		/**< Nombre décimal. */
@@ -41,7 +45,8 @@ enum Nature_lexeme_e {
 	L_CHAINE,				/**< chaine de caractère avec un zero final , de la forme "xxx\0" */
  	
  	L_COMMENTAIRE,			/**< Le commentaire commence par '#' et fini à la fin de la ligne. */
-	L_FIN_LIGNE
+	L_FIN_LIGNE,
+	L_EXPRESSION			/**< Expression d'opérande construite par l'analyse syntaxique (cf. expression.h) */
 };
 
 /**
@@ -61,6 +66,7 @@ enum Etat_lex_e {
 	VIRGULE=L_VIRGULE,
 	PARENTHESE_OUVRANTE=L_PARENTHESE_OUVRANTE,
 	PARENTHESE_FERMANTE=L_PARENTHESE_FERMANTE,
+	OPERATEUR=L_OPERATEUR,
 
 	NOMBRE=L_NOMBRE,
 	DECIMAL=L_NOMBRE_DECIMAL,
@@ -72,6 +78,7 @@ enum Etat_lex_e {
 
 	COMMENTAIRE=L_COMMENTAIRE,
 	FIN_LIGNE=L_FIN_LIGNE,
+	EXPRESSION=L_EXPRESSION,
 
 	INIT,					/**< Etat initial */
 	MOINS,
@@ -94,11 +101,14 @@ struct Lexeme_s {
 };
 
 void lex_read_line(char *ligne, struct Liste_s *liste_lexemes_p, unsigned int num_ligne, unsigned int *nb_etiquettes_p, unsigned int *nb_instructions_p);
+unsigned int lex_read_lines(FILE *fp, struct Liste_s *liste_lexemes_p, unsigned int nb_lignes_max, unsigned int *nb_lignes_p, unsigned int *nb_etiquettes_p, unsigned int *nb_instructions_p);
+void lex_load_flux(FILE *fp, const char *nom_fichier, struct Liste_s *liste_lexemes_p, unsigned int *nb_lignes_p, unsigned int *nb_etiquettes_p, unsigned int *nb_instructions_p);
 void lex_load_file(char *nom_fichier, struct Liste_s *liste_lexemes_p, unsigned int *nb_lignes_p, unsigned int *nb_etiquettes_p, unsigned int *nb_instructions_p);
 void lex_standardise(char* in, char* out);
+enum Etat_lex_e machine_etats_finis_lexicale(enum Etat_lex_e etat, char c);
 
-void visualisation_lexeme(struct Lexeme_s * lexeme_p);
-void visualisation_liste_lexemes(struct Liste_s * liste_p);
+void visualisation_lexeme(struct Sortie_s *sortie_p, struct Lexeme_s * lexeme_p);
+void visualisation_liste_lexemes(struct Sortie_s *sortie_p, struct Liste_s * liste_p);
 
 void detruit_lexeme(void *lexeme_p);
 char *etat_lex_to_str(enum Etat_lex_e etat);
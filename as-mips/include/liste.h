@@ -2,11 +2,21 @@
  * @file liste.h
  * @author TAURAND Sébastien
  * @brief Définitions de types et structures ainsi que des prototypes des fonctions de travail avec les listes génériques simplement chaînées.
+ *
+ * Les noeuds d'une liste sont pris dans des blocs qui lui appartiennent, de LISTE_NOEUDS_MIN noeuds pour le
+ * premier puis deux fois plus grands à chaque fois, jusqu'à LISTE_NOEUDS_MAX : une liste construite d'un trait a
+ * ses noeuds contigus. Un noeud retiré est repris par l'ajout suivant, vider_liste garde les blocs pour les
+ * éléments à venir et detruire_liste les libère d'un coup.
  */
 
 #ifndef _LISTE_H_
 #define _LISTE_H_
 
+#include <stddef.h>
+
+#define LISTE_NOEUDS_MIN	32		/**< Noeuds du premier bloc d'une liste */
+#define LISTE_NOEUDS_MAX	4096	/**< Noeuds d'un bloc au plus */
+
 /* a common function used to free malloc'd objects */
 typedef void (fonctionDestructeur)(void *);
 
@@ -19,6 +29,17 @@ struct NoeudListe_s {
 	void *donnee_p;							/**< Pointeur non typé sur la donnée de l'élément de liste générique simple */
 };
 
+/**
+ * @struct BlocNoeuds_s
+ * @brief Bloc de noeuds contigus d'une liste
+ */
+struct BlocNoeuds_s {
+	struct BlocNoeuds_s *suivant_p;			/**< Bloc suivant de la liste */
+	size_t capacite;						/**< Nombre de noeuds du bloc */
+	size_t nb_utilises;						/**< Nombre de noeuds déjà distribués */
+	struct NoeudListe_s noeuds[1];			/**< Noeuds, alloués à la suite du bloc */
+};
+
 /**
  * @struct Liste_s
  * @brief Liste simplemement chaînée générique
@@ -28,12 +49,20 @@ struct Liste_s {
 	struct NoeudListe_s *debut_liste_p;		/**< Pointeur sur le premier élément de la liste générique simple. NULL si la liste est vide */
 	struct NoeudListe_s *fin_liste_p;		/**< Pointeur sur le dernier élément de la liste générique simple. NULL si la liste est vide */
 	fonctionDestructeur *fnDestructeur_p;	/**< Pointeur sur la fonction de destruction d'un élément de liste. NULL s'il n'y a pas de destructeur associé */
+	struct BlocNoeuds_s *blocs_p;			/**< Premier bloc de noeuds, NULL si aucun noeud n'a encore été demandé */
+	struct BlocNoeuds_s *bloc_courant_p;	/**< Bloc où sont pris les nouveaux noeuds */
+	struct BlocNoeuds_s *dernier_bloc_p;	/**< Dernier bloc de noeuds */
+	struct NoeudListe_s *libres_p;			/**< Noeuds retirés, chaînés par suivant_p, repris avant ceux des blocs */
 };
 
 struct Liste_s *creer_liste(fonctionDestructeur *freeFn);
 struct Liste_s *detruire_liste(struct Liste_s *liste_p);
+void vider_liste(struct Liste_s *liste_p);
 
 void ajouter_debut_liste(struct Liste_s *liste_p, void *donnee_p);
 void ajouter_fin_liste(struct Liste_s *liste_p, void *donnee_p);
+struct NoeudListe_s *inserer_apres_liste(struct Liste_s *liste_p, struct NoeudListe_s *noeud_p, void *donnee_p);
+void *retirer_apres_liste(struct Liste_s *liste_p, struct NoeudListe_s *noeud_p);
+void concatener_liste(struct Liste_s *liste_p, struct Liste_s *suite_p);
 
 #endif /* _LISTE_H_ */
@@ -0,0 +1,69 @@
+/**
+ * @file lot.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des types et des prototypes de l'assemblage d'un lot de fichiers par un groupe de threads
+ */
+
+#ifndef _LOT_H_
+#define _LOT_H_
+
+#include <stddef.h>
+#include <setjmp.h>
+#include <pthread.h>
+
+#include <diag.h>
+#include <sortie.h>
+#include <profil.h>
+#include <assemblage.h>
+
+#define AUCUN_TRAVAIL	((size_t)-1)	/**< Indice renvoyé quand il ne reste plus de travail à prendre */
+
+/**
+ * @struct Travail_s
+ * @brief Assemblage d'un fichier du lot et ses sorties, conservées en mémoire jusqu'à leur tour d'être écrites
+ */
+struct Travail_s {
+	char *source;					/**< Nom du fichier source */
+	char *fichier_objet;			/**< Nom du fichier produit, à côté du source */
+	struct Diag_s *diag_p;			/**< Diagnostics du fichier, gardés en mémoire */
+	struct Sortie_s *listage_p;		/**< Listage du fichier, gardé en mémoire, NULL sans listage */
+	struct Profil_s *profil_p;		/**< Profil du fichier, NULL sans profilage */
+	jmp_buf reprise;				/**< Point de reprise du thread après une erreur fatale sur ce fichier */
+	int resultat;					/**< SUCCESS si le fichier a été assemblé et écrit sans erreur */
+	int termine;					/**< TRUE quand les sorties sont prêtes à être écrites */
+};
+
+/**
+ * @struct FileTravaux_s
+ * @brief File des travaux d'un thread : il prend en tête, les autres threads volent en queue
+ *
+ * Le bourrage évite que les verrous de deux files voisines partagent une ligne de cache.
+ */
+struct FileTravaux_s {
+	pthread_mutex_t verrou;			/**< Verrou de la file */
+	size_t *indices;				/**< Indices des travaux de la file */
+	size_t tete;					/**< Position du prochain travail à prendre par le propriétaire */
+	size_t queue;					/**< Position suivant le dernier travail de la file */
+	char bourrage[64];
+};
+
+/**
+ * @struct Lot_s
+ * @brief Lot de fichiers assemblés par un groupe de threads qui partagent les dictionnaires en lecture seule
+ */
+struct Lot_s {
+	struct Travail_s *travaux;						/**< Travaux, dans l'ordre de la ligne de commande */
+	size_t nb_travaux;								/**< Nombre de travaux */
+	struct FileTravaux_s *files;					/**< Une file de travaux par thread */
+	unsigned int nb_threads;						/**< Nombre de threads */
+	const struct OptionsAssemblage_s *options_p;	/**< Options communes à tous les fichiers */
+	const struct Dictionnaires_s *dictionnaires_p;	/**< Dictionnaires partagés */
+	pthread_mutex_t verrou;							/**< Verrou protégeant les indicateurs termine */
+	pthread_cond_t travail_termine;					/**< Signalé à chaque travail terminé */
+};
+
+int assembler_lot(char **sources, size_t nb_sources, unsigned int nb_threads, const struct OptionsAssemblage_s *options_p,
+		const struct Dictionnaires_s *dictionnaires_p, int listage, int profilage, int profilage_json);
+size_t prendre_travail(struct Lot_s *lot_p, unsigned int numero);
+
+#endif /* _LOT_H_ */
@@ -0,0 +1,47 @@
+/**
+ * @file lucarne.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des types et des prototypes de l'optimisation à lucarne de .text (-O1, --peephole)
+ *
+ * La lucarne ne voit que l'instruction examinée et celle qui la précède. Une table de règles donne, pour chaque
+ * motif d'une ou deux instructions, la condition sur leurs opérandes et l'action : retirer l'instruction
+ * examinée (MOVE $x,$x, ADDI $r,$r,0, second NOP, branchement vers l'instruction suivante) ou remplacer un LW
+ * qui relit ce que le SW précédent vient de ranger par une copie de registre. Une instruction étiquetée n'est
+ * jamais retirée ni remplacée ; les instructions en mode noreorder et les expansions à relaxer sont laissées
+ * telles qu'elles sont écrites. L'optimisation a lieu avant le remplissage des délais de branchement.
+ */
+
+#ifndef _LUCARNE_H_
+#define _LUCARNE_H_
+
+#include <table.h>
+#include <syn.h>
+#include <profil.h>
+
+/**
+ * @enum ActionLucarne_e
+ * @brief Transformation appliquée quand le motif d'une règle est reconnu
+ */
+enum ActionLucarne_e {
+	A_RETIRER,				/**< Retire l'instruction examinée */
+	A_COPIER				/**< Remplace le chargement examiné par une copie du registre rangé (ou le retire) */
+};
+
+/** Condition sur les opérandes du motif (instruction précédente, NULL pour un motif d'une instruction, et examinée) */
+typedef int (conditionLucarne)(struct Instruction_s *precedente_p, struct Instruction_s *instruction_p, struct AnalyseSyntaxe_s *analyse_p);
+
+/**
+ * @struct RegleLucarne_s
+ * @brief Règle de l'optimisation à lucarne
+ */
+struct RegleLucarne_s {
+	const char *precedente;				/**< Nom de l'instruction qui précède, NULL si le motif n'en a qu'une */
+	const char *examinee;				/**< Nom de l'instruction examinée */
+	conditionLucarne *condition_p;		/**< Condition sur les opérandes, NULL si le motif suffit */
+	enum ActionLucarne_e action;		/**< Transformation */
+	enum CompteurProfil_e compteur;		/**< Compteur du profil des applications de la règle */
+};
+
+int optimiser_lucarne(struct AnalyseSyntaxe_s *analyse_p, int recoder);
+
+#endif /* _LUCARNE_H_ */
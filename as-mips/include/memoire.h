@@ -0,0 +1,53 @@
+/**
+ * @file memoire.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des types et des prototypes du bilan des allocations par sous-système
+ *
+ * Compilé avec -DCOMPTER_MEMOIRE, chaque allocation et chaque libération des structures de l'assembleur est
+ * comptée par sous-système (nombre d'allocations, octets vivants, pic d'octets vivants) et le bilan est écrit
+ * sur la sortie d'erreur à la fin du programme. Sans ce drapeau, MEMOIRE_ALLOUER ne fait qu'incrémenter le
+ * compteur d'allocations du profil et MEMOIRE_LIBERER disparaît.
+ */
+
+#ifndef _MEMOIRE_H_
+#define _MEMOIRE_H_
+
+#include <stddef.h>
+
+#include <profil.h>
+
+/**
+ * @enum SousSysteme_e
+ * @brief Sous-systèmes dont les allocations sont comptées séparément
+ */
+enum SousSysteme_e {
+	MEM_LEXEMES,		/**< Lexèmes et leur texte */
+	MEM_LISTES,			/**< Listes génériques et leurs noeuds */
+	MEM_TABLES,			/**< Tables de hachage (structure et cases) */
+	MEM_ETIQUETTES,		/**< Etiquettes */
+	MEM_INSTRUCTIONS,	/**< Instructions de la section .text */
+	MEM_DONNEES,		/**< Données des sections .data et .bss */
+	MEM_DICTIONNAIRES,	/**< Définitions des instructions et des registres */
+	MEM_PRETRAITEMENT,	/**< Fichiers inclus et corps des macros (.include, .macro) */
+	NB_SOUS_SYSTEMES
+};
+
+#ifdef COMPTER_MEMOIRE
+
+/** Compte une allocation de taille octets pour le sous-système */
+#define MEMOIRE_ALLOUER(sous_systeme, taille)	memoire_allouer((sous_systeme), (taille))
+/** Compte la libération d'un bloc de taille octets du sous-système */
+#define MEMOIRE_LIBERER(sous_systeme, taille)	memoire_liberer((sous_systeme), (taille))
+
+void memoire_allouer(enum SousSysteme_e sous_systeme, size_t taille);
+void memoire_liberer(enum SousSysteme_e sous_systeme, size_t taille);
+void ecrire_bilan_memoire(void);
+
+#else
+
+#define MEMOIRE_ALLOUER(sous_systeme, taille)	PROFIL_COMPTER(CPT_ALLOCATIONS)
+#define MEMOIRE_LIBERER(sous_systeme, taille)	((void)0)
+
+#endif /* COMPTER_MEMOIRE */
+
+#endif /* _MEMOIRE_H_ */
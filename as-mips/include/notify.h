@@ -13,6 +13,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+#include <diag.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -61,26 +62,13 @@ extern "C" {
   fprintf( on_stream, "%c[%d;%dm", 0x1B,	\
 	   STYLE(purpose), COLOR(purpose) )
 
-#define ERROR_MSG(...) do {							\
-    fprintf( stderr, "%c[%d;%dm", 0x1B, STYLE_BOLD, COLOR_BLUE );	\
-    fprintf( stderr, "[ ERROR :: %s:%s:%d] ",				\
-	     __FILE__, __FUNCTION__, __LINE__ );			\
-    SET_COLORS(FOR_ERRORS, ON(stderr));					\
-    fprintf( stderr, __VA_ARGS__ );					\
-    fprintf( stderr, ".\n" );						\
-    RESET_COLORS(ON(stderr));						\
-    exit( EXIT_FAILURE );						\
-} while( 0 )
+/* Les erreurs et avertissements passent par le collecteur de diagnostics courant (cf. diag.h) :
+ * ils sont écrits par paquets et ERROR_MSG appelle la fonction fatale du collecteur avant exit(). */
+#define ERROR_MSG(...) \
+    diag_interne_fatal( __FILE__, __FUNCTION__, __LINE__, __VA_ARGS__ )
 
-#define WARNING_MSG(...) do {						\
-    fprintf( stderr, "%c[%d;%dm", 0x1B, STYLE_BOLD, COLOR_BLUE );	\
-    fprintf( stderr, "[WARNING:: %s:%s:%d] ",				\
-	     __FILE__, __FUNCTION__, __LINE__ );			\
-    SET_COLORS(FOR_WARNINGS, ON(stderr));				\
-    fprintf( stderr, __VA_ARGS__ );					\
-    fprintf( stderr, ".\n" );						\
-    RESET_COLORS(ON(stderr));						\
-} while( 0 )
+#define WARNING_MSG(...) \
+    diag_interne( DIAG_AVERTISSEMENT, __FILE__, __FUNCTION__, __LINE__, __VA_ARGS__ )
 
 #ifdef VERBOSE
 #define INFO_MSG(...) do {							\
@@ -0,0 +1,70 @@
+/**
+ * @file objet.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des types et des prototypes de l'écriture du fichier objet relogeable ELF32
+ */
+
+#ifndef _OBJET_H_
+#define _OBJET_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <elf.h>
+#include <sys/uio.h>
+
+#include <liste.h>
+#include <table.h>
+
+#define NB_SECTIONS_ELF		9		/**< null, .text, .data, .bss, .rel.text, .rel.data, .symtab, .strtab, .shstrtab */
+#define NB_VECTEURS_ELF		(2*NB_SECTIONS_ELF+2)	/**< Morceaux du fichier : entête, sections et bourrages, table des sections */
+
+/**
+ * @struct Relocations_s
+ * @brief Tableau extensible d'entrées de relocation
+ */
+struct Relocations_s {
+	Elf32_Rel *entrees;				/**< Entrées de relocation, dans l'ordre des octets de la cible */
+	size_t nb;						/**< Nombre d'entrées */
+	size_t capacite;				/**< Capacité du tableau */
+};
+
+/**
+ * @struct ObjetElf_s
+ * @brief Fichier objet relogeable prêt à être écrit
+ *
+ * Chaque section est construite dans son propre tampon ; le fichier est ensuite décrit par un tableau de
+ * vecteurs pointant directement sur ces tampons, ce qui permet de l'écrire d'un seul writev sans recopie.
+ */
+struct ObjetElf_s {
+	int gros_boutiste;						/**< TRUE pour une cible gros-boutiste */
+	Elf32_Ehdr entete;						/**< Entête du fichier */
+	Elf32_Shdr sections[NB_SECTIONS_ELF];	/**< Table des sections */
+
+	uint8_t *contenu_text;					/**< Contenu de la section .text */
+	uint8_t *contenu_data;					/**< Contenu de la section .data */
+	struct Relocations_s rel_text;			/**< Relocations de la section .text */
+	struct Relocations_s rel_data;			/**< Relocations de la section .data */
+
+	Elf32_Sym *symboles;					/**< Table des symboles */
+	size_t nb_symboles;						/**< Nombre de symboles */
+	size_t capacite_symboles;				/**< Capacité de la table des symboles */
+	char *chaines;							/**< Noms des symboles (.strtab) */
+	size_t taille_chaines;					/**< Taille utilisée de .strtab */
+	size_t capacite_chaines;				/**< Capacité de .strtab */
+	struct Table_s *indefinis_p;			/**< Symboles référencés mais non définis, par nom */
+
+	struct iovec vecteurs[NB_VECTEURS_ELF];	/**< Morceaux du fichier dans l'ordre */
+	int nb_vecteurs;						/**< Nombre de morceaux */
+	size_t taille_fichier;					/**< Taille totale du fichier */
+};
+
+void construire_objet_elf(struct ObjetElf_s *objet_p,
+		struct Liste_s *liste_text_p, struct Liste_s *liste_data_p, struct Liste_s *liste_bss_p,
+		struct Table_s *table_etiquettes_p, int gros_boutiste);
+int ecrire_objet_elf(struct ObjetElf_s *objet_p, int descripteur);
+void liberer_objet_elf(struct ObjetElf_s *objet_p);
+int generer_objet_elf(const char *nom_fichier,
+		struct Liste_s *liste_text_p, struct Liste_s *liste_data_p, struct Liste_s *liste_bss_p,
+		struct Table_s *table_etiquettes_p, int gros_boutiste);
+
+#endif /* _OBJET_H_ */
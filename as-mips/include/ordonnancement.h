@@ -0,0 +1,25 @@
+/**
+ * @file ordonnancement.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des prototypes de l'ordonnancement des instructions de .text (--schedule)
+ *
+ * Le processeur attend quand une instruction lit un registre chargé par l'instruction précédente, ou HI et LO
+ * trop tôt après MULT et DIV (latences de include/dependances.h). Dans chaque bloc de base, les instructions
+ * qui peuvent être déplacées sont réordonnées par liste : à chaque pas, celle qui peut commencer le plus tôt
+ * sans attendre, la première du source en cas d'égalité. Les étiquettes, les rangements, les appels système,
+ * les branchements et leurs délais, les instructions en mode noreorder ou aux effets inconnus restent à leur
+ * place. Le nouvel ordre d'un bloc n'est gardé que s'il attend moins que l'ancien. Les cycles d'attente
+ * supprimés et restants sont comptés dans le profil (--profile).
+ */
+
+#ifndef _ORDONNANCEMENT_H_
+#define _ORDONNANCEMENT_H_
+
+#include <liste.h>
+#include <table.h>
+
+#define ORDONNANCEMENT_BLOC_MAX	64		/**< Nombre maximal d'instructions réordonnées ensemble (masques sur 64 bits) */
+
+unsigned long ordonnancer_text(struct Liste_s *liste_text_p, struct Table_s *table_def_registres_p, struct Table_s *table_etiquettes_p);
+
+#endif /* _ORDONNANCEMENT_H_ */
@@ -0,0 +1,52 @@
+/**
+ * @file pipeline.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des types et des prototypes de l'assemblage en chaîne (analyse lexicale, syntaxique et codage en parallèle)
+ */
+
+#ifndef _PIPELINE_H_
+#define _PIPELINE_H_
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include <liste.h>
+#include <syn.h>
+
+#define TAILLE_LOT_LIGNES	512		/**< Nombre de lignes sources minimal par lot de lexèmes */
+#define TAILLE_ANNEAU		64		/**< Nombre de lots pouvant être en attente entre deux étages (puissance de 2) */
+
+/**
+ * @struct Anneau_s
+ * @brief File circulaire sans verrou entre un unique producteur et un unique consommateur
+ *
+ * Les indices ne font que croître : le producteur est seul à écrire tete, le consommateur seul à écrire queue.
+ * Ils sont séparés par un bourrage pour ne pas partager de ligne de cache.
+ */
+struct Anneau_s {
+	void **cases;					/**< Cases de la file */
+	size_t masque;					/**< Nombre de cases - 1 (le nombre de cases est une puissance de 2) */
+	char bourrage1[64];
+	size_t tete;					/**< Indice de la prochaine case à remplir */
+	char bourrage2[64];
+	size_t queue;					/**< Indice de la prochaine case à vider */
+};
+
+/**
+ * @struct LotInstructions_s
+ * @brief Suite consécutive d'instructions de la liste .text transmise à l'étage de codage
+ */
+struct LotInstructions_s {
+	struct NoeudListe_s *premier_p;	/**< Noeud de la première instruction du lot */
+	struct NoeudListe_s *dernier_p;	/**< Noeud de la dernière instruction du lot */
+};
+
+struct Anneau_s *creer_anneau(size_t nb_cases);
+struct Anneau_s *detruire_anneau(struct Anneau_s *anneau_p);
+void deposer_anneau(struct Anneau_s *anneau_p, void *element_p);
+void *retirer_anneau(struct Anneau_s *anneau_p);
+
+int assembler_en_pipeline(FILE *fp, const char *nom_fichier, struct Liste_s *liste_lexemes_p, struct AnalyseSyntaxe_s *analyse_p,
+		unsigned int *nb_lignes_p, unsigned int *nb_etiquettes_p, unsigned int *nb_instructions_p);
+
+#endif /* _PIPELINE_H_ */
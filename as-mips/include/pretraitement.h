@@ -0,0 +1,81 @@
+/**
+ * @file pretraitement.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des types et des prototypes des directives .include et .macro/.endm
+ *
+ * Le prétraitement travaille sur les lexèmes de chaque ligne, à la sortie de l'analyse lexicale, sans
+ * jamais repasser par du texte. Un fichier inclus est projeté en mémoire (mmap) et analysé une seule fois par
+ * assemblage, même s'il est inclus plusieurs fois : ses lexèmes sont rangés dans une séquence d'un seul bloc.
+ * Le corps d'une macro est rangé de la même façon ; un appel recopie ses lexèmes en remplaçant chaque
+ * paramètre \\nom par les lexèmes de l'argument correspondant. Les lexèmes produits portent le numéro de la
+ * ligne de la directive .include ou de l'appel de macro.
+ *
+ * Syntaxe :
+ *   .include "fichier.s"          (relatif au répertoire du source, puis au répertoire courant)
+ *   .macro nom p1, p2 ... .endm   (appel : nom a1, a2 ; les arguments absents sont vides)
+ */
+
+#ifndef _PRETRAITEMENT_H_
+#define _PRETRAITEMENT_H_
+
+#include <stddef.h>
+
+#include <liste.h>
+#include <table.h>
+#include <lex.h>
+
+#define PRETRAITEMENT_PROFONDEUR_MAX	32		/**< Imbrication maximale des inclusions et des appels de macros */
+#define PRETRAITEMENT_PARAMETRES_MAX	32		/**< Nombre maximal de paramètres d'une macro */
+
+/**
+ * @struct SequenceLexemes_s
+ * @brief Lexèmes d'un fichier inclus ou du corps d'une macro : un seul bloc contient l'entête, les lexèmes,
+ * les noms des paramètres et tous les textes
+ */
+struct SequenceLexemes_s {
+	char *nom;							/**< Clef : chemin du fichier inclus ou nom de la macro en majuscules */
+	size_t taille;						/**< Taille du bloc, pour le bilan mémoire */
+	unsigned int ligne;					/**< Ligne de la définition de la macro, 0 pour un fichier inclus */
+	unsigned int nb_parametres;			/**< Nombre de paramètres de la macro */
+	char **parametres;					/**< Paramètres de la macro, précédés de '\' comme dans le corps */
+	size_t nb_lexemes;					/**< Nombre de lexèmes, fins de ligne comprises */
+	struct Lexeme_s lexemes[1];			/**< Lexèmes (nb_lexemes cases) */
+};
+
+/**
+ * @struct Pretraitement_s
+ * @brief Etat du prétraitement d'un assemblage
+ */
+struct Pretraitement_s {
+	const char *source;					/**< Source assemblé, pour les diagnostics */
+	char *repertoire;					/**< Répertoire du source, NULL s'il n'en a pas */
+	int inclusions_interdites;			/**< TRUE si .include ne doit lire aucun fichier (bibliothèque) */
+	int resultat;						/**< FAILURE dès qu'une erreur de prétraitement a été signalée */
+
+	struct Liste_s *ligne_p;			/**< Lexèmes de la ligne qui vient d'être analysée */
+	struct Table_s *inclusions_p;		/**< Fichiers déjà inclus, NULL avant la première inclusion */
+	struct Table_s *macros_p;			/**< Macros définies, NULL avant la première définition */
+
+	struct Liste_s *corps_p;			/**< Corps de la macro en cours de définition, NULL en dehors d'une définition */
+	char *nom_macro;					/**< Nom de la macro en cours de définition */
+	char *parametres[PRETRAITEMENT_PARAMETRES_MAX];	/**< Paramètres de la macro en cours de définition */
+	unsigned int nb_parametres;			/**< Nombre de paramètres de la macro en cours de définition */
+	unsigned int ligne_macro;			/**< Ligne de la directive .macro en cours */
+	unsigned int ligne_fichier_macro;	/**< Ligne de la directive .macro en cours dans son fichier (inclus ou source) */
+	unsigned int imbrication;			/**< Nombre de .macro imbriqués dans la définition en cours */
+
+	struct Lexeme_s **vues[PRETRAITEMENT_PROFONDEUR_MAX+1];	/**< Lexèmes de la ligne traitée à chaque profondeur */
+	size_t capacites[PRETRAITEMENT_PROFONDEUR_MAX+1];		/**< Capacité des vues */
+};
+
+struct Pretraitement_s *creer_pretraitement(const char *source, int inclusions_interdites);
+int terminer_pretraitement(struct Pretraitement_s *pretraitement_p);
+struct Pretraitement_s *detruire_pretraitement(struct Pretraitement_s *pretraitement_p);
+
+struct Pretraitement_s *pretraitement_courant(void);
+struct Pretraitement_s *pretraitement_installer(struct Pretraitement_s *pretraitement_p);
+
+void pretraiter_ligne(struct Pretraitement_s *pretraitement_p, struct Liste_s *liste_lexemes_p, unsigned int num_ligne,
+		unsigned int *nb_etiquettes_p, unsigned int *nb_instructions_p);
+
+#endif /* _PRETRAITEMENT_H_ */
@@ -0,0 +1,95 @@
+/**
+ * @file profil.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des types et des prototypes du profilage de l'assemblage (temps par étape et compteurs)
+ *
+ * Chaque étape mesure son temps réel (horloge monotone) et le temps processeur du thread qui l'exécute.
+ * Les compteurs sont propres à chaque thread, ce qui ne coûte qu'une incrémentation sur les chemins critiques ;
+ * ils sont cumulés dans le profil quand un thread termine son étape.
+ */
+
+#ifndef _PROFIL_H_
+#define _PROFIL_H_
+
+#include <stdint.h>
+
+#include <sortie.h>
+
+/**
+ * @enum EtapeProfil_e
+ * @brief Etapes mesurées de l'assemblage
+ */
+enum EtapeProfil_e {
+	ETAPE_DICTIONNAIRES,	/**< Chargement des dictionnaires d'instructions et de registres */
+	ETAPE_LEXICALE,			/**< Analyse lexicale */
+	ETAPE_SYNTAXE,			/**< Analyse syntaxique */
+	ETAPE_CODAGE,			/**< Codage des instructions */
+	ETAPE_RESOLUTION,		/**< Résolution des symboles */
+	ETAPE_OBJET,			/**< Ecriture du fichier objet ou de l'image */
+	ETAPE_LISTAGE,			/**< Ecriture du listage */
+	ETAPE_SIMULATION,		/**< Exécution du programme assemblé (--run) */
+	ETAPE_LIBERATION,		/**< Libération de la mémoire */
+	NB_ETAPES
+};
+
+/**
+ * @enum CompteurProfil_e
+ * @brief Compteurs d'événements de l'assemblage
+ */
+enum CompteurProfil_e {
+	CPT_LIGNES,				/**< Lignes du source */
+	CPT_LEXEMES,			/**< Lexèmes produits par l'analyse lexicale */
+	CPT_ETIQUETTES,			/**< Etiquettes définies */
+	CPT_INSTRUCTIONS,		/**< Instructions de la section .text */
+	CPT_DONNEES,			/**< Données des sections .data et .bss */
+	CPT_RECHERCHES_TABLE,	/**< Recherches dans les tables de hachage */
+	CPT_ALLOCATIONS,		/**< Allocations dynamiques des structures de l'assembleur */
+	CPT_SORTIES_CACHE,		/**< Résultats repris du cache des résultats (--cache) */
+	CPT_DELAIS_REMPLIS,		/**< Délais de branchement remplis par une instruction déplacée (mode reorder) */
+	CPT_DELAIS_NOP,			/**< Délais de branchement remplis par un NOP inséré (mode reorder) */
+	CPT_ATTENTES_EVITEES,		/**< Cycles d'attente supprimés par l'ordonnancement (--schedule) */
+	CPT_ATTENTES_RESTANTES,	/**< Cycles d'attente qui restent dans les blocs ordonnancés (--schedule) */
+	CPT_LUCARNE_MOVE,		/**< MOVE $x,$x retirés par la lucarne (--peephole) */
+	CPT_LUCARNE_NEUTRE,		/**< Instructions $r,$r,0 ou $r,$r,$zero retirées par la lucarne */
+	CPT_LUCARNE_NOP,		/**< NOP qui suivaient un NOP retirés par la lucarne */
+	CPT_LUCARNE_SW_LW,		/**< LW qui relisaient le SW précédent remplacés par MOVE ou retirés par la lucarne */
+	CPT_LUCARNE_SAUT,		/**< Branchements et sauts vers l'instruction suivante retirés par la lucarne */
+	CPT_INSTRUCTIONS_SIMULEES,	/**< Instructions exécutées par le simulateur (--run) */
+	NB_COMPTEURS
+};
+
+/**
+ * @struct Profil_s
+ * @brief Mesures d'un assemblage
+ */
+struct Profil_s {
+	const char *fichier_source;				/**< Nom du fichier assemblé */
+	uint64_t debut_mur[NB_ETAPES];			/**< Début de l'étape en cours (ns, horloge monotone) */
+	uint64_t debut_cpu[NB_ETAPES];			/**< Début de l'étape en cours (ns, temps processeur du thread) */
+	uint64_t mur[NB_ETAPES];				/**< Temps réel cumulé de chaque étape (ns) */
+	uint64_t cpu[NB_ETAPES];				/**< Temps processeur cumulé de chaque étape (ns) */
+	int mesuree[NB_ETAPES];					/**< TRUE si l'étape a été exécutée */
+	uint64_t debut_total_mur;				/**< Création du profil (ns, horloge monotone) */
+	uint64_t debut_total_cpu;				/**< Création du profil (ns, temps processeur du processus) */
+	unsigned long compteurs[NB_COMPTEURS];	/**< Compteurs cumulés des threads */
+};
+
+extern __thread unsigned long profil_compteurs[NB_COMPTEURS];
+
+/** Incrémente un compteur du thread courant */
+#define PROFIL_COMPTER(compteur)	(profil_compteurs[(compteur)]++)
+
+struct Profil_s *creer_profil(const char *fichier_source);
+struct Profil_s *detruire_profil(struct Profil_s *profil_p);
+
+struct Profil_s *profil_courant(void);
+struct Profil_s *profil_installer(struct Profil_s *profil_p);
+
+void profil_debut(struct Profil_s *profil_p, enum EtapeProfil_e etape);
+void profil_fin(struct Profil_s *profil_p, enum EtapeProfil_e etape);
+void profil_cumuler(struct Profil_s *profil_p);
+void profil_fixer(struct Profil_s *profil_p, enum CompteurProfil_e compteur, unsigned long valeur);
+
+void ecrire_profil(struct Sortie_s *sortie_p, struct Profil_s *profil_p, int json);
+
+#endif /* _PROFIL_H_ */
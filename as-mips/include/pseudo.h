@@ -0,0 +1,79 @@
+/**
+ * @file pseudo.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des types et des prototypes des pseudo-instructions
+ *
+ * Les pseudo-instructions sont définies à la suite des instructions du dictionnaire, par des modèles
+ * d'expansion d'une ligne chacun :
+ *
+ *   NOM  nbForme  condition  INSTR op, op ... ; INSTR op ...
+ *
+ * où nbForme est le nombre d'opérandes et la forme (R ou N) attendus par l'analyse syntaxique, et où chaque
+ * opérande d'une instruction de l'expansion est \\k (k-ième opérande de la pseudo-instruction), %hi(\\k) ou
+ * %lo(\\k), un registre ou un nombre. Une pseudo-instruction peut avoir plusieurs expansions : la plus courte
+ * de celles dont la condition porte sur le dernier opérande et est vérifiée est choisie à l'analyse syntaxique,
+ * ou par la relaxation de .text (cf. relaxation.h) si ce dernier opérande dépend d'étiquettes.
+ * Les modèles sont analysés une seule fois au chargement du dictionnaire ; une expansion écrit directement
+ * les instructions réelles dans la liste .text, en reprenant les lexèmes de la pseudo-instruction et ceux,
+ * constants, du modèle.
+ */
+
+#ifndef _PSEUDO_H_
+#define _PSEUDO_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <liste.h>
+#include <table.h>
+#include <dico.h>
+#include <lex.h>
+#include <syn.h>
+
+#define PSEUDO_ETAPES_MAX	4		/**< Nombre maximal d'instructions d'une expansion */
+#define PSEUDO_CONSTANTE	-1		/**< Opérande d'une étape pris dans les lexèmes constants du modèle */
+
+/**
+ * @enum ConditionPseudo_e
+ * @brief Condition d'emploi d'une expansion, portant sur le dernier opérande de la pseudo-instruction
+ */
+enum ConditionPseudo_e {
+	C_TOUJOURS=0,			/**< "*" : toujours valable */
+	C_SIGNE16=1,			/**< "s16" : constante sur 16 bits signés */
+	C_NON_SIGNE16=2,		/**< "u16" : constante sur 16 bits non signés */
+	C_HAUT16=3				/**< "h16" : constante dont les 16 bits de poids faible sont nuls */
+};
+
+/**
+ * @struct EtapePseudo_s
+ * @brief Instruction réelle d'une expansion
+ */
+struct EtapePseudo_s {
+	struct DefinitionInstruction_s *definition_p;	/**< Instruction réelle, ou derivee si un opérande est %hi/%lo */
+	struct DefinitionInstruction_s derivee;			/**< Copie de l'instruction réelle dont les champs 'i' sont 'H' (%hi) ou 'L' (%lo) */
+	int parametres[3];								/**< Indice de l'opérande repris de la pseudo-instruction, ou PSEUDO_CONSTANTE */
+	struct Lexeme_s constantes[3];					/**< Lexèmes constants du modèle (registres, nombres) */
+};
+
+/**
+ * @struct ExpansionPseudo_s
+ * @brief Expansion d'une pseudo-instruction
+ */
+struct ExpansionPseudo_s {
+	enum ConditionPseudo_e condition;				/**< Condition d'emploi de l'expansion */
+	unsigned int nb_etapes;							/**< Nombre d'instructions réelles */
+	struct EtapePseudo_s etapes[PSEUDO_ETAPES_MAX];	/**< Instructions réelles */
+	struct ExpansionPseudo_s *suivante_p;			/**< Expansion suivante de la même pseudo-instruction */
+};
+
+int charge_def_pseudo_flux(struct Table_s *table_definition_p, FILE *f_p);
+void detruire_expansions_pseudo(struct ExpansionPseudo_s *expansion_p);
+
+int valeur_constante_pseudo(struct Lexeme_s *lexeme_p, long *valeur_p);
+struct ExpansionPseudo_s *choisir_expansion_pseudo(struct DefinitionInstruction_s *pseudo_p, int constante, long valeur, unsigned int nb_min);
+int pseudo_variable(struct Instruction_s *instruction_p);
+struct ExpansionPseudo_s *expansion_optimiste_pseudo(struct DefinitionInstruction_s *pseudo_p);
+void ecrire_etape_pseudo(struct Instruction_s *reelle_p, struct EtapePseudo_s *etape_p, struct Lexeme_s **operandes);
+uint32_t developper_pseudo(struct Instruction_s *instruction_p, struct ExpansionPseudo_s *expansion_p, struct Liste_s *liste_text_p);
+
+#endif /* _PSEUDO_H_ */
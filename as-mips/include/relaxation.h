@@ -0,0 +1,84 @@
+/**
+ * @file relaxation.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des types et des prototypes de la relaxation de la section .text
+ *
+ * La taille de l'expansion d'une pseudo-instruction dont le dernier opérande dépend d'étiquettes (li $t0, fin-debut
+ * par exemple) n'est connue qu'une fois ces étiquettes placées, et elle déplace à son tour les étiquettes qui la
+ * suivent. L'analyse syntaxique lui donne d'abord son expansion la plus courte, puis la relaxation, à la fin de
+ * l'analyse, recalcule les pseudo-instructions concernées :
+ *
+ * - les décalages relaxés se déduisent des décalages initiaux et d'un arbre de Fenwick des octets gagnés par
+ *   chaque pseudo-instruction, sans replacer toute la section ;
+ * - chaque tour ne réexamine que la liste de travail des pseudo-instructions dont une étiquette a été déplacée
+ *   par rapport à une autre au tour précédent ;
+ * - une expansion ne raccourcit jamais (elle est complétée par des NOP si besoin) et sa taille est bornée par
+ *   PSEUDO_ETAPES_MAX : chaque tour qui n'est pas le dernier fait grandir une expansion, la relaxation se termine.
+ *
+ * Les instructions ne sont réécrites et les décalages mis à jour qu'une fois, à la fin.
+ */
+
+#ifndef _RELAXATION_H_
+#define _RELAXATION_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <liste.h>
+#include <table.h>
+#include <dico.h>
+#include <lex.h>
+#include <syn.h>
+#include <pseudo.h>
+
+/**
+ * @struct EtiquetteRelaxee_s
+ * @brief Etiquette de .text dont dépend une pseudo-instruction variable
+ */
+struct EtiquetteRelaxee_s {
+	struct Etiquette_s *etiquette_p;	/**< Etiquette */
+	uint32_t decalage;					/**< Décalage de l'étiquette avant relaxation */
+	size_t rang;						/**< Nombre de pseudo-instructions variables qui la précèdent */
+};
+
+/**
+ * @struct PseudoVariable_s
+ * @brief Pseudo-instruction dont l'expansion dépend d'étiquettes
+ */
+struct PseudoVariable_s {
+	struct DefinitionInstruction_s *pseudo_p;	/**< Définition de la pseudo-instruction */
+	struct Lexeme_s *operandes[3];				/**< Opérandes de la pseudo-instruction (expressions partagées) */
+	unsigned int ligne;							/**< Numéro de ligne source */
+	uint32_t decalage;							/**< Décalage avant relaxation */
+	struct NoeudListe_s *premier_p;				/**< Noeud de la première instruction de l'expansion dans la liste .text */
+	unsigned int nb_noeuds;						/**< Nombre d'instructions de l'expansion dans la liste .text */
+	struct ExpansionPseudo_s *expansion_p;		/**< Expansion retenue */
+	unsigned int nb_places;						/**< Nombre d'instructions réservées, NOP compris */
+	size_t premiere_etiquette;					/**< Indice de sa première étiquette dans le tableau des étiquettes */
+	size_t nb_etiquettes;						/**< Nombre d'étiquettes de .text dont elle dépend */
+	size_t rang_min;							/**< Plus petit rang de ses étiquettes */
+	size_t rang_max;							/**< Plus grand rang de ses étiquettes */
+	int a_reecrire;								/**< TRUE si ses instructions doivent être réécrites */
+};
+
+/**
+ * @struct Relaxation_s
+ * @brief Pseudo-instructions variables de la section .text, dans l'ordre des décalages
+ */
+struct Relaxation_s {
+	struct PseudoVariable_s *pseudos;			/**< Pseudo-instructions variables */
+	size_t nb_pseudos;							/**< Nombre de pseudo-instructions variables */
+	size_t capacite_pseudos;					/**< Nombre de cases du tableau pseudos */
+	struct EtiquetteRelaxee_s *etiquettes;		/**< Etiquettes de .text dont elles dépendent */
+	size_t nb_etiquettes;						/**< Nombre d'étiquettes rangées */
+	size_t capacite_etiquettes;					/**< Nombre de cases du tableau etiquettes */
+	uint32_t *croissance;						/**< Arbre de Fenwick des octets gagnés par chaque pseudo-instruction */
+};
+
+struct Relaxation_s *creer_relaxation(void);
+void detruire_relaxation(struct Relaxation_s *relaxation_p);
+struct PseudoVariable_s *noter_pseudo_variable(struct Relaxation_s *relaxation_p, struct Instruction_s *instruction_p,
+		struct ExpansionPseudo_s *expansion_p);
+int relaxer_text(struct Relaxation_s *relaxation_p, struct AnalyseSyntaxe_s *analyse_p, int recoder);
+
+#endif /* _RELAXATION_H_ */
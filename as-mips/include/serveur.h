@@ -0,0 +1,41 @@
+/**
+ * @file serveur.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition du protocole et des prototypes du mode serveur (--serve)
+ *
+ * Requêtes et réponses sont des suites de champs « NOM longueur\n » suivis de longueur octets, terminées par
+ * le champ FIN de longueur nulle. Une connexion peut enchaîner plusieurs requêtes.
+ *
+ * Champs d'une requête :
+ * - ARG : un argument de la ligne de commande, comme pour as-mips (options, nom du source)
+ * - REP : répertoire de travail du client, pour les chemins relatifs (source, -o)
+ * - TERMINAUX : deux caractères '0' ou '1' indiquant si la sortie standard et la sortie d'erreur du client sont
+ *   des terminaux (listage et diagnostics en couleur)
+ * - TEXTE : texte du source ; le nom du source éventuel ne sert alors qu'aux diagnostics
+ * - ARRET : arrête le serveur, qui répond sans rien assembler
+ *
+ * Champs d'une réponse : SORTIE (listage), ERREURS (diagnostics, profil), STATUT (code de sortie en décimal).
+ */
+
+#ifndef _SERVEUR_H_
+#define _SERVEUR_H_
+
+#include <assemblage.h>
+
+#define SERVEUR_ARG			"ARG"			/**< Argument de la ligne de commande */
+#define SERVEUR_REP			"REP"			/**< Répertoire de travail du client */
+#define SERVEUR_TERMINAUX	"TERMINAUX"		/**< Sortie standard et sortie d'erreur du client sur un terminal */
+#define SERVEUR_TEXTE		"TEXTE"			/**< Texte du source */
+#define SERVEUR_ARRET		"ARRET"			/**< Arrêt du serveur */
+#define SERVEUR_SORTIE		"SORTIE"		/**< Listage */
+#define SERVEUR_ERREURS		"ERREURS"		/**< Diagnostics et profil */
+#define SERVEUR_STATUT		"STATUT"		/**< Code de sortie */
+#define SERVEUR_FIN			"FIN"			/**< Fin de la requête ou de la réponse */
+
+#define SERVEUR_NOM_MAX		16				/**< Longueur maximale du nom d'un champ */
+#define SERVEUR_ARGS_MAX	256				/**< Nombre maximal d'arguments d'une requête */
+#define SERVEUR_ATTENTE		16				/**< Nombre de connexions en attente sur le socket */
+
+int servir(const char *chemin_socket, const struct Dictionnaires_s *dictionnaires_p);
+
+#endif /* _SERVEUR_H_ */
@@ -0,0 +1,112 @@
+/**
+ * @file simulation.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des types et des prototypes du simulateur du jeu d'instructions (--run)
+ *
+ * Les sections sont placées comme pour l'image (-O binary) puis copiées dans une mémoire clairsemée, découpée en
+ * pages de 4 Kio créées à la première écriture. Chaque mot de .text est décodé une seule fois en une opération
+ * compacte (registres, immédiat étendu, indice de la cible déjà calculé) ; l'exécution enchaîne ensuite les
+ * opérations sans relire leur code, par goto calculé avec GCC, par un switch sinon. Les délais de branchement
+ * sont exécutés comme sur le processeur.
+ *
+ * L'exécution commence à l'étiquette main, ou au début de .text. $ra vaut au départ l'adresse de la fin de .text :
+ * le JR $ra final de main termine le programme. Les appels système reprennent les numéros de SPIM (1 print_int,
+ * 4 print_string, 5 read_int, 8 read_string, 9 sbrk, 10 exit, 11 print_char, 12 read_char, 17 exit2).
+ */
+
+#ifndef _SIMULATION_H_
+#define _SIMULATION_H_
+
+#include <stdint.h>
+
+#include <liste.h>
+#include <table.h>
+#include <image.h>
+#include <sortie.h>
+
+#define SIMULATION_BITS_PAGE	12				/**< Taille d'une page de la mémoire simulée (4 Kio) */
+#define SIMULATION_BITS_TABLE	10				/**< Pages par table de pages (le répertoire indexe les 10 bits de poids fort) */
+#define SIMULATION_PILE			0x7FFFFFF0		/**< Valeur initiale de $sp */
+#define SIMULATION_LIMITE		1000000000UL	/**< Nombre d'instructions exécutées au plus par défaut */
+
+/**
+ * @enum OperationSimulee_e
+ * @brief Opérations connues du simulateur, une par instruction du dictionnaire (MOVE est un ADDU)
+ */
+enum OperationSimulee_e {
+	OP_ADD, OP_ADDI, OP_ADDIU, OP_ADDU, OP_AND, OP_BEQ, OP_BGTZ, OP_BLEZ, OP_BNE, OP_DIV, OP_J, OP_JAL, OP_JR,
+	OP_LUI, OP_LW, OP_MFHI, OP_MFLO, OP_MULT, OP_NOP, OP_OR, OP_ORI, OP_ROTR, OP_SLL, OP_SLT, OP_SRL, OP_SUB,
+	OP_SW, OP_SYSCALL, OP_XOR,
+	OP_INCONNUE,		/**< Mot qui n'est aucune des instructions connues */
+	OP_FIN,				/**< Sentinelle après la dernière instruction de .text */
+	OP_HORS,			/**< Sentinelle des sauts hors de .text */
+	NB_OPERATIONS
+};
+
+/**
+ * @enum ArretSimulation_e
+ * @brief Cause de l'arrêt de la simulation
+ */
+enum ArretSimulation_e {
+	ARRET_EXIT,			/**< Appel système exit ou exit2 */
+	ARRET_FIN_TEXT,		/**< Exécution arrivée à la fin de .text */
+	ARRET_LIMITE,		/**< Nombre maximal d'instructions atteint */
+	ARRET_ERREUR		/**< Instruction inconnue, dépassement, accès non aligné, saut hors de .text... */
+};
+
+/**
+ * @struct OperationDecodee_s
+ * @brief Instruction de .text décodée une fois pour toutes
+ */
+struct OperationDecodee_s {
+	const void *traitement;				/**< Adresse du traitement de l'opération (goto calculé), NULL sans GCC */
+	enum OperationSimulee_e operation;	/**< Opération */
+	uint8_t rs;							/**< Premier registre lu */
+	uint8_t rt;							/**< Second registre lu, ou registre écrit par une instruction immédiate */
+	uint8_t rd;							/**< Registre écrit, 32 pour $zero qui ignore l'écriture */
+	uint8_t sa;							/**< Décalage des SLL, SRL et ROTR */
+	int32_t immediat;					/**< Immédiat étendu selon l'instruction */
+	uint32_t cible;						/**< Indice de l'opération visée par un branchement ou un saut */
+	unsigned int ligne;					/**< Ligne source de l'instruction */
+	unsigned long executions;			/**< Nombre d'exécutions */
+};
+
+/**
+ * @struct MemoireSimulee_s
+ * @brief Mémoire clairsemée de 4 Gio, en pages créées à la première écriture
+ */
+struct MemoireSimulee_s {
+	uint8_t **tables[1 << (32-SIMULATION_BITS_TABLE-SIMULATION_BITS_PAGE)];	/**< Répertoire des tables de pages */
+	unsigned long nb_pages;				/**< Nombre de pages créées */
+	int gros_boutiste;					/**< TRUE pour une cible gros-boutiste */
+};
+
+/**
+ * @struct Simulation_s
+ * @brief Etat du programme simulé
+ */
+struct Simulation_s {
+	struct OperationDecodee_s *operations;	/**< Opérations de .text, suivies des sentinelles OP_FIN et OP_HORS */
+	uint32_t nb_operations;				/**< Nombre d'instructions de .text */
+	uint32_t base_text;					/**< Adresse de .text */
+	uint32_t depart;					/**< Indice de la première instruction exécutée */
+	uint32_t registres[33];				/**< Registres, le 33e recevant les écritures dans $zero */
+	uint32_t hi;						/**< Registre HI */
+	uint32_t lo;						/**< Registre LO */
+	uint32_t tas;						/**< Fin du tas (sbrk), après la dernière section */
+	struct MemoireSimulee_s memoire;	/**< Mémoire du programme */
+	unsigned long limite;				/**< Nombre maximal d'instructions exécutées, 0 sans limite */
+	unsigned long executees;			/**< Nombre d'instructions exécutées */
+	enum ArretSimulation_e arret;		/**< Cause de l'arrêt */
+	int code_sortie;					/**< Code de sortie (exit2), 0 sinon */
+	unsigned int ligne_arret;			/**< Ligne de l'instruction en cause pour ARRET_ERREUR, 0 si inconnue */
+	char message[128];					/**< Explication de l'erreur pour ARRET_ERREUR */
+};
+
+struct Simulation_s *creer_simulation(struct Liste_s *liste_text_p, struct Liste_s *liste_data_p, struct Liste_s *liste_bss_p,
+		struct Table_s *table_etiquettes_p, const struct ParametresImage_s *parametres_p, const char *nom_fichier);
+struct Simulation_s *detruire_simulation(struct Simulation_s *simulation_p);
+void executer_simulation(struct Simulation_s *simulation_p, struct Sortie_s *sortie_programme_p);
+void ecrire_simulation(struct Sortie_s *sortie_p, const struct Simulation_s *simulation_p);
+
+#endif /* _SIMULATION_H_ */
@@ -0,0 +1,46 @@
+/**
+ * @file sortie.h
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des types et des prototypes de la sortie tamponnée (texte et binaire)
+ *
+ * Les écritures remplissent un grand tampon qui n'est transmis au système que lorsqu'il est plein, par un
+ * seul write(). Les nombres sont mis en forme directement dans le tampon, sans passer par printf.
+ */
+
+#ifndef _SORTIE_H_
+#define _SORTIE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TAILLE_TAMPON_SORTIE	(1<<20)		/**< Taille par défaut du tampon de sortie */
+
+/**
+ * @struct Sortie_s
+ * @brief Sortie tamponnée sur un descripteur de fichier
+ */
+struct Sortie_s {
+	int descripteur;			/**< Descripteur de fichier de destination, -1 pour une sortie en mémoire */
+	char *tampon;				/**< Tampon d'écriture */
+	size_t taille;				/**< Nombre d'octets en attente dans le tampon */
+	size_t capacite;			/**< Taille du tampon */
+	int erreur;					/**< errno de la première écriture en échec, 0 sinon */
+	int couleur;				/**< TRUE pour écrire les séquences de couleur ANSI (sortie sur un terminal) */
+};
+
+struct Sortie_s *creer_sortie(int descripteur, size_t capacite);
+struct Sortie_s *detruire_sortie(struct Sortie_s *sortie_p);
+int vider_sortie(struct Sortie_s *sortie_p);
+
+char *sortie_reserver(struct Sortie_s *sortie_p, size_t nb);
+void sortie_ecrire(struct Sortie_s *sortie_p, const void *donnees_p, size_t nb);
+void sortie_chaine(struct Sortie_s *sortie_p, const char *chaine);
+void sortie_caractere(struct Sortie_s *sortie_p, char caractere);
+void sortie_repeter(struct Sortie_s *sortie_p, char caractere, size_t nb);
+void sortie_hex(struct Sortie_s *sortie_p, uint32_t valeur, int nb_chiffres);
+void sortie_decimal(struct Sortie_s *sortie_p, unsigned long valeur, int largeur);
+void sortie_chaine_alignee(struct Sortie_s *sortie_p, const char *chaine, int largeur);
+void sortie_chaine_json(struct Sortie_s *sortie_p, const char *chaine);
+void sortie_style(struct Sortie_s *sortie_p, int style, int couleur);
+
+#endif /* _SORTIE_H_ */
@@ -11,6 +11,9 @@
 
 #include <liste.h>
 #include <table.h>
+#include <sortie.h>
+
+struct Relaxation_s;
 
 /**
  * @enum Section_e
@@ -43,6 +46,8 @@ struct Instruction_s {
 	struct DefinitionInstruction_s *definition_p;	/**< Définition de l'instruction */
 	unsigned int ligne;								/**< Numéro de ligne source associé à la ligne de lexème traitée */
 	uint32_t decalage;								/**< Décalage de l'instruction */
+	uint32_t code;									/**< Code machine de l'instruction */
+	int ordre_fixe;									/**< TRUE si elle suit un .set noreorder : son délai de branchement est laissé tel quel */
 	struct Lexeme_s *operandes[3];					/**< Lexème de l'opérande 1 */
 };
 
@@ -76,12 +81,46 @@ struct Donnee_s {
 	} valeur;
 };
 
+/**
+ * @struct AnalyseSyntaxe_s
+ * @brief Etat de l'analyse syntaxique conservé d'une ligne à l'autre
+ *
+ * Permet de reprendre l'analyse là où elle s'était arrêtée lorsque les lexèmes arrivent par lots successifs.
+ */
+struct AnalyseSyntaxe_s {
+	struct Table_s *table_def_instructions_p;	/**< Pointeur sur la table "dico" des instructions */
+	struct Table_s *table_def_registres_p;		/**< Pointeur sur la table "dico" des registres */
+	struct Table_s *table_etiquettes_p;			/**< Pointeur sur la table des étiquettes */
+	struct Liste_s *liste_text_p;				/**< Pointeur sur la liste des instructions de la section .text */
+	struct Liste_s *liste_data_p;				/**< Pointeur sur la liste des données de la section .data */
+	struct Liste_s *liste_bss_p;				/**< Pointeur sur la liste des réservations des .space de la section .bss */
+	uint32_t decalage_text;						/**< Décalage courant dans la section .text */
+	uint32_t decalage_data;						/**< Décalage courant dans la section .data */
+	uint32_t decalage_bss;						/**< Décalage courant dans la section .bss */
+	enum Section_e section;						/**< Section en cours */
+	int resultat;								/**< SUCCESS tant qu'aucune erreur de syntaxe n'a été rencontrée */
+	int ordre_fixe;								/**< TRUE après .set noreorder, FALSE après .set reorder (par défaut) */
+	int lucarne;								/**< TRUE pour appliquer l'optimisation à lucarne en fin d'analyse (--peephole) */
+	struct Relaxation_s *relaxation_p;			/**< Pseudo-instructions dont l'expansion dépend d'étiquettes, NULL si aucune */
+};
+
+extern const char *NOMS_SECTIONS[];
+extern const char *NOMS_DATA[];
+
 char *clefEtiquette(void *donnee_p);
+void detruit_etiquette(void *etiquette_p);
+void detruit_instruction(void *instruction_p);
+void detruit_donnee(void *donnee_p);
 
-void affiche_table_etiquette(struct Table_s *table_p, char *titre);
-void affiche_liste_donnee(struct Liste_s *liste_p, struct Table_s *table_p, char *titre_liste);
-void affiche_liste_instructions(struct Liste_s *liste_p, struct Table_s *table_p, char *titre_liste);
+void affiche_table_etiquette(struct Sortie_s *sortie_p, struct Table_s *table_p, char *titre);
+void affiche_liste_donnee(struct Sortie_s *sortie_p, struct Liste_s *liste_p, struct Table_s *table_p, char *titre_liste);
+void affiche_liste_instructions(struct Sortie_s *sortie_p, struct Liste_s *liste_p, struct Table_s *table_p, char *titre_liste);
 
+void debuter_analyse_syntaxe(struct AnalyseSyntaxe_s *analyse_p,
+		struct Table_s *table_def_instructions_p, struct Table_s *table_def_registres_p, struct Table_s *table_etiquettes_p,
+		struct Liste_s *liste_text_p, struct Liste_s *liste_data_p, struct Liste_s *liste_bss_p);
+int analyser_lignes(struct AnalyseSyntaxe_s *analyse_p, struct NoeudListe_s *noeud_lexeme_p);
+int terminer_analyse_syntaxe(struct AnalyseSyntaxe_s *analyse_p, int recoder);
 int analyser_syntaxe(struct Liste_s *lignes_lexemes_p,
 		struct Table_s *table_def_instructions_p, struct Table_s *table_def_registres_p, struct Table_s *table_etiquettes_p,
 		struct Liste_s *liste_text_p, struct Liste_s *liste_data_p, struct Liste_s *liste_bss_p);
@@ -33,6 +33,7 @@ size_t hashKR2(char *chaine);
 
 struct Table_s *creer_table(size_t nb_elts, fonctionClef *fn_clef_p, fonctionDestruction *fn_destruction_p);
 struct Table_s *detruire_table(struct Table_s *table_p);
+void redimensionner_table(struct Table_s *table_p, size_t nb_elts);
 
 size_t index_table(struct Table_s *table_p, char *clef);
 void *donnee_table(struct Table_s *table_p, char *clef);
@@ -0,0 +1,317 @@
+/**
+ * @file asmips.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions de la bibliothèque libasmips
+ *
+ * Le source est lu par un flux en mémoire (fmemopen) et assemblé par assembler_flux, sans fichier produit ni
+ * listage. Les diagnostics vont au collecteur du contexte, qui ne les écrit pas ; sa fonction fatale reprend
+ * l'assemblage interrompu au lieu de terminer le programme. Les sections sont ensuite placées comme pour une
+ * image mémoire et remplies dans les tampons du contexte, qui ne sont agrandis qu'au besoin.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <setjmp.h>
+
+#include <global.h>
+#include <notify.h>
+#include <diag.h>
+#include <dico.h>
+#include <lex.h>
+#include <syn.h>
+#include <gen.h>
+#include <image.h>
+#include <empreinte.h>
+#include <assemblage.h>
+#include <asmips.h>
+
+/**
+ * @param contexte_p pointeur sur le contexte dont l'assemblage est interrompu
+ * @return Ne revient pas
+ * @brief Fonction fatale du collecteur d'un contexte : reprend à la fin de l'appel en cours
+ */
+void reprendre_asmips(void *contexte_p)
+{
+	longjmp(((struct AsmMips_s *)contexte_p)->reprise, 1);
+}
+
+/**
+ * @param table_pp pointeur sur la table à créer
+ * @param texte définitions
+ * @param fn_charge_p fonction de chargement depuis un flux
+ * @param empreinte_p pointeur sur l'empreinte des dictionnaires en cours de calcul
+ * @return SUCCESS si les définitions ont été chargées, FAILURE sinon
+ */
+int charger_dictionnaire_asmips(struct Table_s **table_pp, const char *texte,
+		int (*fn_charge_p)(struct Table_s **, FILE *), struct Empreinte_s *empreinte_p)
+{
+	int resultat;
+	FILE *fp=fmemopen((void *)texte, strlen(texte), "r");
+
+	if (!fp) {
+		diag_signaler(NULL, DIAG_ERREUR, NULL, 0, "dictionnaire", "impossible de lire les définitions");
+		return FAILURE;
+	}
+	resultat=fn_charge_p(table_pp, fp);
+	fclose(fp);
+	ajouter_empreinte(empreinte_p, texte, strlen(texte));
+	return resultat;
+}
+
+/**
+ * @param instructions texte du dictionnaire des instructions (contenu de src/dictionnaire_instructions.txt...)
+ * @param registres texte du dictionnaire des registres (contenu de src/dictionnaire_registres.txt...)
+ * @return pointeur sur le contexte créé, NULL si un texte manque ou si les dictionnaires n'ont pas pu être chargés
+ * @brief Crée un contexte et charge ses dictionnaires, donnés par l'appelant : la bibliothèque ne lit aucun fichier
+ */
+struct AsmMips_s *creer_asmips(const char *instructions, const char *registres)
+{
+	struct AsmMips_s *asmips_p;
+	struct Diag_s *precedent_p;
+	struct Empreinte_s empreinte;
+	volatile int resultat=FAILURE;
+
+	if ((!instructions) || (!registres) || (!(asmips_p=calloc(1, sizeof(*asmips_p))))) return NULL;
+	asmips_p->diag_p=creer_diag(DIAG_TEXTE, -1);
+	asmips_p->diag_p->max_repetitions=0;
+	asmips_p->diag_p->fn_fatale_p=reprendre_asmips;
+	asmips_p->diag_p->contexte_fatal_p=asmips_p;
+	initialiser_parametres_image(&asmips_p->parametres);
+	asmips_p->options.image=asmips_p->parametres;
+	asmips_p->options.sans_inclusion=TRUE;
+	asmips_p->dictionnaires_p=&asmips_p->dictionnaires;
+
+	precedent_p=diag_installer(asmips_p->diag_p);
+	if (!setjmp(asmips_p->reprise)) {
+		debuter_empreinte(&empreinte);
+		resultat=charger_dictionnaire_asmips(&asmips_p->dictionnaires.instructions_p, instructions,
+				charge_def_instruction_flux, &empreinte);
+		if (FAILURE==charger_dictionnaire_asmips(&asmips_p->dictionnaires.registres_p, registres,
+				charge_def_registre_flux, &empreinte)) resultat=FAILURE;
+		terminer_empreinte(&empreinte, asmips_p->dictionnaires.empreinte);
+		asmips_p->assemblage_p=creer_assemblage();
+	}
+	else
+		resultat=FAILURE;
+	diag_installer(precedent_p);
+
+	if (resultat==FAILURE) return detruire_asmips(asmips_p);
+	return asmips_p;
+}
+
+/**
+ * @param modele_p pointeur sur le contexte dont les dictionnaires sont partagés, à détruire en dernier
+ * @return pointeur sur le contexte créé, NULL en cas de manque de mémoire
+ * @brief Crée un contexte utilisant les dictionnaires d'un autre, par exemple un contexte par thread
+ */
+struct AsmMips_s *creer_asmips_partage(const struct AsmMips_s *modele_p)
+{
+	struct AsmMips_s *asmips_p=calloc(1, sizeof(*asmips_p));
+	struct Diag_s *precedent_p;
+
+	if (!asmips_p) return NULL;
+	asmips_p->diag_p=creer_diag(DIAG_TEXTE, -1);
+	asmips_p->diag_p->max_repetitions=0;
+	asmips_p->diag_p->fn_fatale_p=reprendre_asmips;
+	asmips_p->diag_p->contexte_fatal_p=asmips_p;
+	asmips_p->parametres=modele_p->parametres;
+	asmips_p->options=modele_p->options;
+	asmips_p->dictionnaires_p=modele_p->dictionnaires_p;
+
+	precedent_p=diag_installer(asmips_p->diag_p);
+	if (!setjmp(asmips_p->reprise))
+		asmips_p->assemblage_p=creer_assemblage();
+	diag_installer(precedent_p);
+
+	if (!asmips_p->assemblage_p) return detruire_asmips(asmips_p);
+	return asmips_p;
+}
+
+/**
+ * @param asmips_p pointeur sur le contexte, NULL accepté
+ * @return NULL
+ * @brief Libère le contexte et tous ses résultats
+ */
+struct AsmMips_s *detruire_asmips(struct AsmMips_s *asmips_p)
+{
+	struct Diag_s *precedent_p;
+	int s;
+
+	if (asmips_p) {
+		precedent_p=diag_installer(asmips_p->diag_p);
+		asmips_p->assemblage_p=detruire_assemblage(asmips_p->assemblage_p);
+		diag_installer(precedent_p);
+		liberer_dictionnaires(&asmips_p->dictionnaires);
+		for (s=S_INIT; s<=S_BSS; s++) free(asmips_p->sections[s].contenu);
+		free(asmips_p->symboles);
+		free(asmips_p->diagnostics);
+		detruire_diag(asmips_p->diag_p);
+		free(asmips_p);
+	}
+	return NULL;
+}
+
+/**
+ * @param symbole1_p pointeur sur une étiquette
+ * @param symbole2_p pointeur sur une étiquette
+ * @return négatif, nul ou positif suivant l'ordre des adresses puis des lignes
+ */
+int comparer_symboles_asmips(const void *symbole1_p, const void *symbole2_p)
+{
+	const struct SymboleAsmMips_s *s1_p=symbole1_p;
+	const struct SymboleAsmMips_s *s2_p=symbole2_p;
+
+	if (s1_p->adresse!=s2_p->adresse) return s1_p->adresse<s2_p->adresse ? -1 : 1;
+	return s1_p->ligne<s2_p->ligne ? -1 : s1_p->ligne>s2_p->ligne ? 1 : 0;
+}
+
+/**
+ * @param section_p pointeur sur la section à remplir
+ * @param adresse adresse de la section placée
+ * @param taille taille de la section
+ * @param contenu TRUE si le contenu de la section doit être construit
+ * @return Rien
+ * @brief Prépare le tampon d'une section, agrandi au besoin et remis à zéro
+ */
+void preparer_section_asmips(struct SectionAsmMips_s *section_p, uint32_t adresse, uint32_t taille, int contenu)
+{
+	section_p->adresse=adresse;
+	section_p->taille=taille;
+	if (!contenu) return;
+	if (taille>section_p->capacite) {
+		free(section_p->contenu);
+		section_p->capacite=0;
+		if (!(section_p->contenu=malloc(taille))) ERROR_MSG("Impossible d'allouer le contenu d'une section");
+		section_p->capacite=taille;
+	}
+	if (section_p->contenu) memset(section_p->contenu, 0, taille);
+}
+
+/**
+ * @param asmips_p pointeur sur le contexte dont l'assemblage a réussi
+ * @param nom nom du source, pour les diagnostics
+ * @return SUCCESS si les sections ont pu être placées, FAILURE sinon
+ * @brief Place les sections, construit leur contenu et relève les étiquettes
+ */
+int recueillir_resultats_asmips(struct AsmMips_s *asmips_p, const char *nom)
+{
+	struct Assemblage_s *assemblage_p=asmips_p->assemblage_p;
+	struct Table_s *etiquettes_p=assemblage_p->etiquettes_p;
+	struct ParametresImage_s *parametres_p=&asmips_p->options.image;
+	struct Etiquette_s *etiquette_p;
+	struct SymboleAsmMips_s *symbole_p;
+	uint32_t tailles[4];
+	size_t i;
+
+	tailles[S_INIT]=0;
+	tailles[S_TEXT]=taille_section(assemblage_p->text_p, S_TEXT);
+	tailles[S_DATA]=taille_section(assemblage_p->data_p, S_DATA);
+	tailles[S_BSS]=taille_section(assemblage_p->bss_p, S_BSS);
+	if (FAILURE==placer_sections_image(parametres_p, tailles, nom)) return FAILURE;
+
+	preparer_section_asmips(asmips_p->sections+S_TEXT, parametres_p->adresses_base[S_TEXT], tailles[S_TEXT], TRUE);
+	preparer_section_asmips(asmips_p->sections+S_DATA, parametres_p->adresses_base[S_DATA], tailles[S_DATA], TRUE);
+	preparer_section_asmips(asmips_p->sections+S_BSS, parametres_p->adresses_base[S_BSS], tailles[S_BSS], FALSE);
+	if ((tailles[S_TEXT]) && (FAILURE==remplir_section_text(assemblage_p->text_p, etiquettes_p, parametres_p->adresses_base,
+			parametres_p->gros_boutiste, asmips_p->sections[S_TEXT].contenu)))
+		return FAILURE;
+	if (tailles[S_DATA])
+		remplir_section_donnees(assemblage_p->data_p, etiquettes_p, parametres_p->adresses_base, parametres_p->gros_boutiste,
+				asmips_p->sections[S_DATA].contenu);
+
+	if (etiquettes_p->nbElts>asmips_p->capacite_symboles) {
+		free(asmips_p->symboles);
+		if (!(asmips_p->symboles=malloc(etiquettes_p->nbElts*sizeof(*asmips_p->symboles))))
+			ERROR_MSG("Impossible d'allouer les étiquettes");
+		asmips_p->capacite_symboles=etiquettes_p->nbElts;
+	}
+	for (i=0; i<etiquettes_p->nbEltsMax; i++)
+		if ((etiquette_p=etiquettes_p->table[i])) {
+			symbole_p=asmips_p->symboles+asmips_p->nb_symboles++;
+			symbole_p->nom=etiquette_p->lexeme_p->data;
+			symbole_p->section=etiquette_p->section;
+			symbole_p->adresse=parametres_p->adresses_base[etiquette_p->section]+etiquette_p->decalage;
+			symbole_p->ligne=etiquette_p->ligne;
+		}
+	qsort(asmips_p->symboles, asmips_p->nb_symboles, sizeof(*asmips_p->symboles), comparer_symboles_asmips);
+	return SUCCESS;
+}
+
+/**
+ * @param asmips_p pointeur sur le contexte
+ * @return Rien
+ * @brief Relève les diagnostics du collecteur du contexte ; leurs messages restent dans le collecteur
+ */
+void recueillir_diagnostics_asmips(struct AsmMips_s *asmips_p)
+{
+	struct Diag_s *diag_p=asmips_p->diag_p;
+	struct DiagnosticAsmMips_s *diagnostic_p;
+	size_t i;
+
+	if (diag_p->nb_attente>asmips_p->capacite_diagnostics) {
+		free(asmips_p->diagnostics);
+		if (!(asmips_p->diagnostics=malloc(diag_p->capacite_attente*sizeof(*asmips_p->diagnostics)))) {
+			asmips_p->capacite_diagnostics=0;
+			return;
+		}
+		asmips_p->capacite_diagnostics=diag_p->capacite_attente;
+	}
+	for (i=0; i<diag_p->nb_attente; i++) {
+		diagnostic_p=asmips_p->diagnostics+asmips_p->nb_diagnostics++;
+		diagnostic_p->severite=diag_p->attente[i].severite;
+		diagnostic_p->ligne=diag_p->attente[i].ligne;
+		diagnostic_p->code=diag_p->attente[i].code;
+		diagnostic_p->message=diag_p->texte+diag_p->attente[i].message;
+	}
+}
+
+/**
+ * @param asmips_p pointeur sur le contexte, ses résultats précédents sont remplacés
+ * @param texte source à assembler, qui n'a pas besoin de se terminer par un caractère nul
+ * @param taille taille du source en octets
+ * @param nom nom du source dans les diagnostics, NULL pour aucun ; il doit rester valable avec les résultats
+ * @return SUCCESS si l'assemblage n'a rencontré aucune erreur, FAILURE sinon
+ * @brief Assemble un source en mémoire ; les diagnostics sont rendus dans les deux cas
+ *
+ * Les options de placement et de boutisme sont prises dans asmips_p->parametres au début de l'appel.
+ */
+int asmips_assembler(struct AsmMips_s *asmips_p, const char *texte, size_t taille, const char *nom)
+{
+	static char vide[1]="";
+	struct Diag_s *precedent_p;
+	volatile int resultat=FAILURE;
+	FILE *fp;
+	int s;
+
+	precedent_p=diag_installer(asmips_p->diag_p);
+	reinitialiser_diag(asmips_p->diag_p);
+	asmips_p->diag_p->fichier_source=nom ? nom : "";
+	asmips_p->nb_symboles=0;
+	asmips_p->nb_diagnostics=0;
+	for (s=S_INIT; s<=S_BSS; s++) {
+		asmips_p->sections[s].adresse=0;
+		asmips_p->sections[s].taille=0;
+	}
+
+	if (!setjmp(asmips_p->reprise)) {
+		/* les résultats précédents (noms des étiquettes compris) ne sont libérés qu'ici */
+		reinitialiser_assemblage(asmips_p->assemblage_p);
+		asmips_p->options.image=asmips_p->parametres;
+		if (!(fp=fmemopen(texte ? (void *)texte : vide, taille, "r"))) ERROR_MSG("Impossible de lire le source en mémoire");
+		resultat=assembler_flux(asmips_p->assemblage_p, fp, asmips_p->diag_p->fichier_source, NULL, &asmips_p->options,
+				asmips_p->dictionnaires_p, NULL);
+		if (resultat==SUCCESS) resultat=recueillir_resultats_asmips(asmips_p, asmips_p->diag_p->fichier_source);
+	}
+	else
+		resultat=FAILURE;
+	if (resultat==FAILURE) {
+		asmips_p->nb_symboles=0;
+		for (s=S_INIT; s<=S_BSS; s++) asmips_p->sections[s].taille=0;
+	}
+
+	recueillir_diagnostics_asmips(asmips_p);
+	diag_installer(precedent_p);
+	return resultat;
+}
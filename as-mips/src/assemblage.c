@@ -0,0 +1,416 @@
+/**
+ * @file assemblage.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions de l'assemblage complet d'un fichier source
+ *
+ * Les diagnostics vont au collecteur courant du thread et le profil éventuel est celui installé pour le thread :
+ * l'appelant choisit où ils vont (sortie d'erreur, mémoire pour un lot de fichiers...).
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <global.h>
+#include <notify.h>
+#include <diag.h>
+#include <dico.h>
+#include <lex.h>
+#include <pretraitement.h>
+#include <cache_sorties.h>
+#include <syn.h>
+#include <gen.h>
+#include <ordonnancement.h>
+#include <pipeline.h>
+#include <objet.h>
+#include <image.h>
+#include <profil.h>
+#include <simulation.h>
+#include <assemblage.h>
+
+/**
+ * @param dictionnaires_p pointeur sur les dictionnaires à charger
+ * @return SUCCESS si les deux dictionnaires ont été chargés, FAILURE sinon
+ * @brief Charge les dictionnaires d'instructions et de registres par défaut
+ */
+int charger_dictionnaires(struct Dictionnaires_s *dictionnaires_p)
+{
+	struct Profil_s *profil_p=profil_courant();
+	struct Empreinte_s empreinte;
+	int resultat;
+
+	profil_debut(profil_p, ETAPE_DICTIONNAIRES);
+	dictionnaires_p->instructions_p=NULL;
+	dictionnaires_p->registres_p=NULL;
+	resultat=charge_def_instruction(&dictionnaires_p->instructions_p, DICTIONNAIRE_INSTRUCTIONS);
+	if (FAILURE==charge_def_registre(&dictionnaires_p->registres_p, DICTIONNAIRE_REGISTRES)) resultat=FAILURE;
+
+	debuter_empreinte(&empreinte);
+	empreinte_fichier(&empreinte, DICTIONNAIRE_INSTRUCTIONS);
+	empreinte_fichier(&empreinte, DICTIONNAIRE_REGISTRES);
+	terminer_empreinte(&empreinte, dictionnaires_p->empreinte);
+	profil_fin(profil_p, ETAPE_DICTIONNAIRES);
+	return resultat;
+}
+
+/**
+ * @param dictionnaires_p pointeur sur les dictionnaires
+ * @return Rien
+ */
+void liberer_dictionnaires(struct Dictionnaires_s *dictionnaires_p)
+{
+	dictionnaires_p->instructions_p=detruire_table(dictionnaires_p->instructions_p);
+	dictionnaires_p->registres_p=detruire_table(dictionnaires_p->registres_p);
+}
+
+/**
+ * @param argc nombre d'arguments
+ * @param argv arguments, argv[0] étant le nom du programme
+ * @param ligne_p pointeur sur la ligne de commande à remplir
+ * @param diag_p collecteur dont --diag et --diag-max changent la forme
+ * @return SUCCESS si tous les arguments sont reconnus, FAILURE sinon
+ * @brief Analyse les options et les noms des sources ; la cohérence de l'ensemble est vérifiée par l'appelant
+ */
+int analyser_ligne_commande(int argc, char *argv[], struct LigneCommande_s *ligne_p, struct Diag_s *diag_p)
+{
+	enum Section_e section;
+	int i;
+
+	memset(ligne_p, 0, sizeof(*ligne_p));
+	ligne_p->options.pipeline=FALSE;
+	initialiser_parametres_image(&ligne_p->options.image);
+	ligne_p->listage=TRUE;
+	ligne_p->limite_simulation=SIMULATION_LIMITE;
+	if (!(ligne_p->sources=calloc(argc+1, sizeof(*ligne_p->sources)))) ERROR_MSG("Impossible de lire la ligne de commande");
+
+	for (i=1; i<argc; i++) {
+		if ((!strcmp(argv[i], "-p")) || (!strcmp(argv[i], "--pipeline")))
+			ligne_p->options.pipeline=TRUE;
+		else if ((!strcmp(argv[i], "-q")) || (!strcmp(argv[i], "--quiet")))
+			ligne_p->listage=FALSE;
+		else if ((!strcmp(argv[i], "-o")) && (i+1<argc))
+			ligne_p->fichier_objet=argv[++i];
+		else if ((!strncmp(argv[i], "-j", 2)) && ((argv[i][2]) || (i+1<argc))) {
+			if (!(ligne_p->nb_threads=strtoul(argv[i][2] ? argv[i]+2 : argv[++i], NULL, 10))) return FAILURE;
+		} else if ((!strcmp(argv[i], "-O")) && (i+1<argc)) {
+			if (FAILURE==format_sortie(argv[++i], &ligne_p->options.image.format)) return FAILURE;
+		} else if (!strcmp(argv[i], "-EB"))
+			ligne_p->options.image.gros_boutiste=TRUE;
+		else if (!strcmp(argv[i], "-EL"))
+			ligne_p->options.image.gros_boutiste=FALSE;
+		else if ((!strncmp(argv[i], "--base-", 7)) && (i+1<argc)) {
+			if (!strcmp(argv[i]+7, "text")) section=S_TEXT;
+			else if (!strcmp(argv[i]+7, "data")) section=S_DATA;
+			else if (!strcmp(argv[i]+7, "bss")) section=S_BSS;
+			else return FAILURE;
+			ligne_p->options.image.adresses_base[section]=strtoul(argv[++i], NULL, 0);
+			ligne_p->options.image.base_fixee[section]=TRUE;
+		} else if ((!strcmp(argv[i], "--gap-fill")) && (i+1<argc))
+			ligne_p->options.image.remplissage=(uint8_t)strtoul(argv[++i], NULL, 0);
+		else if ((!strcmp(argv[i], "--diag")) && (i+1<argc)) {
+			if (FAILURE==diag_format(argv[++i], &diag_p->format)) return FAILURE;
+		} else if ((!strcmp(argv[i], "--diag-max")) && (i+1<argc))
+			diag_p->max_repetitions=strtoul(argv[++i], NULL, 10);
+		else if ((!strcmp(argv[i], "-O1")) || (!strcmp(argv[i], "--peephole")))
+			ligne_p->options.lucarne=TRUE;
+		else if (!strcmp(argv[i], "--estimate"))
+			ligne_p->estimation=TRUE;
+		else if (!strcmp(argv[i], "--run"))
+			ligne_p->simulation=TRUE;
+		else if ((!strcmp(argv[i], "--run-limit")) && (i+1<argc))
+			ligne_p->limite_simulation=strtoul(argv[++i], NULL, 10);
+		else if ((!strcmp(argv[i], "--cfg")) && (i+1<argc))
+			ligne_p->graphe=argv[++i];
+		else if ((!strcmp(argv[i], "--cfg-json")) && (i+1<argc))
+			ligne_p->graphe_json=argv[++i];
+		else if (!strcmp(argv[i], "--schedule"))
+			ligne_p->options.ordonnancement=TRUE;
+		else if ((!strcmp(argv[i], "--cache")) && (i+1<argc))
+			ligne_p->options.cache_sorties=argv[++i];
+		else if (!strcmp(argv[i], "--profile"))
+			ligne_p->profilage=TRUE;
+		else if (!strcmp(argv[i], "--profile-json"))
+			ligne_p->profilage=ligne_p->profilage_json=TRUE;
+		else if ((!strcmp(argv[i], "--serve")) && (i+1<argc))
+			ligne_p->serveur=argv[++i];
+		else if (argv[i][0]=='-')
+			return FAILURE;
+		else
+			ligne_p->sources[ligne_p->nb_sources++]=argv[i];
+	}
+	return SUCCESS;
+}
+
+/**
+ * @param ligne_p pointeur sur la ligne de commande analysée
+ * @return TRUE si elle demande l'estimation, la simulation ou le graphe (--estimate, --run, --run-limit, --cfg,
+ * --cfg-json), que seul l'assemblage d'un unique source par as-mips lui-même produit : ni le lot ni le serveur ne les font
+ */
+int analyses_demandees(const struct LigneCommande_s *ligne_p)
+{
+	return (ligne_p->estimation) || (ligne_p->simulation) || (ligne_p->limite_simulation!=SIMULATION_LIMITE)
+			|| (ligne_p->graphe) || (ligne_p->graphe_json);
+}
+
+/**
+ * @param ligne_p pointeur sur la ligne de commande
+ * @return Rien
+ */
+void liberer_ligne_commande(struct LigneCommande_s *ligne_p)
+{
+	free(ligne_p->sources);
+	ligne_p->sources=NULL;
+	ligne_p->nb_sources=0;
+}
+
+/**
+ * @return pointeur sur l'assemblage créé, avec ses listes vides
+ * @brief Crée les listes d'un assemblage ; la table des étiquettes est créée par assembler_fichier
+ */
+struct Assemblage_s *creer_assemblage(void)
+{
+	struct Assemblage_s *assemblage_p=calloc(1, sizeof(*assemblage_p));
+
+	if (!assemblage_p) ERROR_MSG("Impossible de créer un assemblage");
+	assemblage_p->lexemes_p=creer_liste((fonctionDestructeur *)detruit_lexeme);
+	assemblage_p->text_p=creer_liste(detruit_instruction);
+	assemblage_p->data_p=creer_liste(detruit_donnee);
+	assemblage_p->bss_p=creer_liste(detruit_donnee);
+	return assemblage_p;
+}
+
+/**
+ * @param assemblage_p pointeur sur l'assemblage, éventuellement interrompu
+ * @return Rien
+ * @brief Libère ce qui a été construit par l'assemblage en gardant les listes, prêtes pour un nouvel assemblage
+ */
+void reinitialiser_assemblage(struct Assemblage_s *assemblage_p)
+{
+	if (assemblage_p->source_p) fclose(assemblage_p->source_p);
+	assemblage_p->source_p=NULL;
+	detruire_pretraitement(pretraitement_installer(NULL));
+	assemblage_p->listage_cache_p=detruire_sortie(assemblage_p->listage_cache_p);
+	assemblage_p->etiquettes_p=detruire_table(assemblage_p->etiquettes_p);
+	vider_liste(assemblage_p->text_p);
+	vider_liste(assemblage_p->data_p);
+	vider_liste(assemblage_p->bss_p);
+	vider_liste(assemblage_p->lexemes_p);
+	assemblage_p->nb_lignes=0;
+	assemblage_p->nb_etiquettes=0;
+	assemblage_p->nb_instructions=0;
+}
+
+/**
+ * @param assemblage_p pointeur sur l'assemblage, éventuellement interrompu
+ * @return NULL
+ * @brief Libère tout ce qui a été construit par l'assemblage
+ */
+struct Assemblage_s *detruire_assemblage(struct Assemblage_s *assemblage_p)
+{
+	if (assemblage_p) {
+		if (assemblage_p->source_p) fclose(assemblage_p->source_p);
+		detruire_pretraitement(pretraitement_installer(NULL));
+		detruire_sortie(assemblage_p->listage_cache_p);
+		detruire_table(assemblage_p->etiquettes_p);
+		detruire_liste(assemblage_p->text_p);
+		detruire_liste(assemblage_p->data_p);
+		detruire_liste(assemblage_p->bss_p);
+		detruire_liste(assemblage_p->lexemes_p);
+		free(assemblage_p);
+	}
+	return NULL;
+}
+
+/**
+ * @param assemblage_p pointeur sur un assemblage vide (creer_assemblage)
+ * @param source nom du fichier source
+ * @param fichier_objet nom du fichier objet ou de l'image à écrire, NULL pour ne rien écrire
+ * @param options_p pointeur sur les options d'assemblage
+ * @param dictionnaires_p pointeur sur les dictionnaires chargés
+ * @param listage_p sortie du listage, NULL pour ne pas en écrire
+ * @return SUCCESS si l'assemblage (et l'écriture du fichier objet) n'a rencontré aucune erreur, FAILURE sinon
+ * @brief Assemble un fichier source : analyses, codage, fichier objet puis listage
+ */
+int assembler_fichier(struct Assemblage_s *assemblage_p, char *source, const char *fichier_objet,
+		const struct OptionsAssemblage_s *options_p, const struct Dictionnaires_s *dictionnaires_p, struct Sortie_s *listage_p)
+{
+	FILE *fp=fopen(source, "r");
+
+	if (!fp) ERROR_MSG("Impossible d'ouvrir le fichier \"%s\". Abandon du traitement", source);
+	return assembler_flux(assemblage_p, fp, source, fichier_objet, options_p, dictionnaires_p, listage_p);
+}
+
+/**
+ * @param diag_p pointeur sur le collecteur
+ * @return nombre de diagnostics reçus par le collecteur, toutes gravités confondues
+ */
+unsigned int compter_diagnostics(const struct Diag_s *diag_p)
+{
+	return diag_p->nb_par_severite[0]+diag_p->nb_par_severite[1]+diag_p->nb_par_severite[2]+diag_p->nb_par_severite[3];
+}
+
+/**
+ * @param assemblage_p pointeur sur un assemblage vide (creer_assemblage ou reinitialiser_assemblage)
+ * @param fp source ouvert en lecture, confié à l'assemblage qui le ferme
+ * @param source nom du source, pour les diagnostics
+ * @param fichier_objet nom du fichier objet ou de l'image à écrire, NULL pour ne rien écrire
+ * @param options_p pointeur sur les options d'assemblage
+ * @param dictionnaires_p pointeur sur les dictionnaires chargés
+ * @param listage_p sortie du listage, NULL pour ne pas en écrire
+ * @return SUCCESS si l'assemblage (et l'écriture du fichier objet) n'a rencontré aucune erreur, FAILURE sinon
+ * @brief Assemble un source déjà ouvert : analyses, codage, fichier objet puis listage
+ *
+ * Les diagnostics du collecteur courant sont vidés avant les tables du listage, comme ils l'ont toujours été.
+ * Si l'assemblage est interrompu par une erreur fatale, le source est fermé par reinitialiser_assemblage ou
+ * detruire_assemblage.
+ */
+int assembler_flux(struct Assemblage_s *assemblage_p, FILE *fp, const char *source, const char *fichier_objet,
+		const struct OptionsAssemblage_s *options_p, const struct Dictionnaires_s *dictionnaires_p, struct Sortie_s *listage_p)
+{
+	struct Profil_s *profil_p=profil_courant();
+	struct ParametresImage_s parametres_image=options_p->image;
+	struct AnalyseSyntaxe_s analyse;
+	struct Sortie_s *listage_final_p=listage_p;
+	unsigned char clef[TAILLE_EMPREINTE];
+	unsigned int nb_diagnostics=0;
+	int resultat, ranger=FALSE, inclusions;
+
+	assemblage_p->source_p=fp;
+	if ((options_p->cache_sorties) && ((fichier_objet) || (listage_p))
+			&& (SUCCESS==calculer_clef_sorties(fp, fichier_objet, options_p, dictionnaires_p, listage_p, clef))) {
+		if (SUCCESS==reprendre_sorties(options_p->cache_sorties, clef, fichier_objet, listage_p)) {
+			PROFIL_COMPTER(CPT_SORTIES_CACHE);
+			fclose(assemblage_p->source_p);
+			assemblage_p->source_p=NULL;
+			if (listage_p) vider_sortie(listage_p);
+			return SUCCESS;
+		}
+
+		/* le listage est écrit en mémoire pour être rangé avec le fichier produit, puis recopié dans sa sortie */
+		ranger=TRUE;
+		nb_diagnostics=compter_diagnostics(diag_courant());
+		if (listage_p) {
+			listage_p=assemblage_p->listage_cache_p=creer_sortie(-1, 0);
+			listage_p->couleur=listage_final_p->couleur;
+		}
+	}
+	pretraitement_installer(creer_pretraitement(source, options_p->sans_inclusion));
+	if (options_p->pipeline) {
+		/* Le nombre d'étiquettes n'est pas connu à l'avance, la table s'agrandira au fur et à mesure */
+		assemblage_p->etiquettes_p=creer_table(0, clefEtiquette, detruit_etiquette);
+
+		/* effectue en parallèle les analyses lexicale et syntaxique et le codage des instructions */
+		debuter_analyse_syntaxe(&analyse, dictionnaires_p->instructions_p, dictionnaires_p->registres_p, assemblage_p->etiquettes_p,
+				assemblage_p->text_p, assemblage_p->data_p, assemblage_p->bss_p);
+		analyse.lucarne=options_p->lucarne;
+		resultat=assembler_en_pipeline(fp, source, assemblage_p->lexemes_p, &analyse,
+				&assemblage_p->nb_lignes, &assemblage_p->nb_etiquettes, &assemblage_p->nb_instructions);
+		if (FAILURE==terminer_pretraitement(pretraitement_courant())) resultat=FAILURE;
+		if (FAILURE==terminer_analyse_syntaxe(&analyse, TRUE)) resultat=FAILURE;
+		if (options_p->ordonnancement)
+			ordonnancer_text(assemblage_p->text_p, dictionnaires_p->registres_p, assemblage_p->etiquettes_p);
+		profil_debut(profil_p, ETAPE_RESOLUTION);
+		if (FAILURE==resoudre_liste_instructions(assemblage_p->text_p, assemblage_p->etiquettes_p)) resultat=FAILURE;
+		profil_fin(profil_p, ETAPE_RESOLUTION);
+	} else {
+		profil_debut(profil_p, ETAPE_LEXICALE);
+		lex_load_flux(fp, source, assemblage_p->lexemes_p, &assemblage_p->nb_lignes, &assemblage_p->nb_etiquettes, &assemblage_p->nb_instructions);
+		profil_fin(profil_p, ETAPE_LEXICALE);
+		resultat=terminer_pretraitement(pretraitement_courant());
+
+		/* Crée la table d'étiquettes pour pouvoir contenir toutes celles identifiées lors de l'analyse lexicale */
+		assemblage_p->etiquettes_p=creer_table(assemblage_p->nb_etiquettes, clefEtiquette, detruit_etiquette);
+
+		/* effectue l'analyse syntaxique puis génère le code des instructions */
+		profil_debut(profil_p, ETAPE_SYNTAXE);
+		debuter_analyse_syntaxe(&analyse, dictionnaires_p->instructions_p, dictionnaires_p->registres_p, assemblage_p->etiquettes_p,
+				assemblage_p->text_p, assemblage_p->data_p, assemblage_p->bss_p);
+		analyse.lucarne=options_p->lucarne;
+		analyser_lignes(&analyse, assemblage_p->lexemes_p->debut_liste_p);
+		if (FAILURE==terminer_analyse_syntaxe(&analyse, FALSE)) resultat=FAILURE;
+		if (options_p->ordonnancement)
+			ordonnancer_text(assemblage_p->text_p, dictionnaires_p->registres_p, assemblage_p->etiquettes_p);
+		profil_fin(profil_p, ETAPE_SYNTAXE);
+		if (FAILURE==generer_code(assemblage_p->text_p, dictionnaires_p->registres_p, assemblage_p->etiquettes_p)) resultat=FAILURE;
+	}
+	fclose(assemblage_p->source_p);
+	assemblage_p->source_p=NULL;
+	inclusions=(pretraitement_courant()->inclusions_p!=NULL);
+	detruire_pretraitement(pretraitement_installer(NULL));
+	DEBUG_MSG("Le fichier source comporte %u lignes, %u étiquettes et %u instructions",
+			assemblage_p->nb_lignes, assemblage_p->nb_etiquettes, assemblage_p->nb_instructions);
+
+	if (listage_p) {
+		profil_debut(profil_p, ETAPE_LISTAGE);
+		visualisation_liste_lexemes(listage_p, assemblage_p->lexemes_p);
+		profil_fin(profil_p, ETAPE_LISTAGE);
+	}
+
+	/* écrit le fichier objet si l'assemblage n'a pas rencontré d'erreur */
+	if (fichier_objet) {
+		profil_debut(profil_p, ETAPE_OBJET);
+		if (resultat==SUCCESS)
+			resultat=(parametres_image.format==SORTIE_ELF) ?
+				generer_objet_elf(fichier_objet, assemblage_p->text_p, assemblage_p->data_p, assemblage_p->bss_p,
+						assemblage_p->etiquettes_p, parametres_image.gros_boutiste) :
+				generer_image(fichier_objet, &parametres_image, assemblage_p->text_p, assemblage_p->data_p, assemblage_p->bss_p,
+						assemblage_p->etiquettes_p);
+		else
+			diag_signaler(NULL, DIAG_ERREUR, fichier_objet, 0, "objet", "fichier objet non écrit à cause des erreurs précédentes");
+		profil_fin(profil_p, ETAPE_OBJET);
+	}
+
+	/* écrit les diagnostics de l'assemblage avant les résultats */
+	vider_diag(diag_courant());
+
+	/* affiche les résultats de l'analyse syntaxique */
+	if (listage_p) {
+		profil_debut(profil_p, ETAPE_LISTAGE);
+		affiche_table_etiquette(listage_p, assemblage_p->etiquettes_p, "Table des étiquettes");
+		affiche_liste_donnee(listage_p, assemblage_p->data_p, assemblage_p->etiquettes_p, "Table des données de la section .data");
+		affiche_liste_donnee(listage_p, assemblage_p->bss_p, assemblage_p->etiquettes_p, "Table des données de la section .bss");
+		affiche_liste_instructions(listage_p, assemblage_p->text_p, assemblage_p->etiquettes_p, "Table des instructions de .text");
+		vider_sortie(listage_p);
+		profil_fin(profil_p, ETAPE_LISTAGE);
+	}
+
+	/* un assemblage réussi et sans diagnostic donnerait toujours les mêmes résultats : ils sont rangés, sauf si le
+	 * source inclut des fichiers, qui ne font pas partie de la clef */
+	if (ranger) {
+		if ((resultat==SUCCESS) && (!inclusions) && (compter_diagnostics(diag_courant())==nb_diagnostics))
+			ranger_sorties(options_p->cache_sorties, clef, fichier_objet, listage_p);
+		if (listage_p) {
+			sortie_ecrire(listage_final_p, listage_p->tampon, listage_p->taille);
+			vider_sortie(listage_final_p);
+			assemblage_p->listage_cache_p=detruire_sortie(assemblage_p->listage_cache_p);
+		}
+	}
+
+	/* les compteurs connus à la fin de l'assemblage */
+	profil_fixer(profil_p, CPT_LIGNES, assemblage_p->nb_lignes);
+	profil_fixer(profil_p, CPT_LEXEMES, assemblage_p->lexemes_p->nbElements);
+	profil_fixer(profil_p, CPT_ETIQUETTES, assemblage_p->etiquettes_p->nbElts);
+	profil_fixer(profil_p, CPT_INSTRUCTIONS, assemblage_p->text_p->nbElements);
+	profil_fixer(profil_p, CPT_DONNEES, assemblage_p->data_p->nbElements+assemblage_p->bss_p->nbElements);
+	return resultat;
+}
+
+/**
+ * @param source nom du fichier source
+ * @param format forme du fichier produit
+ * @return nom du fichier objet (à libérer par free) : le source dont l'extension est remplacée suivant le format
+ * @brief Donne le nom du fichier produit pour un source assemblé dans un lot (a.s -> a.o, a.hex...)
+ */
+char *nom_fichier_objet(const char *source, enum FormatSortie_e format)
+{
+	static const char *EXTENSIONS[]={".o", ".bin", ".hex", ".srec"};
+	const char *point_p=strrchr(source, '.');
+	const char *barre_p=strrchr(source, '/');
+	size_t longueur=((point_p) && ((!barre_p) || (point_p>barre_p))) ? (size_t)(point_p-source) : strlen(source);
+	char *nom=malloc(longueur+strlen(EXTENSIONS[format])+1);
+
+	if (!nom) ERROR_MSG("Impossible de créer le nom du fichier objet");
+	memcpy(nom, source, longueur);
+	strcpy(nom+longueur, EXTENSIONS[format]);
+	return nom;
+}
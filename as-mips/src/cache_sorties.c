@@ -0,0 +1,246 @@
+/**
+ * @file cache_sorties.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions du cache des résultats adressé par leur contenu (--cache)
+ *
+ * Une entrée est le fichier REPERTOIRE/<clef en hexadécimal> : l'entête CACHE_SORTIES_MAGIQUE, puis la
+ * longueur et le texte du listage, puis la longueur et le contenu du fichier produit (longueurs de 32 bits
+ * gros-boutistes). Une entrée illisible est ignorée : l'assemblage a lieu et la remplace.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include <global.h>
+#include <notify.h>
+#include <diag.h>
+#include <cache_sorties.h>
+
+static unsigned char empreinte_version[TAILLE_EMPREINTE];	/**< Empreinte de l'assembleur lui-même */
+static pthread_once_t version_calculee=PTHREAD_ONCE_INIT;
+
+/**
+ * @return Rien
+ * @brief Calcule une fois pour toutes l'empreinte de la version et de l'exécutable d'as-mips
+ *
+ * L'exécutable est pris en compte pour qu'un assembleur recompilé n'utilise pas les entrées d'un autre.
+ */
+void calculer_empreinte_version(void)
+{
+	struct Empreinte_s empreinte;
+
+	debuter_empreinte(&empreinte);
+	ajouter_empreinte(&empreinte, VERSION_AS_MIPS, strlen(VERSION_AS_MIPS)+1);
+	empreinte_fichier(&empreinte, "/proc/self/exe");
+	terminer_empreinte(&empreinte, empreinte_version);
+}
+
+/**
+ * @param fp source ouvert en lecture, au début ; il y est ramené
+ * @param fichier_objet nom du fichier à produire, NULL si aucun
+ * @param options_p pointeur sur les options d'assemblage
+ * @param dictionnaires_p pointeur sur les dictionnaires chargés
+ * @param listage_p sortie du listage, NULL s'il n'est pas demandé
+ * @param clef clef de l'entrée du cache
+ * @return SUCCESS si la clef a été calculée, FAILURE si le source ne peut pas être relu (tube...)
+ */
+int calculer_clef_sorties(FILE *fp, const char *fichier_objet, const struct OptionsAssemblage_s *options_p,
+		const struct Dictionnaires_s *dictionnaires_p, const struct Sortie_s *listage_p, unsigned char clef[TAILLE_EMPREINTE])
+{
+	struct Empreinte_s empreinte;
+	const struct ParametresImage_s *image_p=&options_p->image;
+	char tampon[1<<16];
+	size_t lus;
+	int i;
+
+	if (fseek(fp, 0, SEEK_SET)) return FAILURE;
+	pthread_once(&version_calculee, calculer_empreinte_version);
+
+	debuter_empreinte(&empreinte);
+	ajouter_empreinte(&empreinte, empreinte_version, TAILLE_EMPREINTE);
+	ajouter_empreinte(&empreinte, dictionnaires_p->empreinte, TAILLE_EMPREINTE);
+
+	/* options qui changent les résultats, champ par champ pour ne pas dépendre de l'alignement */
+	ajouter_entier_empreinte(&empreinte, fichier_objet ? 1+image_p->format : 0);
+	ajouter_entier_empreinte(&empreinte, image_p->gros_boutiste);
+	for (i=0; i<4; i++) {
+		ajouter_entier_empreinte(&empreinte, image_p->base_fixee[i]);
+		ajouter_entier_empreinte(&empreinte, image_p->base_fixee[i] ? image_p->adresses_base[i] : 0);
+	}
+	ajouter_entier_empreinte(&empreinte, image_p->remplissage);
+	ajouter_entier_empreinte(&empreinte, options_p->lucarne);
+	ajouter_entier_empreinte(&empreinte, options_p->ordonnancement);
+	ajouter_entier_empreinte(&empreinte, listage_p ? 1+listage_p->couleur : 0);
+	/* l'enregistrement S0 d'un fichier S-record contient son nom */
+	if ((fichier_objet) && (image_p->format==SORTIE_SREC)) ajouter_empreinte(&empreinte, fichier_objet, strlen(fichier_objet)+1);
+
+	while ((lus=fread(tampon, 1, sizeof(tampon), fp))) ajouter_empreinte(&empreinte, tampon, lus);
+	if ((ferror(fp)) || (fseek(fp, 0, SEEK_SET))) return FAILURE;
+	clearerr(fp);
+	terminer_empreinte(&empreinte, clef);
+	return SUCCESS;
+}
+
+/**
+ * @param repertoire répertoire du cache
+ * @param clef clef de l'entrée
+ * @return nom de l'entrée, à libérer par free
+ */
+char *nom_entree_sorties(const char *repertoire, const unsigned char clef[TAILLE_EMPREINTE])
+{
+	char *nom=malloc(strlen(repertoire)+2*TAILLE_EMPREINTE+16);
+
+	if (!nom) ERROR_MSG("Impossible de nommer une entrée du cache des résultats");
+	strcpy(nom, repertoire);
+	strcat(nom, "/");
+	empreinte_hex(clef, nom+strlen(nom));
+	return nom;
+}
+
+/**
+ * @param debut_p pointeur sur la lecture en cours, avancé après la partie lue
+ * @param fin_p fin des données
+ * @param taille_p taille de la partie
+ * @return début de la partie, NULL si l'entrée est tronquée
+ * @brief Lit une partie de l'entrée : sa longueur sur 32 bits puis son contenu
+ */
+const unsigned char *lire_partie_sorties(const unsigned char **debut_p, const unsigned char *fin_p, uint32_t *taille_p)
+{
+	const unsigned char *partie_p;
+
+	if (fin_p-*debut_p<4) return NULL;
+	*taille_p=((uint32_t)(*debut_p)[0]<<24) | ((uint32_t)(*debut_p)[1]<<16) | ((uint32_t)(*debut_p)[2]<<8) | (*debut_p)[3];
+	partie_p=*debut_p+4;
+	if ((uint32_t)(fin_p-partie_p)<*taille_p) return NULL;
+	*debut_p=partie_p+*taille_p;
+	return partie_p;
+}
+
+/**
+ * @param repertoire répertoire du cache
+ * @param clef clef de l'entrée
+ * @param fichier_objet fichier à produire, NULL si aucun
+ * @param listage_p sortie recevant le listage, NULL s'il n'est pas demandé
+ * @return SUCCESS si l'entrée existait et que les résultats ont été rendus, FAILURE s'il faut assembler
+ * @brief Rend les résultats rangés dans le cache sans assembler
+ */
+int reprendre_sorties(const char *repertoire, const unsigned char clef[TAILLE_EMPREINTE], const char *fichier_objet,
+		struct Sortie_s *listage_p)
+{
+	char *nom=nom_entree_sorties(repertoire, clef);
+	unsigned char *contenu=NULL;
+	const unsigned char *curseur_p, *listage, *objet;
+	size_t taille=0, capacite=0, lus;
+	uint32_t taille_listage, taille_objet;
+	int resultat=FAILURE;
+	FILE *fp=fopen(nom, "rb");
+
+	free(nom);
+	if (!fp) return FAILURE;
+	do {
+		if (taille==capacite) {
+			capacite=capacite ? 2*capacite : TAILLE_TAMPON_SORTIE;
+			if (!(contenu=realloc(contenu, capacite))) ERROR_MSG("Impossible de lire une entrée du cache des résultats");
+		}
+		lus=fread(contenu+taille, 1, capacite-taille, fp);
+		taille+=lus;
+	} while (lus);
+	fclose(fp);
+
+	curseur_p=contenu+strlen(CACHE_SORTIES_MAGIQUE);
+	if ((taille>=strlen(CACHE_SORTIES_MAGIQUE)) && (!memcmp(contenu, CACHE_SORTIES_MAGIQUE, strlen(CACHE_SORTIES_MAGIQUE)))
+			&& (listage=lire_partie_sorties(&curseur_p, contenu+taille, &taille_listage))
+			&& (objet=lire_partie_sorties(&curseur_p, contenu+taille, &taille_objet))
+			&& (curseur_p==contenu+taille)) {
+		resultat=SUCCESS;
+		if (fichier_objet) {
+			/* le fichier produit est écrit comme l'aurait fait l'assemblage */
+			if ((!(fp=fopen(fichier_objet, "wb"))) || (fwrite(objet, 1, taille_objet, fp)!=taille_objet)) resultat=FAILURE;
+			if ((fp) && (fclose(fp))) resultat=FAILURE;
+		}
+		if ((resultat==SUCCESS) && (listage_p)) sortie_ecrire(listage_p, listage, taille_listage);
+	}
+	free(contenu);
+	return resultat;
+}
+
+/**
+ * @param sortie_p sortie de l'entrée
+ * @param taille taille de la partie
+ * @return Rien
+ */
+void ecrire_taille_sorties(struct Sortie_s *sortie_p, uint32_t taille)
+{
+	unsigned char octets[4];
+
+	octets[0]=taille>>24;
+	octets[1]=taille>>16;
+	octets[2]=taille>>8;
+	octets[3]=taille;
+	sortie_ecrire(sortie_p, octets, sizeof(octets));
+}
+
+/**
+ * @param repertoire répertoire du cache, créé s'il n'existe pas
+ * @param clef clef de l'entrée
+ * @param fichier_objet fichier produit par l'assemblage, NULL si aucun
+ * @param listage_p sortie en mémoire contenant le listage, NULL s'il n'est pas demandé
+ * @return SUCCESS si l'entrée a été rangée, FAILURE sinon (un avertissement est signalé)
+ * @brief Range les résultats d'un assemblage réussi, dans un fichier temporaire renommé à la fin
+ */
+int ranger_sorties(const char *repertoire, const unsigned char clef[TAILLE_EMPREINTE], const char *fichier_objet,
+		const struct Sortie_s *listage_p)
+{
+	char *nom=nom_entree_sorties(repertoire, clef);
+	char *temporaire=malloc(strlen(nom)+8);
+	char tampon[1<<16];
+	struct Sortie_s *sortie_p;
+	struct stat etat;
+	size_t lus;
+	int descripteur, resultat=SUCCESS;
+	FILE *fp=NULL;
+
+	if (!temporaire) ERROR_MSG("Impossible de ranger une entrée du cache des résultats");
+	strcpy(temporaire, nom);
+	strcat(temporaire, ".XXXXXX");
+
+	if ((mkdir(repertoire, 0777)) && (errno!=EEXIST)) resultat=FAILURE;
+	if ((fichier_objet) && ((!(fp=fopen(fichier_objet, "rb"))) || (fstat(fileno(fp), &etat)) || (etat.st_size>0xFFFFFFFFL))) resultat=FAILURE;
+	if ((resultat==FAILURE) || ((descripteur=mkstemp(temporaire))<0) || (fchmod(descripteur, 0644))) {
+		diag_signaler(NULL, DIAG_AVERTISSEMENT, repertoire, 0, "cache-sorties", "impossible de ranger les résultats dans le cache (%s)", strerror(errno));
+		if (fp) fclose(fp);
+		free(temporaire);
+		free(nom);
+		return FAILURE;
+	}
+
+	sortie_p=creer_sortie(descripteur, 0);
+	sortie_chaine(sortie_p, CACHE_SORTIES_MAGIQUE);
+	ecrire_taille_sorties(sortie_p, listage_p ? listage_p->taille : 0);
+	if (listage_p) sortie_ecrire(sortie_p, listage_p->tampon, listage_p->taille);
+	ecrire_taille_sorties(sortie_p, fp ? etat.st_size : 0);
+	if (fp) {
+		while ((lus=fread(tampon, 1, sizeof(tampon), fp))) sortie_ecrire(sortie_p, tampon, lus);
+		if (ferror(fp)) resultat=FAILURE;
+		fclose(fp);
+	}
+	if (FAILURE==vider_sortie(sortie_p)) resultat=FAILURE;
+	sortie_p=detruire_sortie(sortie_p);
+	if (close(descripteur)) resultat=FAILURE;
+
+	/* une entrée de même clef déjà rangée par un autre assemblage est identique : elle est remplacée sans risque */
+	if ((resultat==FAILURE) || (rename(temporaire, nom))) {
+		diag_signaler(NULL, DIAG_AVERTISSEMENT, repertoire, 0, "cache-sorties", "impossible de ranger les résultats dans le cache (%s)", strerror(errno));
+		unlink(temporaire);
+		resultat=FAILURE;
+	}
+	free(temporaire);
+	free(nom);
+	return resultat;
+}
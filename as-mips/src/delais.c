@@ -0,0 +1,224 @@
+/**
+ * @file delais.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions de remplissage des délais de branchement
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <global.h>
+#include <notify.h>
+#include <memoire.h>
+#include <profil.h>
+#include <liste.h>
+#include <table.h>
+#include <dico.h>
+#include <lex.h>
+#include <syn.h>
+#include <gen.h>
+#include <relaxation.h>
+#include <dependances.h>
+#include <delais.h>
+
+/**
+ * @param a_p pointeur sur un décalage
+ * @param b_p pointeur sur un autre
+ * @return ordre des deux décalages, pour qsort
+ */
+int comparer_decalages(const void *a_p, const void *b_p)
+{
+	uint32_t a=*(const uint32_t *)a_p, b=*(const uint32_t *)b_p;
+
+	return (a>b)-(a<b);
+}
+
+/**
+ * @param table_etiquettes_p pointeur sur la table des étiquettes
+ * @param nb_p pointeur recevant le nombre de décalages
+ * @return décalages croissants des étiquettes de .text (à libérer), NULL s'il n'y en a pas
+ */
+uint32_t *decalages_etiquettes_text(struct Table_s *table_etiquettes_p, size_t *nb_p)
+{
+	struct Etiquette_s *etiquette_p;
+	uint32_t *decalages;
+	size_t i;
+
+	*nb_p=0;
+	if ((!table_etiquettes_p->nbElts) || (!(decalages=malloc(table_etiquettes_p->nbElts*sizeof(*decalages))))) return NULL;
+	for (i=0; i<table_etiquettes_p->nbEltsMax; i++)
+		if (((etiquette_p=table_etiquettes_p->table[i])) && (etiquette_p->section==S_TEXT))
+			decalages[(*nb_p)++]=etiquette_p->decalage;
+	qsort(decalages, *nb_p, sizeof(*decalages), comparer_decalages);
+	return decalages;
+}
+
+/**
+ * @param decalages décalages croissants des instructions après lesquelles une instruction est insérée (ou des
+ * instructions retirées)
+ * @param nb nombre de ces décalages
+ * @param decalage décalage avant insertion (ou retrait)
+ * @return nombre d'octets insérés (ou retirés) avant ce décalage
+ */
+uint32_t octets_avant(const uint32_t *decalages, size_t nb, uint32_t decalage)
+{
+	size_t debut=0, fin=nb, milieu;
+
+	while (debut<fin) {
+		milieu=debut+(fin-debut)/2;
+		if (decalages[milieu]<decalage) debut=milieu+1;
+		else fin=milieu;
+	}
+	return 4*(uint32_t)debut;
+}
+
+/**
+ * @param fenetre noeuds des instructions qui précèdent le branchement dans son bloc de base, la plus proche en dernier
+ * @param nb nombre de ces instructions
+ * @param branchement_p pointeur sur le branchement ou le saut
+ * @param table_def_registres_p pointeur sur la table "dico" des registres
+ * @return indice dans la fenêtre de l'instruction la plus proche qui peut être déplacée dans le délai, -1 si aucune
+ *
+ * L'instruction déplacée ne doit dépendre ni du branchement, ni des instructions qui la séparent du branchement.
+ */
+int chercher_instruction_delai(struct NoeudListe_s **fenetre, int nb, struct Instruction_s *branchement_p, struct Table_s *table_def_registres_p)
+{
+	struct EffetsInstruction_s effets_branchement, franchies, effets;
+	int j;
+
+	effets_instruction(branchement_p, table_def_registres_p, &effets_branchement);
+	if (effets_branchement.nature & EFFET_INCONNU) return -1;
+	memset(&franchies, 0, sizeof(franchies));
+	for (j=nb-1; j>=0; j--) {
+		effets_instruction(fenetre[j]->donnee_p, table_def_registres_p, &effets);
+		if (effets.nature & EFFET_INCONNU) return -1;
+		if ((effets_independants(&effets, &effets_branchement)) && (effets_independants(&effets, &franchies))) return j;
+		cumuler_effets(&franchies, &effets);
+	}
+	return -1;
+}
+
+/**
+ * @param premier_p noeud de l'instruction déplacée
+ * @param branchement_p noeud du branchement
+ * @return Rien
+ * @brief Déplace l'instruction dans le délai du branchement : les instructions de premier_p au branchement
+ * remontent d'un noeud, en gardant leurs décalages
+ */
+void deplacer_dans_delai(struct NoeudListe_s *premier_p, struct NoeudListe_s *branchement_p)
+{
+	struct NoeudListe_s *noeud_p;
+	void *deplacee_p=premier_p->donnee_p;
+	uint32_t decalage=((struct Instruction_s *)deplacee_p)->decalage;
+
+	for (noeud_p=premier_p; noeud_p!=branchement_p; noeud_p=noeud_p->suivant_p) {
+		noeud_p->donnee_p=noeud_p->suivant_p->donnee_p;
+		((struct Instruction_s *)noeud_p->donnee_p)->decalage=decalage;
+		decalage+=4;
+	}
+	branchement_p->donnee_p=deplacee_p;
+	((struct Instruction_s *)deplacee_p)->decalage=decalage;
+}
+
+/**
+ * @param analyse_p pointeur sur l'état de l'analyse syntaxique, toutes les lignes ayant été analysées
+ * @param recoder TRUE si les instructions ont déjà été codées : les NOP insérés le sont aussi
+ * @return SUCCESS si les NOP insérés ont pu être codés, FAILURE sinon
+ * @brief Remplit le délai de chaque branchement et saut écrit en mode reorder, puis décale les instructions,
+ * les étiquettes de .text et les pseudo-instructions à relaxer qui suivent les NOP insérés
+ *
+ * Un bloc de base commence à une étiquette ou après un délai ; ses instructions sont gardées dans une fenêtre
+ * de DELAIS_FENETRE instructions, vidée par une instruction qui ne peut pas être franchie (appel système,
+ * instruction inconnue, expansion à relaxer, instruction en mode noreorder). Un branchement étiqueté n'a pas
+ * de candidat : une instruction qui le précède ne serait pas exécutée par un saut vers l'étiquette.
+ */
+int remplir_delais(struct AnalyseSyntaxe_s *analyse_p, int recoder)
+{
+	struct Liste_s *liste_text_p=analyse_p->liste_text_p;
+	struct Relaxation_s *relaxation_p=analyse_p->relaxation_p;
+	struct NoeudListe_s *fenetre[DELAIS_FENETRE], *noeud_p;
+	struct DefinitionInstruction_s *nop_p=NULL;
+	struct Instruction_s *instruction_p, *remplissage_p;
+	struct Etiquette_s *etiquette_p;
+	uint32_t *etiquettes, *insertions=NULL;
+	size_t nb_etiquettes, e=0, nb_insertions=0, capacite_insertions=0, r=0, i;
+	unsigned int restant=0, nature;
+	uint32_t decalage;
+	char msg_err[STRLEN];
+	int nb=0, j, delai_fixe=FALSE, resultat=SUCCESS;
+
+	if ((!liste_text_p) || (!liste_text_p->debut_liste_p)) return SUCCESS;
+	etiquettes=decalages_etiquettes_text(analyse_p->table_etiquettes_p, &nb_etiquettes);
+	decalage=((struct Instruction_s *)liste_text_p->debut_liste_p->donnee_p)->decalage;
+
+	for (noeud_p=liste_text_p->debut_liste_p; noeud_p; noeud_p=noeud_p->suivant_p) {
+		instruction_p=noeud_p->donnee_p;
+		nature=nature_instruction(instruction_p->definition_p);
+
+		/* une étiquette commence un bloc ; les expansions à relaxer restent en place */
+		while ((e<nb_etiquettes) && (etiquettes[e]<instruction_p->decalage)) e++;
+		if ((e<nb_etiquettes) && (etiquettes[e]==instruction_p->decalage)) nb=0;
+		if ((!restant) && (relaxation_p) && (r<relaxation_p->nb_pseudos) && (noeud_p==relaxation_p->pseudos[r].premier_p))
+			restant=relaxation_p->pseudos[r++].nb_noeuds;
+
+		if (delai_fixe) {
+			/* délai écrit par le programmeur en mode noreorder */
+			delai_fixe=FALSE;
+			nb=0;
+		} else if (!(nature & EFFET_DELAI)) {
+			if ((restant) || (instruction_p->ordre_fixe) || (nature & EFFET_BARRIERE))
+				nb=0;
+			else {
+				if (nb==DELAIS_FENETRE) memmove(fenetre, fenetre+1, (--nb)*sizeof(*fenetre));
+				fenetre[nb++]=noeud_p;
+			}
+		} else if (instruction_p->ordre_fixe) {
+			delai_fixe=TRUE;
+			nb=0;
+		} else {
+			if ((j=chercher_instruction_delai(fenetre, nb, instruction_p, analyse_p->table_def_registres_p))>=0) {
+				deplacer_dans_delai(fenetre[j], noeud_p);
+				PROFIL_COMPTER(CPT_DELAIS_REMPLIS);
+			} else {
+				if ((!nop_p) && (!(nop_p=donnee_table(analyse_p->table_def_instructions_p, "NOP"))))
+					ERROR_MSG("L'instruction NOP n'est pas dans le dictionnaire");
+				remplissage_p=calloc(1, sizeof(*remplissage_p));
+				MEMOIRE_ALLOUER(MEM_INSTRUCTIONS, sizeof(*remplissage_p));
+				remplissage_p->definition_p=nop_p;
+				remplissage_p->ligne=instruction_p->ligne;
+				if ((recoder) && (FAILURE==encoder_instruction(remplissage_p, analyse_p->table_def_registres_p, msg_err)))
+					resultat=FAILURE;
+				noeud_p=inserer_apres_liste(liste_text_p, noeud_p, remplissage_p);
+
+				if (nb_insertions==capacite_insertions) {
+					capacite_insertions=capacite_insertions ? 2*capacite_insertions : 64;
+					if (!(insertions=realloc(insertions, capacite_insertions*sizeof(*insertions))))
+						ERROR_MSG("Impossible d'agrandir la liste des délais remplis par un NOP");
+				}
+				insertions[nb_insertions++]=instruction_p->decalage;
+				PROFIL_COMPTER(CPT_DELAIS_NOP);
+			}
+			nb=0;
+		}
+		if (restant) restant--;
+	}
+	free(etiquettes);
+	if (!nb_insertions) return resultat;
+
+	/* chaque NOP inséré décale de 4 octets tout ce qui suit son branchement */
+	for (noeud_p=liste_text_p->debut_liste_p; noeud_p; noeud_p=noeud_p->suivant_p) {
+		((struct Instruction_s *)noeud_p->donnee_p)->decalage=decalage;
+		decalage+=4;
+	}
+	for (i=0; i<analyse_p->table_etiquettes_p->nbEltsMax; i++)
+		if (((etiquette_p=analyse_p->table_etiquettes_p->table[i])) && (etiquette_p->section==S_TEXT))
+			etiquette_p->decalage+=octets_avant(insertions, nb_insertions, etiquette_p->decalage);
+	if (relaxation_p)
+		for (r=0; r<relaxation_p->nb_pseudos; r++)
+			relaxation_p->pseudos[r].decalage+=octets_avant(insertions, nb_insertions, relaxation_p->pseudos[r].decalage);
+	analyse_p->decalage_text+=4*(uint32_t)nb_insertions;
+	free(insertions);
+	return resultat;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file dependances.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions de calcul des effets des instructions
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <string.h>
+
+#include <global.h>
+#include <notify.h>
+#include <table.h>
+#include <dico.h>
+#include <lex.h>
+#include <syn.h>
+#include <dependances.h>
+
+#define HILO	(BIT_REGISTRE(REGISTRE_HI) | BIT_REGISTRE(REGISTRE_LO))
+#define ARGS	(BIT_REGISTRE(2) | BIT_REGISTRE(4) | BIT_REGISTRE(5) | BIT_REGISTRE(6) | BIT_REGISTRE(7))
+
+/* effets et latences des instructions réelles du dictionnaire, par ordre alphabétique ; les latences sont celles
+ * d'un R3000 : chargement lu par l'instruction suivante, MULT et DIV en 12 et 35 cycles avant MFHI/MFLO */
+static const struct DescriptionEffets_s DESCRIPTIONS_EFFETS[]={
+	{"ADD",      'd', 0,                         0,                         0,                  1},
+	{"ADDI",     't', 0,                         0,                         0,                  1},
+	{"ADDIU",    't', 0,                         0,                         0,                  1},
+	{"AND",      'd', 0,                         0,                         0,                  1},
+	{"BEQ",      0,   0,                         0,                         EFFET_BRANCHEMENT,  1},
+	{"BGTZ",     0,   0,                         0,                         EFFET_BRANCHEMENT,  1},
+	{"BLEZ",     0,   0,                         0,                         EFFET_BRANCHEMENT,  1},
+	{"BNE",      0,   0,                         0,                         EFFET_BRANCHEMENT,  1},
+	{"DIV",      0,   0,                         HILO,                      0,                  35},
+	{"J",        0,   0,                         0,                         EFFET_SAUT,         1},
+	{"JAL",      0,   0,                         BIT_REGISTRE(REGISTRE_RA), EFFET_SAUT,         1},
+	{"JR",       0,   0,                         0,                         EFFET_SAUT,         1},
+	{"LUI",      't', 0,                         0,                         0,                  1},
+	{"LW",       't', 0,                         0,                         EFFET_CHARGEMENT,   2},
+	{"MFHI",     'd', BIT_REGISTRE(REGISTRE_HI), 0,                         0,                  1},
+	{"MFLO",     'd', BIT_REGISTRE(REGISTRE_LO), 0,                         0,                  1},
+	{"MOVE",     'd', 0,                         0,                         0,                  1},
+	{"MULT",     0,   0,                         HILO,                      0,                  12},
+	{"NOP",      0,   0,                         0,                         0,                  1},
+	{"OR",       'd', 0,                         0,                         0,                  1},
+	{"ORI",      't', 0,                         0,                         0,                  1},
+	{"ROTR",     'd', 0,                         0,                         0,                  1},
+	{"SLL",      'd', 0,                         0,                         0,                  1},
+	{"SLT",      'd', 0,                         0,                         0,                  1},
+	{"SRL",      'd', 0,                         0,                         0,                  1},
+	{"SUB",      'd', 0,                         0,                         0,                  1},
+	{"SW",       0,   0,                         0,                         EFFET_RANGEMENT,    1},
+	{"SYSTCALL", 0,   ARGS,                      BIT_REGISTRE(2),           EFFET_SYSTEME,      1},
+	{"XOR",      'd', 0,                         0,                         0,                  1}
+};
+
+/**
+ * @param nom nom d'une instruction réelle
+ * @return description de ses effets, NULL si elle n'est pas dans la table
+ */
+const struct DescriptionEffets_s *description_effets(const char *nom)
+{
+	size_t debut=0, fin=sizeof(DESCRIPTIONS_EFFETS)/sizeof(*DESCRIPTIONS_EFFETS), milieu;
+	int ordre;
+
+	while (debut<fin) {
+		milieu=debut+(fin-debut)/2;
+		if (!(ordre=strcmp(nom, DESCRIPTIONS_EFFETS[milieu].nom))) return DESCRIPTIONS_EFFETS+milieu;
+		if (ordre<0) fin=milieu;
+		else debut=milieu+1;
+	}
+	return NULL;
+}
+
+/**
+ * @param definition_p pointeur sur la définition d'une instruction réelle
+ * @return nature de l'instruction (EFFET_xxx) ; hors table, une instruction qui a un champ 'o' ou 'a' est un
+ * branchement ou un saut
+ */
+unsigned int nature_instruction(const struct DefinitionInstruction_s *definition_p)
+{
+	if (definition_p->effets_p) return definition_p->effets_p->nature;
+	if (strchr(definition_p->champs, 'o')) return EFFET_INCONNU | EFFET_BRANCHEMENT;
+	if (strchr(definition_p->champs, 'a')) return EFFET_INCONNU | EFFET_SAUT;
+	return EFFET_INCONNU;
+}
+
+/**
+ * @param instruction_p pointeur sur l'instruction
+ * @param table_def_registres_p pointeur sur la table "dico" des registres
+ * @param effets_p pointeur recevant les effets
+ * @return Rien
+ * @brief Calcule les registres lus et écrits par une instruction : les registres de ses opérandes, sauf celui
+ * qui est écrit, sont lus
+ */
+void effets_instruction(const struct Instruction_s *instruction_p, struct Table_s *table_def_registres_p, struct EffetsInstruction_s *effets_p)
+{
+	const struct DefinitionInstruction_s *def_p=instruction_p->definition_p;
+	const struct DescriptionEffets_s *description_p=def_p->effets_p;
+	struct DefinitionRegistre_s *registre_p;
+	struct Lexeme_s *lexeme_p;
+	unsigned int i;
+
+	effets_p->nature=nature_instruction(def_p);
+	effets_p->lus=description_p ? description_p->lus : 0;
+	effets_p->ecrits=description_p ? description_p->ecrits : 0;
+	effets_p->latence=description_p ? description_p->latence : 1;
+	for (i=0; i<def_p->nb_ops; i++) {
+		lexeme_p=instruction_p->operandes[i];
+		if ((!lexeme_p) || (lexeme_p->nature!=L_REGISTRE)) continue;
+		if (!(registre_p=donnee_table(table_def_registres_p, lexeme_p->data))) {
+			effets_p->nature|=EFFET_INCONNU;
+			continue;
+		}
+		if ((description_p) && (def_p->champs[i]==description_p->champ_ecrit))
+			effets_p->ecrits|=BIT_REGISTRE(registre_p->valeur);
+		else
+			effets_p->lus|=BIT_REGISTRE(registre_p->valeur);
+	}
+	effets_p->lus&=~BIT_REGISTRE(0);
+	effets_p->ecrits&=~BIT_REGISTRE(0);
+}
+
+/**
+ * @param cumul_p pointeur sur les effets cumulés d'une suite d'instructions
+ * @param effets_p pointeur sur les effets d'une instruction à y ajouter
+ * @return Rien
+ */
+void cumuler_effets(struct EffetsInstruction_s *cumul_p, const struct EffetsInstruction_s *effets_p)
+{
+	cumul_p->lus|=effets_p->lus;
+	cumul_p->ecrits|=effets_p->ecrits;
+	cumul_p->nature|=effets_p->nature;
+}
+
+/**
+ * @param a_p pointeur sur les effets d'une instruction (ou d'une suite)
+ * @param b_p pointeur sur les effets d'une autre
+ * @return TRUE si leur ordre d'exécution peut être échangé : aucune n'écrit un registre que l'autre lit ou écrit,
+ * et elles n'accèdent pas toutes les deux à la mémoire si l'une y écrit
+ */
+int effets_independants(const struct EffetsInstruction_s *a_p, const struct EffetsInstruction_s *b_p)
+{
+	if ((a_p->ecrits & (b_p->lus | b_p->ecrits)) || (b_p->ecrits & a_p->lus)) return FALSE;
+	if ((a_p->nature & EFFET_MEMOIRE) && (b_p->nature & EFFET_MEMOIRE) && ((a_p->nature | b_p->nature) & EFFET_RANGEMENT)) return FALSE;
+	return TRUE;
+}
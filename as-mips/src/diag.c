@@ -0,0 +1,532 @@
+/**
+ * @file diag.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions du collecteur de diagnostics
+ *
+ * Chaque diagnostic est enregistré (fichier, ligne, gravité, code, message) dans le collecteur. Les diagnostics
+ * en attente sont mis en forme d'un coup puis écrits par un seul appel système, soit quand le paquet est plein,
+ * soit quand on vide explicitement le collecteur. Au delà de max_repetitions occurrences d'un même diagnostic
+ * (même code et même message), les suivants sont seulement comptés.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <global.h>
+#include <notify.h>
+#include <table.h>
+#include <sortie.h>
+#include <diag.h>
+
+const char *NOMS_SEVERITES[] = {"info", "avertissement", "erreur", "fatal"};
+const int COULEURS_SEVERITES[] = {COLOR_GREEN, COLOR_MAGENTA, COLOR_RED, COLOR_RED};
+
+/**
+ * @struct Repetition_s
+ * @brief Nombre d'occurrences d'un diagnostic identifié par son code et son message
+ */
+struct Repetition_s {
+	char *clef;				/**< code et message séparés par un caractère de contrôle */
+	unsigned long nb;		/**< nombre d'occurrences reçues */
+};
+
+static struct Diag_s *diag_global_p=NULL;			/* collecteur par défaut, sur la sortie d'erreur */
+static __thread struct Diag_s *diag_thread_p=NULL;	/* collecteur installé pour le thread courant */
+static pthread_mutex_t diag_global_verrou=PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @param donnee_p pointeur sur une structure de répétition
+ * @return la clef de la répétition (fonction clef pour la table générique)
+ */
+char *clef_repetition(void *donnee_p)
+{
+	return donnee_p ? ((struct Repetition_s *)donnee_p)->clef : NULL;
+}
+
+/**
+ * @param donnee_p pointeur sur une structure de répétition
+ * @return Rien
+ * @brief Détruit la répétition (fonction de destruction pour la table générique)
+ */
+void destruction_repetition(void *donnee_p)
+{
+	if (donnee_p) {
+		free(((struct Repetition_s *)donnee_p)->clef);
+		free(donnee_p);
+	}
+}
+
+/**
+ * @param format forme d'écriture des diagnostics
+ * @param descripteur descripteur de fichier sur lequel écrire, -1 pour seulement conserver les diagnostics
+ * @return pointeur sur le collecteur créé
+ * @brief Crée un collecteur de diagnostics
+ */
+struct Diag_s *creer_diag(enum FormatDiag_e format, int descripteur)
+{
+	struct Diag_s *diag_p=calloc(1, sizeof(*diag_p));
+	pthread_mutex_t *verrou_p=malloc(sizeof(*verrou_p));
+
+	if ((!diag_p) || (!verrou_p)) {
+		fprintf(stderr, "Impossible de créer le collecteur de diagnostics\n");
+		exit(EXIT_FAILURE);
+	}
+	pthread_mutex_init(verrou_p, NULL);
+
+	diag_p->format=format;
+	diag_p->descripteur=descripteur;
+	diag_p->max_repetitions=DIAG_MAX_REPETITIONS;
+	diag_p->verrou_p=verrou_p;
+	diag_p->repetitions_p=creer_table(DIAG_TAILLE_PAQUET, clef_repetition, destruction_repetition);
+	return diag_p;
+}
+
+/**
+ * @param diag_p pointeur sur le collecteur à détruire
+ * @return NULL
+ * @brief Ecrit les diagnostics encore en attente puis détruit le collecteur
+ */
+struct Diag_s *detruire_diag(struct Diag_s *diag_p)
+{
+	if (diag_p) {
+		vider_diag(diag_p);
+		if (diag_p==diag_global_p) diag_global_p=NULL;
+		if (diag_p==diag_thread_p) diag_thread_p=NULL;
+
+		detruire_table(diag_p->repetitions_p);
+		pthread_mutex_destroy((pthread_mutex_t *)diag_p->verrou_p);
+		free(diag_p->verrou_p);
+		free(diag_p->attente);
+		free(diag_p->texte);
+		free(diag_p);
+	}
+	return NULL;
+}
+
+/**
+ * @param diag_p pointeur sur le collecteur
+ * @return Rien
+ * @brief Oublie les diagnostics en attente et remet les compteurs à zéro pour réutiliser le collecteur
+ */
+void reinitialiser_diag(struct Diag_s *diag_p)
+{
+	if (diag_p) {
+		pthread_mutex_lock((pthread_mutex_t *)diag_p->verrou_p);
+		diag_p->nb_attente=0;
+		diag_p->taille_texte=0;
+		memset(diag_p->nb_par_severite, 0, sizeof(diag_p->nb_par_severite));
+		diag_p->nb_supprimes=0;
+		detruire_table(diag_p->repetitions_p);
+		diag_p->repetitions_p=creer_table(DIAG_TAILLE_PAQUET, clef_repetition, destruction_repetition);
+		pthread_mutex_unlock((pthread_mutex_t *)diag_p->verrou_p);
+	}
+}
+
+/**
+ * @param tampon_pp pointeur sur le tampon de sortie (réalloué si besoin)
+ * @param taille_p pointeur sur la taille utilisée du tampon
+ * @param capacite_p pointeur sur la capacité du tampon
+ * @param chaine chaine à ajouter
+ * @param longueur longueur de la chaine
+ * @return Rien
+ * @brief Ajoute une chaine à la fin d'un tampon qui s'agrandit au besoin
+ */
+void ajouter_tampon(char **tampon_pp, size_t *taille_p, size_t *capacite_p, const char *chaine, size_t longueur)
+{
+	if (*taille_p+longueur+1 > *capacite_p) {
+		*capacite_p=2*(*taille_p+longueur+1);
+		if (!(*tampon_pp=realloc(*tampon_pp, *capacite_p))) {
+			fprintf(stderr, "Impossible d'agrandir le tampon des diagnostics\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	memcpy(*tampon_pp+*taille_p, chaine, longueur);
+	*taille_p+=longueur;
+	(*tampon_pp)[*taille_p]='\0';
+}
+
+/**
+ * @param tampon_pp pointeur sur le tampon de sortie
+ * @param taille_p pointeur sur la taille utilisée du tampon
+ * @param capacite_p pointeur sur la capacité du tampon
+ * @param chaine chaine à ajouter en tant que chaine JSON (avec les guillemets)
+ * @return Rien
+ * @brief Ajoute une chaine JSON en échappant les caractères qui doivent l'être
+ */
+void ajouter_tampon_json(char **tampon_pp, size_t *taille_p, size_t *capacite_p, const char *chaine)
+{
+	char echappement[8];
+	const char *debut_p=chaine;
+
+	ajouter_tampon(tampon_pp, taille_p, capacite_p, "\"", 1);
+	for (; chaine && *chaine; chaine++)
+		if ((*chaine=='"') || (*chaine=='\\') || ((unsigned char)*chaine<0x20)) {
+			ajouter_tampon(tampon_pp, taille_p, capacite_p, debut_p, chaine-debut_p);
+			if ((*chaine=='"') || (*chaine=='\\'))
+				sprintf(echappement, "\\%c", *chaine);
+			else
+				sprintf(echappement, "\\u%04x", (unsigned char)*chaine);
+			ajouter_tampon(tampon_pp, taille_p, capacite_p, echappement, strlen(echappement));
+			debut_p=chaine+1;
+		}
+	if (chaine) ajouter_tampon(tampon_pp, taille_p, capacite_p, debut_p, chaine-debut_p);
+	ajouter_tampon(tampon_pp, taille_p, capacite_p, "\"", 1);
+}
+
+/**
+ * @param descripteur descripteur de fichier
+ * @param tampon données à écrire
+ * @param taille nombre d'octets à écrire
+ * @return Rien
+ * @brief Ecrit tout le tampon, même si l'appel système n'en écrit qu'une partie à la fois
+ */
+void ecrire_tout(int descripteur, const char *tampon, size_t taille)
+{
+	ssize_t nb;
+
+	while (taille) {
+		nb=write(descripteur, tampon, taille);
+		if (nb<0) {
+			if (errno==EINTR) continue;
+			return;
+		}
+		tampon+=nb;
+		taille-=nb;
+	}
+}
+
+/**
+ * @param diag_p pointeur sur le collecteur
+ * @return TRUE si les diagnostics du collecteur sont écrits quelque part (descripteur ou sortie)
+ */
+int diag_ecrit(struct Diag_s *diag_p)
+{
+	return (diag_p->sortie_p) || (diag_p->descripteur>=0);
+}
+
+/**
+ * @param diag_p pointeur sur le collecteur
+ * @param tampon diagnostics mis en forme
+ * @param taille nombre d'octets à écrire
+ * @return Rien
+ * @brief Ecrit les diagnostics mis en forme sur la sortie du collecteur, ou à défaut sur son descripteur
+ */
+void transmettre_diag(struct Diag_s *diag_p, const char *tampon, size_t taille)
+{
+	if (diag_p->sortie_p)
+		sortie_ecrire(diag_p->sortie_p, tampon, taille);
+	else
+		ecrire_tout(diag_p->descripteur, tampon, taille);
+}
+
+/**
+ * @param diag_p pointeur sur le collecteur
+ * @param tampon_pp pointeur sur le tampon de sortie
+ * @param taille_p pointeur sur la taille utilisée du tampon
+ * @param capacite_p pointeur sur la capacité du tampon
+ * @param diagnostic_p diagnostic à mettre en forme
+ * @return Rien
+ * @brief Met en forme un diagnostic suivant le format du collecteur
+ */
+void formater_diagnostic(struct Diag_s *diag_p, char **tampon_pp, size_t *taille_p, size_t *capacite_p, struct Diagnostic_s *diagnostic_p)
+{
+	char entete[STRLEN];
+	const char *message=diag_p->texte+diagnostic_p->message;
+
+	if (diag_p->format==DIAG_JSON) {
+		ajouter_tampon(tampon_pp, taille_p, capacite_p, "{\"fichier\":", 11);
+		ajouter_tampon_json(tampon_pp, taille_p, capacite_p, diagnostic_p->fichier ? diagnostic_p->fichier : "");
+		sprintf(entete, ",\"ligne\":%u,\"severite\":\"%s\",\"code\":", diagnostic_p->ligne, NOMS_SEVERITES[diagnostic_p->severite]);
+		ajouter_tampon(tampon_pp, taille_p, capacite_p, entete, strlen(entete));
+		ajouter_tampon_json(tampon_pp, taille_p, capacite_p, diagnostic_p->code);
+		ajouter_tampon(tampon_pp, taille_p, capacite_p, ",\"message\":", 11);
+		ajouter_tampon_json(tampon_pp, taille_p, capacite_p, message);
+		ajouter_tampon(tampon_pp, taille_p, capacite_p, "}\n", 2);
+		return;
+	}
+
+	if (diag_p->format==DIAG_COULEUR)
+		snprintf(entete, sizeof(entete), "%c[%dm%s:%u:%c[%dm %c[%d;%dm%s:%c[%dm ",
+				0x1B, STYLE_BOLD, diagnostic_p->fichier ? diagnostic_p->fichier : "", diagnostic_p->ligne, 0x1B, STYLE_OFF,
+				0x1B, STYLE_BOLD, COULEURS_SEVERITES[diagnostic_p->severite], NOMS_SEVERITES[diagnostic_p->severite], 0x1B, STYLE_OFF);
+	else
+		snprintf(entete, sizeof(entete), "%s:%u: %s: ",
+				diagnostic_p->fichier ? diagnostic_p->fichier : "", diagnostic_p->ligne, NOMS_SEVERITES[diagnostic_p->severite]);
+	ajouter_tampon(tampon_pp, taille_p, capacite_p, entete, strlen(entete));
+	ajouter_tampon(tampon_pp, taille_p, capacite_p, message, strlen(message));
+	ajouter_tampon(tampon_pp, taille_p, capacite_p, " [", 2);
+	ajouter_tampon(tampon_pp, taille_p, capacite_p, diagnostic_p->code, strlen(diagnostic_p->code));
+	ajouter_tampon(tampon_pp, taille_p, capacite_p, "]\n", 2);
+}
+
+/**
+ * @param diag_p pointeur sur le collecteur, verrou déjà pris
+ * @return Rien
+ * @brief Ecrit en un seul appel système tous les diagnostics en attente
+ */
+void vider_diag_verrouille(struct Diag_s *diag_p)
+{
+	char *tampon=NULL;
+	size_t taille=0;
+	size_t capacite=0;
+	size_t i;
+
+	if ((!diag_ecrit(diag_p)) || (!diag_p->nb_attente)) return;
+
+	for (i=0; i<diag_p->nb_attente; i++)
+		formater_diagnostic(diag_p, &tampon, &taille, &capacite, diag_p->attente+i);
+	transmettre_diag(diag_p, tampon, taille);
+	free(tampon);
+
+	diag_p->nb_attente=0;
+	diag_p->taille_texte=0;
+}
+
+/**
+ * @param diag_p pointeur sur le collecteur
+ * @return Rien
+ * @brief Ecrit tous les diagnostics en attente
+ *
+ * Si des diagnostics trop répétés ont été écartés, un diagnostic de synthèse est écrit en plus.
+ */
+void vider_diag(struct Diag_s *diag_p)
+{
+	struct Diagnostic_s synthese;
+	char message[STRLEN];
+	char *tampon=NULL;
+	size_t taille=0;
+	size_t capacite=0;
+
+	if (!diag_p) return;
+	pthread_mutex_lock((pthread_mutex_t *)diag_p->verrou_p);
+	vider_diag_verrouille(diag_p);
+
+	if ((diag_ecrit(diag_p)) && (diag_p->nb_supprimes)) {
+		sprintf(message, "%lu diagnostics répétés plus de %u fois n'ont pas été écrits", diag_p->nb_supprimes, diag_p->max_repetitions);
+		ajouter_tampon(&diag_p->texte, &diag_p->taille_texte, &diag_p->capacite_texte, message, strlen(message));
+		synthese.fichier=diag_p->fichier_source;
+		synthese.ligne=0;
+		synthese.severite=DIAG_INFO;
+		synthese.code="repetitions";
+		synthese.message=0;
+		formater_diagnostic(diag_p, &tampon, &taille, &capacite, &synthese);
+		transmettre_diag(diag_p, tampon, taille);
+		free(tampon);
+		diag_p->taille_texte=0;
+		diag_p->nb_supprimes=0;
+	}
+	pthread_mutex_unlock((pthread_mutex_t *)diag_p->verrou_p);
+}
+
+/**
+ * @param diag_p pointeur sur le collecteur, verrou déjà pris
+ * @param code identifiant court du diagnostic
+ * @param message texte du diagnostic
+ * @return TRUE si le diagnostic doit être conservé, FALSE s'il a déjà été reçu trop souvent
+ * @brief Compte les occurrences d'un diagnostic
+ */
+int compter_repetition(struct Diag_s *diag_p, const char *code, const char *message)
+{
+	struct Repetition_s *repetition_p;
+	char *clef=malloc(strlen(code)+strlen(message)+2);
+
+	if (!clef) {
+		fprintf(stderr, "Impossible de créer la clef d'un diagnostic\n");
+		exit(EXIT_FAILURE);
+	}
+	sprintf(clef, "%s\037%s", code, message);
+
+	if ((repetition_p=donnee_table(diag_p->repetitions_p, clef)))
+		free(clef);
+	else {
+		if (!(repetition_p=calloc(1, sizeof(*repetition_p)))) {
+			fprintf(stderr, "Impossible de compter un diagnostic\n");
+			exit(EXIT_FAILURE);
+		}
+		repetition_p->clef=clef;
+		ajouter_table(diag_p->repetitions_p, repetition_p);
+	}
+
+	if ((diag_p->max_repetitions) && (++repetition_p->nb > diag_p->max_repetitions)) {
+		diag_p->nb_supprimes++;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * @param diag_p pointeur sur le collecteur
+ * @param severite gravité du diagnostic
+ * @param fichier fichier concerné, NULL pour le fichier source par défaut du collecteur
+ * @param ligne ligne concernée
+ * @param code identifiant court du diagnostic (chaine constante)
+ * @param format format du message à la façon de printf
+ * @param args arguments du message
+ * @return Rien
+ * @brief Enregistre un diagnostic dans le collecteur
+ */
+void diag_enregistrer(struct Diag_s *diag_p, enum Severite_e severite, const char *fichier, unsigned int ligne,
+		const char *code, const char *format, va_list args)
+{
+	char message[4*STRLEN];
+	struct Diagnostic_s *diagnostic_p;
+
+	vsnprintf(message, sizeof(message), format, args);
+
+	pthread_mutex_lock((pthread_mutex_t *)diag_p->verrou_p);
+	diag_p->nb_par_severite[severite]++;
+
+	if ((severite==DIAG_FATALE) || (compter_repetition(diag_p, code, message))) {
+		if (diag_p->nb_attente==diag_p->capacite_attente) {
+			diag_p->capacite_attente=diag_p->capacite_attente ? 2*diag_p->capacite_attente : DIAG_TAILLE_PAQUET;
+			if (!(diag_p->attente=realloc(diag_p->attente, diag_p->capacite_attente*sizeof(*diag_p->attente)))) {
+				fprintf(stderr, "Impossible d'agrandir la liste des diagnostics\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+		diagnostic_p=diag_p->attente+diag_p->nb_attente++;
+		diagnostic_p->fichier=fichier ? fichier : diag_p->fichier_source;
+		diagnostic_p->ligne=ligne;
+		diagnostic_p->severite=severite;
+		diagnostic_p->code=code;
+		diagnostic_p->message=diag_p->taille_texte;
+		ajouter_tampon(&diag_p->texte, &diag_p->taille_texte, &diag_p->capacite_texte, message, strlen(message)+1);
+
+		if ((diag_ecrit(diag_p)) && (diag_p->nb_attente>=DIAG_TAILLE_PAQUET))
+			vider_diag_verrouille(diag_p);
+	}
+	pthread_mutex_unlock((pthread_mutex_t *)diag_p->verrou_p);
+}
+
+/**
+ * @param diag_p pointeur sur le collecteur, NULL pour le collecteur courant
+ * @param severite gravité du diagnostic
+ * @param fichier fichier concerné, NULL pour le fichier source par défaut du collecteur
+ * @param ligne ligne concernée
+ * @param code identifiant court du diagnostic (chaine constante)
+ * @param format format du message à la façon de printf
+ * @return Rien
+ * @brief Signale un diagnostic portant sur le source assemblé
+ */
+void diag_signaler(struct Diag_s *diag_p, enum Severite_e severite, const char *fichier, unsigned int ligne,
+		const char *code, const char *format, ...)
+{
+	va_list args;
+
+	va_start(args, format);
+	diag_enregistrer(diag_p ? diag_p : diag_courant(), severite, fichier, ligne, code, format, args);
+	va_end(args);
+}
+
+/**
+ * @param severite gravité du diagnostic
+ * @param fichier fichier source C à l'origine du diagnostic
+ * @param fonction fonction C à l'origine du diagnostic, qui sert de code
+ * @param ligne ligne du fichier source C
+ * @param format format du message à la façon de printf
+ * @return Rien
+ * @brief Signale un diagnostic interne de l'assembleur (utilisé par WARNING_MSG)
+ */
+void diag_interne(enum Severite_e severite, const char *fichier, const char *fonction, unsigned int ligne,
+		const char *format, ...)
+{
+	va_list args;
+
+	va_start(args, format);
+	diag_enregistrer(diag_courant(), severite, fichier, ligne, fonction, format, args);
+	va_end(args);
+}
+
+/**
+ * @param fichier fichier source C à l'origine du diagnostic
+ * @param fonction fonction C à l'origine du diagnostic, qui sert de code
+ * @param ligne ligne du fichier source C
+ * @param format format du message à la façon de printf
+ * @return Ne revient pas
+ * @brief Signale une erreur fatale puis abandonne le traitement (utilisé par ERROR_MSG)
+ *
+ * Les diagnostics en attente sont écrits, puis la fonction fatale du collecteur est appelée. Sans fonction
+ * fatale, ou si elle revient, le programme se termine.
+ */
+void diag_interne_fatal(const char *fichier, const char *fonction, unsigned int ligne,
+		const char *format, ...)
+{
+	struct Diag_s *diag_p=diag_courant();
+	va_list args;
+
+	va_start(args, format);
+	diag_enregistrer(diag_p, DIAG_FATALE, fichier, ligne, fonction, format, args);
+	va_end(args);
+
+	vider_diag(diag_p);
+	if (diag_p->fn_fatale_p)
+		diag_p->fn_fatale_p(diag_p->contexte_fatal_p);
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * @return Rien
+ * @brief Ecrit les diagnostics du collecteur par défaut en fin de programme
+ */
+void vider_diag_global(void)
+{
+	vider_diag(diag_global_p);
+}
+
+/**
+ * @return pointeur sur le collecteur courant
+ * @brief Renvoie le collecteur installé pour le thread courant, ou à défaut le collecteur par défaut
+ *
+ * Le collecteur par défaut écrit sur la sortie d'erreur, en couleur si c'est un terminal. Il est créé au premier
+ * besoin (y compris s'il a été détruit entre temps) et vidé en fin de programme.
+ */
+struct Diag_s *diag_courant(void)
+{
+	static int vidage_enregistre=FALSE;
+	struct Diag_s *diag_p;
+
+	if (diag_thread_p) return diag_thread_p;
+	if ((diag_p=__atomic_load_n(&diag_global_p, __ATOMIC_ACQUIRE))) return diag_p;
+
+	pthread_mutex_lock(&diag_global_verrou);
+	if (!(diag_p=diag_global_p)) {
+		diag_p=creer_diag(isatty(STDERR_FILENO) ? DIAG_COULEUR : DIAG_TEXTE, STDERR_FILENO);
+		__atomic_store_n(&diag_global_p, diag_p, __ATOMIC_RELEASE);
+		if (!vidage_enregistre) vidage_enregistre=(0==atexit(vider_diag_global));
+	}
+	pthread_mutex_unlock(&diag_global_verrou);
+	return diag_p;
+}
+
+/**
+ * @param diag_p pointeur sur le collecteur à installer, NULL pour revenir au collecteur par défaut
+ * @return pointeur sur le collecteur précédemment installé pour ce thread
+ * @brief Installe le collecteur utilisé par le thread courant (WARNING_MSG, ERROR_MSG, diag_signaler)
+ */
+struct Diag_s *diag_installer(struct Diag_s *diag_p)
+{
+	struct Diag_s *precedent_p=diag_thread_p;
+	diag_thread_p=diag_p;
+	return precedent_p;
+}
+
+/**
+ * @param nom nom du format ("texte", "couleur" ou "json")
+ * @param format_p pointeur recevant le format
+ * @return SUCCESS si le nom est reconnu, FAILURE sinon
+ * @brief Convertit un nom de format de diagnostic
+ */
+int diag_format(const char *nom, enum FormatDiag_e *format_p)
+{
+	if (!strcmp(nom, "texte")) *format_p=DIAG_TEXTE;
+	else if (!strcmp(nom, "couleur")) *format_p=DIAG_COULEUR;
+	else if (!strcmp(nom, "json")) *format_p=DIAG_JSON;
+	else return FAILURE;
+	return SUCCESS;
+}
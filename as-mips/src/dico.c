@@ -5,6 +5,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <inttypes.h>
 
 #include <global.h>
@@ -12,6 +13,9 @@
 #include <str_utils.h>
 #include <table.h>
 #include <dico.h>
+#include <memoire.h>
+#include <pseudo.h>
+#include <dependances.h>
 
 const char TYPE_OPS[]= {'R', 'N', 'B'}; /* lettres associés à enum Operandes_e à la définition des type syntaxiques des instructions */
 
@@ -35,6 +39,9 @@ char *clef_def_instruction(void *donnee_p)
 void destruction_def_instruction(void *donnee_p)
 {
 	if (donnee_p) {
+		detruire_expansions_pseudo(((struct DefinitionInstruction_s *)donnee_p)->expansions_p);
+		MEMOIRE_LIBERER(MEM_DICTIONNAIRES, strlen(((struct DefinitionInstruction_s *)donnee_p)->nom)+1);
+		MEMOIRE_LIBERER(MEM_DICTIONNAIRES, sizeof(struct DefinitionInstruction_s));
 		free(((struct DefinitionInstruction_s *)donnee_p)->nom);
 		free(donnee_p);
 	}
@@ -60,6 +67,8 @@ char *clef_def_registre(void *donnee_p)
 void destruction_def_registre(void *donnee_p)
 {
 	if (donnee_p) {
+		MEMOIRE_LIBERER(MEM_DICTIONNAIRES, strlen(((struct DefinitionRegistre_s *)donnee_p)->nom)+1);
+		MEMOIRE_LIBERER(MEM_DICTIONNAIRES, sizeof(struct DefinitionRegistre_s));
 		free(((struct DefinitionRegistre_s *)donnee_p)->nom);
 		free(donnee_p);
 	}
@@ -67,12 +76,12 @@ void destruction_def_registre(void *donnee_p)
 
 /**
  * @param table_definition_pp Pointeur sur un pointeur de table de hachage générique
- * @param nom_fichier chaine contenant le nom du fichier à charger
+ * @param f_p dictionnaire ouvert en lecture (fichier, texte en mémoire...), qui n'est pas fermé
  * @return SUCCESS si la table de definition des instructions a pu être chargée correctement
- * @brief Fonction de chargement de la définition des instructions
+ * @brief Fonction de chargement de la définition des instructions, suivies des éventuelles pseudo-instructions
  *
  */
-int charge_def_instruction(struct Table_s **table_definition_pp, char *nom_fichier)
+int charge_def_instruction_flux(struct Table_s **table_definition_pp, FILE *f_p)
 {
 	char *nom_instruction=calloc(STRLEN, sizeof(char));
 	char car_nature;
@@ -82,21 +91,27 @@ int charge_def_instruction(struct Table_s **table_definition_pp, char *nom_fichi
 
 	struct DefinitionInstruction_s *def_instruction_p=NULL;
 
-	FILE* f_p=fopen(nom_fichier,"r"); /* Ouverture du dictionnaire d'instruction */
-	if (!f_p) ERROR_MSG("Impossible d'ouvrir le fichier");
-
 	if (1!=fscanf(f_p,"%d",&nb_mots)) ERROR_MSG("Nombre d'instructions du dictionnaire introuvable"); /* Lecture de la première ligne du dictionnaire */
 	*table_definition_pp=creer_table(nb_mots, clef_def_instruction, destruction_def_instruction);
 
-	while (f_p && (i < nb_mots)) { /* Tant que l'on a pas lu l'enemble du dictionnaire */
+	while (i < nb_mots) { /* Tant que l'on a pas lu l'enemble du dictionnaire */
 
 		if (1 != fscanf(f_p,"%s", nom_instruction)) ERROR_MSG("La ligne du dictionnaire ne comprenait pas le nom de l'instruction en cours");
 		if (1 != fscanf(f_p,"%d", &nb_operandes)) ERROR_MSG("La ligne du dictionnaire ne comprenait pas le nombre d'arguments de l'instruction en cours");
 		if (1 != fscanf(f_p,"%c", &car_nature)) ERROR_MSG("Pas de caractère de type syntaxique pour %s", nom_instruction);
 
 		def_instruction_p=malloc(sizeof(*def_instruction_p));
+		if (1 != fscanf(f_p,"%" SCNx32, &def_instruction_p->motif)) ERROR_MSG("Pas de code machine pour %s", nom_instruction);
+		if (1 != fscanf(f_p,"%3s", def_instruction_p->champs)) ERROR_MSG("Pas de placement des opérandes pour %s", nom_instruction);
+		if ((def_instruction_p->champs[0]!='-') && (strlen(def_instruction_p->champs)!=(size_t)nb_operandes))
+			ERROR_MSG("Le placement des opérandes de %s ne correspond pas à son nombre d'opérandes", nom_instruction);
+
 		def_instruction_p->nom=strdup(nom_instruction);
+		MEMOIRE_ALLOUER(MEM_DICTIONNAIRES, sizeof(*def_instruction_p));
+		MEMOIRE_ALLOUER(MEM_DICTIONNAIRES, strlen(nom_instruction)+1);
 		def_instruction_p->nb_ops=nb_operandes;
+		def_instruction_p->expansions_p=NULL;
+		def_instruction_p->effets_p=description_effets(nom_instruction);
 
 		if (car_nature==TYPE_OPS[I_OP_R])
 			def_instruction_p->type_ops=I_OP_R;
@@ -110,20 +125,37 @@ int charge_def_instruction(struct Table_s **table_definition_pp, char *nom_fichi
 		ajouter_table(*table_definition_pp, def_instruction_p);
 		i++;
 	}
-	fclose(f_p);
 
 	free(nom_instruction);
-	return SUCCESS;
+	return charge_def_pseudo_flux(*table_definition_pp, f_p);
 }
 
 /**
  * @param table_definition_pp Pointeur sur un pointeur de table de hachage générique
  * @param nom_fichier chaine contenant le nom du fichier à charger
+ * @return SUCCESS si la table de definition des instructions a pu être chargée correctement
+ * @brief Fonction de chargement du fichier de définition des instructions
+ *
+ */
+int charge_def_instruction(struct Table_s **table_definition_pp, char *nom_fichier)
+{
+	int resultat;
+	FILE* f_p=fopen(nom_fichier,"r"); /* Ouverture du dictionnaire d'instruction */
+	if (!f_p) ERROR_MSG("Impossible d'ouvrir le fichier");
+
+	resultat=charge_def_instruction_flux(table_definition_pp, f_p);
+	fclose(f_p);
+	return resultat;
+}
+
+/**
+ * @param table_definition_pp Pointeur sur un pointeur de table de hachage générique
+ * @param f_p dictionnaire ouvert en lecture (fichier, texte en mémoire...), qui n'est pas fermé
  * @return SUCCESS si la table de definition des registres a pu être chargée correctement
  * @brief Fonction de chargement de la définition des registres
  *
  */
-int charge_def_registre(struct Table_s **table_definition_pp, char *nom_fichier)
+int charge_def_registre_flux(struct Table_s **table_definition_pp, FILE *f_p)
 {
 	char *nom_reg=calloc(STRLEN, sizeof(char));
 	int valeur=0;
@@ -132,27 +164,43 @@ int charge_def_registre(struct Table_s **table_definition_pp, char *nom_fichier)
 
 	struct DefinitionRegistre_s *def_registre_p=NULL;
 
-	FILE* f_p=fopen(nom_fichier,"r"); /* Ouverture du dictionnaire d'instruction */
-	if (!f_p) ERROR_MSG("Impossible d'ouvrir le fichier");
-
 	if (1!=fscanf(f_p,"%d",&nb_mots)) ERROR_MSG("Nombre d'instructions du dictionnaire introuvable"); /* Lecture de la première ligne du dictionnaire */
 	*table_definition_pp=creer_table(nb_mots, clef_def_registre, destruction_def_registre);
 
-	while (f_p && (i < nb_mots)) { /* Tant que l'on a pas lu l'enemble du dictionnaire */
+	while (i < nb_mots) { /* Tant que l'on a pas lu l'enemble du dictionnaire */
 
 		if (1 != fscanf(f_p,"%s", nom_reg)) ERROR_MSG("La ligne du dictionnaire ne comprenait pas le nom du registre en cours");
 		if (1 != fscanf(f_p,"%d", &valeur)) ERROR_MSG("La ligne du dictionnaire ne comprenait pas la valeur du registre en cours");
 
 		def_registre_p=malloc(sizeof(*def_registre_p));
 		def_registre_p->nom=strdup(nom_reg);
+		MEMOIRE_ALLOUER(MEM_DICTIONNAIRES, sizeof(*def_registre_p));
+		MEMOIRE_ALLOUER(MEM_DICTIONNAIRES, strlen(nom_reg)+1);
 		def_registre_p->valeur=valeur;
 		ajouter_table(*table_definition_pp, def_registre_p);
 		i++;
 	}
-	fclose(f_p);
 
 	free(nom_reg);
 	return SUCCESS;
 }
 
+/**
+ * @param table_definition_pp Pointeur sur un pointeur de table de hachage générique
+ * @param nom_fichier chaine contenant le nom du fichier à charger
+ * @return SUCCESS si la table de definition des registres a pu être chargée correctement
+ * @brief Fonction de chargement du fichier de définition des registres
+ *
+ */
+int charge_def_registre(struct Table_s **table_definition_pp, char *nom_fichier)
+{
+	int resultat;
+	FILE* f_p=fopen(nom_fichier,"r"); /* Ouverture du dictionnaire de registres */
+	if (!f_p) ERROR_MSG("Impossible d'ouvrir le fichier");
+
+	resultat=charge_def_registre_flux(table_definition_pp, f_p);
+	fclose(f_p);
+	return resultat;
+}
+
 
@@ -0,0 +1,172 @@
+/**
+ * @file empreinte.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions du calcul d'empreinte SHA-256 (FIPS 180-4)
+ *
+ * Les empreintes servent de clef au cache des résultats : une empreinte cryptographique rend les collisions
+ * négligeables, contrairement aux fonctions de hachage des tables.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <global.h>
+#include <empreinte.h>
+
+static const uint32_t K[64]={
+	0x428a2f98u, 0x71374491u, 0xb5c0fbcfu, 0xe9b5dba5u, 0x3956c25bu, 0x59f111f1u, 0x923f82a4u, 0xab1c5ed5u,
+	0xd807aa98u, 0x12835b01u, 0x243185beu, 0x550c7dc3u, 0x72be5d74u, 0x80deb1feu, 0x9bdc06a7u, 0xc19bf174u,
+	0xe49b69c1u, 0xefbe4786u, 0x0fc19dc6u, 0x240ca1ccu, 0x2de92c6fu, 0x4a7484aau, 0x5cb0a9dcu, 0x76f988dau,
+	0x983e5152u, 0xa831c66du, 0xb00327c8u, 0xbf597fc7u, 0xc6e00bf3u, 0xd5a79147u, 0x06ca6351u, 0x14292967u,
+	0x27b70a85u, 0x2e1b2138u, 0x4d2c6dfcu, 0x53380d13u, 0x650a7354u, 0x766a0abbu, 0x81c2c92eu, 0x92722c85u,
+	0xa2bfe8a1u, 0xa81a664bu, 0xc24b8b70u, 0xc76c51a3u, 0xd192e819u, 0xd6990624u, 0xf40e3585u, 0x106aa070u,
+	0x19a4c116u, 0x1e376c08u, 0x2748774cu, 0x34b0bcb5u, 0x391c0cb3u, 0x4ed8aa4au, 0x5b9cca4fu, 0x682e6ff3u,
+	0x748f82eeu, 0x78a5636fu, 0x84c87814u, 0x8cc70208u, 0x90befffau, 0xa4506cebu, 0xbef9a3f7u, 0xc67178f2u
+};
+
+#define ROTD(x, n)	(((x)>>(n)) | ((x)<<(32-(n))))		/**< Rotation à droite sur 32 bits */
+
+/**
+ * @param empreinte_p pointeur sur le calcul en cours
+ * @param bloc_p bloc de 64 octets
+ * @return Rien
+ * @brief Fait entrer un bloc complet dans l'état
+ */
+void traiter_bloc_empreinte(struct Empreinte_s *empreinte_p, const unsigned char *bloc_p)
+{
+	uint32_t w[64], a, b, c, d, e, f, g, h, t1, t2;
+	int i;
+
+	for (i=0; i<16; i++)
+		w[i]=((uint32_t)bloc_p[4*i]<<24) | ((uint32_t)bloc_p[4*i+1]<<16) | ((uint32_t)bloc_p[4*i+2]<<8) | bloc_p[4*i+3];
+	for (i=16; i<64; i++)
+		w[i]=(ROTD(w[i-2], 17)^ROTD(w[i-2], 19)^(w[i-2]>>10)) + w[i-7] + (ROTD(w[i-15], 7)^ROTD(w[i-15], 18)^(w[i-15]>>3)) + w[i-16];
+
+	a=empreinte_p->etat[0]; b=empreinte_p->etat[1]; c=empreinte_p->etat[2]; d=empreinte_p->etat[3];
+	e=empreinte_p->etat[4]; f=empreinte_p->etat[5]; g=empreinte_p->etat[6]; h=empreinte_p->etat[7];
+	for (i=0; i<64; i++) {
+		t1=h + (ROTD(e, 6)^ROTD(e, 11)^ROTD(e, 25)) + ((e&f)^(~e&g)) + K[i] + w[i];
+		t2=(ROTD(a, 2)^ROTD(a, 13)^ROTD(a, 22)) + ((a&b)^(a&c)^(b&c));
+		h=g; g=f; f=e; e=d+t1;
+		d=c; c=b; b=a; a=t1+t2;
+	}
+	empreinte_p->etat[0]+=a; empreinte_p->etat[1]+=b; empreinte_p->etat[2]+=c; empreinte_p->etat[3]+=d;
+	empreinte_p->etat[4]+=e; empreinte_p->etat[5]+=f; empreinte_p->etat[6]+=g; empreinte_p->etat[7]+=h;
+}
+
+/**
+ * @param empreinte_p pointeur sur le calcul à commencer
+ * @return Rien
+ */
+void debuter_empreinte(struct Empreinte_s *empreinte_p)
+{
+	static const uint32_t ETAT_INITIAL[8]={
+		0x6a09e667u, 0xbb67ae85u, 0x3c6ef372u, 0xa54ff53au, 0x510e527fu, 0x9b05688cu, 0x1f83d9abu, 0x5be0cd19u
+	};
+
+	memcpy(empreinte_p->etat, ETAT_INITIAL, sizeof(ETAT_INITIAL));
+	empreinte_p->nb_octets=0;
+}
+
+/**
+ * @param empreinte_p pointeur sur le calcul en cours
+ * @param donnees_p données à ajouter
+ * @param nb nombre d'octets des données
+ * @return Rien
+ */
+void ajouter_empreinte(struct Empreinte_s *empreinte_p, const void *donnees_p, size_t nb)
+{
+	const unsigned char *octets_p=donnees_p;
+	size_t remplis=empreinte_p->nb_octets%64;
+	size_t morceau;
+
+	empreinte_p->nb_octets+=nb;
+	if (remplis) {
+		morceau=(nb<64-remplis) ? nb : 64-remplis;
+		memcpy(empreinte_p->bloc+remplis, octets_p, morceau);
+		octets_p+=morceau;
+		nb-=morceau;
+		if (remplis+morceau<64) return;
+		traiter_bloc_empreinte(empreinte_p, empreinte_p->bloc);
+	}
+	for (; nb>=64; octets_p+=64, nb-=64) traiter_bloc_empreinte(empreinte_p, octets_p);
+	memcpy(empreinte_p->bloc, octets_p, nb);
+}
+
+/**
+ * @param empreinte_p pointeur sur le calcul en cours
+ * @param valeur entier ajouté en gros-boutiste, indépendamment de la machine
+ * @return Rien
+ */
+void ajouter_entier_empreinte(struct Empreinte_s *empreinte_p, uint32_t valeur)
+{
+	unsigned char octets[4];
+
+	octets[0]=valeur>>24;
+	octets[1]=valeur>>16;
+	octets[2]=valeur>>8;
+	octets[3]=valeur;
+	ajouter_empreinte(empreinte_p, octets, sizeof(octets));
+}
+
+/**
+ * @param empreinte_p pointeur sur le calcul en cours, à recommencer par debuter_empreinte pour être réutilisé
+ * @param resultat empreinte des données ajoutées
+ * @return Rien
+ */
+void terminer_empreinte(struct Empreinte_s *empreinte_p, unsigned char resultat[TAILLE_EMPREINTE])
+{
+	uint64_t nb_bits=empreinte_p->nb_octets*8;
+	unsigned char fin[72];
+	size_t nb_fin=(empreinte_p->nb_octets%64<56) ? 56-empreinte_p->nb_octets%64 : 120-empreinte_p->nb_octets%64;
+	int i;
+
+	/* bourrage : un bit à 1, des zéros puis la longueur en bits sur 64 bits gros-boutiste */
+	memset(fin, 0, sizeof(fin));
+	fin[0]=0x80;
+	for (i=0; i<8; i++) fin[nb_fin+i]=(unsigned char)(nb_bits>>(56-8*i));
+	ajouter_empreinte(empreinte_p, fin, nb_fin+8);
+
+	for (i=0; i<8; i++) {
+		resultat[4*i]=empreinte_p->etat[i]>>24;
+		resultat[4*i+1]=empreinte_p->etat[i]>>16;
+		resultat[4*i+2]=empreinte_p->etat[i]>>8;
+		resultat[4*i+3]=empreinte_p->etat[i];
+	}
+}
+
+/**
+ * @param empreinte_p pointeur sur le calcul en cours
+ * @param fichier fichier dont le contenu est ajouté
+ * @return SUCCESS si le fichier a été lu en entier, FAILURE sinon
+ */
+int empreinte_fichier(struct Empreinte_s *empreinte_p, const char *fichier)
+{
+	unsigned char tampon[1<<16];
+	size_t lus;
+	int resultat;
+	FILE *fp=fopen(fichier, "rb");
+
+	if (!fp) return FAILURE;
+	while ((lus=fread(tampon, 1, sizeof(tampon), fp))) ajouter_empreinte(empreinte_p, tampon, lus);
+	resultat=ferror(fp) ? FAILURE : SUCCESS;
+	fclose(fp);
+	return resultat;
+}
+
+/**
+ * @param empreinte empreinte à écrire
+ * @param hex texte hexadécimal en minuscules de l'empreinte
+ * @return Rien
+ */
+void empreinte_hex(const unsigned char empreinte[TAILLE_EMPREINTE], char hex[2*TAILLE_EMPREINTE+1])
+{
+	static const char CHIFFRES[]="0123456789abcdef";
+	int i;
+
+	for (i=0; i<TAILLE_EMPREINTE; i++) {
+		hex[2*i]=CHIFFRES[empreinte[i]>>4];
+		hex[2*i+1]=CHIFFRES[empreinte[i]&0xf];
+	}
+	hex[2*TAILLE_EMPREINTE]='\0';
+}
@@ -0,0 +1,366 @@
+/**
+ * @file estimation.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions d'estimation statique des cycles de .text
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <global.h>
+#include <notify.h>
+#include <liste.h>
+#include <table.h>
+#include <dico.h>
+#include <lex.h>
+#include <syn.h>
+#include <sortie.h>
+#include <dependances.h>
+#include <estimation.h>
+
+#define VISEE_BRANCHEMENT	0x1		/* étiquette visée par un branchement conditionnel */
+#define VISEE_APPEL			0x2		/* étiquette visée par JAL */
+
+static const char *NOMS_SOURCES_ATTENTE[NB_SOURCES_ATTENTE]={
+	"chargement", "mult/div", "branchement"
+};
+
+/**
+ * @param a_p pointeur sur un pointeur d'étiquette
+ * @param b_p pointeur sur un autre
+ * @return ordre des deux étiquettes par décalage puis par nom, pour qsort
+ */
+int comparer_etiquettes_decalage(const void *a_p, const void *b_p)
+{
+	const struct Etiquette_s *a=*(struct Etiquette_s * const *)a_p, *b=*(struct Etiquette_s * const *)b_p;
+
+	if (a->decalage!=b->decalage) return (a->decalage>b->decalage)-(a->decalage<b->decalage);
+	return strcmp(a->lexeme_p->data, b->lexeme_p->data);
+}
+
+/**
+ * @param table_etiquettes_p pointeur sur la table des étiquettes
+ * @param nb_p pointeur recevant le nombre d'étiquettes
+ * @return étiquettes de .text par décalage croissant (tableau à libérer), NULL s'il n'y en a pas
+ */
+struct Etiquette_s **etiquettes_text_triees(struct Table_s *table_etiquettes_p, size_t *nb_p)
+{
+	struct Etiquette_s **etiquettes, *etiquette_p;
+	size_t i;
+
+	*nb_p=0;
+	if ((!table_etiquettes_p->nbElts) || (!(etiquettes=malloc(table_etiquettes_p->nbElts*sizeof(*etiquettes))))) return NULL;
+	for (i=0; i<table_etiquettes_p->nbEltsMax; i++)
+		if (((etiquette_p=table_etiquettes_p->table[i])) && (etiquette_p->section==S_TEXT))
+			etiquettes[(*nb_p)++]=etiquette_p;
+	qsort(etiquettes, *nb_p, sizeof(*etiquettes), comparer_etiquettes_decalage);
+	return etiquettes;
+}
+
+/**
+ * @param liste_text_p pointeur sur la liste des instructions de .text
+ * @param table_etiquettes_p pointeur sur la table des étiquettes
+ * @param etiquettes étiquettes de .text par décalage croissant
+ * @param nb nombre de ces étiquettes
+ * @return pour chaque étiquette, VISEE_BRANCHEMENT si un branchement conditionnel la vise, VISEE_APPEL si un JAL
+ * la vise (tableau à libérer)
+ */
+int *etiquettes_visees(struct Liste_s *liste_text_p, struct Table_s *table_etiquettes_p, struct Etiquette_s **etiquettes, size_t nb)
+{
+	struct NoeudListe_s *noeud_p;
+	struct Instruction_s *instruction_p;
+	struct Lexeme_s *cible_p;
+	struct Etiquette_s *etiquette_p;
+	const struct DescriptionEffets_s *description_p;
+	size_t debut, fin, milieu;
+	int *visees=calloc(nb+1, sizeof(*visees)), marque;
+
+	if (!visees) ERROR_MSG("Impossible de créer les marques des étiquettes visées");
+	for (noeud_p=liste_text_p->debut_liste_p; noeud_p; noeud_p=noeud_p->suivant_p) {
+		instruction_p=noeud_p->donnee_p;
+		description_p=instruction_p->definition_p->effets_p;
+		if (nature_instruction(instruction_p->definition_p) & EFFET_BRANCHEMENT) marque=VISEE_BRANCHEMENT;
+		else if ((description_p) && (description_p->nature & EFFET_SAUT) && (description_p->ecrits & BIT_REGISTRE(REGISTRE_RA))) marque=VISEE_APPEL;
+		else continue;
+		if (!instruction_p->definition_p->nb_ops) continue;
+		cible_p=instruction_p->operandes[instruction_p->definition_p->nb_ops-1];
+		if ((!cible_p) || (cible_p->nature!=L_SYMBOLE) || (!(etiquette_p=donnee_table(table_etiquettes_p, cible_p->data)))) continue;
+		for (debut=0, fin=nb; debut<fin; ) {
+			milieu=debut+(fin-debut)/2;
+			if (etiquettes[milieu]->decalage<etiquette_p->decalage) debut=milieu+1;
+			else fin=milieu;
+		}
+		for ( ; (debut<nb) && (etiquettes[debut]->decalage==etiquette_p->decalage); debut++)
+			if (etiquettes[debut]==etiquette_p) visees[debut]|=marque;
+	}
+	return visees;
+}
+
+/**
+ * @param estimation_p pointeur sur l'estimation en cours
+ * @param decalage décalage de la première instruction du bloc
+ * @return pointeur sur le nouveau bloc, valable jusqu'au bloc suivant
+ */
+struct BlocEstime_s *nouveau_bloc_estime(struct Estimation_s *estimation_p, uint32_t decalage)
+{
+	struct BlocEstime_s *bloc_p;
+
+	if (estimation_p->nb_blocs==estimation_p->capacite_blocs) {
+		estimation_p->capacite_blocs=estimation_p->capacite_blocs ? 2*estimation_p->capacite_blocs : 64;
+		if (!(estimation_p->blocs=realloc(estimation_p->blocs, estimation_p->capacite_blocs*sizeof(*estimation_p->blocs))))
+			ERROR_MSG("Impossible d'agrandir les blocs de l'estimation");
+	}
+	bloc_p=estimation_p->blocs+estimation_p->nb_blocs++;
+	memset(bloc_p, 0, sizeof(*bloc_p));
+	bloc_p->decalage=decalage;
+	bloc_p->premiere_attente=estimation_p->nb_attentes;
+	return bloc_p;
+}
+
+/**
+ * @param estimation_p pointeur sur l'estimation en cours
+ * @param bloc_p pointeur sur le bloc de l'instruction qui attend
+ * @param ligne ligne source de l'instruction
+ * @param source cause de l'attente
+ * @param cycles nombre de cycles d'attente
+ * @return Rien
+ */
+void noter_attente_estimee(struct Estimation_s *estimation_p, struct BlocEstime_s *bloc_p, unsigned int ligne,
+		enum SourceAttente_e source, unsigned long cycles)
+{
+	struct AttenteEstimee_s *attente_p;
+
+	if (estimation_p->nb_attentes==estimation_p->capacite_attentes) {
+		estimation_p->capacite_attentes=estimation_p->capacite_attentes ? 2*estimation_p->capacite_attentes : 64;
+		if (!(estimation_p->attentes=realloc(estimation_p->attentes, estimation_p->capacite_attentes*sizeof(*estimation_p->attentes))))
+			ERROR_MSG("Impossible d'agrandir les attentes de l'estimation");
+	}
+	attente_p=estimation_p->attentes+estimation_p->nb_attentes++;
+	attente_p->ligne=ligne;
+	attente_p->source=source;
+	attente_p->cycles=cycles;
+	bloc_p->attentes[source]+=cycles;
+	bloc_p->nb_attentes++;
+}
+
+/**
+ * @param effets_p pointeur sur les effets d'une instruction qui écrit des registres
+ * @return cause de l'attente d'une instruction qui lirait trop tôt ce qu'elle écrit
+ */
+enum SourceAttente_e source_attente(const struct EffetsInstruction_s *effets_p)
+{
+	if (effets_p->nature & EFFET_CHARGEMENT) return ATT_CHARGEMENT;
+	if (effets_p->ecrits & (BIT_REGISTRE(REGISTRE_HI) | BIT_REGISTRE(REGISTRE_LO))) return ATT_MULDIV;
+	return ATT_BRANCHEMENT;
+}
+
+/**
+ * @param liste_text_p pointeur sur la liste des instructions de .text, résolues
+ * @param table_def_registres_p pointeur sur la table "dico" des registres
+ * @param table_etiquettes_p pointeur sur la table des étiquettes
+ * @return estimation des cycles de chaque bloc de base
+ * @brief Joue les instructions de .text dans l'ordre de la liste sur le pipeline et note leurs attentes
+ */
+struct Estimation_s *creer_estimation(struct Liste_s *liste_text_p, struct Table_s *table_def_registres_p, struct Table_s *table_etiquettes_p)
+{
+	struct Estimation_s *estimation_p=calloc(1, sizeof(*estimation_p));
+	struct Etiquette_s **etiquettes;
+	struct NoeudListe_s *noeud_p;
+	struct Instruction_s *instruction_p;
+	struct BlocEstime_s *bloc_p=NULL;
+	struct EffetsInstruction_s effets;
+	enum SourceAttente_e producteurs[NB_REGISTRES_EFFETS], source;
+	long prets[NB_REGISTRES_EFFETS], cycle=-1, debut, besoin;
+	size_t nb_etiquettes, e=0, k;
+	int *visees, r, lecture_id, branchement=FALSE, delai=FALSE, apres_delai=FALSE;
+
+	if (!estimation_p) ERROR_MSG("Impossible de créer l'estimation des cycles");
+	etiquettes=etiquettes_text_triees(table_etiquettes_p, &nb_etiquettes);
+	visees=etiquettes_visees(liste_text_p, table_etiquettes_p, etiquettes, nb_etiquettes);
+	for (r=0; r<NB_REGISTRES_EFFETS; r++) {
+		prets[r]=-1;
+		producteurs[r]=ATT_BRANCHEMENT;
+	}
+
+	for (noeud_p=liste_text_p->debut_liste_p; noeud_p; noeud_p=noeud_p->suivant_p) {
+		instruction_p=noeud_p->donnee_p;
+		effets_instruction(instruction_p, table_def_registres_p, &effets);
+
+		/* un bloc commence à une étiquette ou après un délai ; la fonction, à une étiquette qui n'est pas une cible de branchement */
+		while ((e<nb_etiquettes) && (etiquettes[e]->decalage<instruction_p->decalage)) e++;
+		if ((!bloc_p) || (apres_delai) || ((e<nb_etiquettes) && (etiquettes[e]->decalage==instruction_p->decalage))) {
+			bloc_p=nouveau_bloc_estime(estimation_p, instruction_p->decalage);
+			for (k=e; (k<nb_etiquettes) && (etiquettes[k]->decalage==instruction_p->decalage); k++) {
+				if (!bloc_p->etiquette) bloc_p->etiquette=etiquettes[k]->lexeme_p->data;
+				if ((!bloc_p->debut_fonction) && ((visees[k] & VISEE_APPEL) || (!(visees[k] & VISEE_BRANCHEMENT)))) {
+					bloc_p->etiquette=etiquettes[k]->lexeme_p->data;
+					bloc_p->debut_fonction=TRUE;
+				}
+			}
+		}
+		delai=branchement;
+		if ((!bloc_p->nb_instructions) || (instruction_p->ligne<bloc_p->premiere_ligne)) bloc_p->premiere_ligne=instruction_p->ligne;
+		if (instruction_p->ligne>bloc_p->derniere_ligne) bloc_p->derniere_ligne=instruction_p->ligne;
+		bloc_p->nb_instructions++;
+
+		/* l'instruction commence quand les registres qu'elle lit sont prêts, un cycle plus tôt pour un branchement */
+		lecture_id=(effets.nature & EFFET_DELAI) ? 1 : 0;
+		debut=cycle+1;
+		source=ATT_BRANCHEMENT;
+		for (r=1; r<NB_REGISTRES_EFFETS; r++)
+			if ((effets.lus & BIT_REGISTRE(r)) && ((besoin=prets[r]+lecture_id)>debut)) {
+				debut=besoin;
+				source=producteurs[r];
+			}
+		if (debut>cycle+1) noter_attente_estimee(estimation_p, bloc_p, instruction_p->ligne, source, debut-cycle-1);
+		for (r=1; r<NB_REGISTRES_EFFETS; r++)
+			if (effets.ecrits & BIT_REGISTRE(r)) {
+				prets[r]=debut+effets.latence;
+				producteurs[r]=source_attente(&effets);
+			}
+		cycle=debut;
+
+		if ((delai) && (!strcmp(instruction_p->definition_p->nom, "NOP"))) bloc_p->delais_vides++;
+		apres_delai=delai;
+		branchement=(!delai) && (effets.nature & EFFET_DELAI);
+	}
+	free(etiquettes);
+	free(visees);
+	return estimation_p;
+}
+
+/**
+ * @param estimation_p pointeur sur l'estimation, NULL accepté
+ * @return NULL
+ */
+struct Estimation_s *detruire_estimation(struct Estimation_s *estimation_p)
+{
+	if (estimation_p) {
+		free(estimation_p->blocs);
+		free(estimation_p->attentes);
+		free(estimation_p);
+	}
+	return NULL;
+}
+
+/**
+ * @param bloc_p pointeur sur un bloc estimé
+ * @return cycles du bloc, une fois le pipeline rempli : un par instruction, plus les attentes
+ */
+unsigned long cycles_bloc(const struct BlocEstime_s *bloc_p)
+{
+	unsigned long cycles=bloc_p->nb_instructions;
+	int s;
+
+	for (s=0; s<NB_SOURCES_ATTENTE; s++) cycles+=bloc_p->attentes[s];
+	return cycles;
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param nom nom à écrire, NULL accepté
+ * @param largeur largeur de la colonne
+ * @return Rien
+ * @brief Ecrit un nom aligné à gauche dans sa colonne
+ */
+void colonne_nom(struct Sortie_s *sortie_p, const char *nom, size_t largeur)
+{
+	size_t longueur=nom ? strlen(nom) : 0;
+
+	if (nom) sortie_chaine(sortie_p, nom);
+	sortie_repeter(sortie_p, ' ', (longueur<largeur) ? largeur-longueur : 1);
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param bloc_p pointeur sur les totaux d'un bloc ou d'une fonction
+ * @return Rien
+ * @brief Ecrit les colonnes de chiffres d'un bloc ou d'une fonction
+ */
+void colonnes_estimation(struct Sortie_s *sortie_p, const struct BlocEstime_s *bloc_p)
+{
+	int s;
+
+	sortie_decimal(sortie_p, bloc_p->nb_instructions, 7);
+	sortie_decimal(sortie_p, cycles_bloc(bloc_p), 8);
+	for (s=0; s<NB_SOURCES_ATTENTE; s++) sortie_decimal(sortie_p, bloc_p->attentes[s], 12);
+	sortie_decimal(sortie_p, bloc_p->delais_vides, 12);
+	sortie_caractere(sortie_p, '\n');
+}
+
+/**
+ * @param cumul_p pointeur sur les totaux d'une fonction ou du programme
+ * @param bloc_p pointeur sur un bloc à y ajouter
+ * @return Rien
+ */
+void cumuler_bloc_estime(struct BlocEstime_s *cumul_p, const struct BlocEstime_s *bloc_p)
+{
+	int s;
+
+	cumul_p->nb_instructions+=bloc_p->nb_instructions;
+	for (s=0; s<NB_SOURCES_ATTENTE; s++) cumul_p->attentes[s]+=bloc_p->attentes[s];
+	cumul_p->delais_vides+=bloc_p->delais_vides;
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param estimation_p pointeur sur l'estimation
+ * @return Rien
+ * @brief Ecrit les cycles et les attentes de chaque bloc (avec les lignes des attentes), puis de chaque fonction
+ */
+void ecrire_estimation(struct Sortie_s *sortie_p, const struct Estimation_s *estimation_p)
+{
+	static const char *ENTETE="  instr  cycles  chargement    mult/div branchement  délais NOP\n";
+	const struct BlocEstime_s *bloc_p;
+	const struct AttenteEstimee_s *attente_p;
+	struct BlocEstime_s fonction, total;
+	const char *nom_fonction="(début de .text)";
+	char lignes[32];
+	size_t b, a;
+
+	sortie_chaine(sortie_p, "Estimation statique des cycles de .text (pipeline à 5 étages)\n\ndécalage      lignes  bloc                ");
+	sortie_chaine(sortie_p, ENTETE);
+	for (b=0; b<estimation_p->nb_blocs; b++) {
+		bloc_p=estimation_p->blocs+b;
+		sortie_hex(sortie_p, bloc_p->decalage, 8);
+		sprintf(lignes, "%u-%u", bloc_p->premiere_ligne, bloc_p->derniere_ligne);
+		sortie_chaine_alignee(sortie_p, lignes, 12);
+		sortie_chaine(sortie_p, "  ");
+		colonne_nom(sortie_p, bloc_p->etiquette, 20);
+		colonnes_estimation(sortie_p, bloc_p);
+		for (a=0; a<bloc_p->nb_attentes; a++) {
+			attente_p=estimation_p->attentes+bloc_p->premiere_attente+a;
+			sortie_chaine(sortie_p, "    ligne ");
+			sortie_decimal(sortie_p, attente_p->ligne, 0);
+			sortie_chaine(sortie_p, " : ");
+			sortie_decimal(sortie_p, attente_p->cycles, 0);
+			sortie_chaine(sortie_p, attente_p->cycles>1 ? " cycles d'attente (" : " cycle d'attente (");
+			sortie_chaine(sortie_p, NOMS_SOURCES_ATTENTE[attente_p->source]);
+			sortie_chaine(sortie_p, ")\n");
+		}
+	}
+
+	sortie_chaine(sortie_p, "\nfonction                                ");
+	sortie_chaine(sortie_p, ENTETE);
+	memset(&fonction, 0, sizeof(fonction));
+	memset(&total, 0, sizeof(total));
+	for (b=0; b<=estimation_p->nb_blocs; b++) {
+		bloc_p=(b<estimation_p->nb_blocs) ? estimation_p->blocs+b : NULL;
+		if (((!bloc_p) || (bloc_p->debut_fonction)) && (fonction.nb_instructions)) {
+			colonne_nom(sortie_p, nom_fonction, 40);
+			colonnes_estimation(sortie_p, &fonction);
+			memset(&fonction, 0, sizeof(fonction));
+		}
+		if (!bloc_p) break;
+		if ((bloc_p->debut_fonction) || ((!b) && (bloc_p->etiquette))) nom_fonction=bloc_p->etiquette;
+		cumuler_bloc_estime(&fonction, bloc_p);
+		cumuler_bloc_estime(&total, bloc_p);
+	}
+	colonne_nom(sortie_p, "total", 40);
+	colonnes_estimation(sortie_p, &total);
+	sortie_chaine(sortie_p, "(plus ");
+	sortie_decimal(sortie_p, ESTIMATION_REMPLISSAGE, 0);
+	sortie_chaine(sortie_p, " cycles de remplissage du pipeline pour un passage)\n\n");
+}
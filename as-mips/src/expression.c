@@ -0,0 +1,538 @@
+/**
+ * @file expression.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions d'analyse et d'évaluation des expressions d'opérandes
+ *
+ * L'analyse est une descente récursive par niveau de priorité qui produit directement la notation polonaise
+ * inverse dans un tableau de taille fixe : chaque opérateur dont les opérandes sont des constantes est calculé
+ * au moment où il est produit, une expression sans étiquette se réduit donc à une seule constante. L'évaluation
+ * n'alloue rien : elle utilise une pile de la taille maximale d'une expression.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include <global.h>
+#include <notify.h>
+#include <memoire.h>
+#include <liste.h>
+#include <table.h>
+#include <lex.h>
+#include <syn.h>
+#include <gen.h>
+#include <expression.h>
+
+#define NIVEAU_SOMME	4		/**< Niveau de priorité de + et - */
+#define NIVEAU_MAX		5		/**< Niveau de priorité le plus fort des opérateurs binaires (* / %) */
+
+/**
+ * @struct AnalyseExpression_s
+ * @brief Etat de l'analyse d'une expression
+ */
+struct AnalyseExpression_s {
+	struct NoeudListe_s *noeud_p;							/**< Noeud du lexème courant */
+	struct Lexeme_s *lexeme_p;								/**< Lexème courant, NULL en fin de liste */
+	int forme_base;											/**< TRUE si "(" registre termine l'expression (forme B) */
+	struct TermeExpression_s termes[EXPRESSION_TERMES_MAX];	/**< Termes produits */
+	size_t nb_termes;										/**< Nombre de termes produits */
+	char texte[2*STRLEN];									/**< Texte de l'expression */
+	size_t taille_texte;									/**< Longueur du texte */
+	char *msg_err;											/**< Message d'erreur */
+};
+
+/**
+ * @param lexeme_p pointeur sur un lexème, NULL accepté
+ * @param operateur texte de l'opérateur
+ * @return TRUE si le lexème est cet opérateur
+ */
+int est_lexeme_operateur(struct Lexeme_s *lexeme_p, const char *operateur)
+{
+	return (lexeme_p) && (lexeme_p->nature==L_OPERATEUR) && (!strcmp(lexeme_p->data, operateur));
+}
+
+/**
+ * @param lexeme_p pointeur sur un lexème
+ * @return TRUE si le lexème est un nombre signé, qui ajoute ou retranche sa valeur à ce qui le précède ("a -4")
+ */
+int est_nombre_signe(struct Lexeme_s *lexeme_p)
+{
+	return (lexeme_p->nature==L_NOMBRE) && ((lexeme_p->data[0]=='-') || (lexeme_p->data[0]=='+'));
+}
+
+/**
+ * @param noeud_p noeud d'une parenthèse ouvrante
+ * @return TRUE si elle est suivie d'un registre, c'est à dire si elle ouvre la base d'une instruction de forme B
+ */
+int ouvre_base(struct NoeudListe_s *noeud_p)
+{
+	return (noeud_p->suivant_p) && (((struct Lexeme_s *)noeud_p->suivant_p->donnee_p)->nature==L_REGISTRE);
+}
+
+/**
+ * @param noeud_lexeme_p noeud du premier lexème de l'opérande
+ * @param forme_base TRUE pour le décalage d'une instruction de forme B
+ * @return TRUE si ce lexème peut commencer une expression
+ */
+int est_debut_expression(struct NoeudListe_s *noeud_lexeme_p, int forme_base)
+{
+	struct Lexeme_s *lexeme_p;
+
+	if (!noeud_lexeme_p) return FALSE;
+	lexeme_p=(struct Lexeme_s *)noeud_lexeme_p->donnee_p;
+	switch (lexeme_p->nature) {
+	case L_NOMBRE:
+	case L_SYMBOLE:
+	case L_OPERATEUR:
+		return TRUE;
+	case L_PARENTHESE_OUVRANTE:
+		return (!forme_base) || (!ouvre_base(noeud_lexeme_p));
+	default:
+		return FALSE;
+	}
+}
+
+/**
+ * @param analyse_p pointeur sur l'état de l'analyse
+ * @return Rien
+ * @brief Ajoute le lexème courant au texte de l'expression et passe au suivant
+ */
+void avancer_expression(struct AnalyseExpression_s *analyse_p)
+{
+	size_t longueur=strlen(analyse_p->lexeme_p->data);
+
+	if (analyse_p->taille_texte+longueur < sizeof(analyse_p->texte)) {
+		memcpy(analyse_p->texte+analyse_p->taille_texte, analyse_p->lexeme_p->data, longueur+1);
+		analyse_p->taille_texte+=longueur;
+	}
+	analyse_p->noeud_p=analyse_p->noeud_p->suivant_p;
+	analyse_p->lexeme_p=analyse_p->noeud_p ? (struct Lexeme_s *)analyse_p->noeud_p->donnee_p : NULL;
+}
+
+/**
+ * @param analyse_p pointeur sur l'état de l'analyse
+ * @return TRUE si le lexème courant termine l'opérande
+ */
+int fin_expression(struct AnalyseExpression_s *analyse_p)
+{
+	return (!analyse_p->lexeme_p) || (analyse_p->lexeme_p->nature==L_FIN_LIGNE) || (analyse_p->lexeme_p->nature==L_COMMENTAIRE) ||
+			((analyse_p->forme_base) && (analyse_p->lexeme_p->nature==L_PARENTHESE_OUVRANTE) && (ouvre_base(analyse_p->noeud_p)));
+}
+
+/**
+ * @param nature opérateur
+ * @param x premier opérande (seul opérande d'un opérateur unaire)
+ * @param y second opérande
+ * @param resultat_p pointeur recevant le résultat
+ * @param msg_err chaine recevant le message d'erreur éventuel
+ * @return SUCCESS, FAILURE pour une division par zéro
+ * @brief Calcule un opérateur sur des constantes de 32 bits (décalages logiques, divisions signées)
+ */
+int calculer_operateur(enum TermeExpression_e nature, uint32_t x, uint32_t y, uint32_t *resultat_p, char *msg_err)
+{
+	switch (nature) {
+	case E_OPPOSE:			*resultat_p=-x; break;
+	case E_NON:				*resultat_p=~x; break;
+	case E_FOIS:			*resultat_p=x*y; break;
+	case E_PLUS:			*resultat_p=x+y; break;
+	case E_MOINS:			*resultat_p=x-y; break;
+	case E_DECALAGE_GAUCHE:	*resultat_p=(y<32) ? x<<y : 0; break;
+	case E_DECALAGE_DROITE:	*resultat_p=(y<32) ? x>>y : 0; break;
+	case E_ET:				*resultat_p=x&y; break;
+	case E_OU_EXCLUSIF:		*resultat_p=x^y; break;
+	case E_OU:				*resultat_p=x|y; break;
+	case E_DIVISE:
+	case E_MODULO:
+		if (!y) {
+			strcpy(msg_err, "divise par zéro");
+			return FAILURE;
+		}
+		if ((x==0x80000000u) && (y==0xFFFFFFFFu))	/* seul quotient qui déborde */
+			*resultat_p=(nature==E_DIVISE) ? x : 0;
+		else
+			*resultat_p=(uint32_t)((nature==E_DIVISE) ? (int32_t)x / (int32_t)y : (int32_t)x % (int32_t)y);
+		break;
+	default:
+		ERROR_MSG("Opérateur d'expression inconnu %d", nature);
+	}
+	return SUCCESS;
+}
+
+/**
+ * @param analyse_p pointeur sur l'état de l'analyse
+ * @param nature nature du terme
+ * @param valeur valeur d'une constante
+ * @param symbole nom d'une étiquette
+ * @return SUCCESS si le terme a été ajouté ou calculé, FAILURE sinon
+ * @brief Ajoute un terme à l'expression, en calculant tout de suite un opérateur appliqué à des constantes
+ */
+int emettre_terme(struct AnalyseExpression_s *analyse_p, enum TermeExpression_e nature, int32_t valeur, const char *symbole)
+{
+	struct TermeExpression_s *termes=analyse_p->termes;
+	size_t n=analyse_p->nb_termes;
+	uint32_t resultat;
+
+	if (((nature==E_OPPOSE) || (nature==E_NON)) && (n>=1) && (termes[n-1].nature==E_NOMBRE)) {
+		calculer_operateur(nature, (uint32_t)termes[n-1].valeur, 0, &resultat, analyse_p->msg_err);
+		termes[n-1].valeur=(int32_t)resultat;
+		return SUCCESS;
+	}
+	if ((nature!=E_NOMBRE) && (nature!=E_SYMBOLE) && (nature!=E_OPPOSE) && (nature!=E_NON) &&
+			(n>=2) && (termes[n-2].nature==E_NOMBRE) && (termes[n-1].nature==E_NOMBRE)) {
+		if (FAILURE==calculer_operateur(nature, (uint32_t)termes[n-2].valeur, (uint32_t)termes[n-1].valeur, &resultat, analyse_p->msg_err))
+			return FAILURE;
+		termes[n-2].valeur=(int32_t)resultat;
+		analyse_p->nb_termes--;
+		return SUCCESS;
+	}
+
+	if (n==EXPRESSION_TERMES_MAX) {
+		strcpy(analyse_p->msg_err, "rend l'expression trop longue");
+		return FAILURE;
+	}
+	termes[n].nature=nature;
+	termes[n].valeur=valeur;
+	termes[n].symbole=symbole;
+	analyse_p->nb_termes++;
+	return SUCCESS;
+}
+
+int analyser_niveau_expression(struct AnalyseExpression_s *analyse_p, int niveau);
+
+/**
+ * @param analyse_p pointeur sur l'état de l'analyse
+ * @return SUCCESS si un terme a pu être lu, FAILURE sinon (le lexème courant est en cause)
+ * @brief Lit un nombre, une étiquette, une expression entre parenthèses ou un opérateur unaire suivi de son opérande
+ */
+int analyser_terme_expression(struct AnalyseExpression_s *analyse_p)
+{
+	struct Lexeme_s *lexeme_p=analyse_p->lexeme_p;
+	long nombre;
+
+	if (fin_expression(analyse_p)) {
+		strcpy(analyse_p->msg_err, "n'est pas un nombre ou un symbole");
+		return FAILURE;
+	}
+	if ((est_lexeme_operateur(lexeme_p, "-")) || (est_lexeme_operateur(lexeme_p, "~"))) {
+		avancer_expression(analyse_p);
+		if (FAILURE==analyser_terme_expression(analyse_p)) return FAILURE;
+		return emettre_terme(analyse_p, lexeme_p->data[0]=='-' ? E_OPPOSE : E_NON, 0, NULL);
+	}
+	if (est_lexeme_operateur(lexeme_p, "+")) {
+		avancer_expression(analyse_p);
+		return analyser_terme_expression(analyse_p);
+	}
+
+	switch (lexeme_p->nature) {
+	case L_NOMBRE:
+		errno=0;
+		nombre=strtol(lexeme_p->data, NULL, 0);
+		if (errno) {
+			strcpy(analyse_p->msg_err, "n'a pas pu être évalué numériquement");
+			return FAILURE;
+		}
+		if ((nombre>(long)UINT32_MAX) || (nombre<(long)INT32_MIN)) {
+			strcpy(analyse_p->msg_err, "est au delà des valeurs permises");
+			return FAILURE;
+		}
+		avancer_expression(analyse_p);
+		return emettre_terme(analyse_p, E_NOMBRE, (int32_t)(uint32_t)nombre, NULL);
+	case L_SYMBOLE:
+		avancer_expression(analyse_p);
+		return emettre_terme(analyse_p, E_SYMBOLE, 0, lexeme_p->data);
+	case L_PARENTHESE_OUVRANTE:
+		avancer_expression(analyse_p);
+		if (FAILURE==analyser_niveau_expression(analyse_p, 0)) return FAILURE;
+		if ((!analyse_p->lexeme_p) || (analyse_p->lexeme_p->nature!=L_PARENTHESE_FERMANTE)) {
+			strcpy(analyse_p->msg_err, "à la place d'une parenthèse fermante");
+			return FAILURE;
+		}
+		avancer_expression(analyse_p);
+		return SUCCESS;
+	case L_OPERATEUR:
+		if ((!strcmp(lexeme_p->data, "%hi")) || (!strcmp(lexeme_p->data, "%lo"))) {
+			strcpy(analyse_p->msg_err, "n'est permis qu'en tête de l'opérande");
+			return FAILURE;
+		}
+		/* pas de break : un opérateur binaire ne commence pas un terme */
+	default:
+		strcpy(analyse_p->msg_err, "n'est pas un nombre ou un symbole");
+		return FAILURE;
+	}
+}
+
+/**
+ * @param lexeme_p pointeur sur un lexème
+ * @param niveau niveau de priorité
+ * @param nature_p pointeur recevant l'opérateur
+ * @return TRUE si le lexème est un opérateur binaire de ce niveau
+ */
+int operateur_binaire(struct Lexeme_s *lexeme_p, int niveau, enum TermeExpression_e *nature_p)
+{
+	const char *operateurs[NIVEAU_MAX+1][3]={{"|"}, {"^"}, {"&"}, {"<<", ">>"}, {"+", "-"}, {"*", "/", "%"}};
+	const enum TermeExpression_e natures[NIVEAU_MAX+1][3]={{E_OU}, {E_OU_EXCLUSIF}, {E_ET}, {E_DECALAGE_GAUCHE, E_DECALAGE_DROITE},
+			{E_PLUS, E_MOINS}, {E_FOIS, E_DIVISE, E_MODULO}};
+	int i;
+
+	if (lexeme_p->nature!=L_OPERATEUR) return FALSE;
+	for (i=0; (i<3) && (operateurs[niveau][i]); i++)
+		if (!strcmp(lexeme_p->data, operateurs[niveau][i])) {
+			*nature_p=natures[niveau][i];
+			return TRUE;
+		}
+	return FALSE;
+}
+
+/**
+ * @param analyse_p pointeur sur l'état de l'analyse
+ * @param niveau niveau de priorité, de 0 (|) à NIVEAU_MAX (* / %)
+ * @return SUCCESS si l'expression de ce niveau a pu être lue, FAILURE sinon
+ * @brief Lit une suite de termes reliés par des opérateurs de même priorité, associatifs à gauche
+ */
+int analyser_niveau_expression(struct AnalyseExpression_s *analyse_p, int niveau)
+{
+	struct NoeudListe_s *noeud_operateur_p;
+	enum TermeExpression_e nature;
+
+	if (niveau>NIVEAU_MAX) return analyser_terme_expression(analyse_p);
+	if (FAILURE==analyser_niveau_expression(analyse_p, niveau+1)) return FAILURE;
+
+	while (!fin_expression(analyse_p)) {
+		noeud_operateur_p=analyse_p->noeud_p;
+		if (operateur_binaire(analyse_p->lexeme_p, niveau, &nature))
+			avancer_expression(analyse_p);
+		else if ((niveau==NIVEAU_SOMME) && (est_nombre_signe(analyse_p->lexeme_p)))
+			nature=E_PLUS; /* le nombre est lu avec son signe */
+		else
+			break;
+
+		if (FAILURE==analyser_niveau_expression(analyse_p, niveau+1)) return FAILURE;
+		if (FAILURE==emettre_terme(analyse_p, nature, 0, NULL)) {
+			/* l'erreur de calcul est signalée sur l'opérateur */
+			analyse_p->noeud_p=noeud_operateur_p;
+			analyse_p->lexeme_p=(struct Lexeme_s *)noeud_operateur_p->donnee_p;
+			return FAILURE;
+		}
+	}
+	return SUCCESS;
+}
+
+/**
+ * @param noeud_lexeme_pp pointeur sur le noeud du premier lexème de l'opérande, placé au retour sur le lexème qui
+ * suit l'opérande (ou sur le lexème en cause en cas d'erreur)
+ * @param lexeme_pp pointeur sur le lexème correspondant, mis à jour de la même façon
+ * @param forme_base TRUE pour le décalage d'une instruction de forme B, qui s'arrête avant "(" registre
+ * @param msg_err chaine recevant le message d'erreur éventuel
+ * @return lexème de l'opérande : le lexème lui-même pour un nombre ou une étiquette seuls, le lexème d'une
+ * expression (à libérer par detruire_expression) sinon, NULL en cas d'erreur
+ * @brief Lit l'opérande numérique ou symbolique d'une instruction
+ */
+struct Lexeme_s *lire_expression(struct NoeudListe_s **noeud_lexeme_pp, struct Lexeme_s **lexeme_pp, int forme_base, char *msg_err)
+{
+	struct AnalyseExpression_s analyse;
+	struct Expression_s *expression_p;
+	struct Lexeme_s *lexeme_p=*lexeme_pp, *suivant_p;
+	enum PartieExpression_e partie=P_TOUT;
+	size_t i, taille;
+	char *texte_p;
+	int resultat;
+
+	/* cas le plus fréquent : un nombre ou une étiquette seuls restent le lexème lu */
+	if ((lexeme_p) && ((lexeme_p->nature==L_NOMBRE) || (lexeme_p->nature==L_SYMBOLE)) && ((*noeud_lexeme_pp)->suivant_p)) {
+		suivant_p=(struct Lexeme_s *)(*noeud_lexeme_pp)->suivant_p->donnee_p;
+		if ((suivant_p->nature!=L_OPERATEUR) && (!est_nombre_signe(suivant_p))) {
+			*noeud_lexeme_pp=(*noeud_lexeme_pp)->suivant_p;
+			*lexeme_pp=suivant_p;
+			return lexeme_p;
+		}
+	}
+
+	analyse.noeud_p=*noeud_lexeme_pp;
+	analyse.lexeme_p=lexeme_p;
+	analyse.forme_base=forme_base;
+	analyse.nb_termes=0;
+	analyse.texte[0]='\0';
+	analyse.taille_texte=0;
+	analyse.msg_err=msg_err;
+
+	if ((est_lexeme_operateur(lexeme_p, "%hi")) || (est_lexeme_operateur(lexeme_p, "%lo"))) {
+		partie=(lexeme_p->data[1]=='h') ? P_HI : P_LO;
+		avancer_expression(&analyse);
+		if ((!analyse.lexeme_p) || (analyse.lexeme_p->nature!=L_PARENTHESE_OUVRANTE)) {
+			strcpy(msg_err, "à la place d'une parenthèse ouvrante");
+			resultat=FAILURE;
+		}
+		else
+			resultat=analyser_terme_expression(&analyse);
+	}
+	else
+		resultat=analyser_niveau_expression(&analyse, 0);
+
+	*noeud_lexeme_pp=analyse.noeud_p;
+	*lexeme_pp=analyse.lexeme_p;
+	if (FAILURE==resultat) return NULL;
+
+	/* un seul bloc : l'entête, les termes, le texte de l'expression puis les noms des étiquettes */
+	taille=sizeof(*expression_p)+(analyse.nb_termes-1)*sizeof(struct TermeExpression_s)+analyse.taille_texte+1;
+	for (i=0; i<analyse.nb_termes; i++)
+		if (analyse.termes[i].nature==E_SYMBOLE) taille+=strlen(analyse.termes[i].symbole)+1;
+	if (!(expression_p=malloc(taille))) ERROR_MSG("Impossible de créer une expression");
+	MEMOIRE_ALLOUER(MEM_INSTRUCTIONS, taille);
+
+	expression_p->taille=taille;
+	expression_p->references=1;
+	expression_p->partie=partie;
+	expression_p->nb_termes=analyse.nb_termes;
+	memcpy(expression_p->termes, analyse.termes, analyse.nb_termes*sizeof(struct TermeExpression_s));
+	texte_p=(char *)(expression_p->termes+analyse.nb_termes);
+	expression_p->lexeme.data=strcpy(texte_p, analyse.texte);
+	expression_p->lexeme.nature=L_EXPRESSION;
+	expression_p->lexeme.ligne=lexeme_p->ligne;
+	texte_p+=analyse.taille_texte+1;
+	for (i=0; i<analyse.nb_termes; i++)
+		if (analyse.termes[i].nature==E_SYMBOLE) {
+			expression_p->termes[i].symbole=strcpy(texte_p, analyse.termes[i].symbole);
+			texte_p+=strlen(texte_p)+1;
+		}
+	return &expression_p->lexeme;
+}
+
+/**
+ * @param expression_p pointeur sur l'expression, NULL accepté
+ * @return Rien
+ * @brief Libère une expression quand la dernière instruction qui la partage la rend
+ */
+void detruire_expression(struct Expression_s *expression_p)
+{
+	if ((expression_p) && (!--expression_p->references)) {
+		MEMOIRE_LIBERER(MEM_INSTRUCTIONS, expression_p->taille);
+		free(expression_p);
+	}
+}
+
+/**
+ * @param lexeme_p pointeur sur le lexème d'un opérande
+ * @return le même lexème, dont l'expression éventuelle a une instruction de plus pour propriétaire
+ */
+struct Lexeme_s *partager_expression(struct Lexeme_s *lexeme_p)
+{
+	if ((lexeme_p) && (lexeme_p->nature==L_EXPRESSION))
+		((struct Expression_s *)lexeme_p)->references++;
+	return lexeme_p;
+}
+
+/**
+ * @param partie partie de la valeur gardée
+ * @param valeur valeur entière
+ * @return valeur de la partie (%hi est corrigé de la retenue que %lo, signé, provoquera)
+ */
+uint32_t partie_expression(enum PartieExpression_e partie, uint32_t valeur)
+{
+	switch (partie) {
+	case P_HI: return ((valeur+0x8000u) >> 16) & 0xFFFFu;
+	case P_LO: return valeur & 0xFFFFu;
+	default: return valeur;
+	}
+}
+
+/**
+ * @param lexeme_p pointeur sur le lexème d'un opérande
+ * @param valeur_p pointeur recevant la valeur, NULL accepté
+ * @return TRUE si l'opérande est une expression réduite à une constante dès l'analyse syntaxique
+ */
+int expression_constante(const struct Lexeme_s *lexeme_p, long *valeur_p)
+{
+	const struct Expression_s *expression_p=(const struct Expression_s *)lexeme_p;
+
+	if ((lexeme_p->nature!=L_EXPRESSION) || (expression_p->nb_termes!=1) || (expression_p->termes[0].nature!=E_NOMBRE)) return FALSE;
+	if (valeur_p)
+		*valeur_p=(expression_p->partie==P_TOUT) ? (long)expression_p->termes[0].valeur :
+				(long)partie_expression(expression_p->partie, (uint32_t)expression_p->termes[0].valeur);
+	return TRUE;
+}
+
+/**
+ * @param expression_p pointeur sur l'expression
+ * @param table_etiquettes_p pointeur sur la table des étiquettes complète, NULL si aucune étiquette n'est connue
+ * @param adresses_base adresses de début de chaque section (indicées par Section_e), NULL pour des sections en 0
+ * @param valeur_p pointeur recevant la valeur
+ * @param msg_err chaine recevant le message d'erreur éventuel
+ * @return SUCCESS si l'expression est une constante éventuellement relative à un seul symbole, FAILURE sinon
+ * @brief Evalue une expression : la différence de deux étiquettes d'une même section est une constante
+ */
+int evaluer_expression(const struct Expression_s *expression_p, struct Table_s *table_etiquettes_p, const uint32_t *adresses_base,
+		struct ValeurExpression_s *valeur_p, char *msg_err)
+{
+	struct ValeurExpression_s pile[EXPRESSION_TERMES_MAX];
+	const struct TermeExpression_s *terme_p;
+	struct ValeurExpression_s *x_p, *y_p;
+	size_t i, n=0;
+
+	for (i=0; i<expression_p->nb_termes; i++) {
+		terme_p=expression_p->termes+i;
+		if (terme_p->nature==E_NOMBRE) {
+			pile[n].valeur=pile[n].addenda=(uint32_t)terme_p->valeur;
+			pile[n].symbole=NULL;
+			pile[n].etiquette_p=NULL;
+			n++;
+			continue;
+		}
+		if (terme_p->nature==E_SYMBOLE) {
+			pile[n].symbole=terme_p->symbole;
+			pile[n].etiquette_p=table_etiquettes_p ? donnee_table(table_etiquettes_p, (char *)terme_p->symbole) : NULL;
+			pile[n].valeur=pile[n].etiquette_p ? adresse_etiquette(pile[n].etiquette_p, adresses_base) : 0;
+			pile[n].addenda=0;
+			n++;
+			continue;
+		}
+
+		/* x est le premier opérande (le seul pour un opérateur unaire), y le second */
+		if ((terme_p->nature==E_OPPOSE) || (terme_p->nature==E_NON)) {
+			x_p=y_p=pile+n-1;
+		} else {
+			x_p=pile+n-2;
+			y_p=pile+n-1;
+			n--;
+		}
+
+		if ((terme_p->nature==E_PLUS) && (x_p->symbole) && (y_p->symbole)) {
+			strcpy(msg_err, "additionne deux symboles");
+			return FAILURE;
+		}
+		if ((terme_p->nature==E_MOINS) && (y_p->symbole)) {
+			/* seule la différence de deux étiquettes d'une même section (ou d'un même symbole) est une constante */
+			if ((!x_p->symbole) || ((x_p->etiquette_p) && ((!y_p->etiquette_p) || (x_p->etiquette_p->section!=y_p->etiquette_p->section))) ||
+					((!x_p->etiquette_p) && ((y_p->etiquette_p) || (strcmp(x_p->symbole, y_p->symbole))))) {
+				strcpy(msg_err, "est la différence de symboles qui ne sont pas dans la même section");
+				return FAILURE;
+			}
+			x_p->valeur-=y_p->valeur;
+			x_p->addenda=x_p->valeur;
+			x_p->symbole=NULL;
+			x_p->etiquette_p=NULL;
+			continue;
+		}
+		if ((terme_p->nature==E_PLUS) || (terme_p->nature==E_MOINS)) {
+			if (y_p->symbole) {
+				x_p->symbole=y_p->symbole;
+				x_p->etiquette_p=y_p->etiquette_p;
+			}
+			x_p->valeur=(terme_p->nature==E_PLUS) ? x_p->valeur+y_p->valeur : x_p->valeur-y_p->valeur;
+			x_p->addenda=(terme_p->nature==E_PLUS) ? x_p->addenda+y_p->addenda : x_p->addenda-y_p->addenda;
+			continue;
+		}
+
+		if ((x_p->symbole) || (y_p->symbole)) {
+			strcpy(msg_err, "n'est pas relogeable : seuls + et - s'appliquent à un symbole");
+			return FAILURE;
+		}
+		if (FAILURE==calculer_operateur(terme_p->nature, x_p->valeur, y_p->valeur, &x_p->valeur, msg_err)) return FAILURE;
+		x_p->addenda=x_p->valeur;
+	}
+
+	*valeur_p=pile[0];
+	valeur_p->valeur=partie_expression(expression_p->partie, valeur_p->valeur);
+	return SUCCESS;
+}
@@ -0,0 +1,513 @@
+/**
+ * @file gen.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions de génération du code machine des instructions
+ *
+ * Le code est produit en deux temps : les registres et les nombres sont insérés dès que l'instruction est
+ * connue, les symboles ne le sont qu'une fois la table des étiquettes complète.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <errno.h>
+
+#include <global.h>
+#include <notify.h>
+#include <liste.h>
+#include <table.h>
+#include <dico.h>
+#include <lex.h>
+#include <syn.h>
+#include <gen.h>
+#include <expression.h>
+#include <profil.h>
+
+/**
+ * @param champ lettre identifiant le champ du code machine
+ * @return masque des bits du champ dans le code machine
+ * @brief Renvoie le masque des bits occupés par un champ du code machine
+ */
+uint32_t masque_champ(char champ)
+{
+	switch (champ) {
+	case 's': return 0x03E00000;
+	case 't': return 0x001F0000;
+	case 'd': return 0x0000F800;
+	case 'h': return 0x000007C0;
+	case 'i':
+	case 'o':
+	case 'H':
+	case 'L': return 0x0000FFFF;
+	case 'a': return 0x03FFFFFF;
+	default : return 0;
+	}
+}
+
+/**
+ * @param code_p pointeur sur le code machine à compléter
+ * @param champ lettre identifiant le champ du code machine
+ * @param valeur valeur à placer dans le champ
+ * @param msg_err chaine recevant le message d'erreur éventuel
+ * @return SUCCESS si la valeur a pu être placée, FAILURE si elle ne tient pas dans le champ
+ * @brief Remplace le contenu d'un champ du code machine par une valeur
+ */
+int remplacer_champ(uint32_t *code_p, char champ, long valeur, char *msg_err)
+{
+	uint32_t bits;
+
+	switch (champ) {
+	case 's':
+	case 't':
+	case 'd':
+	case 'h':
+		if ((valeur<0) || (valeur>31)) {
+			strcpy(msg_err, "ne tient pas sur 5 bits");
+			return FAILURE;
+		}
+		bits=(uint32_t)valeur << (champ=='s' ? 21 : champ=='t' ? 16 : champ=='d' ? 11 : 6);
+		break;
+	case 'i':
+		/* un mot de 32 bits dont la valeur signée tient sur 16 bits (0xFFFF8000) est étendu par le signe */
+		if ((valeur>=0x80000000L) && (valeur<=(long)UINT32_MAX) && ((int32_t)valeur>=INT16_MIN)) valeur=(int32_t)valeur;
+		if ((valeur<INT16_MIN) || (valeur>UINT16_MAX)) {
+			strcpy(msg_err, "ne tient pas sur 16 bits");
+			return FAILURE;
+		}
+		bits=(uint32_t)valeur & 0xFFFF;
+		break;
+	case 'o':
+		if ((valeur<INT16_MIN) || (valeur>INT16_MAX)) {
+			strcpy(msg_err, "est un déplacement trop grand pour un branchement");
+			return FAILURE;
+		}
+		bits=(uint32_t)valeur & 0xFFFF;
+		break;
+	case 'H':
+	case 'L':
+		if ((valeur<INT32_MIN) || (valeur>(long)UINT32_MAX)) {
+			strcpy(msg_err, "ne tient pas sur 32 bits");
+			return FAILURE;
+		}
+		bits=partie_expression(champ=='H' ? P_HI : P_LO, (uint32_t)valeur);
+		break;
+	case 'a':
+		if ((valeur<0) || (valeur>0x03FFFFFF)) {
+			strcpy(msg_err, "ne tient pas sur 26 bits");
+			return FAILURE;
+		}
+		bits=(uint32_t)valeur;
+		break;
+	default:
+		strcpy(msg_err, "est placé dans un champ inconnu");
+		return FAILURE;
+	}
+
+	*code_p=(*code_p & ~masque_champ(champ)) | bits;
+	return SUCCESS;
+}
+
+/**
+ * @param instruction_p pointeur sur l'instruction en erreur
+ * @param indice indice de l'opérande en cause
+ * @param msg_err message d'erreur
+ * @return Rien
+ * @brief Signale une erreur de génération de code au collecteur de diagnostics
+ */
+void signaler_erreur_codage(struct Instruction_s *instruction_p, int indice, char *msg_err)
+{
+	diag_signaler(NULL, DIAG_ERREUR, NULL, instruction_p->ligne, "codage", "%s %s",
+			(indice>=0) && instruction_p->operandes[indice] ? instruction_p->operandes[indice]->data : instruction_p->definition_p->nom,
+			msg_err);
+}
+
+/**
+ * @param instruction_p pointeur sur l'instruction à coder
+ * @param table_def_registres_p pointeur sur la table "dico" des registres
+ * @param msg_err chaine recevant le message d'erreur éventuel
+ * @return SUCCESS si le codage a réussi, FAILURE sinon
+ * @brief Calcule le code machine de l'instruction à partir de ses registres et nombres
+ *
+ * Un nombre donne directement la valeur du champ (déplacement en mots pour un branchement, index de mot pour un saut).
+ * Les champs correspondant à des symboles restent à zéro, ils seront complétés par resoudre_instruction.
+ * Cette fonction ne lit que la table des registres et peut donc être appelée pendant que l'analyse syntaxique
+ * complète encore la table des étiquettes.
+ */
+int encoder_instruction(struct Instruction_s *instruction_p, struct Table_s *table_def_registres_p, char *msg_err)
+{
+	struct DefinitionInstruction_s *def_p=instruction_p->definition_p;
+	struct DefinitionRegistre_s *registre_p;
+	struct Lexeme_s *lexeme_p;
+	uint32_t code=def_p->motif;
+	long valeur;
+	unsigned int i;
+
+	for (i=0; i<def_p->nb_ops; i++) {
+		lexeme_p=instruction_p->operandes[i];
+		if (!lexeme_p) continue;
+
+		if (lexeme_p->nature==L_REGISTRE) {
+			if (!(registre_p=donnee_table(table_def_registres_p, lexeme_p->data))) {
+				strcpy(msg_err, "n'est pas un registre valide");
+				signaler_erreur_codage(instruction_p, i, msg_err);
+				return FAILURE;
+			}
+			valeur=registre_p->valeur;
+		} else if (lexeme_p->nature==L_NOMBRE) {
+			errno=0;
+			valeur=strtol(lexeme_p->data, NULL, 0);
+			if (errno) {
+				strcpy(msg_err, "n'a pas pu être évalué numériquement");
+				signaler_erreur_codage(instruction_p, i, msg_err);
+				return FAILURE;
+			}
+		} else if (!expression_constante(lexeme_p, &valeur))
+			continue; /* symbole ou expression relative à un symbole : sera traité par resoudre_instruction */
+
+		if (FAILURE==remplacer_champ(&code, def_p->champs[i], valeur, msg_err)) {
+			signaler_erreur_codage(instruction_p, i, msg_err);
+			return FAILURE;
+		}
+	}
+
+	instruction_p->code=code;
+	return SUCCESS;
+}
+
+/**
+ * @param etiquette_p pointeur sur l'étiquette
+ * @param adresses_base adresses de début de chaque section (indicées par Section_e), NULL pour des sections en 0
+ * @return adresse de l'étiquette
+ * @brief Calcule l'adresse d'une étiquette à partir de son décalage et de l'adresse de sa section
+ */
+uint32_t adresse_etiquette(struct Etiquette_s *etiquette_p, const uint32_t *adresses_base)
+{
+	return etiquette_p->decalage + (adresses_base ? adresses_base[etiquette_p->section] : 0);
+}
+
+/**
+ * @param instruction_p pointeur sur l'instruction dont il faut compléter le code
+ * @param table_etiquettes_p pointeur sur la table des étiquettes complète
+ * @param adresses_base adresses de début de chaque section (indicées par Section_e), NULL pour des sections en 0
+ * @param code_p pointeur sur le code à compléter (initialement le code de l'instruction)
+ * @return SUCCESS si tous les symboles connus ont pu être placés, FAILURE sinon
+ * @brief Complète un code machine avec l'adresse des symboles, les sections étant placées à des adresses données
+ *
+ * Sans adresses de base, un branchement vers une autre section que .text n'est pas résolu : l'écart entre
+ * deux sections n'est connu qu'une fois qu'elles sont placées. Une expression est évaluée ici : réduite à une
+ * différence d'étiquettes, elle est placée comme un nombre, relative à une étiquette, comme cette étiquette.
+ */
+int placer_instruction(struct Instruction_s *instruction_p, struct Table_s *table_etiquettes_p, const uint32_t *adresses_base, uint32_t *code_p)
+{
+	struct DefinitionInstruction_s *def_p=instruction_p->definition_p;
+	struct Etiquette_s *etiquette_p;
+	struct Lexeme_s *lexeme_p;
+	struct ValeurExpression_s valeur_expression;
+	enum PartieExpression_e partie;
+	char msg_err[STRLEN];
+	uint32_t adresse;
+	long valeur;
+	unsigned int i;
+
+	for (i=0; i<def_p->nb_ops; i++) {
+		lexeme_p=instruction_p->operandes[i];
+		if (!lexeme_p) continue;
+		partie=P_TOUT;
+		if (lexeme_p->nature==L_SYMBOLE) {
+			if (!(etiquette_p=donnee_table(table_etiquettes_p, lexeme_p->data))) continue;
+			adresse=adresse_etiquette(etiquette_p, adresses_base);
+		} else if ((lexeme_p->nature==L_EXPRESSION) && (!expression_constante(lexeme_p, NULL))) {
+			if (FAILURE==evaluer_expression((struct Expression_s *)lexeme_p, table_etiquettes_p, adresses_base, &valeur_expression, msg_err)) {
+				signaler_erreur_codage(instruction_p, i, msg_err);
+				return FAILURE;
+			}
+			if ((valeur_expression.symbole) && (!valeur_expression.etiquette_p)) continue;
+			etiquette_p=valeur_expression.etiquette_p;
+			adresse=valeur_expression.valeur;
+			partie=((struct Expression_s *)lexeme_p)->partie;
+		} else
+			continue;
+
+		if ((!etiquette_p) || (partie!=P_TOUT))
+			valeur=(partie!=P_TOUT) ? (long)adresse : (long)(int32_t)adresse;
+		else if (def_p->champs[i]=='o') {
+			if ((etiquette_p->section!=S_TEXT) && (!adresses_base)) continue;
+			valeur=((long)adresse - (long)(instruction_p->decalage + (adresses_base ? adresses_base[S_TEXT] : 0) + 4)) / 4;
+		} else if (def_p->champs[i]=='a')
+			valeur=(adresse >> 2) & 0x03FFFFFF;
+		else if ((def_p->champs[i]=='H') || (def_p->champs[i]=='L'))
+			valeur=(long)adresse;
+		else if (adresses_base) {
+			/* placée, l'adresse doit tenir entière dans le champ : %lo() en donne les 16 bits de poids faible */
+			if (adresse>(def_p->champs[i]=='h' ? 0x1FU : 0xFFFFU)) {
+				sprintf(msg_err, "est placé en 0x%08lX, qui ne tient pas sur %d bits (dépassement de relocation)",
+						(unsigned long)adresse, def_p->champs[i]=='h' ? 5 : 16);
+				signaler_erreur_codage(instruction_p, i, msg_err);
+				return FAILURE;
+			}
+			valeur=(long)adresse;
+		} else if (def_p->champs[i]=='h')
+			valeur=adresse & 0x1F;
+		else
+			valeur=adresse & 0xFFFF;
+
+		if (FAILURE==remplacer_champ(code_p, def_p->champs[i], valeur, msg_err)) {
+			signaler_erreur_codage(instruction_p, i, msg_err);
+			return FAILURE;
+		}
+	}
+	return SUCCESS;
+}
+
+/**
+ * @param instruction_p pointeur sur l'instruction dont il faut compléter le code
+ * @param table_etiquettes_p pointeur sur la table des étiquettes complète
+ * @return SUCCESS si tous les symboles connus ont pu être placés, FAILURE sinon
+ * @brief Complète le code machine de l'instruction avec la valeur des symboles
+ *
+ * Un symbole absent de la table des étiquettes n'est pas une erreur : son champ reste à zéro.
+ */
+int resoudre_instruction(struct Instruction_s *instruction_p, struct Table_s *table_etiquettes_p)
+{
+	return placer_instruction(instruction_p, table_etiquettes_p, NULL, &instruction_p->code);
+}
+
+/**
+ * @param premier_p pointeur sur le noeud de la première instruction du lot
+ * @param dernier_p pointeur sur le noeud de la dernière instruction du lot, NULL pour aller jusqu'en fin de liste
+ * @param table_def_registres_p pointeur sur la table "dico" des registres
+ * @return SUCCESS si toutes les instructions du lot ont pu être codées, FAILURE sinon
+ * @brief Code un lot consécutif d'instructions de la liste .text
+ *
+ * Le noeud suivant dernier_p n'est jamais lu, la liste peut donc continuer à grandir pendant le codage.
+ */
+int encoder_lot_instructions(struct NoeudListe_s *premier_p, struct NoeudListe_s *dernier_p, struct Table_s *table_def_registres_p)
+{
+	struct NoeudListe_s *noeud_p;
+	char msg_err[STRLEN];
+	int resultat=SUCCESS;
+
+	for (noeud_p=premier_p; noeud_p; noeud_p=noeud_p->suivant_p) {
+		if (FAILURE==encoder_instruction((struct Instruction_s *)noeud_p->donnee_p, table_def_registres_p, msg_err))
+			resultat=FAILURE;
+		if (noeud_p==dernier_p) break;
+	}
+	return resultat;
+}
+
+/**
+ * @param liste_text_p pointeur sur la liste des instructions de la section .text
+ * @param table_etiquettes_p pointeur sur la table des étiquettes complète
+ * @return SUCCESS si tous les symboles connus ont pu être placés, FAILURE sinon
+ * @brief Complète le code de toutes les instructions faisant référence à des symboles
+ */
+int resoudre_liste_instructions(struct Liste_s *liste_text_p, struct Table_s *table_etiquettes_p)
+{
+	struct NoeudListe_s *noeud_p;
+	int resultat=SUCCESS;
+
+	if (liste_text_p)
+		for (noeud_p=liste_text_p->debut_liste_p; noeud_p; noeud_p=noeud_p->suivant_p)
+			if (FAILURE==resoudre_instruction((struct Instruction_s *)noeud_p->donnee_p, table_etiquettes_p))
+				resultat=FAILURE;
+	return resultat;
+}
+
+/**
+ * @param liste_text_p pointeur sur la liste des instructions de la section .text
+ * @param table_def_registres_p pointeur sur la table "dico" des registres
+ * @param table_etiquettes_p pointeur sur la table des étiquettes complète
+ * @return SUCCESS si toutes les instructions ont pu être codées, FAILURE sinon
+ * @brief Génère le code machine de toutes les instructions de la section .text
+ */
+int generer_code(struct Liste_s *liste_text_p, struct Table_s *table_def_registres_p, struct Table_s *table_etiquettes_p)
+{
+	struct Profil_s *profil_p=profil_courant();
+	int resultat=SUCCESS;
+
+	if (liste_text_p) {
+		profil_debut(profil_p, ETAPE_CODAGE);
+		resultat=encoder_lot_instructions(liste_text_p->debut_liste_p, NULL, table_def_registres_p);
+		profil_fin(profil_p, ETAPE_CODAGE);
+		profil_debut(profil_p, ETAPE_RESOLUTION);
+		if (FAILURE==resoudre_liste_instructions(liste_text_p, table_etiquettes_p))
+			resultat=FAILURE;
+		profil_fin(profil_p, ETAPE_RESOLUTION);
+	}
+	return resultat;
+}
+
+/**
+ * @param mot mot de 32 bits dans l'ordre de la machine hôte
+ * @param gros_boutiste TRUE pour une cible gros-boutiste, FALSE pour une cible petit-boutiste
+ * @return le mot dont les octets, rangés en mémoire, sont dans l'ordre de la cible
+ * @brief Convertit un mot de 32 bits dans l'ordre des octets de la cible
+ */
+uint32_t mot_cible(uint32_t mot, int gros_boutiste)
+{
+	const uint16_t test=1;
+	int hote_gros_boutiste=!*(const uint8_t *)&test;
+
+	return (hote_gros_boutiste==(gros_boutiste!=FALSE)) ? mot : __builtin_bswap32(mot);
+}
+
+/**
+ * @param demi_mot mot de 16 bits dans l'ordre de la machine hôte
+ * @param gros_boutiste TRUE pour une cible gros-boutiste, FALSE pour une cible petit-boutiste
+ * @return le demi-mot dont les octets, rangés en mémoire, sont dans l'ordre de la cible
+ * @brief Convertit un mot de 16 bits dans l'ordre des octets de la cible
+ */
+uint16_t demi_mot_cible(uint16_t demi_mot, int gros_boutiste)
+{
+	const uint16_t test=1;
+	int hote_gros_boutiste=!*(const uint8_t *)&test;
+
+	return (hote_gros_boutiste==(gros_boutiste!=FALSE)) ? demi_mot : __builtin_bswap16(demi_mot);
+}
+
+/**
+ * @param donnee_p pointeur sur la donnée
+ * @return nombre d'octets occupés par la donnée dans sa section
+ * @brief Renvoie la taille d'une donnée des sections .data ou .bss
+ */
+uint32_t taille_donnee(struct Donnee_s *donnee_p)
+{
+	switch (donnee_p->type) {
+	case D_BYTE: return 1;
+	case D_WORD: return 4;
+	case D_ASCIIZ: return donnee_p->valeur.chaine ? 1+strlen(donnee_p->valeur.chaine) : 0;
+	case D_SPACE: return donnee_p->valeur.nbOctets;
+	default: return 0;
+	}
+}
+
+/**
+ * @param liste_p pointeur sur la liste des instructions (.text) ou des données (.data, .bss)
+ * @param section section correspondant à la liste
+ * @return taille en octets de la section
+ * @brief Calcule la taille d'une section à partir de son dernier élément
+ */
+uint32_t taille_section(struct Liste_s *liste_p, enum Section_e section)
+{
+	struct Donnee_s *donnee_p;
+
+	if ((!liste_p) || (!liste_p->fin_liste_p)) return 0;
+	if (section==S_TEXT)
+		return ((struct Instruction_s *)liste_p->fin_liste_p->donnee_p)->decalage+4;
+
+	donnee_p=(struct Donnee_s *)liste_p->fin_liste_p->donnee_p;
+	return donnee_p->decalage+taille_donnee(donnee_p);
+}
+
+/**
+ * @param liste_text_p pointeur sur la liste des instructions codées et résolues
+ * @param table_etiquettes_p pointeur sur la table des étiquettes complète
+ * @param adresses_base adresses de début de chaque section, NULL pour garder le code résolu avec des sections en 0
+ * @param gros_boutiste TRUE pour une cible gros-boutiste
+ * @param contenu_p contenu de la section, d'au moins taille_section octets
+ * @return SUCCESS si toutes les instructions ont pu être placées, FAILURE si une adresse ne tient pas dans son champ
+ * @brief Ecrit le code des instructions dans le contenu de la section .text
+ */
+int remplir_section_text(struct Liste_s *liste_text_p, struct Table_s *table_etiquettes_p, const uint32_t *adresses_base,
+		int gros_boutiste, uint8_t *contenu_p)
+{
+	struct NoeudListe_s *noeud_p;
+	struct Instruction_s *instruction_p;
+	uint32_t mot;
+	int resultat=SUCCESS;
+
+	for (noeud_p=liste_text_p ? liste_text_p->debut_liste_p : NULL; noeud_p; noeud_p=noeud_p->suivant_p) {
+		instruction_p=(struct Instruction_s *)noeud_p->donnee_p;
+		mot=instruction_p->code;
+		if ((adresses_base) && (FAILURE==placer_instruction(instruction_p, table_etiquettes_p, adresses_base, &mot)))
+			resultat=FAILURE;
+		mot=mot_cible(mot, gros_boutiste);
+		memcpy(contenu_p+instruction_p->decalage, &mot, 4);
+	}
+	return resultat;
+}
+
+/**
+ * @param liste_text_p pointeur sur la liste des instructions codées et résolues
+ * @param table_etiquettes_p pointeur sur la table des étiquettes complète
+ * @param adresses_base adresses de début de chaque section, NULL pour garder le code résolu avec des sections en 0
+ * @param taille taille de la section en octets (cf. taille_section)
+ * @param gros_boutiste TRUE pour une cible gros-boutiste
+ * @return pointeur sur le contenu de la section, à libérer par free ; NULL si une adresse placée ne tient pas dans son champ
+ * @brief Construit le contenu binaire de la section .text
+ */
+uint8_t *construire_section_text(struct Liste_s *liste_text_p, struct Table_s *table_etiquettes_p, const uint32_t *adresses_base,
+		uint32_t taille, int gros_boutiste)
+{
+	uint8_t *contenu_p=calloc(taille ? taille : 1, 1);
+
+	if (!contenu_p) ERROR_MSG("Impossible de créer le contenu de la section .text");
+	if (FAILURE==remplir_section_text(liste_text_p, table_etiquettes_p, adresses_base, gros_boutiste, contenu_p)) {
+		free(contenu_p);
+		return NULL;
+	}
+	return contenu_p;
+}
+
+/**
+ * @param liste_data_p pointeur sur la liste des données de la section
+ * @param table_etiquettes_p pointeur sur la table des étiquettes complète
+ * @param adresses_base adresses de début de chaque section, NULL pour des sections en 0
+ * @param gros_boutiste TRUE pour une cible gros-boutiste
+ * @param contenu_p contenu de la section, d'au moins taille_section octets et mis à zéro
+ * @return Rien
+ * @brief Ecrit les données dans le contenu d'une section de données
+ *
+ * Un .word symbolique reçoit l'adresse de l'étiquette, 0 si elle est inconnue.
+ */
+void remplir_section_donnees(struct Liste_s *liste_data_p, struct Table_s *table_etiquettes_p, const uint32_t *adresses_base,
+		int gros_boutiste, uint8_t *contenu_p)
+{
+	struct NoeudListe_s *noeud_p;
+	struct Donnee_s *donnee_p;
+	struct Etiquette_s *etiquette_p;
+	uint32_t mot;
+
+	for (noeud_p=liste_data_p ? liste_data_p->debut_liste_p : NULL; noeud_p; noeud_p=noeud_p->suivant_p) {
+		donnee_p=(struct Donnee_s *)noeud_p->donnee_p;
+		switch (donnee_p->type) {
+		case D_BYTE:
+			contenu_p[donnee_p->decalage]=donnee_p->valeur.octetNS;
+			break;
+		case D_WORD:
+			mot=donnee_p->valeur.motNS;
+			if (donnee_p->lexeme_p->nature==L_SYMBOLE)
+				mot=(etiquette_p=donnee_table(table_etiquettes_p, donnee_p->lexeme_p->data)) ? adresse_etiquette(etiquette_p, adresses_base) : 0;
+			mot=mot_cible(mot, gros_boutiste);
+			memcpy(contenu_p+donnee_p->decalage, &mot, 4);
+			break;
+		case D_ASCIIZ:
+			if (donnee_p->valeur.chaine)
+				memcpy(contenu_p+donnee_p->decalage, donnee_p->valeur.chaine, 1+strlen(donnee_p->valeur.chaine));
+			break;
+		default: /* .space : déjà à zéro */
+			break;
+		}
+	}
+}
+
+/**
+ * @param liste_data_p pointeur sur la liste des données de la section
+ * @param table_etiquettes_p pointeur sur la table des étiquettes complète
+ * @param adresses_base adresses de début de chaque section, NULL pour des sections en 0
+ * @param taille taille de la section en octets (cf. taille_section)
+ * @param gros_boutiste TRUE pour une cible gros-boutiste
+ * @return pointeur sur le contenu de la section, à libérer par free
+ * @brief Construit le contenu binaire d'une section de données
+ */
+uint8_t *construire_section_donnees(struct Liste_s *liste_data_p, struct Table_s *table_etiquettes_p, const uint32_t *adresses_base,
+		uint32_t taille, int gros_boutiste)
+{
+	uint8_t *contenu_p=calloc(taille ? taille : 1, 1);
+
+	if (!contenu_p) ERROR_MSG("Impossible de créer le contenu d'une section de données");
+	remplir_section_donnees(liste_data_p, table_etiquettes_p, adresses_base, gros_boutiste, contenu_p);
+	return contenu_p;
+}
@@ -0,0 +1,436 @@
+/**
+ * @file graphe.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions du graphe de flot de contrôle de .text
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <global.h>
+#include <notify.h>
+#include <liste.h>
+#include <table.h>
+#include <dico.h>
+#include <lex.h>
+#include <syn.h>
+#include <diag.h>
+#include <sortie.h>
+#include <dependances.h>
+#include <simulation.h>
+#include <graphe.h>
+
+/**
+ * @enum FinBloc_e
+ * @brief Effet d'une instruction sur la suite de l'exécution
+ */
+enum FinBloc_e {
+	FIN_AUCUNE,				/* passe à l'instruction suivante */
+	FIN_BRANCHEMENT,		/* branchement conditionnel */
+	FIN_SAUT,				/* saut J */
+	FIN_APPEL,				/* appel JAL */
+	FIN_INDIRECT			/* saut JR, cible inconnue */
+};
+
+static const char *NOMS_ARCS[]={"suite", "branchement", "saut", "appel"};
+
+/**
+ * @param instruction_p pointeur sur une instruction résolue
+ * @return effet de l'instruction sur la suite de l'exécution
+ */
+enum FinBloc_e fin_bloc(const struct Instruction_s *instruction_p)
+{
+	const struct DefinitionInstruction_s *definition_p=instruction_p->definition_p;
+	unsigned int nature=nature_instruction(definition_p);
+
+	/* BEQ $zero, $zero (l'expansion de B) est toujours pris : il n'a pas de suite */
+	if (nature & EFFET_BRANCHEMENT)
+		return ((!strcmp(definition_p->nom, "BEQ")) && (!(instruction_p->code & 0x03FF0000))) ? FIN_SAUT : FIN_BRANCHEMENT;
+	if (!(nature & EFFET_SAUT)) return FIN_AUCUNE;
+	if (!strchr(definition_p->champs, 'a')) return FIN_INDIRECT;
+	if ((definition_p->effets_p) && (definition_p->effets_p->ecrits & BIT_REGISTRE(REGISTRE_RA))) return FIN_APPEL;
+	return FIN_SAUT;
+}
+
+/**
+ * @param instruction_p pointeur sur un branchement ou un saut direct
+ * @param table_etiquettes_p pointeur sur la table des étiquettes
+ * @param par_mot indice de l'instruction de chaque mot de .text, GRAPHE_AUCUN s'il n'y en a pas
+ * @param nb_mots nombre de mots de .text
+ * @return indice de l'instruction visée, GRAPHE_AUCUN si elle n'est pas dans .text
+ * @brief Résout la cible par la table des étiquettes, ou par le code quand l'opérande n'est pas un symbole
+ */
+uint32_t cible_graphe(struct Instruction_s *instruction_p, struct Table_s *table_etiquettes_p, const uint32_t *par_mot, uint32_t nb_mots)
+{
+	struct Lexeme_s *operande_p=instruction_p->definition_p->nb_ops ? instruction_p->operandes[instruction_p->definition_p->nb_ops-1] : NULL;
+	struct Etiquette_s *etiquette_p;
+	uint32_t decalage;
+
+	if ((operande_p) && (operande_p->nature==L_SYMBOLE)) {
+		etiquette_p=donnee_table(table_etiquettes_p, operande_p->data);
+		if ((!etiquette_p) || (etiquette_p->section!=S_TEXT)) return GRAPHE_AUCUN;
+		decalage=etiquette_p->decalage;
+	} else if (strchr(instruction_p->definition_p->champs, 'o'))
+		decalage=instruction_p->decalage+4+4*(uint32_t)(int32_t)(int16_t)(instruction_p->code & 0xFFFF);
+	else
+		decalage=((instruction_p->decalage+4) & 0xF0000000) | ((instruction_p->code & 0x03FFFFFF) << 2);
+	if ((decalage & 3) || (decalage/4>=nb_mots)) return GRAPHE_AUCUN;
+	return par_mot[decalage/4];
+}
+
+/**
+ * @param graphe_p pointeur sur le graphe en construction
+ * @param origine indice du bloc de départ
+ * @param destination indice de l'instruction d'arrivée, GRAPHE_AUCUN accepté
+ * @param nature raison du passage
+ * @return Rien
+ * @brief Ajoute un arc vers le bloc d'une instruction, sauf s'il existe déjà
+ */
+void ajouter_arc(struct GrapheFlot_s *graphe_p, uint32_t origine, uint32_t destination, enum NatureArc_e nature)
+{
+	struct BlocGraphe_s *bloc_p=graphe_p->blocs+origine;
+	struct ArcGraphe_s *arc_p;
+	uint32_t a;
+
+	if ((destination==GRAPHE_AUCUN) || (destination>=graphe_p->nb_instructions)) return;
+	destination=graphe_p->blocs_instructions[destination];
+	for (a=0; a<bloc_p->nb_successeurs; a++)
+		if (graphe_p->arcs[bloc_p->premier_successeur+a].destination==destination) return;
+	arc_p=graphe_p->arcs+graphe_p->nb_arcs++;
+	arc_p->origine=origine;
+	arc_p->destination=destination;
+	arc_p->nature=nature;
+	bloc_p->nb_successeurs++;
+}
+
+/**
+ * @param liste_text_p pointeur sur la liste des instructions de .text, résolues
+ * @param table_etiquettes_p pointeur sur la table des étiquettes
+ * @return graphe de flot de contrôle de .text
+ * @brief Découpe .text en blocs de base et relie chaque bloc à ses successeurs et à ses prédécesseurs
+ */
+struct GrapheFlot_s *creer_graphe(struct Liste_s *liste_text_p, struct Table_s *table_etiquettes_p)
+{
+	struct GrapheFlot_s *graphe_p=calloc(1, sizeof(*graphe_p));
+	struct NoeudListe_s *noeud_p;
+	struct Etiquette_s *etiquette_p;
+	struct BlocGraphe_s *bloc_p;
+	struct Instruction_s *instruction_p;
+	uint32_t *par_mot, *cibles, nb_mots=0, n, i, k, b, a, dernier;
+	unsigned char *tetes, *fins;
+	const char **noms;
+	size_t e;
+
+	if (!graphe_p) ERROR_MSG("Impossible de créer le graphe de flot de contrôle");
+	n=graphe_p->nb_instructions=(uint32_t)liste_text_p->nbElements;
+	graphe_p->instructions=malloc((n+1)*sizeof(*graphe_p->instructions));
+	graphe_p->blocs_instructions=malloc((n+1)*sizeof(*graphe_p->blocs_instructions));
+	cibles=malloc((n+1)*sizeof(*cibles));
+	tetes=calloc(n+1, sizeof(*tetes));
+	fins=calloc(n+1, sizeof(*fins));
+	noms=calloc(n+1, sizeof(*noms));
+	if ((!graphe_p->instructions) || (!graphe_p->blocs_instructions) || (!cibles) || (!tetes) || (!fins) || (!noms))
+		ERROR_MSG("Impossible de créer le graphe de flot de contrôle");
+
+	/* les instructions sont numérotées dans l'ordre de .text, chaque mot renvoyant à la sienne */
+	for (i=0, noeud_p=liste_text_p->debut_liste_p; noeud_p; noeud_p=noeud_p->suivant_p, i++) {
+		graphe_p->instructions[i]=instruction_p=noeud_p->donnee_p;
+		if (instruction_p->decalage/4>=nb_mots) nb_mots=instruction_p->decalage/4+1;
+	}
+	if (!(par_mot=malloc((nb_mots+1)*sizeof(*par_mot)))) ERROR_MSG("Impossible de créer le graphe de flot de contrôle");
+	for (k=0; k<nb_mots; k++) par_mot[k]=GRAPHE_AUCUN;
+	for (i=0; i<n; i++) par_mot[graphe_p->instructions[i]->decalage/4]=i;
+
+	/* têtes de bloc : le début, les étiquettes, les cibles, et l'instruction qui suit un délai */
+	if (n) tetes[0]=TRUE;
+	for (e=0; e<table_etiquettes_p->nbEltsMax; e++)
+		if (((etiquette_p=table_etiquettes_p->table[e])) && (etiquette_p->section==S_TEXT) && (etiquette_p->decalage/4<nb_mots)
+				&& ((k=par_mot[etiquette_p->decalage/4])!=GRAPHE_AUCUN)) {
+			tetes[k]=TRUE;
+			if ((!noms[k]) || (strcmp(etiquette_p->lexeme_p->data, noms[k])<0)) noms[k]=etiquette_p->lexeme_p->data;
+		}
+	for (i=0; i<n; i++) {
+		cibles[i]=GRAPHE_AUCUN;
+		instruction_p=graphe_p->instructions[i];
+		fins[i]=(unsigned char)fin_bloc(instruction_p);
+		if (fins[i]==FIN_AUCUNE) continue;
+		if (fins[i]!=FIN_INDIRECT)
+			if ((cibles[i]=cible_graphe(instruction_p, table_etiquettes_p, par_mot, nb_mots))!=GRAPHE_AUCUN) tetes[cibles[i]]=TRUE;
+		if (i+2<n) tetes[i+2]=TRUE;
+	}
+
+	for (i=0; i<n; i++) graphe_p->nb_blocs+=tetes[i];
+	graphe_p->blocs=calloc(graphe_p->nb_blocs+1, sizeof(*graphe_p->blocs));
+	graphe_p->arcs=malloc((2*graphe_p->nb_blocs+1)*sizeof(*graphe_p->arcs));
+	if ((!graphe_p->blocs) || (!graphe_p->arcs)) ERROR_MSG("Impossible de créer les blocs du graphe de flot de contrôle");
+	for (i=0, b=GRAPHE_AUCUN; i<n; i++) {
+		instruction_p=graphe_p->instructions[i];
+		if (tetes[i]) {
+			bloc_p=graphe_p->blocs+(++b);
+			bloc_p->premiere_instruction=i;
+			bloc_p->decalage=instruction_p->decalage;
+			bloc_p->premiere_ligne=instruction_p->ligne;
+			bloc_p->etiquette=noms[i];
+		}
+		graphe_p->blocs_instructions[i]=b;
+		if (instruction_p->ligne<bloc_p->premiere_ligne) bloc_p->premiere_ligne=instruction_p->ligne;
+		if (instruction_p->ligne>bloc_p->derniere_ligne) bloc_p->derniere_ligne=instruction_p->ligne;
+		bloc_p->nb_instructions++;
+	}
+
+	/* le bloc suit le branchement de son avant-dernière instruction (la dernière est le délai), sinon passe au suivant */
+	for (b=0; b<graphe_p->nb_blocs; b++) {
+		bloc_p=graphe_p->blocs+b;
+		bloc_p->premier_successeur=graphe_p->nb_arcs;
+		dernier=bloc_p->premiere_instruction+bloc_p->nb_instructions-1;
+		k=((dernier>0) && (fins[dernier-1]!=FIN_AUCUNE)) ? dernier-1 : GRAPHE_AUCUN;
+		if (k==GRAPHE_AUCUN) {
+			ajouter_arc(graphe_p, b, dernier+1, ARC_SUITE);
+			continue;
+		}
+		if ((fins[k]!=FIN_INDIRECT) && (cibles[k]==GRAPHE_AUCUN)) bloc_p->cible_inconnue=TRUE;
+		switch (fins[k]) {
+		case FIN_BRANCHEMENT:
+			ajouter_arc(graphe_p, b, cibles[k], ARC_BRANCHEMENT);
+			ajouter_arc(graphe_p, b, dernier+1, ARC_SUITE);
+			break;
+		case FIN_SAUT:
+			ajouter_arc(graphe_p, b, cibles[k], ARC_SAUT);
+			break;
+		case FIN_APPEL:
+			ajouter_arc(graphe_p, b, cibles[k], ARC_APPEL);
+			ajouter_arc(graphe_p, b, dernier+1, ARC_SUITE);
+			break;
+		default:
+			bloc_p->indirect=TRUE;
+			break;
+		}
+	}
+
+	/* les prédécesseurs : décompte par bloc d'arrivée, puis rangement des arcs à la place de chaque bloc */
+	if (!(graphe_p->predecesseurs=malloc((graphe_p->nb_arcs+1)*sizeof(*graphe_p->predecesseurs))))
+		ERROR_MSG("Impossible de créer les prédécesseurs du graphe de flot de contrôle");
+	for (a=0; a<graphe_p->nb_arcs; a++) graphe_p->blocs[graphe_p->arcs[a].destination].nb_predecesseurs++;
+	for (b=0, k=0; b<graphe_p->nb_blocs; b++) {
+		graphe_p->blocs[b].premier_predecesseur=k;
+		k+=graphe_p->blocs[b].nb_predecesseurs;
+		graphe_p->blocs[b].nb_predecesseurs=0;
+	}
+	for (a=0; a<graphe_p->nb_arcs; a++) {
+		bloc_p=graphe_p->blocs+graphe_p->arcs[a].destination;
+		graphe_p->predecesseurs[bloc_p->premier_predecesseur+bloc_p->nb_predecesseurs++]=a;
+	}
+
+	free(par_mot);
+	free(cibles);
+	free(tetes);
+	free(fins);
+	free(noms);
+	return graphe_p;
+}
+
+/**
+ * @param graphe_p pointeur sur le graphe, NULL accepté
+ * @return NULL
+ */
+struct GrapheFlot_s *detruire_graphe(struct GrapheFlot_s *graphe_p)
+{
+	if (graphe_p) {
+		free(graphe_p->instructions);
+		free(graphe_p->blocs_instructions);
+		free(graphe_p->blocs);
+		free(graphe_p->arcs);
+		free(graphe_p->predecesseurs);
+		free(graphe_p);
+	}
+	return NULL;
+}
+
+/**
+ * @param graphe_p pointeur sur le graphe
+ * @param simulation_p pointeur sur la simulation exécutée du même assemblage
+ * @return Rien
+ * @brief Reporte sur chaque bloc le nombre d'exécutions de sa première instruction
+ */
+void annoter_graphe(struct GrapheFlot_s *graphe_p, const struct Simulation_s *simulation_p)
+{
+	uint32_t b, mot;
+
+	for (b=0; b<graphe_p->nb_blocs; b++) {
+		mot=graphe_p->blocs[b].decalage/4;
+		graphe_p->blocs[b].executions=(mot<simulation_p->nb_operations) ? simulation_p->operations[mot].executions : 0;
+	}
+	graphe_p->annote=TRUE;
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param graphe_p pointeur sur le graphe
+ * @param source nom du fichier source
+ * @return Rien
+ * @brief Ecrit le graphe pour Graphviz ; les blocs les plus exécutés sont les plus rouges
+ */
+void ecrire_graphe_dot(struct Sortie_s *sortie_p, const struct GrapheFlot_s *graphe_p, const char *source)
+{
+	const struct BlocGraphe_s *bloc_p;
+	const struct ArcGraphe_s *arc_p;
+	unsigned long plus_grand=0;
+	char couleur[32];
+	uint32_t b, a;
+
+	for (b=0; b<graphe_p->nb_blocs; b++)
+		if (graphe_p->blocs[b].executions>plus_grand) plus_grand=graphe_p->blocs[b].executions;
+
+	sortie_chaine(sortie_p, "digraph ");
+	sortie_chaine_json(sortie_p, source);
+	sortie_chaine(sortie_p, " {\n\tnode [shape=box, fontname=\"monospace\"];\n");
+	for (b=0; b<graphe_p->nb_blocs; b++) {
+		bloc_p=graphe_p->blocs+b;
+		sortie_chaine(sortie_p, "\tb");
+		sortie_decimal(sortie_p, b, 0);
+		sortie_chaine(sortie_p, " [label=\"");
+		if (bloc_p->etiquette) {
+			sortie_chaine(sortie_p, bloc_p->etiquette);
+			sortie_chaine(sortie_p, "\\n");
+		}
+		sortie_chaine(sortie_p, "0x");
+		sortie_hex(sortie_p, bloc_p->decalage, 8);
+		sortie_chaine(sortie_p, "  lignes ");
+		sortie_decimal(sortie_p, bloc_p->premiere_ligne, 0);
+		sortie_caractere(sortie_p, '-');
+		sortie_decimal(sortie_p, bloc_p->derniere_ligne, 0);
+		sortie_chaine(sortie_p, "\\n");
+		sortie_decimal(sortie_p, bloc_p->nb_instructions, 0);
+		sortie_chaine(sortie_p, " instructions, ");
+		sortie_decimal(sortie_p, 4*(unsigned long)bloc_p->nb_instructions, 0);
+		sortie_chaine(sortie_p, " octets");
+		if (graphe_p->annote) {
+			sortie_chaine(sortie_p, "\\n");
+			sortie_decimal(sortie_p, bloc_p->executions, 0);
+			sortie_chaine(sortie_p, " exécutions");
+		}
+		if (bloc_p->cible_inconnue) sortie_chaine(sortie_p, "\\n(cible hors de .text)");
+		sortie_caractere(sortie_p, '"');
+		if (bloc_p->indirect) sortie_chaine(sortie_p, ", peripheries=2");
+		if ((graphe_p->annote) && (bloc_p->executions)) {
+			sprintf(couleur, "%.3f", (double)bloc_p->executions/plus_grand);
+			sortie_chaine(sortie_p, ", style=filled, fillcolor=\"0.000 ");
+			sortie_chaine(sortie_p, couleur);
+			sortie_chaine(sortie_p, " 1.000\"");
+		}
+		sortie_chaine(sortie_p, "];\n");
+	}
+	for (a=0; a<graphe_p->nb_arcs; a++) {
+		arc_p=graphe_p->arcs+a;
+		sortie_chaine(sortie_p, "\tb");
+		sortie_decimal(sortie_p, arc_p->origine, 0);
+		sortie_chaine(sortie_p, " -> b");
+		sortie_decimal(sortie_p, arc_p->destination, 0);
+		switch (arc_p->nature) {
+		case ARC_BRANCHEMENT: sortie_chaine(sortie_p, " [label=\"pris\"]"); break;
+		case ARC_SAUT: sortie_chaine(sortie_p, " [style=bold]"); break;
+		case ARC_APPEL: sortie_chaine(sortie_p, " [style=dashed, label=\"appel\"]"); break;
+		default: break;
+		}
+		sortie_chaine(sortie_p, ";\n");
+	}
+	sortie_chaine(sortie_p, "}\n");
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param graphe_p pointeur sur le graphe
+ * @param source nom du fichier source
+ * @return Rien
+ * @brief Ecrit le graphe en JSON, un bloc puis un arc par ligne
+ */
+void ecrire_graphe_json(struct Sortie_s *sortie_p, const struct GrapheFlot_s *graphe_p, const char *source)
+{
+	const struct BlocGraphe_s *bloc_p;
+	uint32_t b, a;
+
+	sortie_chaine(sortie_p, "{\"source\":");
+	sortie_chaine_json(sortie_p, source);
+	sortie_chaine(sortie_p, graphe_p->annote ? ",\"annote\":true,\"blocs\":[\n" : ",\"annote\":false,\"blocs\":[\n");
+	for (b=0; b<graphe_p->nb_blocs; b++) {
+		bloc_p=graphe_p->blocs+b;
+		sortie_chaine(sortie_p, "{\"id\":");
+		sortie_decimal(sortie_p, b, 0);
+		sortie_chaine(sortie_p, ",\"decalage\":");
+		sortie_decimal(sortie_p, bloc_p->decalage, 0);
+		sortie_chaine(sortie_p, ",\"etiquette\":");
+		if (bloc_p->etiquette) sortie_chaine_json(sortie_p, bloc_p->etiquette);
+		else sortie_chaine(sortie_p, "null");
+		sortie_chaine(sortie_p, ",\"lignes\":[");
+		sortie_decimal(sortie_p, bloc_p->premiere_ligne, 0);
+		sortie_caractere(sortie_p, ',');
+		sortie_decimal(sortie_p, bloc_p->derniere_ligne, 0);
+		sortie_chaine(sortie_p, "],\"instructions\":");
+		sortie_decimal(sortie_p, bloc_p->nb_instructions, 0);
+		sortie_chaine(sortie_p, ",\"octets\":");
+		sortie_decimal(sortie_p, 4*(unsigned long)bloc_p->nb_instructions, 0);
+		sortie_chaine(sortie_p, bloc_p->indirect ? ",\"indirect\":true" : ",\"indirect\":false");
+		sortie_chaine(sortie_p, bloc_p->cible_inconnue ? ",\"cible_inconnue\":true" : ",\"cible_inconnue\":false");
+		if (graphe_p->annote) {
+			sortie_chaine(sortie_p, ",\"executions\":");
+			sortie_decimal(sortie_p, bloc_p->executions, 0);
+		}
+		sortie_chaine(sortie_p, ",\"successeurs\":[");
+		for (a=0; a<bloc_p->nb_successeurs; a++) {
+			if (a) sortie_caractere(sortie_p, ',');
+			sortie_decimal(sortie_p, graphe_p->arcs[bloc_p->premier_successeur+a].destination, 0);
+		}
+		sortie_chaine(sortie_p, "],\"predecesseurs\":[");
+		for (a=0; a<bloc_p->nb_predecesseurs; a++) {
+			if (a) sortie_caractere(sortie_p, ',');
+			sortie_decimal(sortie_p, graphe_p->arcs[graphe_p->predecesseurs[bloc_p->premier_predecesseur+a]].origine, 0);
+		}
+		sortie_chaine(sortie_p, (b+1<graphe_p->nb_blocs) ? "]},\n" : "]}\n");
+	}
+	sortie_chaine(sortie_p, "],\"arcs\":[\n");
+	for (a=0; a<graphe_p->nb_arcs; a++) {
+		sortie_chaine(sortie_p, "{\"origine\":");
+		sortie_decimal(sortie_p, graphe_p->arcs[a].origine, 0);
+		sortie_chaine(sortie_p, ",\"destination\":");
+		sortie_decimal(sortie_p, graphe_p->arcs[a].destination, 0);
+		sortie_chaine(sortie_p, ",\"nature\":\"");
+		sortie_chaine(sortie_p, NOMS_ARCS[graphe_p->arcs[a].nature]);
+		sortie_chaine(sortie_p, (a+1<graphe_p->nb_arcs) ? "\"},\n" : "\"}\n");
+	}
+	sortie_chaine(sortie_p, "]}\n");
+}
+
+/**
+ * @param nom_fichier nom du fichier à créer
+ * @param graphe_p pointeur sur le graphe
+ * @param json TRUE pour écrire du JSON, FALSE pour du DOT (Graphviz)
+ * @param source nom du fichier source, qui nomme le graphe
+ * @return SUCCESS si le fichier a été écrit, FAILURE sinon
+ */
+int ecrire_graphe(const char *nom_fichier, const struct GrapheFlot_s *graphe_p, int json, const char *source)
+{
+	struct Sortie_s *sortie_p;
+	int descripteur, resultat;
+
+	if ((descripteur=open(nom_fichier, O_WRONLY | O_CREAT | O_TRUNC, 0666))<0) {
+		diag_signaler(NULL, DIAG_ERREUR, nom_fichier, 0, "graphe", "impossible de créer le fichier du graphe : %s", strerror(errno));
+		return FAILURE;
+	}
+	sortie_p=creer_sortie(descripteur, 0);
+	if (json) ecrire_graphe_json(sortie_p, graphe_p, source);
+	else ecrire_graphe_dot(sortie_p, graphe_p, source);
+	resultat=vider_sortie(sortie_p);
+	if (resultat==FAILURE)
+		diag_signaler(NULL, DIAG_ERREUR, nom_fichier, 0, "graphe", "impossible d'écrire le fichier du graphe : %s", strerror(errno));
+	sortie_p=detruire_sortie(sortie_p);
+	if ((close(descripteur)) && (resultat==SUCCESS)) {
+		diag_signaler(NULL, DIAG_ERREUR, nom_fichier, 0, "graphe", "impossible de terminer le fichier du graphe : %s", strerror(errno));
+		resultat=FAILURE;
+	}
+	return resultat;
+}
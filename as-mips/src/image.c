@@ -0,0 +1,380 @@
+/**
+ * @file image.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions d'écriture d'images mémoire (binaire brut, Intel HEX, S-record)
+ *
+ * Les sections sont placées à leur adresse de base puis envoyées à travers une sortie tamponnée. Les lignes
+ * Intel HEX et S-record sont mises en forme directement dans le tampon. Le contenu de .bss n'est jamais
+ * construit : les zéros de l'image binaire et les trous sont écrits tampon par tampon.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <global.h>
+#include <notify.h>
+#include <liste.h>
+#include <table.h>
+#include <dico.h>
+#include <lex.h>
+#include <syn.h>
+#include <gen.h>
+#include <sortie.h>
+#include <image.h>
+
+static const char CHIFFRES_HEX_MAJ[]="0123456789ABCDEF";
+
+/**
+ * @param parametres_p pointeur sur les paramètres à initialiser
+ * @return Rien
+ * @brief Paramètres par défaut : ELF, .text en 0, les autres sections à la suite, trous remplis de zéros
+ */
+void initialiser_parametres_image(struct ParametresImage_s *parametres_p)
+{
+	memset(parametres_p, 0, sizeof(*parametres_p));
+	parametres_p->format=SORTIE_ELF;
+	parametres_p->base_fixee[S_TEXT]=TRUE;
+	parametres_p->gros_boutiste=TRUE;
+}
+
+/**
+ * @param nom nom du format ("elf", "binary", "ihex" ou "srec")
+ * @param format_p pointeur recevant le format
+ * @return SUCCESS si le nom est reconnu, FAILURE sinon
+ * @brief Convertit un nom de format de sortie
+ */
+int format_sortie(const char *nom, enum FormatSortie_e *format_p)
+{
+	if (!strcmp(nom, "elf")) *format_p=SORTIE_ELF;
+	else if (!strcmp(nom, "binary")) *format_p=SORTIE_BINAIRE;
+	else if (!strcmp(nom, "ihex")) *format_p=SORTIE_IHEX;
+	else if (!strcmp(nom, "srec")) *format_p=SORTIE_SREC;
+	else return FAILURE;
+	return SUCCESS;
+}
+
+/**
+ * @param place_p endroit où écrire les deux chiffres
+ * @param octet octet à écrire
+ * @return pointeur juste après les deux chiffres
+ * @brief Met en forme un octet en deux chiffres hexadécimaux majuscules
+ */
+char *hex_octet(char *place_p, uint8_t octet)
+{
+	place_p[0]=CHIFFRES_HEX_MAJ[octet >> 4];
+	place_p[1]=CHIFFRES_HEX_MAJ[octet & 0xF];
+	return place_p+2;
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param type type d'enregistrement (00 données, 01 fin, 04 adresse linéaire étendue, 05 adresse de départ)
+ * @param adresse 16 bits de poids faible de l'adresse
+ * @param donnees_p données de l'enregistrement
+ * @param nb nombre d'octets de données (au plus 255)
+ * @return Rien
+ * @brief Ecrit un enregistrement Intel HEX ":LLAAAATT...CC"
+ */
+void enregistrement_ihex(struct Sortie_s *sortie_p, uint8_t type, uint16_t adresse, const uint8_t *donnees_p, unsigned int nb)
+{
+	char *place_p=sortie_reserver(sortie_p, 1+2+4+2+2*nb+2+1);
+	uint8_t somme=nb + (adresse >> 8) + (adresse & 0xFF) + type;
+	unsigned int i;
+
+	*place_p++=':';
+	place_p=hex_octet(place_p, nb);
+	place_p=hex_octet(place_p, adresse >> 8);
+	place_p=hex_octet(place_p, adresse & 0xFF);
+	place_p=hex_octet(place_p, type);
+	for (i=0; i<nb; i++) {
+		somme+=donnees_p[i];
+		place_p=hex_octet(place_p, donnees_p[i]);
+	}
+	place_p=hex_octet(place_p, (uint8_t)(-somme));
+	*place_p='\n';
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param type chiffre du type d'enregistrement ('0', '3', '5', '6' ou '7')
+ * @param adresse adresse (ou nombre d'enregistrements pour S5/S6)
+ * @param nb_octets_adresse nombre d'octets de l'adresse (2, 3 ou 4)
+ * @param donnees_p données de l'enregistrement
+ * @param nb nombre d'octets de données
+ * @return Rien
+ * @brief Ecrit un enregistrement S-record "StCCAAAA...DD...SS"
+ */
+void enregistrement_srec(struct Sortie_s *sortie_p, char type, uint32_t adresse, int nb_octets_adresse, const uint8_t *donnees_p, unsigned int nb)
+{
+	uint8_t compte=nb_octets_adresse+nb+1;
+	char *place_p=sortie_reserver(sortie_p, 2+2+2*compte+1);
+	uint8_t somme=compte;
+	uint8_t octet;
+	unsigned int i;
+
+	*place_p++='S';
+	*place_p++=type;
+	place_p=hex_octet(place_p, compte);
+	for (i=nb_octets_adresse; i>0; i--) {
+		octet=(adresse >> (8*(i-1))) & 0xFF;
+		somme+=octet;
+		place_p=hex_octet(place_p, octet);
+	}
+	for (i=0; i<nb; i++) {
+		somme+=donnees_p[i];
+		place_p=hex_octet(place_p, donnees_p[i]);
+	}
+	place_p=hex_octet(place_p, (uint8_t)~somme);
+	*place_p='\n';
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param sections_p sections placées, dans l'ordre des adresses
+ * @param nb_sections nombre de sections
+ * @param remplissage octet de remplissage des trous
+ * @return Rien
+ * @brief Ecrit l'image binaire brute, de la première section jusqu'à la fin du dernier contenu
+ *
+ * Un .bss situé avant le dernier contenu est écrit comme des zéros ; un .bss final n'est pas écrit.
+ */
+void ecrire_binaire(struct Sortie_s *sortie_p, struct SectionImage_s *sections_p, int nb_sections, uint8_t remplissage)
+{
+	uint32_t adresse;
+	int i, derniere=-1;
+
+	for (i=0; i<nb_sections; i++)
+		if (sections_p[i].contenu) derniere=i;
+	if (derniere<0) return;
+
+	adresse=sections_p[0].adresse;
+	for (i=0; i<=derniere; i++) {
+		sortie_repeter(sortie_p, remplissage, sections_p[i].adresse-adresse);
+		if (sections_p[i].contenu)
+			sortie_ecrire(sortie_p, sections_p[i].contenu, sections_p[i].taille);
+		else
+			sortie_repeter(sortie_p, 0, sections_p[i].taille);
+		adresse=sections_p[i].adresse+sections_p[i].taille;
+	}
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param sections_p sections placées, dans l'ordre des adresses
+ * @param nb_sections nombre de sections
+ * @param depart adresse de départ du programme
+ * @return Rien
+ * @brief Ecrit l'image au format Intel HEX (le .bss n'y figure pas)
+ */
+void ecrire_ihex(struct Sortie_s *sortie_p, struct SectionImage_s *sections_p, int nb_sections, uint32_t depart)
+{
+	uint8_t poids_fort[4];
+	uint32_t adresse, haut=0, reste, nb;
+	const uint8_t *donnees_p;
+	int i;
+
+	for (i=0; i<nb_sections; i++) {
+		if (!sections_p[i].contenu) continue;
+		adresse=sections_p[i].adresse;
+		donnees_p=sections_p[i].contenu;
+		reste=sections_p[i].taille;
+		while (reste) {
+			if ((adresse >> 16)!=haut) {
+				haut=adresse >> 16;
+				poids_fort[0]=haut >> 8;
+				poids_fort[1]=haut & 0xFF;
+				enregistrement_ihex(sortie_p, 0x04, 0, poids_fort, 2);
+			}
+			nb=reste < OCTETS_PAR_ENREGISTREMENT ? reste : OCTETS_PAR_ENREGISTREMENT;
+			if (nb > 0x10000-(adresse & 0xFFFF)) nb=0x10000-(adresse & 0xFFFF);	/* pas de chevauchement de page */
+			enregistrement_ihex(sortie_p, 0x00, adresse & 0xFFFF, donnees_p, nb);
+			adresse+=nb;
+			donnees_p+=nb;
+			reste-=nb;
+		}
+	}
+
+	poids_fort[0]=depart >> 24;
+	poids_fort[1]=(depart >> 16) & 0xFF;
+	poids_fort[2]=(depart >> 8) & 0xFF;
+	poids_fort[3]=depart & 0xFF;
+	enregistrement_ihex(sortie_p, 0x05, 0, poids_fort, 4);
+	enregistrement_ihex(sortie_p, 0x01, 0, NULL, 0);
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param sections_p sections placées, dans l'ordre des adresses
+ * @param nb_sections nombre de sections
+ * @param depart adresse de départ du programme
+ * @param entete texte de l'enregistrement S0
+ * @return Rien
+ * @brief Ecrit l'image au format S-record avec adresses sur 32 bits (le .bss n'y figure pas)
+ */
+void ecrire_srec(struct Sortie_s *sortie_p, struct SectionImage_s *sections_p, int nb_sections, uint32_t depart, const char *entete)
+{
+	uint32_t adresse, reste, nb, nb_enregistrements=0;
+	const uint8_t *donnees_p;
+	int i;
+
+	enregistrement_srec(sortie_p, '0', 0, 2, (const uint8_t *)entete, strlen(entete) > 64 ? 64 : strlen(entete));
+	for (i=0; i<nb_sections; i++) {
+		if (!sections_p[i].contenu) continue;
+		adresse=sections_p[i].adresse;
+		donnees_p=sections_p[i].contenu;
+		reste=sections_p[i].taille;
+		while (reste) {
+			nb=reste < OCTETS_PAR_ENREGISTREMENT ? reste : OCTETS_PAR_ENREGISTREMENT;
+			enregistrement_srec(sortie_p, '3', adresse, 4, donnees_p, nb);
+			nb_enregistrements++;
+			adresse+=nb;
+			donnees_p+=nb;
+			reste-=nb;
+		}
+	}
+
+	if (nb_enregistrements<0x10000)
+		enregistrement_srec(sortie_p, '5', nb_enregistrements, 2, NULL, 0);
+	else if (nb_enregistrements<0x1000000)
+		enregistrement_srec(sortie_p, '6', nb_enregistrements, 3, NULL, 0);
+	enregistrement_srec(sortie_p, '7', depart, 4, NULL, 0);
+}
+
+/**
+ * @param section1_p pointeur sur une section placée
+ * @param section2_p pointeur sur une section placée
+ * @return négatif, nul ou positif suivant l'ordre des adresses
+ * @brief Ordonne les sections par adresse croissante
+ */
+int comparer_sections_image(const void *section1_p, const void *section2_p)
+{
+	uint32_t a1=((const struct SectionImage_s *)section1_p)->adresse;
+	uint32_t a2=((const struct SectionImage_s *)section2_p)->adresse;
+
+	return a1<a2 ? -1 : a1>a2 ? 1 : 0;
+}
+
+/**
+ * @param parametres_p pointeur sur les paramètres de l'image (les adresses non fixées sont complétées)
+ * @param tailles taille de chaque section, indicée par Section_e
+ * @param nom_fichier nom du fichier image, pour les diagnostics
+ * @return SUCCESS si les sections tiennent dans l'espace d'adressage sans se chevaucher, FAILURE sinon
+ * @brief Calcule l'adresse des sections non fixées et vérifie le placement
+ */
+int placer_sections_image(struct ParametresImage_s *parametres_p, uint32_t *tailles, const char *nom_fichier)
+{
+	uint64_t fin=0;
+	int s, t;
+
+	for (s=S_TEXT; s<=S_BSS; s++) {
+		if (!parametres_p->base_fixee[s])
+			parametres_p->adresses_base[s]=(uint32_t)((fin + ALIGNEMENT_SECTIONS_IMAGE-1) & ~(uint64_t)(ALIGNEMENT_SECTIONS_IMAGE-1));
+		fin=(uint64_t)parametres_p->adresses_base[s]+tailles[s];
+		if (fin > 0x100000000ULL) {
+			diag_signaler(NULL, DIAG_ERREUR, nom_fichier, 0, "image", "la section %s dépasse la fin de l'espace d'adressage", NOMS_SECTIONS[s]);
+			return FAILURE;
+		}
+	}
+
+	for (s=S_TEXT; s<=S_BSS; s++)
+		for (t=s+1; t<=S_BSS; t++)
+			if ((tailles[s]) && (tailles[t]) &&
+					(parametres_p->adresses_base[s] < parametres_p->adresses_base[t]+tailles[t]) &&
+					(parametres_p->adresses_base[t] < parametres_p->adresses_base[s]+tailles[s])) {
+				diag_signaler(NULL, DIAG_ERREUR, nom_fichier, 0, "image", "les sections %s et %s se chevauchent", NOMS_SECTIONS[s], NOMS_SECTIONS[t]);
+				return FAILURE;
+			}
+	return SUCCESS;
+}
+
+/**
+ * @param nom_fichier nom du fichier image à créer
+ * @param parametres_p pointeur sur les paramètres de l'image
+ * @param liste_text_p pointeur sur la liste des instructions codées
+ * @param liste_data_p pointeur sur la liste des données de .data
+ * @param liste_bss_p pointeur sur la liste des réservations de .bss
+ * @param table_etiquettes_p pointeur sur la table des étiquettes complète
+ * @return SUCCESS si le fichier a été écrit, FAILURE sinon
+ * @brief Place les sections, résout les symboles avec leurs adresses définitives et écrit l'image
+ */
+int generer_image(const char *nom_fichier, struct ParametresImage_s *parametres_p,
+		struct Liste_s *liste_text_p, struct Liste_s *liste_data_p, struct Liste_s *liste_bss_p,
+		struct Table_s *table_etiquettes_p)
+{
+	struct SectionImage_s sections[3];
+	struct Sortie_s *sortie_p;
+	uint32_t tailles[4];
+	uint8_t *contenu_text, *contenu_data;
+	int nb_sections=0, descripteur, resultat;
+
+	tailles[S_INIT]=0;
+	tailles[S_TEXT]=taille_section(liste_text_p, S_TEXT);
+	tailles[S_DATA]=taille_section(liste_data_p, S_DATA);
+	tailles[S_BSS]=taille_section(liste_bss_p, S_BSS);
+	if (FAILURE==placer_sections_image(parametres_p, tailles, nom_fichier)) return FAILURE;
+
+	/* les sections sont construites avant de créer le fichier, qui n'est pas écrit si une adresse déborde */
+	if (!(contenu_text=construire_section_text(liste_text_p, table_etiquettes_p, parametres_p->adresses_base, tailles[S_TEXT],
+			parametres_p->gros_boutiste))) {
+		diag_signaler(NULL, DIAG_ERREUR, nom_fichier, 0, "image", "fichier image non écrit à cause des erreurs précédentes");
+		return FAILURE;
+	}
+	contenu_data=construire_section_donnees(liste_data_p, table_etiquettes_p, parametres_p->adresses_base, tailles[S_DATA], parametres_p->gros_boutiste);
+
+	if ((descripteur=open(nom_fichier, O_WRONLY | O_CREAT | O_TRUNC, 0666))<0) {
+		diag_signaler(NULL, DIAG_ERREUR, nom_fichier, 0, "image", "impossible de créer le fichier image : %s", strerror(errno));
+		free(contenu_text);
+		free(contenu_data);
+		return FAILURE;
+	}
+
+	if (tailles[S_TEXT]) {
+		sections[nb_sections].section=S_TEXT;
+		sections[nb_sections].contenu=contenu_text;
+		sections[nb_sections].adresse=parametres_p->adresses_base[S_TEXT];
+		sections[nb_sections++].taille=tailles[S_TEXT];
+	}
+	if (tailles[S_DATA]) {
+		sections[nb_sections].section=S_DATA;
+		sections[nb_sections].contenu=contenu_data;
+		sections[nb_sections].adresse=parametres_p->adresses_base[S_DATA];
+		sections[nb_sections++].taille=tailles[S_DATA];
+	}
+	if (tailles[S_BSS]) {
+		sections[nb_sections].section=S_BSS;
+		sections[nb_sections].contenu=NULL;
+		sections[nb_sections].adresse=parametres_p->adresses_base[S_BSS];
+		sections[nb_sections++].taille=tailles[S_BSS];
+	}
+	qsort(sections, nb_sections, sizeof(*sections), comparer_sections_image);
+
+	sortie_p=creer_sortie(descripteur, 0);
+	switch (parametres_p->format) {
+	case SORTIE_IHEX:
+		ecrire_ihex(sortie_p, sections, nb_sections, parametres_p->adresses_base[S_TEXT]);
+		break;
+	case SORTIE_SREC:
+		ecrire_srec(sortie_p, sections, nb_sections, parametres_p->adresses_base[S_TEXT], nom_fichier);
+		break;
+	default:
+		ecrire_binaire(sortie_p, sections, nb_sections, parametres_p->remplissage);
+		break;
+	}
+	resultat=vider_sortie(sortie_p);
+	if (resultat==FAILURE)
+		diag_signaler(NULL, DIAG_ERREUR, nom_fichier, 0, "image", "impossible d'écrire le fichier image : %s", strerror(errno));
+	sortie_p=detruire_sortie(sortie_p);
+	free(contenu_text);
+	free(contenu_data);
+
+	if ((close(descripteur)) && (resultat==SUCCESS)) {
+		diag_signaler(NULL, DIAG_ERREUR, nom_fichier, 0, "image", "impossible de terminer le fichier image : %s", strerror(errno));
+		resultat=FAILURE;
+	}
+	return resultat;
+}
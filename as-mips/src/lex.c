@@ -18,6 +18,24 @@
 #include <lex.h>
 #include <liste.h>
 #include <table.h>
+#include <sortie.h>
+#include <memoire.h>
+#include <pretraitement.h>
+
+const char OPERATEURS[]="*/%<>&|^~";	/**< Caractères qui commencent un opérateur d'expression, en dehors de '+' et '-' */
+
+/**
+ * @param token texte d'un lexème de l'état OPERATEUR, en minuscules
+ * @return TRUE si c'est un opérateur d'expression connu
+ */
+int est_operateur(const char *token)
+{
+	const char *operateurs[]={"+", "-", "*", "/", "%", "<<", ">>", "&", "|", "^", "~", "%hi", "%lo", NULL};
+	int i;
+
+	for (i=0; operateurs[i]; i++) if (!strcmp(token, operateurs[i])) return TRUE;
+	return FALSE;
+}
 
 /**
  * @param etat etat de la machine à états finis lexicale
@@ -48,6 +66,8 @@ char *etat_lex_to_str(enum Etat_lex_e etat)
 		case DECIMAL_ZERO:			return "DECIMAL_ZERO";
 		case PARENTHESE_OUVRANTE:	return "PARENTHESE_OUVRANTE";
 		case PARENTHESE_FERMANTE:	return "PARENTHESE_FERMANTE";
+		case OPERATEUR:				return "OPERATEUR";
+		case EXPRESSION:			return "EXPRESSION";
 		case ERREUR:				return "ERREUR";
 		case FIN_LIGNE:				return "FIN_LIGNE";
 		default : 	ERROR_MSG("Erreur de résolution du nom de l'état %d de la machine à états finis lexicale... Il manque donc au moins un nom d'état à rajouter", etat);
@@ -84,6 +104,7 @@ enum Etat_lex_e machine_etats_finis_lexicale(enum Etat_lex_e etat, char c)
  *		INIT -> REGISTRE [label="$"];
  *		INIT -> PARENTHESE_OUVRANTE [label="("];
  *		INIT -> PARENTHESE_FERMANTE [label=")"];
+ *		INIT -> OPERATEUR [label="* / % < > & | ^ ~"];
  *		INIT -> SYMBOLE [label="_alpha"];
  *		INIT -> ERREUR [label="sinon"];
  *
@@ -100,6 +121,9 @@ enum Etat_lex_e machine_etats_finis_lexicale(enum Etat_lex_e etat, char c)
  *		PARENTHESE_OUVRANTE -> ERREUR;
  *		PARENTHESE_FERMANTE -> ERREUR;
  *
+ *		OPERATEUR -> OPERATEUR [label="< > alpha"];
+ *		OPERATEUR -> ERREUR [label="sinon"];
+ *
  *		DECIMAL_ZERO -> OCTAL [label="0 à 7---"];
  *		DECIMAL_ZERO -> DEBUT_HEXADECIMAL [label="x ou X"];
  *		DECIMAL_ZERO -> ERREUR [label="sinon"];
@@ -139,6 +163,8 @@ enum Etat_lex_e machine_etats_finis_lexicale(enum Etat_lex_e etat, char c)
  * hexa indique un caractère compris de '0' à '9' ou compris de 'A' à 'F' ou compris de 'a' à 'f'\n
  * \n
  * Seuls les états verts correspondent à des états de sortie corrects en fin de lexème.
+ * Un '+' ou un '-' seul est un opérateur ; un lexème OPERATEUR n'est correct que s'il fait partie de la liste
+ * des opérateurs (cf. est_operateur).
  *
  */
 
@@ -154,6 +180,7 @@ enum Etat_lex_e machine_etats_finis_lexicale(enum Etat_lex_e etat, char c)
 			else if (c=='$') etat=REGISTRE;
 			else if (c=='(') etat=PARENTHESE_OUVRANTE;
 			else if (c==')') etat=PARENTHESE_FERMANTE;
+			else if (strchr(OPERATEURS, c)) etat=OPERATEUR;
 			else if (isalpha(c) || (c=='_')) etat=SYMBOLE;
 			else etat=ERREUR;
 			break;
@@ -199,6 +226,10 @@ enum Etat_lex_e machine_etats_finis_lexicale(enum Etat_lex_e etat, char c)
 			else if (!(isalnum(c) || (c=='_'))) etat=ERREUR;
 			break;
 
+		case OPERATEUR: /* "<<", ">>", "%hi" ou "%lo" */
+			if ((c!='<') && (c!='>') && (!isalpha(c))) etat=ERREUR;
+			break;
+
 		case POINT:
 			if (isalpha(c)) etat=DIRECTIVE;
 			else etat=ERREUR;
@@ -223,6 +254,30 @@ enum Etat_lex_e machine_etats_finis_lexicale(enum Etat_lex_e etat, char c)
 	return etat;
 }
 
+/**
+ * @param curseur_pp pointeur sur la position courante dans la ligne standardisée, avancée après le lexème
+ * @return début du lexème suivant, terminé par un zéro, NULL en fin de ligne
+ * @brief Découpe la ligne standardisée aux espaces, sauf à l'intérieur d'une chaîne entre guillemets
+ */
+char *lex_token_suivant(char **curseur_pp)
+{
+	char *debut_p=*curseur_pp, *fin_p;
+
+	while (*debut_p==' ') debut_p++;
+	if (!*debut_p) return NULL;
+	for (fin_p=debut_p; (*fin_p) && (*fin_p!=' '); fin_p++)
+		if ((*fin_p=='"') && (!(fin_p=strchr(fin_p+1, '"')))) {
+			fin_p=debut_p+strlen(debut_p); /* chaîne non terminée : elle va jusqu'au bout de la ligne */
+			break;
+		}
+	*curseur_pp=fin_p;
+	if (*fin_p) {
+		*fin_p='\0';
+		(*curseur_pp)++;
+	}
+	return debut_p;
+}
+
 /**
  * @param ligne chaine contenant la ligne du fichier source assembleur à analyser
  * @param liste_lexemes_p pointeur sur la liste de lexèmes servant à stoquer les lexèmes qui seront extraits dans l'analyses
@@ -241,15 +296,15 @@ void lex_read_line(char *ligne, struct Liste_s *liste_lexemes_p, unsigned int nu
 	int i;
 	int debutLigne = 1;
 	
-    char *seps = " ";
     char *token = NULL;
+    char *curseur_p = NULL;
     char save[2*STRLEN];
 
     /* copy the input line so that we can do anything with it without impacting outside world*/
     memcpy( save, ligne, 2*STRLEN );
 
-    /* get each token*/
-    for( token = strtok( save, seps ); NULL != token; token = strtok( NULL, seps )) {
+    /* get each token, a quoted string being a single token even if it contains spaces */
+    for( curseur_p = save; NULL != (token = lex_token_suivant( &curseur_p )); ) {
     	etat=INIT;
 		i=0; /* On se place sur le premier caractère du token en cours */
 		while('\0'!=(c=token[i])) { /* Tant que la ligne n'est pas terminee */
@@ -258,11 +313,13 @@ void lex_read_line(char *ligne, struct Liste_s *liste_lexemes_p, unsigned int nu
         }
         
         if (etat==COMMENTAIRE) {
-         	char * diese_p=strchr(ligne,'#');
+         	char * diese_p=ligne+(token-save); /* le '#' du lexème, et non un '#' d'une chaîne qui le précède */
 
          	lexeme_p = malloc(sizeof(*lexeme_p));
          	if (!(lexeme_p->data = (char *)malloc(strlen(diese_p)+1*sizeof(char)))) ERROR_MSG("Impossible de dupliquer le contenu du nouveau commentaire");
     		strcpy(lexeme_p->data, diese_p);
+    		MEMOIRE_ALLOUER(MEM_LEXEMES, sizeof(*lexeme_p));
+    		MEMOIRE_ALLOUER(MEM_LEXEMES, strlen(diese_p)+1);
          	lexeme_p->nature=COMMENTAIRE;
          	lexeme_p->ligne=num_ligne;
          	ajouter_fin_liste(liste_lexemes_p, lexeme_p);
@@ -279,7 +336,11 @@ void lex_read_line(char *ligne, struct Liste_s *liste_lexemes_p, unsigned int nu
 
     			case MOINS:
     			case PLUS:
-    				etat=ERREUR; /* les signes doivent être accolés à un nombre */
+    				etat=OPERATEUR; /* un signe qui n'est pas accolé à un nombre est un opérateur */
+    				break;
+
+    			case OPERATEUR:
+    				if (!est_operateur(strlwr(token))) etat=ERREUR;
     				break;
         			
     			case DEBUT_HEXADECIMAL:
@@ -323,6 +384,8 @@ void lex_read_line(char *ligne, struct Liste_s *liste_lexemes_p, unsigned int nu
 
          	if (!(lexeme_p->data = (char *)malloc(strlen(token)+1*sizeof(char)))) ERROR_MSG("Impossible de dupliquer le contenu du nouveau lexeme");
     		strcpy(lexeme_p->data, token);
+    		MEMOIRE_ALLOUER(MEM_LEXEMES, sizeof(*lexeme_p));
+    		MEMOIRE_ALLOUER(MEM_LEXEMES, strlen(token)+1);
          	lexeme_p->nature=etat;
          	lexeme_p->ligne=num_ligne;
          	ajouter_fin_liste(liste_lexemes_p, lexeme_p);
@@ -334,10 +397,68 @@ void lex_read_line(char *ligne, struct Liste_s *liste_lexemes_p, unsigned int nu
 
     lexeme_p->data=NULL;
     lexeme_p->nature=FIN_LIGNE;
+    MEMOIRE_ALLOUER(MEM_LEXEMES, sizeof(*lexeme_p));
     lexeme_p->ligne=num_ligne;
     ajouter_fin_liste(liste_lexemes_p, lexeme_p);
 }
 
+/**
+ * @param fp Le fichier source asssembleur ouvert en lecture
+ * @param liste_lexemes_p Un pointeur sur une liste (générique) de lexèmes
+ * @param nb_lignes_max Le nombre maximal de lignes à lire, 0 pour lire jusqu'à la fin du fichier
+ * @param nb_lignes_p Le pointeur vers le compteur de nombre de lignes
+ * @param nb_etiquettes_p Le pointeur vers le compteur de nombre d'étiquettes
+ * @param nb_instructions_p Le pointeur vers le compteur de nombre d'instructions
+ * @return Le nombre de lignes lues
+ * @brief Cette fonction effectue l'analyse lexicale des lignes suivantes d'un fichier déjà ouvert
+ *
+ * Les compteurs ne sont pas remis à zéro, ce qui permet d'analyser un fichier en plusieurs fois. Si un
+ * prétraitement est installé, chaque ligne lui est confiée (.include, .macro, appels de macros).
+ */
+unsigned int lex_read_lines(FILE *fp, struct Liste_s *liste_lexemes_p, unsigned int nb_lignes_max, unsigned int *nb_lignes_p, unsigned int *nb_etiquettes_p, unsigned int *nb_instructions_p)
+{
+    char         line[STRLEN]; /* original source line */
+    char         res[2*STRLEN]; /* standardised source line, can be longeur due to some possible added spaces*/
+    unsigned int nb_lues = 0;
+    struct Pretraitement_s *pretraitement_p = pretraitement_courant();
+    struct Liste_s *liste_ligne_p = pretraitement_p ? pretraitement_p->ligne_p : liste_lexemes_p;
+
+    while(!feof(fp) && ((!nb_lignes_max) || (nb_lues < nb_lignes_max))) {
+        /*read source code line-by-line */
+        if ( NULL != fgets( line, STRLEN-1, fp ) ) {
+            if (strlen(line)) if (line[strlen(line)-1] == '\n') line[strlen(line)-1] = '\0';  /* remove final '\n' */
+            (*nb_lignes_p)++;
+            nb_lues++;
+
+            if ( 0 == strlen(line) ) continue;
+            lex_standardise( line, res );
+            lex_read_line( res, liste_ligne_p, *nb_lignes_p, nb_etiquettes_p, nb_instructions_p );
+            /* les lexèmes bruts de la ligne restent au prétraitement, ceux qu'elle produit vont dans la liste */
+            if ( pretraitement_p ) pretraiter_ligne( pretraitement_p, liste_lexemes_p, *nb_lignes_p, nb_etiquettes_p, nb_instructions_p );
+        }
+    }
+    return nb_lues;
+}
+
+/**
+ * @param fp Le fichier source asssembleur ouvert en lecture, lu jusqu'au bout mais pas fermé
+ * @param nom_fichier Le nom du fichier source asssembleur, pour les diagnostics
+ * @param liste_lexemes_p Un pointeur sur une liste (générique) de lexèmes
+ * @param nb_lignes_p Le pointeur vers le compteur de nombre de lignes
+ * @param nb_etiquettes_p Le pointeur vers le compteur de nombre d'étiquettes
+ * @param nb_instructions_p Le pointeur vers le compteur de nombre d'instructions
+ * @return Rien. Si ce n'est la liste générique de lexèmes ainsi que les nombres de lignes, d'instructions et d'étiquettes
+ * @brief Cette fonction effectue l'analyse lexicale d'un source déjà ouvert (fichier, texte en mémoire...)
+ */
+void lex_load_flux(FILE *fp, const char *nom_fichier, struct Liste_s *liste_lexemes_p, unsigned int *nb_lignes_p, unsigned int *nb_etiquettes_p, unsigned int *nb_instructions_p)
+{
+    *nb_lignes_p = 0;
+
+    lex_read_lines(fp, liste_lexemes_p, 0, nb_lignes_p, nb_etiquettes_p, nb_instructions_p);
+
+    if (!*nb_lignes_p) diag_signaler(NULL, DIAG_AVERTISSEMENT, nom_fichier, 0, "fichier-vide", "le fichier est vide");
+}
+
 /**
  * @param nom_fichier Le nom du fichier source asssembleur
  * @param liste_lexemes_p Un pointeur sur une liste (générique) de lexèmes
@@ -352,31 +473,16 @@ void lex_load_file(char *nom_fichier, struct Liste_s *liste_lexemes_p, unsigned
 {
 
     FILE        *fp   = NULL;
-    char         line[STRLEN]; /* original source line */
-    char         res[2*STRLEN]; /* standardised source line, can be longeur due to some possible added spaces*/
     
     fp = fopen( nom_fichier, "r" );
     if ( NULL == fp ) {
         /*macro ERROR_MSG : message d'erreur puis fin de programme ! */
         ERROR_MSG("Impossible d'ouvrir le fichier \"%s\". Abandon du traitement",nom_fichier);
     }
-    *nb_lignes_p = 0;
 
-    while(!feof(fp)) {
-        /*read source code line-by-line */
-        if ( NULL != fgets( line, STRLEN-1, fp ) ) {
-            if (strlen(line)) if (line[strlen(line)-1] == '\n') line[strlen(line)-1] = '\0';  /* remove final '\n' */
-            (*nb_lignes_p)++;
-
-            if ( 0 != strlen(line) ) {
-                lex_standardise( line, res );
-                lex_read_line( res, liste_lexemes_p, *nb_lignes_p, nb_etiquettes_p, nb_instructions_p );
-            }
-        }       
-    }
+    lex_load_flux(fp, nom_fichier, liste_lexemes_p, nb_lignes_p, nb_etiquettes_p, nb_instructions_p);
 
     fclose(fp);
-    if (!*nb_lignes_p) WARNING_MSG("Attention, le fichier \"%s\" est vide", nom_fichier);
 }
 
 /**
@@ -385,11 +491,13 @@ void lex_load_file(char *nom_fichier, struct Liste_s *liste_lexemes_p, unsigned
  * @return nothing
  * @brief This function will prepare a line of source code for further analysis.
  *
- * Aucun changement de casse n'est effectué à ce niveau
+ * Aucun changement de casse n'est effectué à ce niveau. Une chaîne entre guillemets est recopiée telle quelle :
+ * ni ses opérateurs, ni ses signes, ni ses '#', ni ses espaces ne sont touchés.
  */
 void lex_standardise(char* in, char* out)
 {
-    unsigned int i, j;
+    unsigned int i, j, k;
+    int partie;
     const char * ESPACE_AVANT = "#$,-()+";
     const char * PAS_ESPACE_AVANT = ":";
     const char * ESPACE_APRES = ":,()";
@@ -398,12 +506,35 @@ void lex_standardise(char* in, char* out)
     DEBUG_MSG("in  = \"%s\"", in);
     
     for ( i= 0, j= 0; i < strlen(in); i++ ) {
+        if (in[i] == '"') {
+        	/* recopie la chaîne jusqu'au guillemet fermant compris (ou jusqu'à la fin de la ligne s'il manque) */
+        	for ( out[j++]=in[i++]; (i < strlen(in)) && (in[i] != '"'); i++ ) out[j++]=in[i];
+        	if (i < strlen(in)) out[j++]=in[i];
+        	continue;
+        }
         if (strchr(ESPACE_AVANT, in[i])) {
         	if (j>0) if (out[j-1] != ' ') out[j++]=' '; /* rajoute un espace avant les symboles '$', ',', '(', ')', '-', '+' # si pas en début de ligne et pas déjà un espace. */
 			out[j++]=in[i]; /* Puis, recopie le symbole */      
 
         	/* Si c'est un commentaire, puis recopie tous les caractères suivants jusqu'à la fin de la ligne sans faire de standardisation aval */
 		    if ( in[i] == '#') for ( i++; i < strlen(in); i++ ) out[j++]=in[i];
+
+		    /* un signe qui ne précède pas un nombre est un opérateur : il est séparé de ce qui le suit */
+		    if ((in[i] == '-') || (in[i] == '+')) {
+		    	for ( k= i+1; isblank((int) in[k]); k++ );
+		    	if ((in[k]) && (!isdigit((int) in[k]))) out[j++]=' ';
+		    }
+        }
+        else if (strchr(OPERATEURS, in[i])) {
+        	/* les autres opérateurs sont entourés d'espaces, sauf entre les deux caractères de << et >> et après le % de %hi( et %lo( */
+        	partie=FALSE;
+        	if ((in[i] == '%') && ((!strncmp(in+i+1, "hi", 2)) || (!strncmp(in+i+1, "lo", 2)))) {
+        		for ( k= i+3; isblank((int) in[k]); k++ );
+        		partie=(in[k] == '(');
+        	}
+        	if (j>0) if ((out[j-1] != ' ') && (((in[i] != '<') && (in[i] != '>')) || (out[j-1] != in[i]))) out[j++]=' ';
+        	out[j++]=in[i];
+        	if ((!partie) && (((in[i] != '<') && (in[i] != '>')) || (in[i+1] != in[i])) && (in[i+1]) && (!isblank((int) in[i+1]))) out[j++]=' ';
         }
         else {
 		    /* translate all spaces (i.e., tab) into simple spaces */
@@ -443,37 +574,49 @@ void lex_standardise(char* in, char* out)
 void detruit_lexeme(void *lexeme_p)
 {
 	INFO_MSG("Lexeme: %p ... %s",Lexeme_p,((struct Lexeme_s *)Lexeme_p)->data);
-	free(((struct Lexeme_s *)lexeme_p)->data);
+	if (((struct Lexeme_s *)lexeme_p)->data) {
+		MEMOIRE_LIBERER(MEM_LEXEMES, strlen(((struct Lexeme_s *)lexeme_p)->data)+1);
+		free(((struct Lexeme_s *)lexeme_p)->data);
+	}
 	free(lexeme_p);
+	MEMOIRE_LIBERER(MEM_LEXEMES, sizeof(struct Lexeme_s));
 }
 
 /**
+ * @param sortie_p pointeur sur la sortie du listage
  * @param lexeme_p pointeur sur un lexeme
  * @return Rien, si ce n'est l'affichage
  * @brief Cette fonction permet de visualiser le contenu d'un lexeme
  *
  */
-void visualisation_lexeme(struct Lexeme_s * lexeme_p)
+void visualisation_lexeme(struct Sortie_s *sortie_p, struct Lexeme_s * lexeme_p)
 {
-	printf("(%s|%s|%d)", etat_lex_to_str(lexeme_p->nature), lexeme_p->data, lexeme_p->ligne);
+	sortie_caractere(sortie_p, '(');
+	sortie_chaine(sortie_p, etat_lex_to_str(lexeme_p->nature));
+	sortie_caractere(sortie_p, '|');
+	sortie_chaine_alignee(sortie_p, lexeme_p->data, 0);
+	sortie_caractere(sortie_p, '|');
+	sortie_decimal(sortie_p, lexeme_p->ligne, 0);
+	sortie_caractere(sortie_p, ')');
 }
 
 /**
+ * @param sortie_p pointeur sur la sortie du listage
  * @param liste_p pointeur sur une liste de (générique) de lexèmes
  * @return rien
  * @brief Cette fonction permet de visualiser le contenu d'une liste de lexeme
  *
  */
-void visualisation_liste_lexemes(struct Liste_s * liste_p)
+void visualisation_liste_lexemes(struct Sortie_s *sortie_p, struct Liste_s * liste_p)
 {
 	struct NoeudListe_s * lexemeCourant_p=liste_p->debut_liste_p;
 
 	while (lexemeCourant_p) {
-		visualisation_lexeme((struct Lexeme_s *)lexemeCourant_p->donnee_p);
+		visualisation_lexeme(sortie_p, (struct Lexeme_s *)lexemeCourant_p->donnee_p);
 		if (((struct Lexeme_s *)lexemeCourant_p->donnee_p)->nature == L_FIN_LIGNE)
-			printf("\n");
+			sortie_caractere(sortie_p, '\n');
 		else
-			if (lexemeCourant_p->suivant_p) printf(", ");
+			if (lexemeCourant_p->suivant_p) sortie_chaine(sortie_p, ", ");
 		lexemeCourant_p=lexemeCourant_p->suivant_p;
 	}
 }
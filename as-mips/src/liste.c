@@ -9,6 +9,57 @@
 
 #include <notify.h>
 #include <liste.h>
+#include <memoire.h>
+
+/**
+ * @param liste_p pointeur sur une liste générique simplement chaînée
+ * @return noeud non initialisé, pris parmi les noeuds retirés ou dans le bloc courant
+ * @brief Distribue un noeud du pool de la liste, en créant un bloc deux fois plus grand que le précédent si besoin
+ */
+struct NoeudListe_s *allouer_noeud(struct Liste_s *liste_p)
+{
+	struct NoeudListe_s *noeud_p=liste_p->libres_p;
+	struct BlocNoeuds_s *bloc_p;
+	size_t capacite, taille;
+
+	if (noeud_p) {
+		liste_p->libres_p=noeud_p->suivant_p;
+		return noeud_p;
+	}
+	for (bloc_p=liste_p->bloc_courant_p; (bloc_p) && (bloc_p->nb_utilises==bloc_p->capacite); bloc_p=bloc_p->suivant_p);
+	if (!bloc_p) {
+		capacite=liste_p->dernier_bloc_p ? 2*liste_p->dernier_bloc_p->capacite : LISTE_NOEUDS_MIN;
+		if (capacite>LISTE_NOEUDS_MAX) capacite=LISTE_NOEUDS_MAX;
+		taille=sizeof(*bloc_p)+(capacite-1)*sizeof(bloc_p->noeuds[0]);
+		if (!(bloc_p=malloc(taille)))
+			ERROR_MSG("Impossible de créer un nouvel élément de liste");
+		MEMOIRE_ALLOUER(MEM_LISTES, taille);
+		bloc_p->suivant_p=NULL;
+		bloc_p->capacite=capacite;
+		bloc_p->nb_utilises=0;
+		if (liste_p->dernier_bloc_p)
+			liste_p->dernier_bloc_p->suivant_p=bloc_p;
+		else
+			liste_p->blocs_p=bloc_p;
+		liste_p->dernier_bloc_p=bloc_p;
+	}
+	liste_p->bloc_courant_p=bloc_p;
+	return bloc_p->noeuds+bloc_p->nb_utilises++;
+}
+
+/**
+ * @param liste_p pointeur sur une liste générique simplement chaînée, dont aucun noeud n'est plus utilisé
+ * @return Rien
+ * @brief Rend tous les noeuds des blocs disponibles, sans libérer les blocs
+ */
+void reprendre_noeuds(struct Liste_s *liste_p)
+{
+	struct BlocNoeuds_s *bloc_p;
+
+	for (bloc_p=liste_p->blocs_p; bloc_p; bloc_p=bloc_p->suivant_p) bloc_p->nb_utilises=0;
+	liste_p->bloc_courant_p=liste_p->blocs_p;
+	liste_p->libres_p=NULL;
+}
 
 /**
  * @param freeFn Pointeur sur la fonction de destruction des données dynamiques liées à l'élement de liste
@@ -22,33 +73,53 @@ struct Liste_s *creer_liste(fonctionDestructeur *freeFn)
 		ERROR_MSG("Impossible de créer une nouvelle liste");
 		return NULL;
 	}
+	MEMOIRE_ALLOUER(MEM_LISTES, sizeof(*liste_p));
 	liste_p->fnDestructeur_p = freeFn;
 	return liste_p;
 }
 
+/**
+ * @param liste_p pointeur sur une liste générique simplement chaînée
+ * @return Rien
+ * @brief Détruit l'ensemble des éléments de la liste, qui reste utilisable (vide) et garde ses blocs de noeuds
+ */
+void vider_liste(struct Liste_s *liste_p)
+{
+	struct NoeudListe_s *noeud_p;
+
+	for (noeud_p = liste_p->debut_liste_p; noeud_p != NULL; noeud_p = noeud_p->suivant_p) {
+		if (liste_p->fnDestructeur_p)
+			liste_p->fnDestructeur_p(noeud_p->donnee_p);
+		else
+			free(noeud_p->donnee_p);
+	}
+	liste_p->debut_liste_p=NULL;
+	liste_p->fin_liste_p=NULL;
+	liste_p->nbElements=0;
+	reprendre_noeuds(liste_p);
+}
+
 /**
  * @param liste_p pointeur sur une liste générique simplement chaînée
  * @return Pointeur NULL
  * @brief Détruit l'ensemble des éléments de la liste en libérant la mémoire dynamique direct et indirecte associée
- * pour ce faire, on utilise l'éventuelle fonction de destruction passée à la création de liste.
+ * pour ce faire, on utilise l'éventuelle fonction de destruction passée à la création de liste. Les blocs de
+ * noeuds sont libérés d'un coup.
  */
 struct Liste_s *detruire_liste(struct Liste_s *liste_p)
 {
-	struct NoeudListe_s *noeud_p;
+	struct BlocNoeuds_s *bloc_p;
+
 	if (liste_p) {
 		INFO_MSG("Destruction de la Liste: %p : %d éléments",liste_p,liste_p->nbElements);
-		while (liste_p->debut_liste_p != NULL) {
-			noeud_p = liste_p->debut_liste_p;
-			liste_p->debut_liste_p = noeud_p->suivant_p;
-
-			if (liste_p->fnDestructeur_p)
-				liste_p->fnDestructeur_p(noeud_p->donnee_p);
-			else
-				free(noeud_p->donnee_p);
-
-			free(noeud_p);
+		vider_liste(liste_p);
+		while ((bloc_p=liste_p->blocs_p)) {
+			liste_p->blocs_p=bloc_p->suivant_p;
+			MEMOIRE_LIBERER(MEM_LISTES, sizeof(*bloc_p)+(bloc_p->capacite-1)*sizeof(bloc_p->noeuds[0]));
+			free(bloc_p);
 		}
 		free(liste_p);
+		MEMOIRE_LIBERER(MEM_LISTES, sizeof(*liste_p));
 	}
 	return NULL;
 }
@@ -64,10 +135,7 @@ void ajouter_debut_liste(struct Liste_s *liste_p, void *donnee_p)
 	struct NoeudListe_s *noeud_p = NULL;
 
 	if (liste_p) {
-		noeud_p=malloc(sizeof(*noeud_p));
-		if (!noeud_p)
-			ERROR_MSG("Impossible de créer un nouvel élément de liste");
-
+		noeud_p=allouer_noeud(liste_p);
 		noeud_p->donnee_p = donnee_p;
 		noeud_p->suivant_p = liste_p->debut_liste_p;
 		liste_p->debut_liste_p = noeud_p;
@@ -90,10 +158,7 @@ void ajouter_fin_liste(struct Liste_s *liste_p, void *donnee_p)
 	struct NoeudListe_s *noeud_p = NULL;
 
 	if (liste_p) {
-		noeud_p=malloc(sizeof(*noeud_p));
-		if (!noeud_p)
-			ERROR_MSG("Impossible de créer un nouvel élément de liste");
-
+		noeud_p=allouer_noeud(liste_p);
 		noeud_p->donnee_p = donnee_p;
 		noeud_p->suivant_p = NULL;
 		if (liste_p->fin_liste_p)
@@ -105,3 +170,80 @@ void ajouter_fin_liste(struct Liste_s *liste_p, void *donnee_p)
 		liste_p->nbElements++;
 	}
 }
+
+/**
+ * @param liste_p pointeur sur une liste générique simplement chaînée
+ * @param noeud_p pointeur sur le noeud de la liste après lequel insérer
+ * @param donnee_p Pointeur sur la donnée à insérer
+ * @return noeud du nouvel élément
+ * @brief Insère un nouvel élément après un noeud de la liste
+ */
+struct NoeudListe_s *inserer_apres_liste(struct Liste_s *liste_p, struct NoeudListe_s *noeud_p, void *donnee_p)
+{
+	struct NoeudListe_s *nouveau_p=allouer_noeud(liste_p);
+
+	nouveau_p->donnee_p = donnee_p;
+	nouveau_p->suivant_p = noeud_p->suivant_p;
+	noeud_p->suivant_p = nouveau_p;
+	if (liste_p->fin_liste_p == noeud_p)
+		liste_p->fin_liste_p = nouveau_p;
+	liste_p->nbElements++;
+	return nouveau_p;
+}
+
+/**
+ * @param liste_p pointeur sur une liste générique simplement chaînée
+ * @param noeud_p pointeur sur le noeud qui précède celui à retirer, NULL pour retirer le premier
+ * @return donnée de l'élément retiré, qui n'est pas détruite
+ * @brief Retire de la liste l'élément qui suit un noeud ; son noeud servira au prochain ajout
+ */
+void *retirer_apres_liste(struct Liste_s *liste_p, struct NoeudListe_s *noeud_p)
+{
+	struct NoeudListe_s *retire_p=noeud_p ? noeud_p->suivant_p : liste_p->debut_liste_p;
+	void *donnee_p=retire_p->donnee_p;
+
+	if (noeud_p)
+		noeud_p->suivant_p = retire_p->suivant_p;
+	else
+		liste_p->debut_liste_p = retire_p->suivant_p;
+	if (liste_p->fin_liste_p == retire_p)
+		liste_p->fin_liste_p = noeud_p;
+	liste_p->nbElements--;
+	retire_p->suivant_p = liste_p->libres_p;
+	liste_p->libres_p = retire_p;
+	return donnee_p;
+}
+
+/**
+ * @param liste_p pointeur sur une liste générique simplement chaînée
+ * @param suite_p pointeur sur la liste dont les éléments sont à rajouter en fin de liste_p
+ * @return Rien
+ * @brief Déplace tous les éléments de suite_p à la fin de liste_p
+ *
+ * Les éléments reçoivent des noeuds du pool de liste_p, à la suite des précédents : les noeuds de suite_p ne sont
+ * plus valables au retour. La liste suite_p est vide mais n'est pas détruite, et garde ses blocs pour être
+ * remplie de nouveau sans allocation.
+ */
+void concatener_liste(struct Liste_s *liste_p, struct Liste_s *suite_p)
+{
+	struct NoeudListe_s *noeud_p, *nouveau_p;
+
+	if (liste_p && suite_p && suite_p->debut_liste_p) {
+		for (noeud_p = suite_p->debut_liste_p; noeud_p != NULL; noeud_p = noeud_p->suivant_p) {
+			nouveau_p = allouer_noeud(liste_p);
+			nouveau_p->donnee_p = noeud_p->donnee_p;
+			nouveau_p->suivant_p = NULL;
+			if (liste_p->fin_liste_p)
+				liste_p->fin_liste_p->suivant_p = nouveau_p;
+			else
+				liste_p->debut_liste_p = nouveau_p;
+			liste_p->fin_liste_p = nouveau_p;
+		}
+		liste_p->nbElements += suite_p->nbElements;
+
+		suite_p->debut_liste_p = NULL;
+		suite_p->fin_liste_p = NULL;
+		suite_p->nbElements = 0;
+		reprendre_noeuds(suite_p);
+	}
+}
@@ -0,0 +1,253 @@
+/**
+ * @file lot.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Assemblage d'un lot de fichiers par un groupe de threads avec vol de travail
+ *
+ * Les fichiers sont répartis à tour de rôle dans une file par thread. Chaque thread prend les travaux en tête
+ * de sa file, puis vole en queue des files des autres quand la sienne est vide. Les dictionnaires ne sont
+ * chargés qu'une fois et ne sont que lus par les threads. Les diagnostics, le listage et le profil de chaque
+ * fichier restent en mémoire : le thread principal les écrit fichier par fichier, dans l'ordre de la ligne de
+ * commande, dès que le fichier suivant est terminé. Une erreur fatale n'abandonne que le fichier concerné.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <setjmp.h>
+#include <pthread.h>
+
+#include <global.h>
+#include <notify.h>
+#include <diag.h>
+#include <sortie.h>
+#include <profil.h>
+#include <assemblage.h>
+#include <lot.h>
+
+/**
+ * @struct Ouvrier_s
+ * @brief Paramètres d'un thread du lot
+ */
+struct Ouvrier_s {
+	struct Lot_s *lot_p;		/**< Lot partagé */
+	unsigned int numero;		/**< Numéro du thread, qui est aussi celui de sa file */
+};
+
+/**
+ * @param contexte_p pointeur sur le travail en cours
+ * @return Ne revient pas
+ * @brief Fonction fatale des collecteurs du lot : reprend le thread au début du travail interrompu
+ */
+void reprendre_travail(void *contexte_p)
+{
+	longjmp(((struct Travail_s *)contexte_p)->reprise, 1);
+}
+
+/**
+ * @param lot_p pointeur sur le lot
+ * @param numero numéro du thread demandeur
+ * @return indice du travail pris, AUCUN_TRAVAIL s'il n'en reste plus
+ * @brief Prend le prochain travail de la file du thread, ou à défaut vole le dernier travail d'une autre file
+ *
+ * Les travaux ne sont jamais ajoutés après le lancement des threads : toutes les files vides signifient la fin.
+ */
+size_t prendre_travail(struct Lot_s *lot_p, unsigned int numero)
+{
+	struct FileTravaux_s *file_p=&lot_p->files[numero];
+	size_t indice=AUCUN_TRAVAIL;
+	unsigned int i;
+
+	pthread_mutex_lock(&file_p->verrou);
+	if (file_p->tete<file_p->queue) indice=file_p->indices[file_p->tete++];
+	pthread_mutex_unlock(&file_p->verrou);
+
+	for (i=1; (indice==AUCUN_TRAVAIL) && (i<lot_p->nb_threads); i++) {
+		file_p=&lot_p->files[(numero+i)%lot_p->nb_threads];
+		pthread_mutex_lock(&file_p->verrou);
+		if (file_p->tete<file_p->queue) indice=file_p->indices[--file_p->queue];
+		pthread_mutex_unlock(&file_p->verrou);
+	}
+	return indice;
+}
+
+/**
+ * @param lot_p pointeur sur le lot
+ * @param travail_p pointeur sur le travail à exécuter
+ * @return Rien
+ * @brief Assemble un fichier du lot avec ses propres diagnostics et son propre profil
+ */
+void executer_travail(struct Lot_s *lot_p, struct Travail_s *travail_p)
+{
+	struct Assemblage_s *assemblage_p;
+
+	diag_installer(travail_p->diag_p);
+	profil_installer(travail_p->profil_p);
+
+	assemblage_p=creer_assemblage();
+	if (!setjmp(travail_p->reprise))
+		travail_p->resultat=assembler_fichier(assemblage_p, travail_p->source, travail_p->fichier_objet,
+				lot_p->options_p, lot_p->dictionnaires_p, travail_p->listage_p);
+	else
+		travail_p->resultat=FAILURE;
+
+	profil_debut(travail_p->profil_p, ETAPE_LIBERATION);
+	assemblage_p=detruire_assemblage(assemblage_p);
+	profil_fin(travail_p->profil_p, ETAPE_LIBERATION);
+	profil_cumuler(travail_p->profil_p);
+
+	profil_installer(NULL);
+	diag_installer(NULL);
+
+	pthread_mutex_lock(&lot_p->verrou);
+	travail_p->termine=TRUE;
+	pthread_cond_broadcast(&lot_p->travail_termine);
+	pthread_mutex_unlock(&lot_p->verrou);
+}
+
+/**
+ * @param parametre_p pointeur sur les paramètres du thread (struct Ouvrier_s)
+ * @return NULL
+ * @brief Corps d'un thread du lot : exécute des travaux tant qu'il en reste
+ */
+void *ouvrier_lot(void *parametre_p)
+{
+	struct Ouvrier_s *ouvrier_p=parametre_p;
+	size_t indice;
+
+	while (AUCUN_TRAVAIL!=(indice=prendre_travail(ouvrier_p->lot_p, ouvrier_p->numero)))
+		executer_travail(ouvrier_p->lot_p, &ouvrier_p->lot_p->travaux[indice]);
+	return NULL;
+}
+
+/**
+ * @param travail_p pointeur sur le travail terminé
+ * @param profilage_json TRUE pour écrire le profil en JSON
+ * @return Rien
+ * @brief Ecrit les sorties gardées en mémoire d'un travail puis les libère
+ */
+void emettre_travail(struct Travail_s *travail_p, int profilage_json)
+{
+	struct Sortie_s *rapport_p;
+
+	/* les diagnostics d'abord, comme pour un fichier seul */
+	travail_p->diag_p->descripteur=STDERR_FILENO;
+	travail_p->diag_p=detruire_diag(travail_p->diag_p);
+
+	if (travail_p->listage_p) {
+		travail_p->listage_p->descripteur=STDOUT_FILENO;
+		travail_p->listage_p=detruire_sortie(travail_p->listage_p);
+	}
+
+	if (travail_p->profil_p) {
+		rapport_p=creer_sortie(STDERR_FILENO, 0);
+		ecrire_profil(rapport_p, travail_p->profil_p, profilage_json);
+		rapport_p=detruire_sortie(rapport_p);
+		travail_p->profil_p=detruire_profil(travail_p->profil_p);
+	}
+	free(travail_p->fichier_objet);
+	travail_p->fichier_objet=NULL;
+}
+
+/**
+ * @param sources noms des fichiers sources
+ * @param nb_sources nombre de fichiers sources
+ * @param nb_threads nombre de threads assembleurs
+ * @param options_p pointeur sur les options communes à tous les fichiers
+ * @param dictionnaires_p pointeur sur les dictionnaires chargés
+ * @param listage TRUE pour écrire le listage de chaque fichier sur la sortie standard
+ * @param profilage TRUE pour écrire le profil de chaque fichier sur la sortie d'erreur
+ * @param profilage_json TRUE pour écrire les profils en JSON
+ * @return SUCCESS si tous les fichiers ont été assemblés et écrits sans erreur, FAILURE sinon
+ * @brief Assemble un lot de fichiers, chacun produisant son fichier objet à côté de son source
+ *
+ * Les diagnostics reprennent la forme et la limite de répétitions du collecteur courant.
+ */
+int assembler_lot(char **sources, size_t nb_sources, unsigned int nb_threads, const struct OptionsAssemblage_s *options_p,
+		const struct Dictionnaires_s *dictionnaires_p, int listage, int profilage, int profilage_json)
+{
+	struct Diag_s *diag_p=diag_courant();
+	struct Lot_s lot;
+	struct Ouvrier_s *ouvriers;
+	pthread_t *threads;
+	struct Travail_s *travail_p;
+	int resultat=SUCCESS;
+	unsigned int t;
+	size_t i;
+
+	if (nb_threads<1) nb_threads=1;
+	if (nb_threads>nb_sources) nb_threads=nb_sources;
+
+	memset(&lot, 0, sizeof(lot));
+	lot.nb_travaux=nb_sources;
+	lot.nb_threads=nb_threads;
+	lot.options_p=options_p;
+	lot.dictionnaires_p=dictionnaires_p;
+	lot.travaux=calloc(nb_sources, sizeof(*lot.travaux));
+	lot.files=calloc(nb_threads, sizeof(*lot.files));
+	ouvriers=calloc(nb_threads, sizeof(*ouvriers));
+	threads=calloc(nb_threads, sizeof(*threads));
+	if ((!lot.travaux) || (!lot.files) || (!ouvriers) || (!threads)) ERROR_MSG("Impossible de créer le lot de fichiers");
+	pthread_mutex_init(&lot.verrou, NULL);
+	pthread_cond_init(&lot.travail_termine, NULL);
+
+	/* toutes les sorties sont créées avant le lancement des threads */
+	for (i=0; i<nb_sources; i++) {
+		travail_p=&lot.travaux[i];
+		travail_p->source=sources[i];
+		travail_p->fichier_objet=nom_fichier_objet(sources[i], options_p->image.format);
+		travail_p->diag_p=creer_diag(diag_p->format, -1);
+		travail_p->diag_p->max_repetitions=diag_p->max_repetitions;
+		travail_p->diag_p->fichier_source=sources[i];
+		travail_p->diag_p->fn_fatale_p=reprendre_travail;
+		travail_p->diag_p->contexte_fatal_p=travail_p;
+		if (listage) {
+			travail_p->listage_p=creer_sortie(-1, 0);
+			travail_p->listage_p->couleur=isatty(STDOUT_FILENO);
+		}
+		if (profilage) travail_p->profil_p=creer_profil(sources[i]);
+	}
+
+	/* répartition à tour de rôle : chaque thread commence par les premiers fichiers, qui sont écrits en premier */
+	for (t=0; t<nb_threads; t++) {
+		pthread_mutex_init(&lot.files[t].verrou, NULL);
+		if (!(lot.files[t].indices=malloc((nb_sources/nb_threads+1)*sizeof(*lot.files[t].indices))))
+			ERROR_MSG("Impossible de créer une file de travaux");
+	}
+	for (i=0; i<nb_sources; i++) {
+		t=i%nb_threads;
+		lot.files[t].indices[lot.files[t].queue++]=i;
+	}
+
+	for (t=0; t<nb_threads; t++) {
+		ouvriers[t].lot_p=&lot;
+		ouvriers[t].numero=t;
+		if (pthread_create(&threads[t], NULL, ouvrier_lot, &ouvriers[t]))
+			ERROR_MSG("Impossible de lancer un thread d'assemblage");
+	}
+
+	/* écrit les sorties dans l'ordre des fichiers, chacune dès que possible */
+	for (i=0; i<nb_sources; i++) {
+		travail_p=&lot.travaux[i];
+		pthread_mutex_lock(&lot.verrou);
+		while (!travail_p->termine) pthread_cond_wait(&lot.travail_termine, &lot.verrou);
+		pthread_mutex_unlock(&lot.verrou);
+
+		emettre_travail(travail_p, profilage_json);
+		if (travail_p->resultat==FAILURE) resultat=FAILURE;
+	}
+
+	for (t=0; t<nb_threads; t++) {
+		pthread_join(threads[t], NULL);
+		pthread_mutex_destroy(&lot.files[t].verrou);
+		free(lot.files[t].indices);
+	}
+	pthread_cond_destroy(&lot.travail_termine);
+	pthread_mutex_destroy(&lot.verrou);
+	free(threads);
+	free(ouvriers);
+	free(lot.files);
+	free(lot.travaux);
+	return resultat;
+}
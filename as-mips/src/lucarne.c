@@ -0,0 +1,268 @@
+/**
+ * @file lucarne.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions de l'optimisation à lucarne de .text
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <string.h>
+
+#include <global.h>
+#include <notify.h>
+#include <profil.h>
+#include <liste.h>
+#include <table.h>
+#include <dico.h>
+#include <lex.h>
+#include <syn.h>
+#include <gen.h>
+#include <pseudo.h>
+#include <expression.h>
+#include <relaxation.h>
+#include <delais.h>
+#include <lucarne.h>
+
+int copie_identique(struct Instruction_s *precedente_p, struct Instruction_s *instruction_p, struct AnalyseSyntaxe_s *analyse_p);
+int immediat_neutre(struct Instruction_s *precedente_p, struct Instruction_s *instruction_p, struct AnalyseSyntaxe_s *analyse_p);
+int registre_neutre(struct Instruction_s *precedente_p, struct Instruction_s *instruction_p, struct AnalyseSyntaxe_s *analyse_p);
+int meme_adresse(struct Instruction_s *precedente_p, struct Instruction_s *instruction_p, struct AnalyseSyntaxe_s *analyse_p);
+int saut_suivante(struct Instruction_s *precedente_p, struct Instruction_s *instruction_p, struct AnalyseSyntaxe_s *analyse_p);
+
+/* règles de la lucarne, essayées dans l'ordre */
+static const struct RegleLucarne_s REGLES_LUCARNE[]={
+	{NULL,  "MOVE",  copie_identique, A_RETIRER, CPT_LUCARNE_MOVE},
+	{NULL,  "ADDI",  immediat_neutre, A_RETIRER, CPT_LUCARNE_NEUTRE},
+	{NULL,  "ADDIU", immediat_neutre, A_RETIRER, CPT_LUCARNE_NEUTRE},
+	{NULL,  "ORI",   immediat_neutre, A_RETIRER, CPT_LUCARNE_NEUTRE},
+	{NULL,  "SLL",   immediat_neutre, A_RETIRER, CPT_LUCARNE_NEUTRE},
+	{NULL,  "SRL",   immediat_neutre, A_RETIRER, CPT_LUCARNE_NEUTRE},
+	{NULL,  "ROTR",  immediat_neutre, A_RETIRER, CPT_LUCARNE_NEUTRE},
+	{NULL,  "ADD",   registre_neutre, A_RETIRER, CPT_LUCARNE_NEUTRE},
+	{NULL,  "OR",    registre_neutre, A_RETIRER, CPT_LUCARNE_NEUTRE},
+	{NULL,  "XOR",   registre_neutre, A_RETIRER, CPT_LUCARNE_NEUTRE},
+	{NULL,  "SUB",   registre_neutre, A_RETIRER, CPT_LUCARNE_NEUTRE},
+	{"NOP", "NOP",   NULL,            A_RETIRER, CPT_LUCARNE_NOP},
+	{"SW",  "LW",    meme_adresse,    A_COPIER,  CPT_LUCARNE_SW_LW},
+	{NULL,  "BEQ",   saut_suivante,   A_RETIRER, CPT_LUCARNE_SAUT},
+	{NULL,  "BNE",   saut_suivante,   A_RETIRER, CPT_LUCARNE_SAUT},
+	{NULL,  "BGTZ",  saut_suivante,   A_RETIRER, CPT_LUCARNE_SAUT},
+	{NULL,  "BLEZ",  saut_suivante,   A_RETIRER, CPT_LUCARNE_SAUT},
+	{NULL,  "J",     saut_suivante,   A_RETIRER, CPT_LUCARNE_SAUT}
+};
+
+/**
+ * @param lexeme_p pointeur sur le lexème d'un opérande
+ * @param table_def_registres_p pointeur sur la table "dico" des registres
+ * @return numéro du registre, -1 si l'opérande n'est pas un registre connu
+ */
+int numero_registre(struct Lexeme_s *lexeme_p, struct Table_s *table_def_registres_p)
+{
+	struct DefinitionRegistre_s *registre_p;
+
+	if ((!lexeme_p) || (lexeme_p->nature!=L_REGISTRE) || (!(registre_p=donnee_table(table_def_registres_p, lexeme_p->data))))
+		return -1;
+	return (int)registre_p->valeur;
+}
+
+/**
+ * @param a_p pointeur sur le lexème d'un opérande
+ * @param b_p pointeur sur le lexème d'un autre
+ * @param table_def_registres_p pointeur sur la table "dico" des registres
+ * @return TRUE si les deux opérandes désignent le même registre
+ */
+int meme_registre(struct Lexeme_s *a_p, struct Lexeme_s *b_p, struct Table_s *table_def_registres_p)
+{
+	int a=numero_registre(a_p, table_def_registres_p);
+
+	return (a>=0) && (a==numero_registre(b_p, table_def_registres_p));
+}
+
+/**
+ * @return TRUE pour MOVE $x, $x
+ */
+int copie_identique(struct Instruction_s *precedente_p, struct Instruction_s *instruction_p, struct AnalyseSyntaxe_s *analyse_p)
+{
+	return meme_registre(instruction_p->operandes[0], instruction_p->operandes[1], analyse_p->table_def_registres_p);
+}
+
+/**
+ * @return TRUE pour une instruction $r, $r, 0 dont le dernier opérande est neutre (ADDI, ORI, SLL...)
+ */
+int immediat_neutre(struct Instruction_s *precedente_p, struct Instruction_s *instruction_p, struct AnalyseSyntaxe_s *analyse_p)
+{
+	long valeur;
+
+	return (meme_registre(instruction_p->operandes[0], instruction_p->operandes[1], analyse_p->table_def_registres_p))
+			&& (valeur_constante_pseudo(instruction_p->operandes[2], &valeur)) && (!valeur);
+}
+
+/**
+ * @return TRUE pour une instruction $r, $r, $zero dont le dernier opérande est neutre (ADD, OR, XOR, SUB)
+ */
+int registre_neutre(struct Instruction_s *precedente_p, struct Instruction_s *instruction_p, struct AnalyseSyntaxe_s *analyse_p)
+{
+	return (meme_registre(instruction_p->operandes[0], instruction_p->operandes[1], analyse_p->table_def_registres_p))
+			&& (!numero_registre(instruction_p->operandes[2], analyse_p->table_def_registres_p));
+}
+
+/**
+ * @return TRUE si le LW examiné lit l'adresse où le SW précédent vient d'écrire (même base, même décalage)
+ */
+int meme_adresse(struct Instruction_s *precedente_p, struct Instruction_s *instruction_p, struct AnalyseSyntaxe_s *analyse_p)
+{
+	struct Lexeme_s *a_p=precedente_p->operandes[1], *b_p=instruction_p->operandes[1];
+	long a, b;
+
+	if (!meme_registre(precedente_p->operandes[2], instruction_p->operandes[2], analyse_p->table_def_registres_p)) return FALSE;
+	if (numero_registre(precedente_p->operandes[0], analyse_p->table_def_registres_p)<0) return FALSE;
+	if ((valeur_constante_pseudo(a_p, &a)) && (valeur_constante_pseudo(b_p, &b))) return a==b;
+	return (a_p->nature==b_p->nature) && (!strcmp(a_p->data, b_p->data));
+}
+
+/**
+ * @return TRUE si le branchement ou le saut examiné va à l'instruction qui le suit
+ *
+ * Les délais ne sont pas encore remplis : en mode reorder, l'instruction suivante est écrite juste après.
+ */
+int saut_suivante(struct Instruction_s *precedente_p, struct Instruction_s *instruction_p, struct AnalyseSyntaxe_s *analyse_p)
+{
+	struct Lexeme_s *cible_p=instruction_p->operandes[instruction_p->definition_p->nb_ops-1];
+	struct Etiquette_s *etiquette_p;
+
+	if ((!cible_p) || (cible_p->nature!=L_SYMBOLE) || (!(etiquette_p=donnee_table(analyse_p->table_etiquettes_p, cible_p->data))))
+		return FALSE;
+	return (etiquette_p->section==S_TEXT) && (etiquette_p->decalage==instruction_p->decalage+4);
+}
+
+/**
+ * @param precedente_p pointeur sur l'instruction qui précède, NULL si elle ne peut pas faire partie d'un motif
+ * @param instruction_p pointeur sur l'instruction examinée
+ * @param analyse_p pointeur sur l'état de l'analyse syntaxique
+ * @return première règle dont le motif et la condition sont vérifiés, NULL si aucune
+ */
+const struct RegleLucarne_s *chercher_regle_lucarne(struct Instruction_s *precedente_p, struct Instruction_s *instruction_p,
+		struct AnalyseSyntaxe_s *analyse_p)
+{
+	const struct RegleLucarne_s *regle_p;
+
+	for (regle_p=REGLES_LUCARNE; regle_p<REGLES_LUCARNE+sizeof(REGLES_LUCARNE)/sizeof(*REGLES_LUCARNE); regle_p++) {
+		if (strcmp(regle_p->examinee, instruction_p->definition_p->nom)) continue;
+		if ((regle_p->precedente) && ((!precedente_p) || (strcmp(regle_p->precedente, precedente_p->definition_p->nom)))) continue;
+		if ((!regle_p->condition_p) || (regle_p->condition_p(precedente_p, instruction_p, analyse_p))) return regle_p;
+	}
+	return NULL;
+}
+
+/**
+ * @param liste_text_p pointeur sur la liste des instructions de .text
+ * @return TRUE si tous les branchements et sauts de .text visent une étiquette
+ *
+ * Un déplacement ou une adresse écrits en nombre ne suivraient pas les instructions retirées.
+ */
+int cibles_symboliques(struct Liste_s *liste_text_p)
+{
+	struct NoeudListe_s *noeud_p;
+	struct Instruction_s *instruction_p;
+	struct DefinitionInstruction_s *def_p;
+
+	for (noeud_p=liste_text_p->debut_liste_p; noeud_p; noeud_p=noeud_p->suivant_p) {
+		instruction_p=noeud_p->donnee_p;
+		def_p=instruction_p->definition_p;
+		if ((def_p->nb_ops) && (strchr("oa", def_p->champs[def_p->nb_ops-1]))
+				&& (instruction_p->operandes[def_p->nb_ops-1]) && (instruction_p->operandes[def_p->nb_ops-1]->nature!=L_SYMBOLE))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * @param analyse_p pointeur sur l'état de l'analyse syntaxique, toutes les lignes ayant été analysées
+ * @param recoder TRUE si les instructions ont déjà été codées : les copies qui remplacent un LW le sont aussi
+ * @return SUCCESS si les instructions modifiées ont pu être codées, FAILURE sinon
+ * @brief Applique les règles de la lucarne à chaque instruction de .text, puis décale les instructions, les
+ * étiquettes de .text et les pseudo-instructions à relaxer qui suivent les instructions retirées
+ *
+ * L'instruction qui précède est la dernière gardée : une instruction retirée peut former un nouveau motif avec
+ * la suivante (NOP, MOVE $t0,$t0, NOP).
+ */
+int optimiser_lucarne(struct AnalyseSyntaxe_s *analyse_p, int recoder)
+{
+	struct Liste_s *liste_text_p=analyse_p->liste_text_p;
+	struct Relaxation_s *relaxation_p=analyse_p->relaxation_p;
+	struct NoeudListe_s *noeud_p, *suivant_p, *garde_p=NULL;
+	struct Instruction_s *instruction_p, *precedente_p=NULL;
+	const struct RegleLucarne_s *regle_p;
+	struct DefinitionInstruction_s *move_p=NULL;
+	struct Etiquette_s *etiquette_p;
+	struct Lexeme_s *decalage_p;
+	uint32_t *etiquettes, *retraits=NULL, decalage;
+	size_t nb_etiquettes, e=0, nb_retraits=0, capacite_retraits=0, r=0, i;
+	unsigned int restant=0;
+	char msg_err[STRLEN];
+	int candidate, resultat=SUCCESS;
+
+	if ((!liste_text_p) || (!liste_text_p->debut_liste_p) || (!cibles_symboliques(liste_text_p))) return SUCCESS;
+	etiquettes=decalages_etiquettes_text(analyse_p->table_etiquettes_p, &nb_etiquettes);
+	decalage=((struct Instruction_s *)liste_text_p->debut_liste_p->donnee_p)->decalage;
+
+	for (noeud_p=liste_text_p->debut_liste_p; noeud_p; noeud_p=suivant_p) {
+		suivant_p=noeud_p->suivant_p;
+		instruction_p=noeud_p->donnee_p;
+
+		/* les expansions à relaxer et le code en mode noreorder restent tels quels */
+		if ((!restant) && (relaxation_p) && (r<relaxation_p->nb_pseudos) && (noeud_p==relaxation_p->pseudos[r].premier_p))
+			restant=relaxation_p->pseudos[r++].nb_noeuds;
+		candidate=(!restant) && (!instruction_p->ordre_fixe);
+
+		/* une étiquette désigne l'instruction, qui ne peut être ni retirée ni remplacée */
+		while ((e<nb_etiquettes) && (etiquettes[e]<instruction_p->decalage)) e++;
+		regle_p=((candidate) && ((e==nb_etiquettes) || (etiquettes[e]!=instruction_p->decalage))) ?
+				chercher_regle_lucarne(precedente_p, instruction_p, analyse_p) : NULL;
+
+		if (regle_p) {
+			PROFIL_COMPTER(regle_p->compteur);
+			if ((regle_p->action==A_COPIER)
+					&& (!meme_registre(instruction_p->operandes[0], precedente_p->operandes[0], analyse_p->table_def_registres_p))) {
+				if ((!move_p) && (!(move_p=donnee_table(analyse_p->table_def_instructions_p, "MOVE"))))
+					ERROR_MSG("L'instruction MOVE n'est pas dans le dictionnaire");
+				decalage_p=instruction_p->operandes[1];
+				if (decalage_p->nature==L_EXPRESSION) detruire_expression((struct Expression_s *)decalage_p);
+				instruction_p->definition_p=move_p;
+				instruction_p->operandes[1]=precedente_p->operandes[0];
+				instruction_p->operandes[2]=NULL;
+				if ((recoder) && (FAILURE==encoder_instruction(instruction_p, analyse_p->table_def_registres_p, msg_err)))
+					resultat=FAILURE;
+			} else {
+				if (nb_retraits==capacite_retraits) {
+					capacite_retraits=capacite_retraits ? 2*capacite_retraits : 64;
+					if (!(retraits=realloc(retraits, capacite_retraits*sizeof(*retraits))))
+						ERROR_MSG("Impossible d'agrandir la liste des instructions retirées par la lucarne");
+				}
+				retraits[nb_retraits++]=instruction_p->decalage;
+				detruit_instruction(retirer_apres_liste(liste_text_p, garde_p));
+				continue;
+			}
+		}
+		garde_p=noeud_p;
+		precedente_p=candidate ? instruction_p : NULL;
+		if (restant) restant--;
+	}
+	free(etiquettes);
+	if (!nb_retraits) return resultat;
+
+	/* chaque instruction retirée avance de 4 octets tout ce qui la suivait */
+	for (noeud_p=liste_text_p->debut_liste_p; noeud_p; noeud_p=noeud_p->suivant_p) {
+		((struct Instruction_s *)noeud_p->donnee_p)->decalage=decalage;
+		decalage+=4;
+	}
+	for (i=0; i<analyse_p->table_etiquettes_p->nbEltsMax; i++)
+		if (((etiquette_p=analyse_p->table_etiquettes_p->table[i])) && (etiquette_p->section==S_TEXT))
+			etiquette_p->decalage-=octets_avant(retraits, nb_retraits, etiquette_p->decalage);
+	if (relaxation_p)
+		for (r=0; r<relaxation_p->nb_pseudos; r++)
+			relaxation_p->pseudos[r].decalage-=octets_avant(retraits, nb_retraits, relaxation_p->pseudos[r].decalage);
+	analyse_p->decalage_text-=4*(uint32_t)nb_retraits;
+	free(retraits);
+	return resultat;
+}
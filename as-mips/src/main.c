@@ -11,11 +11,16 @@
 
 #include <global.h>
 #include <notify.h>
-#include <lex.h>
-#include <str_utils.h>
-#include <syn.h>
-#include <dico.h>
-#include <table.h>
+#include <diag.h>
+#include <image.h>
+#include <sortie.h>
+#include <profil.h>
+#include <assemblage.h>
+#include <estimation.h>
+#include <simulation.h>
+#include <graphe.h>
+#include <lot.h>
+#include <serveur.h>
 
 /**
  * @param exec Name of executable.
@@ -25,7 +30,39 @@
  */
 void print_usage( char *exec )
 {
-    fprintf(stderr, "Usage: %s file.s\n", exec);
+    fprintf(stderr, "Usage: %s [options] file.s\n", exec);
+    fprintf(stderr, "       %s [options] [-j N] a.s b.s ...\n", exec);
+    fprintf(stderr, "       %s --serve SOCKET|-\n", exec);
+    fprintf(stderr, "Options :\n");
+    fprintf(stderr, "  -p, --pipeline   analyses lexicale, syntaxique et codage en parallèle\n");
+    fprintf(stderr, "  -q, --quiet      n'écrit pas le listage sur la sortie standard\n");
+    fprintf(stderr, "  --cache REP      reprend du répertoire REP les résultats d'un assemblage identique (source, dictionnaires,\n");
+    fprintf(stderr, "                   version et options), ou y range ceux d'un assemblage réussi sans diagnostic\n");
+    fprintf(stderr, "  -O1, --peephole  retire les instructions inutiles (MOVE $x,$x, ADDI $r,$r,0, NOP en double, saut vers\n");
+    fprintf(stderr, "                   l'instruction suivante) et remplace un LW qui relit le SW précédent par un MOVE\n");
+    fprintf(stderr, "  --schedule       réordonne les instructions de chaque bloc de base pour éviter les attentes\n");
+    fprintf(stderr, "                   (chargement lu trop tôt, MFHI/MFLO trop près de MULT/DIV)\n");
+    fprintf(stderr, "  --estimate       écrit les cycles et les attentes estimés de chaque bloc de base et de chaque fonction\n");
+    fprintf(stderr, "                   de .text, sur un pipeline à 5 étages (sans lot ni cache des résultats)\n");
+    fprintf(stderr, "  --run            exécute le programme assemblé (depuis main, appels système de SPIM) puis écrit sur la\n");
+    fprintf(stderr, "                   sortie d'erreur les instructions exécutées par opération et par ligne source\n");
+    fprintf(stderr, "  --run-limit N    nombre maximal d'instructions exécutées par --run (1000000000 par défaut, 0 : illimité)\n");
+    fprintf(stderr, "  --cfg FICHIER    écrit le graphe de flot de contrôle de .text pour Graphviz (blocs, tailles, lignes\n");
+    fprintf(stderr, "                   et, avec --run, nombre d'exécutions de chaque bloc)\n");
+    fprintf(stderr, "  --cfg-json FICHIER  idem, en JSON (blocs avec successeurs et prédécesseurs, arcs) ; cumulable avec --cfg\n");
+    fprintf(stderr, "  -o FICHIER       écrit le fichier objet relogeable ELF32 (ou l'image choisie par -O)\n");
+    fprintf(stderr, "  -j N             assemble les fichiers avec N threads, chacun vers son fichier objet (a.s -> a.o)\n");
+    fprintf(stderr, "                   (--estimate, --run, --run-limit, --cfg et --cfg-json sont refusés, comme par --serve)\n");
+    fprintf(stderr, "  -O FORMAT        forme du fichier écrit : elf (par défaut), binary, ihex ou srec\n");
+    fprintf(stderr, "  -EB, -EL         cible gros-boutiste (par défaut) ou petit-boutiste\n");
+    fprintf(stderr, "  --base-text ADR, --base-data ADR, --base-bss ADR\n");
+    fprintf(stderr, "                   adresse d'une section dans l'image (par défaut .text en 0, les autres à la suite)\n");
+    fprintf(stderr, "  --gap-fill OCTET octet de remplissage des trous de l'image binaire (0 par défaut)\n");
+    fprintf(stderr, "  --diag FORMAT    forme des diagnostics : texte, couleur ou json\n");
+    fprintf(stderr, "  --diag-max N     nombre d'occurrences écrites d'un même diagnostic (0 : illimité)\n");
+    fprintf(stderr, "  --profile        écrit sur la sortie d'erreur les temps de chaque étape et les compteurs\n");
+    fprintf(stderr, "  --profile-json   idem, en un objet JSON sur une ligne\n");
+    fprintf(stderr, "  --serve SOCKET   attend les requêtes d'assemblage sur un socket Unix (- : entrée et sortie standard)\n");
 }
 
 /**
@@ -37,67 +74,127 @@ void print_usage( char *exec )
  */
 int main(int argc, char *argv[])
 {
-
-    unsigned int nbLignes 	= 0;
-    unsigned int nbEtiquettes = 0;
-    unsigned int nbInstructions = 0;
-
-    char         *file 	= NULL;
-    
-    struct Table_s *tableDefinitionInstructions_p=NULL;
-    struct Table_s *tableDefinitionRegistres_p=NULL;
-    struct Table_s *tableEtiquettes_p=NULL;
-    struct Liste_s *listeLexemes_p=NULL;
-    struct Liste_s *listeText_p=NULL;
-    struct Liste_s *listeData_p=NULL;
-    struct Liste_s *listeBss_p=NULL;
-
-    if (argc != 2) {
+    struct LigneCommande_s ligne;
+    int          lot = FALSE;
+    int          resultat = SUCCESS;
+
+    struct Dictionnaires_s dictionnaires;
+    struct Assemblage_s *assemblage_p=NULL;
+    struct Diag_s *diag_p=diag_courant();
+    struct Sortie_s *listage_p=NULL;
+    struct Profil_s *profil_p=NULL;
+    struct Sortie_s *rapport_p=NULL;
+    struct Estimation_s *estimation_p=NULL;
+    struct Simulation_s *simulation_p=NULL;
+    struct Sortie_s *sortie_programme_p=NULL;
+    struct GrapheFlot_s *graphe_p=NULL;
+
+    if (FAILURE==analyser_ligne_commande(argc, argv, &ligne, diag_p)) {
         print_usage(argv[0]);
         exit(EXIT_FAILURE);
     }
-    file = argv[argc-1];
-    if (NULL == file) {
-        fprintf(stderr, "Pas de nom pour le fichier assembleur. Abandon du traitement.\n" );
+    lot=(ligne.nb_threads) || (ligne.nb_sources>1);
+    if (((ligne.serveur) ? (ligne.nb_sources) || (ligne.fichier_objet) || (ligne.nb_threads) :
+    		(!ligne.nb_sources) || ((lot) && (ligne.fichier_objet))
+    		|| ((!lot) && (ligne.options.image.format!=SORTIE_ELF) && (!ligne.fichier_objet)))
+    		|| (((lot) || (ligne.serveur)) && (analyses_demandees(&ligne)))) {
+        print_usage(argv[0]);
         exit(EXIT_FAILURE);
     }
 
-    listeLexemes_p=creer_liste((fonctionDestructeur *)detruit_lexeme);
-    listeText_p=creer_liste(NULL);
-    listeData_p=creer_liste(NULL);
-    listeBss_p=creer_liste(NULL);
+    /* le profil est installé pour le thread principal, les étages de la chaîne le reprennent */
+    if ((ligne.profilage) && (!lot) && (!ligne.serveur)) profil_installer(profil_p=creer_profil(ligne.sources[0]));
+
+    /* les dictionnaires sont chargés une seule fois, puis seulement lus */
+    charger_dictionnaires(&dictionnaires);
+
+    if ((lot) || (ligne.serveur)) {
+    	if (ligne.serveur)
+    		/* les requêtes sont assemblées avec les dictionnaires et les tampons déjà prêts */
+    		resultat=servir(ligne.serveur, &dictionnaires);
+    	else {
+    		/* chaque fichier produit son fichier objet à côté de son source ; les threads du lot remplacent la chaîne */
+    		if (!ligne.nb_threads) ligne.nb_threads=(sysconf(_SC_NPROCESSORS_ONLN)>0) ? sysconf(_SC_NPROCESSORS_ONLN) : 1;
+    		ligne.options.pipeline=FALSE;
+    		resultat=assembler_lot(ligne.sources, ligne.nb_sources, ligne.nb_threads, &ligne.options, &dictionnaires,
+    				ligne.listage, ligne.profilage, ligne.profilage_json);
+    	}
+    	liberer_dictionnaires(&dictionnaires);
+    	liberer_ligne_commande(&ligne);
+    	diag_p=detruire_diag(diag_p);
+    	exit( (resultat==FAILURE) ? EXIT_FAILURE : EXIT_SUCCESS );
+    }
+    diag_p->fichier_source=ligne.sources[0];
 
-    /* ---------------- effectue l'analyse lexicale  -------------------*/
-    lex_load_file(file, listeLexemes_p, &nbLignes, &nbEtiquettes, &nbInstructions);
+    /* le listage est écrit par gros blocs, en couleur seulement sur un terminal */
+    if (ligne.listage) {
+        listage_p=creer_sortie(STDOUT_FILENO, 0);
+        listage_p->couleur=isatty(STDOUT_FILENO);
+    }
 
-    /* ---------------- print the lexical analysis -------------------*/
-    DEBUG_MSG("Le fichier source comporte %u lignes, %u étiquettes et %u instructions", nbLignes, nbEtiquettes, nbInstructions);
-	visualisation_liste_lexemes(listeLexemes_p);
+    /* l'estimation, la simulation et le graphe ont besoin des instructions, qu'un résultat repris du cache n'a pas */
+    if ((ligne.estimation) || (ligne.simulation) || (ligne.graphe) || (ligne.graphe_json)) ligne.options.cache_sorties=NULL;
 
-	/* Crée la table d'étiquettes pour pouvoir contenir toutes celles identifiées lors de l'analyse lexicale */
-	tableEtiquettes_p=creer_table(nbEtiquettes, clefEtiquette, NULL);
-	charge_def_instruction(&tableDefinitionInstructions_p, "src/dictionnaire_instructions.txt");
-	charge_def_registre(&tableDefinitionRegistres_p, "src/dictionnaire_registres.txt");
+    assemblage_p=creer_assemblage();
+    resultat=assembler_fichier(assemblage_p, ligne.sources[0], ligne.fichier_objet, &ligne.options, &dictionnaires, listage_p);
+    listage_p=detruire_sortie(listage_p);
 
-	/* effectue l'analyse syntaxique */
-	analyser_syntaxe(listeLexemes_p, tableDefinitionInstructions_p, tableDefinitionRegistres_p, tableEtiquettes_p, listeText_p, listeData_p, listeBss_p);
+    /* l'estimation des cycles suit le listage sur la sortie standard */
+    if ((ligne.estimation) && (resultat==SUCCESS)) {
+        estimation_p=creer_estimation(assemblage_p->text_p, dictionnaires.registres_p, assemblage_p->etiquettes_p);
+        rapport_p=creer_sortie(STDOUT_FILENO, 0);
+        ecrire_estimation(rapport_p, estimation_p);
+        rapport_p=detruire_sortie(rapport_p);
+        estimation_p=detruire_estimation(estimation_p);
+    }
 
-	/* affiche les résultats de l'analyse syntaxique */
-	affiche_table_etiquette(tableEtiquettes_p, "Table des étiquettes");
-	affiche_liste_donnee(listeData_p, tableEtiquettes_p, "Table des données de la section .data");
-	affiche_liste_donnee(listeBss_p, tableEtiquettes_p, "Table des données de la section .bss");
-	affiche_liste_instructions(listeText_p, tableEtiquettes_p, "Table des instructions de .text");
+    /* le graphe est construit avant la simulation, qui annote ensuite ses blocs */
+    if (((ligne.graphe) || (ligne.graphe_json)) && (resultat==SUCCESS)) graphe_p=creer_graphe(assemblage_p->text_p, assemblage_p->etiquettes_p);
+
+    /* le programme simulé écrit sur la sortie standard, le bilan de la simulation va sur la sortie d'erreur */
+    if ((ligne.simulation) && (resultat==SUCCESS)) {
+        profil_debut(profil_p, ETAPE_SIMULATION);
+        simulation_p=creer_simulation(assemblage_p->text_p, assemblage_p->data_p, assemblage_p->bss_p,
+                assemblage_p->etiquettes_p, &ligne.options.image, ligne.sources[0]);
+        if (simulation_p) {
+            simulation_p->limite=ligne.limite_simulation;
+            sortie_programme_p=creer_sortie(STDOUT_FILENO, 0);
+            executer_simulation(simulation_p, sortie_programme_p);
+            sortie_programme_p=detruire_sortie(sortie_programme_p);
+            rapport_p=creer_sortie(STDERR_FILENO, 0);
+            ecrire_simulation(rapport_p, simulation_p);
+            rapport_p=detruire_sortie(rapport_p);
+            if (graphe_p) annoter_graphe(graphe_p, simulation_p);
+            simulation_p=detruire_simulation(simulation_p);
+        } else
+            resultat=FAILURE;
+        profil_fin(profil_p, ETAPE_SIMULATION);
+    }
+    if (graphe_p) {
+        /* --cfg et --cfg-json peuvent être donnés ensemble : chaque format va dans son fichier */
+        if ((ligne.graphe) && (FAILURE==ecrire_graphe(ligne.graphe, graphe_p, FALSE, ligne.sources[0]))) resultat=FAILURE;
+        if ((ligne.graphe_json) && (FAILURE==ecrire_graphe(ligne.graphe_json, graphe_p, TRUE, ligne.sources[0]))) resultat=FAILURE;
+        graphe_p=detruire_graphe(graphe_p);
+    }
 
     /* ---------------- Libérer nos camarades pointeurs -------------------*/
-	tableEtiquettes_p=detruire_table(tableEtiquettes_p);
-    tableDefinitionInstructions_p=detruire_table(tableDefinitionInstructions_p);
-    tableDefinitionRegistres_p=detruire_table(tableDefinitionRegistres_p);
-
-	listeText_p=detruire_liste(listeText_p);
-    listeData_p=detruire_liste(listeData_p);
-    listeBss_p=detruire_liste(listeBss_p);
-	listeLexemes_p=detruire_liste(listeLexemes_p);
-
-	exit( EXIT_SUCCESS );
+	profil_debut(profil_p, ETAPE_LIBERATION);
+	assemblage_p=detruire_assemblage(assemblage_p);
+	liberer_dictionnaires(&dictionnaires);
+	profil_fin(profil_p, ETAPE_LIBERATION);
+
+	/* le rapport de profilage est écrit sur la sortie d'erreur, après les diagnostics */
+	if (profil_p) {
+		profil_cumuler(profil_p);
+		rapport_p=creer_sortie(STDERR_FILENO, 0);
+		ecrire_profil(rapport_p, profil_p, ligne.profilage_json);
+		rapport_p=detruire_sortie(rapport_p);
+		profil_p=detruire_profil(profil_p);
+	}
+	liberer_ligne_commande(&ligne);
+	diag_p=detruire_diag(diag_p);
+
+	/* un échec n'est signalé par le code de sortie que si un fichier ou une exécution était demandé */
+	exit( ((ligne.fichier_objet) || (ligne.simulation) || (ligne.graphe) || (ligne.graphe_json)) && (resultat==FAILURE)
+			? EXIT_FAILURE : EXIT_SUCCESS );
 }
-
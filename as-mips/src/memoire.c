@@ -0,0 +1,105 @@
+/**
+ * @file memoire.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions du bilan des allocations par sous-système
+ *
+ * Les compteurs sont globaux au processus et mis à jour par des opérations atomiques, les threads de
+ * l'assemblage en chaîne allouant en même temps. Tout ce module disparaît sans -DCOMPTER_MEMOIRE.
+ */
+
+#include <memoire.h>
+
+#ifdef COMPTER_MEMOIRE
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <global.h>
+#include <sortie.h>
+
+/**
+ * @struct BilanMemoire_s
+ * @brief Compteurs d'un sous-système
+ */
+struct BilanMemoire_s {
+	unsigned long nb_allocations;	/**< Nombre d'allocations */
+	unsigned long nb_liberations;	/**< Nombre de libérations */
+	size_t vivants;					/**< Octets alloués et pas encore libérés */
+	size_t pic;						/**< Maximum atteint par vivants */
+};
+
+static struct BilanMemoire_s bilans[NB_SOUS_SYSTEMES+1];	/**< Un bilan par sous-système, puis le total */
+static int bilan_enregistre=FALSE;
+
+static const char *NOMS_SOUS_SYSTEMES[NB_SOUS_SYSTEMES+1]={
+	"lexemes", "listes", "tables", "etiquettes", "instructions", "donnees", "dictionnaires", "pretraitement", "total"
+};
+
+/**
+ * @param bilan_p pointeur sur le bilan
+ * @param taille octets alloués
+ * @return Rien
+ * @brief Ajoute une allocation au bilan et met à jour son pic
+ */
+void bilan_allouer(struct BilanMemoire_s *bilan_p, size_t taille)
+{
+	size_t vivants, pic;
+
+	__atomic_add_fetch(&bilan_p->nb_allocations, 1, __ATOMIC_RELAXED);
+	vivants=__atomic_add_fetch(&bilan_p->vivants, taille, __ATOMIC_RELAXED);
+	pic=__atomic_load_n(&bilan_p->pic, __ATOMIC_RELAXED);
+	while ((vivants>pic) && (!__atomic_compare_exchange_n(&bilan_p->pic, &pic, vivants, TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED)));
+}
+
+/**
+ * @param sous_systeme sous-système qui alloue
+ * @param taille nombre d'octets alloués
+ * @return Rien
+ * @brief Compte une allocation ; le bilan est écrit à la fin du programme
+ */
+void memoire_allouer(enum SousSysteme_e sous_systeme, size_t taille)
+{
+	PROFIL_COMPTER(CPT_ALLOCATIONS);
+	if ((!__atomic_load_n(&bilan_enregistre, __ATOMIC_RELAXED)) && (!__atomic_exchange_n(&bilan_enregistre, TRUE, __ATOMIC_ACQ_REL)))
+		atexit(ecrire_bilan_memoire);
+	bilan_allouer(bilans+sous_systeme, taille);
+	bilan_allouer(bilans+NB_SOUS_SYSTEMES, taille);
+}
+
+/**
+ * @param sous_systeme sous-système qui libère
+ * @param taille nombre d'octets libérés (ceux de l'allocation correspondante)
+ * @return Rien
+ */
+void memoire_liberer(enum SousSysteme_e sous_systeme, size_t taille)
+{
+	__atomic_add_fetch(&bilans[sous_systeme].nb_liberations, 1, __ATOMIC_RELAXED);
+	__atomic_sub_fetch(&bilans[sous_systeme].vivants, taille, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&bilans[NB_SOUS_SYSTEMES].nb_liberations, 1, __ATOMIC_RELAXED);
+	__atomic_sub_fetch(&bilans[NB_SOUS_SYSTEMES].vivants, taille, __ATOMIC_RELAXED);
+}
+
+/**
+ * @return Rien
+ * @brief Ecrit le bilan des allocations sur la sortie d'erreur (appelée à la fin du programme)
+ *
+ * Des octets encore vivants à ce moment signalent une fuite du sous-système.
+ */
+void ecrire_bilan_memoire(void)
+{
+	struct Sortie_s *sortie_p=creer_sortie(STDERR_FILENO, 4096);
+	int i;
+
+	sortie_chaine(sortie_p, "Bilan mémoire  allocations  libérations  vivants (octets)  pic (octets)\n");
+	for (i=0; i<=NB_SOUS_SYSTEMES; i++) {
+		sortie_chaine_alignee(sortie_p, NOMS_SOUS_SYSTEMES[i], 13);
+		sortie_decimal(sortie_p, bilans[i].nb_allocations, 13);
+		sortie_decimal(sortie_p, bilans[i].nb_liberations, 13);
+		sortie_decimal(sortie_p, bilans[i].vivants, 18);
+		sortie_decimal(sortie_p, bilans[i].pic, 14);
+		sortie_caractere(sortie_p, '\n');
+	}
+	detruire_sortie(sortie_p);
+}
+
+#endif /* COMPTER_MEMOIRE */
@@ -0,0 +1,522 @@
+/**
+ * @file objet.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions d'écriture du fichier objet relogeable ELF32 (MIPS, gros ou petit boutiste)
+ *
+ * Les étiquettes définies deviennent des symboles globaux. Une référence à une étiquette définie est relogée par
+ * rapport au symbole de sa section (le décalage de l'étiquette est déjà dans le code), une référence à un
+ * symbole inconnu l'est par rapport à un symbole global non défini.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <global.h>
+#include <notify.h>
+#include <liste.h>
+#include <table.h>
+#include <dico.h>
+#include <lex.h>
+#include <syn.h>
+#include <gen.h>
+#include <expression.h>
+#include <objet.h>
+
+#ifndef EF_MIPS_ABI_O32
+#define EF_MIPS_ABI_O32		0x00001000
+#endif
+
+/* Indices des sections dans la table des sections */
+enum SectionElf_e {
+	SE_NULLE=0, SE_TEXT=1, SE_DATA=2, SE_BSS=3, SE_REL_TEXT=4, SE_REL_DATA=5, SE_SYMTAB=6, SE_STRTAB=7, SE_SHSTRTAB=8
+};
+
+/* Noms des sections, concaténés dans .shstrtab */
+static const char NOMS_SECTIONS_ELF[]="\0.text\0.data\0.bss\0.rel.text\0.rel.data\0.symtab\0.strtab\0.shstrtab";
+static const uint8_t BOURRAGE_ELF[4]={0, 0, 0, 0};
+
+/**
+ * @struct SymboleIndefini_s
+ * @brief Symbole référencé mais absent de la table des étiquettes
+ */
+struct SymboleIndefini_s {
+	char *nom;				/**< Nom du symbole (appartient au lexème) */
+	uint32_t indice;		/**< Indice du symbole dans .symtab */
+};
+
+char *clef_symbole_indefini(void *donnee_p)
+{
+	return donnee_p ? ((struct SymboleIndefini_s *)donnee_p)->nom : NULL;
+}
+
+void destruction_symbole_indefini(void *donnee_p)
+{
+	free(donnee_p);
+}
+
+/**
+ * @param etiquette1_p pointeur sur un pointeur d'étiquette
+ * @param etiquette2_p pointeur sur un pointeur d'étiquette
+ * @return négatif, nul ou positif suivant l'ordre des deux étiquettes
+ * @brief Ordonne les étiquettes par section puis par décalage, pour une table des symboles reproductible
+ */
+int comparer_etiquettes(const void *etiquette1_p, const void *etiquette2_p)
+{
+	const struct Etiquette_s *e1_p=*(struct Etiquette_s * const *)etiquette1_p;
+	const struct Etiquette_s *e2_p=*(struct Etiquette_s * const *)etiquette2_p;
+
+	if (e1_p->section!=e2_p->section) return (int)e1_p->section - (int)e2_p->section;
+	if (e1_p->decalage!=e2_p->decalage) return e1_p->decalage < e2_p->decalage ? -1 : 1;
+	return (int)e1_p->ligne - (int)e2_p->ligne;
+}
+
+/**
+ * @param objet_p pointeur sur l'objet en construction
+ * @param nom nom à ajouter
+ * @return position du nom dans .strtab
+ * @brief Ajoute un nom de symbole à .strtab
+ */
+uint32_t ajouter_chaine_elf(struct ObjetElf_s *objet_p, const char *nom)
+{
+	size_t longueur=strlen(nom)+1;
+	uint32_t position=objet_p->taille_chaines;
+
+	if (objet_p->taille_chaines+longueur > objet_p->capacite_chaines) {
+		objet_p->capacite_chaines=2*(objet_p->taille_chaines+longueur);
+		if (!(objet_p->chaines=realloc(objet_p->chaines, objet_p->capacite_chaines)))
+			ERROR_MSG("Impossible d'agrandir la table des noms de symboles");
+	}
+	memcpy(objet_p->chaines+position, nom, longueur);
+	objet_p->taille_chaines+=longueur;
+	return position;
+}
+
+/**
+ * @param objet_p pointeur sur l'objet en construction
+ * @param nom nom du symbole, NULL pour un symbole sans nom
+ * @param valeur valeur du symbole
+ * @param info type et portée du symbole (ELF32_ST_INFO)
+ * @param section indice de la section du symbole
+ * @return indice du symbole dans .symtab
+ * @brief Ajoute un symbole à .symtab
+ */
+uint32_t ajouter_symbole_elf(struct ObjetElf_s *objet_p, const char *nom, uint32_t valeur, unsigned char info, uint16_t section)
+{
+	Elf32_Sym *symbole_p;
+	int gb=objet_p->gros_boutiste;
+
+	if (objet_p->nb_symboles==objet_p->capacite_symboles) {
+		objet_p->capacite_symboles=objet_p->capacite_symboles ? 2*objet_p->capacite_symboles : 64;
+		if (!(objet_p->symboles=realloc(objet_p->symboles, objet_p->capacite_symboles*sizeof(*objet_p->symboles))))
+			ERROR_MSG("Impossible d'agrandir la table des symboles");
+	}
+	symbole_p=objet_p->symboles+objet_p->nb_symboles;
+	symbole_p->st_name=mot_cible(nom ? ajouter_chaine_elf(objet_p, nom) : 0, gb);
+	symbole_p->st_value=mot_cible(valeur, gb);
+	symbole_p->st_size=0;
+	symbole_p->st_info=info;
+	symbole_p->st_other=STV_DEFAULT;
+	symbole_p->st_shndx=demi_mot_cible(section, gb);
+	return objet_p->nb_symboles++;
+}
+
+/**
+ * @param objet_p pointeur sur l'objet en construction
+ * @param relocations_p pointeur sur les relocations de la section concernée
+ * @param decalage décalage de l'emplacement à reloger dans la section
+ * @param symbole indice du symbole dans .symtab
+ * @param type type de relocation MIPS
+ * @return Rien
+ * @brief Ajoute une entrée de relocation
+ */
+void ajouter_relocation_elf(struct ObjetElf_s *objet_p, struct Relocations_s *relocations_p, uint32_t decalage, uint32_t symbole, unsigned char type)
+{
+	if (relocations_p->nb==relocations_p->capacite) {
+		relocations_p->capacite=relocations_p->capacite ? 2*relocations_p->capacite : 64;
+		if (!(relocations_p->entrees=realloc(relocations_p->entrees, relocations_p->capacite*sizeof(*relocations_p->entrees))))
+			ERROR_MSG("Impossible d'agrandir une table de relocations");
+	}
+	relocations_p->entrees[relocations_p->nb].r_offset=mot_cible(decalage, objet_p->gros_boutiste);
+	relocations_p->entrees[relocations_p->nb].r_info=mot_cible(ELF32_R_INFO(symbole, type), objet_p->gros_boutiste);
+	relocations_p->nb++;
+}
+
+/**
+ * @param objet_p pointeur sur l'objet en construction
+ * @param table_etiquettes_p pointeur sur la table des étiquettes
+ * @param nom nom du symbole référencé
+ * @param section_p pointeur recevant la section de l'étiquette, S_INIT si elle n'est pas définie
+ * @return indice du symbole par rapport auquel reloger la référence
+ * @brief Choisit le symbole d'une relocation : symbole de section pour une étiquette définie, symbole non défini sinon
+ */
+uint32_t symbole_relocation_elf(struct ObjetElf_s *objet_p, struct Table_s *table_etiquettes_p, char *nom, enum Section_e *section_p)
+{
+	struct Etiquette_s *etiquette_p=donnee_table(table_etiquettes_p, nom);
+	struct SymboleIndefini_s *indefini_p;
+
+	if ((etiquette_p) && (etiquette_p->section!=S_INIT)) {
+		*section_p=etiquette_p->section;
+		return (uint32_t)etiquette_p->section; /* les symboles de section ont l'indice de leur section */
+	}
+
+	*section_p=S_INIT;
+	if (!(indefini_p=donnee_table(objet_p->indefinis_p, nom))) {
+		if (!(indefini_p=malloc(sizeof(*indefini_p)))) ERROR_MSG("Impossible de créer un symbole non défini");
+		indefini_p->nom=nom;
+		indefini_p->indice=ajouter_symbole_elf(objet_p, nom, 0, ELF32_ST_INFO(STB_GLOBAL, STT_NOTYPE), SHN_UNDEF);
+		ajouter_table(objet_p->indefinis_p, indefini_p);
+	}
+	return indefini_p->indice;
+}
+
+/**
+ * @param objet_p pointeur sur l'objet en construction
+ * @param decalage décalage du mot dans .text
+ * @param masque masque du champ
+ * @param valeur valeur du champ
+ * @return Rien
+ * @brief Remplace un champ d'un mot de .text, dans l'ordre des octets de la cible
+ */
+void completer_champ_elf(struct ObjetElf_s *objet_p, uint32_t decalage, uint32_t masque, uint32_t valeur)
+{
+	uint32_t mot;
+
+	memcpy(&mot, objet_p->contenu_text+decalage, 4);
+	mot=mot_cible(mot, objet_p->gros_boutiste) & ~masque;
+	mot|=valeur & masque;
+	mot=mot_cible(mot, objet_p->gros_boutiste);
+	memcpy(objet_p->contenu_text+decalage, &mot, 4);
+}
+
+/**
+ * @param objet_p pointeur sur l'objet en construction
+ * @param liste_text_p pointeur sur la liste des instructions
+ * @param table_etiquettes_p pointeur sur la table des étiquettes
+ * @return Rien
+ * @brief Crée les relocations des opérandes symboliques de .text et complète les champs qui en dépendent
+ *
+ * Un branchement vers une étiquette de .text est déjà résolu et n'est pas relogé. Pour un branchement vers un
+ * autre symbole, le champ reçoit l'addenda de R_MIPS_PC16 (cible - 4, en mots). Une expression relative à un
+ * symbole est relogée comme ce symbole (R_MIPS_HI16 pour %hi, y compris le champ 'H' d'une expansion de
+ * pseudo-instruction) ; pour un symbole non défini, le champ reçoit
+ * la partie constante de l'expression. Une expression constante n'est pas relogée.
+ */
+void reloger_text_elf(struct ObjetElf_s *objet_p, struct Liste_s *liste_text_p, struct Table_s *table_etiquettes_p)
+{
+	struct NoeudListe_s *noeud_p;
+	struct Instruction_s *instruction_p;
+	struct Etiquette_s *etiquette_p;
+	struct Lexeme_s *lexeme_p;
+	struct ValeurExpression_s valeur;
+	enum PartieExpression_e partie;
+	enum Section_e section;
+	uint32_t symbole, cible, addenda, masque;
+	const char *nom;
+	char msg_err[STRLEN];
+	char champ;
+	unsigned int i;
+
+	for (noeud_p=liste_text_p ? liste_text_p->debut_liste_p : NULL; noeud_p; noeud_p=noeud_p->suivant_p) {
+		instruction_p=(struct Instruction_s *)noeud_p->donnee_p;
+		for (i=0; i<instruction_p->definition_p->nb_ops; i++) {
+			if (!(lexeme_p=instruction_p->operandes[i])) continue;
+			champ=instruction_p->definition_p->champs[i];
+			if ((champ!='a') && (champ!='i') && (champ!='o') && (champ!='H') && (champ!='L')) continue;
+
+			partie=P_TOUT;
+			addenda=0;
+			if (lexeme_p->nature==L_SYMBOLE)
+				nom=lexeme_p->data;
+			else if (lexeme_p->nature==L_EXPRESSION) {
+				/* une expression invalide a déjà été signalée par la génération du code */
+				if ((FAILURE==evaluer_expression((struct Expression_s *)lexeme_p, table_etiquettes_p, NULL, &valeur, msg_err)) ||
+						(!valeur.symbole)) continue;
+				nom=valeur.symbole;
+				partie=((struct Expression_s *)lexeme_p)->partie;
+				addenda=valeur.addenda;
+			} else
+				continue;
+			if (champ=='H') partie=P_HI;
+			else if (champ=='L') partie=P_LO;
+
+			etiquette_p=donnee_table(table_etiquettes_p, (char *)nom);
+			if ((champ=='o') && (etiquette_p) && (etiquette_p->section==S_TEXT)) continue;
+
+			symbole=symbole_relocation_elf(objet_p, table_etiquettes_p, (char *)nom, &section);
+			masque=(champ=='a') ? 0x03FFFFFFu : 0xFFFFu;
+			cible=(section==S_INIT ? 0 : etiquette_p->decalage) + addenda;
+			if (champ=='o')
+				completer_champ_elf(objet_p, instruction_p->decalage, masque, (cible-4) >> 2);
+			else if (section==S_INIT)
+				completer_champ_elf(objet_p, instruction_p->decalage, masque, champ=='a' ? cible >> 2 : partie_expression(partie, cible));
+			ajouter_relocation_elf(objet_p, &objet_p->rel_text, instruction_p->decalage, symbole,
+					champ=='a' ? R_MIPS_26 : champ=='o' ? R_MIPS_PC16 : partie==P_HI ? R_MIPS_HI16 : R_MIPS_LO16);
+		}
+	}
+}
+
+/**
+ * @param objet_p pointeur sur l'objet en construction
+ * @param liste_data_p pointeur sur la liste des données de .data
+ * @param table_etiquettes_p pointeur sur la table des étiquettes
+ * @return Rien
+ * @brief Crée les relocations R_MIPS_32 des .word symboliques de .data
+ */
+void reloger_data_elf(struct ObjetElf_s *objet_p, struct Liste_s *liste_data_p, struct Table_s *table_etiquettes_p)
+{
+	struct NoeudListe_s *noeud_p;
+	struct Donnee_s *donnee_p;
+	enum Section_e section;
+	uint32_t symbole;
+
+	for (noeud_p=liste_data_p ? liste_data_p->debut_liste_p : NULL; noeud_p; noeud_p=noeud_p->suivant_p) {
+		donnee_p=(struct Donnee_s *)noeud_p->donnee_p;
+		if ((donnee_p->type!=D_WORD) || (donnee_p->lexeme_p->nature!=L_SYMBOLE)) continue;
+		symbole=symbole_relocation_elf(objet_p, table_etiquettes_p, donnee_p->lexeme_p->data, &section);
+		ajouter_relocation_elf(objet_p, &objet_p->rel_data, donnee_p->decalage, symbole, R_MIPS_32);
+	}
+}
+
+/**
+ * @param objet_p pointeur sur l'objet en construction
+ * @param section indice de la section
+ * @param nom position du nom dans .shstrtab
+ * @param type type de la section
+ * @param drapeaux attributs de la section
+ * @param donnees contenu de la section, NULL si elle n'occupe pas de place dans le fichier
+ * @param taille taille de la section
+ * @param lien, info, alignement, taille_entree champs sh_link, sh_info, sh_addralign et sh_entsize
+ * @return Rien
+ * @brief Décrit une section et ajoute son contenu (précédé du bourrage d'alignement) aux morceaux du fichier
+ */
+void placer_section_elf(struct ObjetElf_s *objet_p, enum SectionElf_e section, uint32_t nom, uint32_t type, uint32_t drapeaux,
+		const void *donnees, size_t taille, uint32_t lien, uint32_t info, uint32_t alignement, uint32_t taille_entree)
+{
+	Elf32_Shdr *entete_p=objet_p->sections+section;
+	int gb=objet_p->gros_boutiste;
+	size_t bourrage=(alignement - objet_p->taille_fichier % alignement) % alignement;
+
+	if ((donnees) && (taille) && (bourrage)) {
+		objet_p->vecteurs[objet_p->nb_vecteurs].iov_base=(void *)BOURRAGE_ELF;
+		objet_p->vecteurs[objet_p->nb_vecteurs++].iov_len=bourrage;
+		objet_p->taille_fichier+=bourrage;
+	}
+
+	entete_p->sh_name=mot_cible(nom, gb);
+	entete_p->sh_type=mot_cible(type, gb);
+	entete_p->sh_flags=mot_cible(drapeaux, gb);
+	entete_p->sh_addr=0;
+	entete_p->sh_offset=mot_cible(objet_p->taille_fichier, gb);
+	entete_p->sh_size=mot_cible(taille, gb);
+	entete_p->sh_link=mot_cible(lien, gb);
+	entete_p->sh_info=mot_cible(info, gb);
+	entete_p->sh_addralign=mot_cible(alignement, gb);
+	entete_p->sh_entsize=mot_cible(taille_entree, gb);
+
+	if ((donnees) && (taille)) {
+		objet_p->vecteurs[objet_p->nb_vecteurs].iov_base=(void *)donnees;
+		objet_p->vecteurs[objet_p->nb_vecteurs++].iov_len=taille;
+		objet_p->taille_fichier+=taille;
+	}
+}
+
+/**
+ * @param nom nom de la section
+ * @return position du nom dans .shstrtab
+ * @brief Retrouve la position d'un nom de section dans .shstrtab
+ */
+uint32_t nom_section_elf(const char *nom)
+{
+	const char *courant_p=NOMS_SECTIONS_ELF+1;
+
+	while (strcmp(courant_p, nom)) courant_p+=strlen(courant_p)+1;
+	return courant_p-NOMS_SECTIONS_ELF;
+}
+
+/**
+ * @param objet_p pointeur sur l'objet à construire
+ * @param liste_text_p pointeur sur la liste des instructions codées et résolues
+ * @param liste_data_p pointeur sur la liste des données de .data
+ * @param liste_bss_p pointeur sur la liste des réservations de .bss
+ * @param table_etiquettes_p pointeur sur la table des étiquettes complète
+ * @param gros_boutiste TRUE pour une cible gros-boutiste, FALSE pour une cible petit-boutiste
+ * @return Rien
+ * @brief Construit en mémoire toutes les sections du fichier objet et la liste des morceaux à écrire
+ */
+void construire_objet_elf(struct ObjetElf_s *objet_p,
+		struct Liste_s *liste_text_p, struct Liste_s *liste_data_p, struct Liste_s *liste_bss_p,
+		struct Table_s *table_etiquettes_p, int gros_boutiste)
+{
+	uint32_t taille_text=taille_section(liste_text_p, S_TEXT);
+	uint32_t taille_data=taille_section(liste_data_p, S_DATA);
+	uint32_t taille_bss=taille_section(liste_bss_p, S_BSS);
+	struct Etiquette_s **etiquettes_pp;
+	size_t i, nb_etiquettes=0;
+	uint32_t premier_global;
+	int gb=gros_boutiste;
+
+	memset(objet_p, 0, sizeof(*objet_p));
+	objet_p->gros_boutiste=gros_boutiste;
+	objet_p->indefinis_p=creer_table(0, clef_symbole_indefini, destruction_symbole_indefini);
+	objet_p->contenu_text=construire_section_text(liste_text_p, table_etiquettes_p, NULL, taille_text, gros_boutiste);
+	objet_p->contenu_data=construire_section_donnees(liste_data_p, table_etiquettes_p, NULL, taille_data, gros_boutiste);
+
+	/* symboles locaux : symbole nul puis un symbole par section de contenu */
+	ajouter_chaine_elf(objet_p, "");
+	ajouter_symbole_elf(objet_p, NULL, 0, ELF32_ST_INFO(STB_LOCAL, STT_NOTYPE), SHN_UNDEF);
+	for (i=SE_TEXT; i<=SE_BSS; i++)
+		ajouter_symbole_elf(objet_p, NULL, 0, ELF32_ST_INFO(STB_LOCAL, STT_SECTION), i);
+	premier_global=objet_p->nb_symboles;
+
+	/* symboles globaux définis, dans l'ordre des adresses */
+	if (!(etiquettes_pp=malloc((table_etiquettes_p->nbElts+1)*sizeof(*etiquettes_pp))))
+		ERROR_MSG("Impossible de trier les étiquettes");
+	for (i=0; i<table_etiquettes_p->nbEltsMax; i++)
+		if ((table_etiquettes_p->table[i]) && (((struct Etiquette_s *)table_etiquettes_p->table[i])->section!=S_INIT))
+			etiquettes_pp[nb_etiquettes++]=table_etiquettes_p->table[i];
+	qsort(etiquettes_pp, nb_etiquettes, sizeof(*etiquettes_pp), comparer_etiquettes);
+	for (i=0; i<nb_etiquettes; i++)
+		ajouter_symbole_elf(objet_p, etiquettes_pp[i]->lexeme_p->data, etiquettes_pp[i]->decalage,
+				ELF32_ST_INFO(STB_GLOBAL, etiquettes_pp[i]->section==S_TEXT ? STT_FUNC : STT_OBJECT), etiquettes_pp[i]->section);
+	free(etiquettes_pp);
+
+	/* symboles globaux non définis, créés au fil des relocations */
+	reloger_text_elf(objet_p, liste_text_p, table_etiquettes_p);
+	reloger_data_elf(objet_p, liste_data_p, table_etiquettes_p);
+
+	/* entête */
+	memcpy(objet_p->entete.e_ident, ELFMAG, SELFMAG);
+	objet_p->entete.e_ident[EI_CLASS]=ELFCLASS32;
+	objet_p->entete.e_ident[EI_DATA]=gros_boutiste ? ELFDATA2MSB : ELFDATA2LSB;
+	objet_p->entete.e_ident[EI_VERSION]=EV_CURRENT;
+	objet_p->entete.e_ident[EI_OSABI]=ELFOSABI_SYSV;
+	objet_p->entete.e_type=demi_mot_cible(ET_REL, gb);
+	objet_p->entete.e_machine=demi_mot_cible(EM_MIPS, gb);
+	objet_p->entete.e_version=mot_cible(EV_CURRENT, gb);
+	objet_p->entete.e_flags=mot_cible(EF_MIPS_ARCH_32R2 | EF_MIPS_ABI_O32, gb);
+	objet_p->entete.e_ehsize=demi_mot_cible(sizeof(Elf32_Ehdr), gb);
+	objet_p->entete.e_shentsize=demi_mot_cible(sizeof(Elf32_Shdr), gb);
+	objet_p->entete.e_shnum=demi_mot_cible(NB_SECTIONS_ELF, gb);
+	objet_p->entete.e_shstrndx=demi_mot_cible(SE_SHSTRTAB, gb);
+	objet_p->vecteurs[0].iov_base=&objet_p->entete;
+	objet_p->vecteurs[0].iov_len=sizeof(Elf32_Ehdr);
+	objet_p->nb_vecteurs=1;
+	objet_p->taille_fichier=sizeof(Elf32_Ehdr);
+
+	/* sections, dans l'ordre du fichier */
+	placer_section_elf(objet_p, SE_TEXT, nom_section_elf(".text"), SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR,
+			objet_p->contenu_text, taille_text, 0, 0, 4, 0);
+	placer_section_elf(objet_p, SE_DATA, nom_section_elf(".data"), SHT_PROGBITS, SHF_ALLOC | SHF_WRITE,
+			objet_p->contenu_data, taille_data, 0, 0, 4, 0);
+	placer_section_elf(objet_p, SE_BSS, nom_section_elf(".bss"), SHT_NOBITS, SHF_ALLOC | SHF_WRITE,
+			NULL, taille_bss, 0, 0, 4, 0);
+	placer_section_elf(objet_p, SE_REL_TEXT, nom_section_elf(".rel.text"), SHT_REL, 0,
+			objet_p->rel_text.entrees, objet_p->rel_text.nb*sizeof(Elf32_Rel), SE_SYMTAB, SE_TEXT, 4, sizeof(Elf32_Rel));
+	placer_section_elf(objet_p, SE_REL_DATA, nom_section_elf(".rel.data"), SHT_REL, 0,
+			objet_p->rel_data.entrees, objet_p->rel_data.nb*sizeof(Elf32_Rel), SE_SYMTAB, SE_DATA, 4, sizeof(Elf32_Rel));
+	placer_section_elf(objet_p, SE_SYMTAB, nom_section_elf(".symtab"), SHT_SYMTAB, 0,
+			objet_p->symboles, objet_p->nb_symboles*sizeof(Elf32_Sym), SE_STRTAB, premier_global, 4, sizeof(Elf32_Sym));
+	placer_section_elf(objet_p, SE_STRTAB, nom_section_elf(".strtab"), SHT_STRTAB, 0,
+			objet_p->chaines, objet_p->taille_chaines, 0, 0, 1, 0);
+	placer_section_elf(objet_p, SE_SHSTRTAB, nom_section_elf(".shstrtab"), SHT_STRTAB, 0,
+			NOMS_SECTIONS_ELF, sizeof(NOMS_SECTIONS_ELF), 0, 0, 1, 0);
+
+	/* table des sections, alignée sur 4 octets */
+	if (objet_p->taille_fichier%4) {
+		objet_p->vecteurs[objet_p->nb_vecteurs].iov_base=(void *)BOURRAGE_ELF;
+		objet_p->vecteurs[objet_p->nb_vecteurs++].iov_len=4-objet_p->taille_fichier%4;
+		objet_p->taille_fichier+=4-objet_p->taille_fichier%4;
+	}
+	objet_p->entete.e_shoff=mot_cible(objet_p->taille_fichier, gb);
+	objet_p->vecteurs[objet_p->nb_vecteurs].iov_base=objet_p->sections;
+	objet_p->vecteurs[objet_p->nb_vecteurs++].iov_len=sizeof(objet_p->sections);
+	objet_p->taille_fichier+=sizeof(objet_p->sections);
+}
+
+/**
+ * @param objet_p pointeur sur l'objet construit
+ * @param descripteur descripteur du fichier de sortie
+ * @return SUCCESS si tout le fichier a été écrit, FAILURE sinon (errno renseigné)
+ * @brief Ecrit le fichier objet d'un seul writev, en reprenant là où il s'est arrêté s'il n'écrit pas tout
+ */
+int ecrire_objet_elf(struct ObjetElf_s *objet_p, int descripteur)
+{
+	struct iovec *vecteurs_p=objet_p->vecteurs;
+	int nb_vecteurs=objet_p->nb_vecteurs;
+	ssize_t nb;
+
+	while (nb_vecteurs) {
+		nb=writev(descripteur, vecteurs_p, nb_vecteurs);
+		if (nb<0) {
+			if (errno==EINTR) continue;
+			return FAILURE;
+		}
+		while ((nb_vecteurs) && ((size_t)nb>=vecteurs_p->iov_len)) {
+			nb-=vecteurs_p->iov_len;
+			vecteurs_p++;
+			nb_vecteurs--;
+		}
+		if (nb_vecteurs) {
+			vecteurs_p->iov_base=(char *)vecteurs_p->iov_base+nb;
+			vecteurs_p->iov_len-=nb;
+		}
+	}
+	return SUCCESS;
+}
+
+/**
+ * @param objet_p pointeur sur l'objet
+ * @return Rien
+ * @brief Libère les tampons de l'objet
+ */
+void liberer_objet_elf(struct ObjetElf_s *objet_p)
+{
+	free(objet_p->contenu_text);
+	free(objet_p->contenu_data);
+	free(objet_p->rel_text.entrees);
+	free(objet_p->rel_data.entrees);
+	free(objet_p->symboles);
+	free(objet_p->chaines);
+	objet_p->indefinis_p=detruire_table(objet_p->indefinis_p);
+	memset(objet_p, 0, sizeof(*objet_p));
+}
+
+/**
+ * @param nom_fichier nom du fichier objet à créer
+ * @param liste_text_p pointeur sur la liste des instructions codées et résolues
+ * @param liste_data_p pointeur sur la liste des données de .data
+ * @param liste_bss_p pointeur sur la liste des réservations de .bss
+ * @param table_etiquettes_p pointeur sur la table des étiquettes complète
+ * @param gros_boutiste TRUE pour une cible gros-boutiste, FALSE pour une cible petit-boutiste
+ * @return SUCCESS si le fichier a été écrit, FAILURE sinon
+ * @brief Construit et écrit le fichier objet relogeable ELF32
+ */
+int generer_objet_elf(const char *nom_fichier,
+		struct Liste_s *liste_text_p, struct Liste_s *liste_data_p, struct Liste_s *liste_bss_p,
+		struct Table_s *table_etiquettes_p, int gros_boutiste)
+{
+	struct ObjetElf_s objet;
+	int descripteur, resultat;
+
+	if ((descripteur=open(nom_fichier, O_WRONLY | O_CREAT | O_TRUNC, 0666))<0) {
+		diag_signaler(NULL, DIAG_ERREUR, nom_fichier, 0, "objet", "impossible de créer le fichier objet : %s", strerror(errno));
+		return FAILURE;
+	}
+
+	construire_objet_elf(&objet, liste_text_p, liste_data_p, liste_bss_p, table_etiquettes_p, gros_boutiste);
+	resultat=ecrire_objet_elf(&objet, descripteur);
+	if (resultat==FAILURE)
+		diag_signaler(NULL, DIAG_ERREUR, nom_fichier, 0, "objet", "impossible d'écrire le fichier objet : %s", strerror(errno));
+	liberer_objet_elf(&objet);
+
+	if ((close(descripteur)) && (resultat==SUCCESS)) {
+		diag_signaler(NULL, DIAG_ERREUR, nom_fichier, 0, "objet", "impossible de terminer le fichier objet : %s", strerror(errno));
+		resultat=FAILURE;
+	}
+	return resultat;
+}
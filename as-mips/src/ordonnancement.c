@@ -0,0 +1,208 @@
+/**
+ * @file ordonnancement.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions d'ordonnancement des instructions de .text
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <string.h>
+
+#include <global.h>
+#include <notify.h>
+#include <profil.h>
+#include <liste.h>
+#include <table.h>
+#include <dico.h>
+#include <lex.h>
+#include <syn.h>
+#include <dependances.h>
+#include <delais.h>
+#include <ordonnancement.h>
+
+/**
+ * @param effets_p pointeur sur les effets de l'instruction
+ * @param prets cycle à partir duquel chaque registre peut être lu
+ * @param cycle cycle de l'instruction précédente
+ * @return premier cycle où l'instruction peut commencer sans lire un registre qui n'est pas prêt
+ */
+long debut_instruction(const struct EffetsInstruction_s *effets_p, const long prets[NB_REGISTRES_EFFETS], long cycle)
+{
+	long debut=cycle+1;
+	int r;
+
+	for (r=1; r<NB_REGISTRES_EFFETS; r++)
+		if ((effets_p->lus & BIT_REGISTRE(r)) && (prets[r]>debut)) debut=prets[r];
+	return debut;
+}
+
+/**
+ * @param effets_p pointeur sur les effets de l'instruction
+ * @param prets cycle à partir duquel chaque registre peut être lu, mis à jour
+ * @param debut cycle où l'instruction commence
+ * @return Rien
+ */
+void lancer_instruction(const struct EffetsInstruction_s *effets_p, long prets[NB_REGISTRES_EFFETS], long debut)
+{
+	int r;
+
+	for (r=1; r<NB_REGISTRES_EFFETS; r++)
+		if (effets_p->ecrits & BIT_REGISTRE(r)) prets[r]=debut+effets_p->latence;
+}
+
+/**
+ * @param effets effets des instructions du bloc, dans l'ordre du source
+ * @param ordre indices des instructions dans l'ordre d'exécution
+ * @param nb nombre d'instructions
+ * @return nombre de cycles d'attente de cette suite, le processeur lançant au plus une instruction par cycle
+ */
+unsigned long cycles_attente(const struct EffetsInstruction_s *effets, const int *ordre, int nb)
+{
+	long prets[NB_REGISTRES_EFFETS], cycle=-1, debut;
+	unsigned long attente=0;
+	int i;
+
+	memset(prets, 0, sizeof(prets));
+	for (i=0; i<nb; i++) {
+		debut=debut_instruction(effets+ordre[i], prets, cycle);
+		attente+=debut-cycle-1;
+		lancer_instruction(effets+ordre[i], prets, debut);
+		cycle=debut;
+	}
+	return attente;
+}
+
+/**
+ * @param effets effets des instructions du bloc, dans l'ordre du source
+ * @param nb nombre d'instructions (au plus ORDONNANCEMENT_BLOC_MAX)
+ * @param ordre tableau recevant les indices des instructions dans le nouvel ordre
+ * @return Rien
+ * @brief Ordonnancement par liste : une instruction est prête quand toutes celles dont elle dépend sont placées ;
+ * parmi les prêtes, celle qui peut commencer le plus tôt est placée, la première du source en cas d'égalité
+ */
+void ordonner_bloc(const struct EffetsInstruction_s *effets, int nb, int *ordre)
+{
+	uint64_t precedentes[ORDONNANCEMENT_BLOC_MAX], placees=0;
+	long prets[NB_REGISTRES_EFFETS], cycle=-1, debut, meilleur_debut=0;
+	int i, j, k, meilleure;
+
+	for (i=0; i<nb; i++)
+		for (precedentes[i]=0, j=0; j<i; j++)
+			if (!effets_independants(effets+i, effets+j)) precedentes[i]|=(uint64_t)1 << j;
+
+	memset(prets, 0, sizeof(prets));
+	for (k=0; k<nb; k++) {
+		for (meilleure=-1, i=0; i<nb; i++) {
+			if (((placees >> i) & 1) || (precedentes[i] & ~placees)) continue;
+			debut=debut_instruction(effets+i, prets, cycle);
+			if ((meilleure<0) || (debut<meilleur_debut)) {
+				meilleure=i;
+				meilleur_debut=debut;
+			}
+		}
+		ordre[k]=meilleure;
+		placees|=(uint64_t)1 << meilleure;
+		lancer_instruction(effets+meilleure, prets, meilleur_debut);
+		cycle=meilleur_debut;
+	}
+}
+
+/**
+ * @param bloc noeuds consécutifs des instructions qui peuvent être déplacées
+ * @param effets effets de ces instructions, suivis de ceux de l'instruction fixe qui termine le bloc s'il y en a une
+ * @param nb nombre d'instructions du bloc
+ * @param terminal TRUE si effets[nb] est l'instruction qui termine le bloc
+ * @param restantes_p pointeur sur le nombre de cycles d'attente restants, augmenté de ceux du bloc
+ * @return nombre de cycles d'attente supprimés dans le bloc
+ * @brief Réordonne un bloc si le nouvel ordre attend moins, l'instruction qui le termine comprise ; les noeuds
+ * gardent leurs décalages et reçoivent les instructions dans le nouvel ordre
+ */
+unsigned long reordonner_bloc(struct NoeudListe_s **bloc, const struct EffetsInstruction_s *effets, int nb, int terminal,
+		unsigned long *restantes_p)
+{
+	void *donnees[ORDONNANCEMENT_BLOC_MAX];
+	int source[ORDONNANCEMENT_BLOC_MAX+1], ordre[ORDONNANCEMENT_BLOC_MAX+1];
+	unsigned long avant, apres;
+	uint32_t decalage;
+	int i;
+
+	for (i=0; i<=nb; i++) source[i]=i;
+	avant=cycles_attente(effets, source, nb+(terminal ? 1 : 0));
+	if ((nb<2) || (!avant)) {
+		*restantes_p+=avant;
+		return 0;
+	}
+	ordonner_bloc(effets, nb, ordre);
+	ordre[nb]=nb;
+	apres=cycles_attente(effets, ordre, nb+(terminal ? 1 : 0));
+	if (apres>=avant) {
+		*restantes_p+=avant;
+		return 0;
+	}
+
+	decalage=((struct Instruction_s *)bloc[0]->donnee_p)->decalage;
+	for (i=0; i<nb; i++) donnees[i]=bloc[ordre[i]]->donnee_p;
+	for (i=0; i<nb; i++) {
+		bloc[i]->donnee_p=donnees[i];
+		((struct Instruction_s *)donnees[i])->decalage=decalage;
+		decalage+=4;
+	}
+	*restantes_p+=apres;
+	return avant-apres;
+}
+
+/**
+ * @param liste_text_p pointeur sur la liste des instructions de .text, délais remplis et expansions relaxées
+ * @param table_def_registres_p pointeur sur la table "dico" des registres
+ * @param table_etiquettes_p pointeur sur la table des étiquettes
+ * @return nombre de cycles d'attente supprimés
+ * @brief Réordonne les instructions de chaque bloc de base pour masquer les latences des chargements et de HI/LO
+ *
+ * Un bloc est une suite d'instructions qui peuvent être déplacées, commencée par une étiquette ou après une
+ * instruction fixe, et d'au plus ORDONNANCEMENT_BLOC_MAX instructions. Les instructions déjà codées (mode
+ * pipeline) le restent : aucune instruction déplacée n'a de champ relatif à son adresse.
+ */
+unsigned long ordonnancer_text(struct Liste_s *liste_text_p, struct Table_s *table_def_registres_p, struct Table_s *table_etiquettes_p)
+{
+	struct NoeudListe_s *bloc[ORDONNANCEMENT_BLOC_MAX], *noeud_p;
+	struct EffetsInstruction_s effets[ORDONNANCEMENT_BLOC_MAX+1];
+	struct Instruction_s *instruction_p;
+	uint32_t *etiquettes;
+	size_t nb_etiquettes, e=0;
+	unsigned long supprimees=0, restantes=0;
+	int nb=0, delai=FALSE, fixe;
+
+	if ((!liste_text_p) || (!liste_text_p->debut_liste_p)) return 0;
+	etiquettes=decalages_etiquettes_text(table_etiquettes_p, &nb_etiquettes);
+
+	for (noeud_p=liste_text_p->debut_liste_p; noeud_p; noeud_p=noeud_p->suivant_p) {
+		instruction_p=noeud_p->donnee_p;
+
+		/* une étiquette commence un nouveau bloc */
+		while ((e<nb_etiquettes) && (etiquettes[e]<instruction_p->decalage)) e++;
+		if ((e<nb_etiquettes) && (etiquettes[e]==instruction_p->decalage)) {
+			supprimees+=reordonner_bloc(bloc, effets, nb, FALSE, &restantes);
+			nb=0;
+		}
+
+		effets_instruction(instruction_p, table_def_registres_p, effets+nb);
+		fixe=(delai) || (instruction_p->ordre_fixe) || (effets[nb].nature & (EFFET_BARRIERE | EFFET_RANGEMENT));
+		delai=((effets[nb].nature & EFFET_DELAI)!=0);
+		if (fixe) {
+			supprimees+=reordonner_bloc(bloc, effets, nb, TRUE, &restantes);
+			nb=0;
+		} else {
+			bloc[nb++]=noeud_p;
+			if (nb==ORDONNANCEMENT_BLOC_MAX) {
+				supprimees+=reordonner_bloc(bloc, effets, nb, FALSE, &restantes);
+				nb=0;
+			}
+		}
+	}
+	supprimees+=reordonner_bloc(bloc, effets, nb, FALSE, &restantes);
+	free(etiquettes);
+
+	profil_compteurs[CPT_ATTENTES_EVITEES]+=supprimees;
+	profil_compteurs[CPT_ATTENTES_RESTANTES]+=restantes;
+	return supprimees;
+}
@@ -0,0 +1,279 @@
+/**
+ * @file pipeline.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Assemblage en chaîne : analyse lexicale, analyse syntaxique et codage s'exécutent chacun dans un thread
+ *
+ * L'analyse lexicale produit des lots de lignes de lexèmes, l'analyse syntaxique les rattache à la liste de
+ * lexèmes et en tire des lots d'instructions que l'étage de codage transforme en code machine.
+ * Les étages communiquent par des files circulaires sans verrou ; un pointeur NULL marque la fin du flux.
+ * La résolution des symboles a lieu après la fin de la chaîne, une fois la table des étiquettes complète.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <global.h>
+#include <notify.h>
+#include <liste.h>
+#include <table.h>
+#include <lex.h>
+#include <syn.h>
+#include <gen.h>
+#include <pipeline.h>
+#include <profil.h>
+
+#define NB_ATTENTES_ACTIVES	64		/**< Nombre d'essais avant de rendre la main au système quand la file est vide ou pleine */
+
+/**
+ * @struct EtagesPipeline_s
+ * @brief Données partagées par les étages de la chaîne
+ */
+struct EtagesPipeline_s {
+	struct Anneau_s *anneau_lexemes_p;		/**< Lots de lexèmes de l'analyse lexicale vers l'analyse syntaxique */
+	struct Anneau_s *anneau_instructions_p;	/**< Lots d'instructions de l'analyse syntaxique vers le codage */
+	struct Liste_s *liste_lexemes_p;		/**< Liste de tous les lexèmes, complétée par l'analyse syntaxique */
+	struct AnalyseSyntaxe_s *analyse_p;		/**< Etat de l'analyse syntaxique */
+	int resultat_codage;					/**< Résultat de l'étage de codage */
+	struct Diag_s *diag_p;					/**< Collecteur de diagnostics du thread appelant, partagé par les étages */
+	struct Profil_s *profil_p;				/**< Profil du thread appelant, NULL si l'assemblage n'est pas profilé */
+};
+
+/**
+ * @param nb_cases nombre minimal de cases de la file
+ * @return pointeur sur la file créée
+ * @brief Crée une file circulaire dont le nombre de cases est arrondi à la puissance de 2 supérieure
+ */
+struct Anneau_s *creer_anneau(size_t nb_cases)
+{
+	size_t taille=1;
+	struct Anneau_s *anneau_p=calloc(1, sizeof(*anneau_p));
+
+	if (!anneau_p) ERROR_MSG("Impossible de créer une file circulaire");
+	while (taille<nb_cases) taille<<=1;
+
+	anneau_p->cases=calloc(taille, sizeof(*anneau_p->cases));
+	if (!anneau_p->cases) ERROR_MSG("Impossible de créer les cases de la file circulaire");
+	anneau_p->masque=taille-1;
+	return anneau_p;
+}
+
+/**
+ * @param anneau_p pointeur sur la file à détruire
+ * @return NULL
+ * @brief Détruit la file circulaire (les éléments encore présents ne sont pas libérés)
+ */
+struct Anneau_s *detruire_anneau(struct Anneau_s *anneau_p)
+{
+	if (anneau_p) {
+		free(anneau_p->cases);
+		free(anneau_p);
+	}
+	return NULL;
+}
+
+/**
+ * @param anneau_p pointeur sur la file
+ * @param element_p élément à déposer
+ * @return Rien
+ * @brief Dépose un élément dans la file, en attendant qu'une case se libère si elle est pleine
+ *
+ * Ne doit être appelée que par l'unique producteur de la file.
+ */
+void deposer_anneau(struct Anneau_s *anneau_p, void *element_p)
+{
+	size_t tete=anneau_p->tete;
+	int essais=0;
+
+	while (tete - __atomic_load_n(&anneau_p->queue, __ATOMIC_ACQUIRE) > anneau_p->masque)
+		if (++essais >= NB_ATTENTES_ACTIVES) {
+			sched_yield();
+			essais=0;
+		}
+
+	anneau_p->cases[tete & anneau_p->masque]=element_p;
+	__atomic_store_n(&anneau_p->tete, tete+1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @param anneau_p pointeur sur la file
+ * @return élément retiré
+ * @brief Retire le plus ancien élément de la file, en attendant qu'il y en ait un si elle est vide
+ *
+ * Ne doit être appelée que par l'unique consommateur de la file.
+ */
+void *retirer_anneau(struct Anneau_s *anneau_p)
+{
+	size_t queue=anneau_p->queue;
+	void *element_p;
+	int essais=0;
+
+	while (__atomic_load_n(&anneau_p->tete, __ATOMIC_ACQUIRE) == queue)
+		if (++essais >= NB_ATTENTES_ACTIVES) {
+			sched_yield();
+			essais=0;
+		}
+
+	element_p=anneau_p->cases[queue & anneau_p->masque];
+	__atomic_store_n(&anneau_p->queue, queue+1, __ATOMIC_RELEASE);
+	return element_p;
+}
+
+/**
+ * @param arg_p pointeur sur les données partagées de la chaîne
+ * @return NULL
+ * @brief Etage d'analyse syntaxique : rattache chaque lot de lexèmes à la liste et l'analyse
+ *
+ * Les instructions ajoutées à la liste .text lors de l'analyse d'un lot sont transmises à l'étage de codage.
+ */
+void *etage_syntaxe(void *arg_p)
+{
+	struct EtagesPipeline_s *etages_p=arg_p;
+	struct Liste_s *liste_text_p=etages_p->analyse_p->liste_text_p;
+	struct Liste_s *lot_lexemes_p;
+	struct LotInstructions_s *lot_instructions_p;
+	struct NoeudListe_s *premier_lexeme_p;
+	struct NoeudListe_s *fin_lexemes_p;
+	struct NoeudListe_s *fin_text_p;
+
+	diag_installer(etages_p->diag_p);
+	profil_installer(etages_p->profil_p);
+	profil_debut(etages_p->profil_p, ETAPE_SYNTAXE);
+	while ((lot_lexemes_p=retirer_anneau(etages_p->anneau_lexemes_p))) {
+		/* les lexèmes du lot reçoivent de nouveaux noeuds à la fin de la liste */
+		fin_lexemes_p=etages_p->liste_lexemes_p->fin_liste_p;
+		concatener_liste(etages_p->liste_lexemes_p, lot_lexemes_p);
+		premier_lexeme_p=fin_lexemes_p ? fin_lexemes_p->suivant_p : etages_p->liste_lexemes_p->debut_liste_p;
+		detruire_liste(lot_lexemes_p);
+
+		fin_text_p=liste_text_p->fin_liste_p;
+		analyser_lignes(etages_p->analyse_p, premier_lexeme_p);
+
+		if (liste_text_p->fin_liste_p != fin_text_p) {
+			if (!(lot_instructions_p=malloc(sizeof(*lot_instructions_p)))) ERROR_MSG("Impossible de créer un lot d'instructions");
+			lot_instructions_p->premier_p=fin_text_p ? fin_text_p->suivant_p : liste_text_p->debut_liste_p;
+			lot_instructions_p->dernier_p=liste_text_p->fin_liste_p;
+			deposer_anneau(etages_p->anneau_instructions_p, lot_instructions_p);
+		}
+	}
+	deposer_anneau(etages_p->anneau_instructions_p, NULL);
+	profil_fin(etages_p->profil_p, ETAPE_SYNTAXE);
+	profil_cumuler(etages_p->profil_p);
+	return NULL;
+}
+
+/**
+ * @param arg_p pointeur sur les données partagées de la chaîne
+ * @return NULL
+ * @brief Etage de codage : calcule le code machine de chaque lot d'instructions reçu
+ */
+void *etage_codage(void *arg_p)
+{
+	struct EtagesPipeline_s *etages_p=arg_p;
+	struct LotInstructions_s *lot_instructions_p;
+
+	diag_installer(etages_p->diag_p);
+	profil_installer(etages_p->profil_p);
+	profil_debut(etages_p->profil_p, ETAPE_CODAGE);
+	etages_p->resultat_codage=SUCCESS;
+	while ((lot_instructions_p=retirer_anneau(etages_p->anneau_instructions_p))) {
+		if (FAILURE==encoder_lot_instructions(lot_instructions_p->premier_p, lot_instructions_p->dernier_p, etages_p->analyse_p->table_def_registres_p))
+			etages_p->resultat_codage=FAILURE;
+		free(lot_instructions_p);
+	}
+	profil_fin(etages_p->profil_p, ETAPE_CODAGE);
+	profil_cumuler(etages_p->profil_p);
+	return NULL;
+}
+
+/**
+ * @param lot_p pointeur sur le lot de lexèmes en cours de constitution
+ * @param fin_precedente_p dernier noeud du lot avant l'analyse de la dernière ligne
+ * @param significative ancienne valeur, conservée si la ligne ne contenait aucun lexème
+ * @return TRUE si la dernière ligne contient autre chose que des étiquettes et des commentaires
+ * @brief Indique si le lot peut être coupé après la dernière ligne analysée
+ *
+ * Une étiquette seule sur sa ligne a besoin de la ligne suivante pour connaître son alignement
+ * (cf. suite_est_directive_word), on ne coupe donc jamais un lot juste après une telle ligne.
+ */
+int ligne_est_significative(struct Liste_s *lot_p, struct NoeudListe_s *fin_precedente_p, int significative)
+{
+	struct NoeudListe_s *noeud_p=fin_precedente_p ? fin_precedente_p->suivant_p : lot_p->debut_liste_p;
+	struct Lexeme_s *lexeme_p;
+
+	if (noeud_p) significative=FALSE;
+	for (; noeud_p; noeud_p=noeud_p->suivant_p) {
+		lexeme_p=(struct Lexeme_s *)noeud_p->donnee_p;
+		if ((lexeme_p->nature!=L_ETIQUETTE) && (lexeme_p->nature!=L_COMMENTAIRE) && (lexeme_p->nature!=L_FIN_LIGNE))
+			return TRUE;
+	}
+	return significative;
+}
+
+/**
+ * @param fp Le fichier source asssembleur ouvert en lecture, lu jusqu'au bout mais pas fermé
+ * @param nom_fichier Le nom du fichier source asssembleur, pour les diagnostics
+ * @param liste_lexemes_p Un pointeur sur la liste (générique) recevant tous les lexèmes
+ * @param analyse_p Un pointeur sur l'état de l'analyse syntaxique déjà initialisé
+ * @param nb_lignes_p Le pointeur vers le compteur de nombre de lignes
+ * @param nb_etiquettes_p Le pointeur vers le compteur de nombre d'étiquettes
+ * @param nb_instructions_p Le pointeur vers le compteur de nombre d'instructions
+ * @return SUCCESS si l'analyse syntaxique et le codage n'ont pas rencontré d'erreur, FAILURE sinon
+ * @brief Assemble le fichier en faisant travailler en parallèle les analyses lexicale, syntaxique et le codage
+ *
+ * L'analyse lexicale s'exécute dans le thread appelant. La table des étiquettes de analyse_p doit pouvoir
+ * s'agrandir car le nombre d'étiquettes n'est pas connu à l'avance. Au retour, il reste à résoudre les symboles.
+ */
+int assembler_en_pipeline(FILE *fp, const char *nom_fichier, struct Liste_s *liste_lexemes_p, struct AnalyseSyntaxe_s *analyse_p,
+		unsigned int *nb_lignes_p, unsigned int *nb_etiquettes_p, unsigned int *nb_instructions_p)
+{
+	struct EtagesPipeline_s etages;
+	pthread_t thread_syntaxe, thread_codage;
+	struct Liste_s *lot_p;
+	struct NoeudListe_s *fin_precedente_p;
+	unsigned int nb_lignes_lot;
+	int significative;
+
+	*nb_lignes_p=0;
+
+	etages.anneau_lexemes_p=creer_anneau(TAILLE_ANNEAU);
+	etages.anneau_instructions_p=creer_anneau(TAILLE_ANNEAU);
+	etages.liste_lexemes_p=liste_lexemes_p;
+	etages.analyse_p=analyse_p;
+	etages.diag_p=diag_courant();
+	etages.profil_p=profil_courant();
+
+	if (pthread_create(&thread_syntaxe, NULL, etage_syntaxe, &etages))
+		ERROR_MSG("Impossible de lancer le thread d'analyse syntaxique");
+	if (pthread_create(&thread_codage, NULL, etage_codage, &etages))
+		ERROR_MSG("Impossible de lancer le thread de codage");
+
+	profil_debut(etages.profil_p, ETAPE_LEXICALE);
+	while (!feof(fp)) {
+		lot_p=creer_liste(NULL);
+		nb_lignes_lot=0;
+		significative=TRUE;
+		while (!feof(fp) && ((nb_lignes_lot<TAILLE_LOT_LIGNES) || (!significative))) {
+			fin_precedente_p=lot_p->fin_liste_p;
+			nb_lignes_lot+=lex_read_lines(fp, lot_p, 1, nb_lignes_p, nb_etiquettes_p, nb_instructions_p);
+			significative=ligne_est_significative(lot_p, fin_precedente_p, significative);
+		}
+		if (lot_p->nbElements)
+			deposer_anneau(etages.anneau_lexemes_p, lot_p);
+		else
+			detruire_liste(lot_p);
+	}
+	deposer_anneau(etages.anneau_lexemes_p, NULL);
+	profil_fin(etages.profil_p, ETAPE_LEXICALE);
+
+	pthread_join(thread_syntaxe, NULL);
+	pthread_join(thread_codage, NULL);
+
+	etages.anneau_lexemes_p=detruire_anneau(etages.anneau_lexemes_p);
+	etages.anneau_instructions_p=detruire_anneau(etages.anneau_instructions_p);
+
+	if (!*nb_lignes_p) diag_signaler(NULL, DIAG_AVERTISSEMENT, nom_fichier, 0, "fichier-vide", "le fichier est vide");
+	return ((analyse_p->resultat==SUCCESS) && (etages.resultat_codage==SUCCESS)) ? SUCCESS : FAILURE;
+}
@@ -0,0 +1,657 @@
+/**
+ * @file pretraitement.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions des directives .include et .macro/.endm
+ *
+ * Chaque ligne est d'abord analysée dans une liste à part. Une ligne ordinaire est rattachée telle quelle à
+ * la liste des lexèmes (en temps constant) ; seules les directives de prétraitement et les appels de macros
+ * sont traités. Une ligne est vue comme un tableau de pointeurs sur ses lexèmes, qu'ils soient ceux de la
+ * ligne du source ou ceux d'une séquence rangée ; chaque profondeur d'imbrication a son tableau, réutilisé
+ * d'une ligne à l'autre.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include <global.h>
+#include <notify.h>
+#include <diag.h>
+#include <str_utils.h>
+#include <memoire.h>
+#include <lex.h>
+#include <pretraitement.h>
+
+static __thread struct Pretraitement_s *pretraitement_thread_p=NULL;	/**< Prétraitement installé pour le thread courant */
+
+int traiter_vue(struct Pretraitement_s *pretraitement_p, unsigned int profondeur, size_t nb, unsigned int num_ligne,
+		struct Liste_s *liste_lexemes_p, struct Liste_s *ligne_p, unsigned int *nb_etiquettes_p, unsigned int *nb_instructions_p);
+
+/**
+ * @param sequence_p pointeur sur une séquence
+ * @return nom de la séquence
+ */
+char *clef_sequence(void *sequence_p)
+{
+	return ((struct SequenceLexemes_s *)sequence_p)->nom;
+}
+
+/**
+ * @param sequence_p pointeur sur une séquence
+ * @return Rien
+ */
+void detruire_sequence(void *sequence_p)
+{
+	MEMOIRE_LIBERER(MEM_PRETRAITEMENT, ((struct SequenceLexemes_s *)sequence_p)->taille);
+	free(sequence_p);
+}
+
+/**
+ * @param nom nom de la séquence
+ * @param ligne ligne de la définition, 0 pour un fichier inclus
+ * @param parametres paramètres de la macro, sans le '\' initial
+ * @param nb_parametres nombre de paramètres
+ * @param lexemes_p liste des lexèmes à ranger, qui n'est pas modifiée
+ * @return pointeur sur la séquence créée d'un seul bloc
+ */
+struct SequenceLexemes_s *creer_sequence(const char *nom, unsigned int ligne, char **parametres, unsigned int nb_parametres,
+		struct Liste_s *lexemes_p)
+{
+	struct SequenceLexemes_s *sequence_p;
+	struct NoeudListe_s *noeud_p;
+	struct Lexeme_s *lexeme_p;
+	size_t taille, nb=lexemes_p->nbElements;
+	char *texte_p;
+	unsigned int i;
+
+	/* les pointeurs des paramètres suivent les lexèmes, les textes viennent en dernier */
+	taille=sizeof(*sequence_p)+(nb ? nb-1 : 0)*sizeof(struct Lexeme_s)+nb_parametres*sizeof(char *)+strlen(nom)+1;
+	for (i=0; i<nb_parametres; i++) taille+=strlen(parametres[i])+2;
+	for (noeud_p=lexemes_p->debut_liste_p; noeud_p; noeud_p=noeud_p->suivant_p)
+		if (((struct Lexeme_s *)noeud_p->donnee_p)->data) taille+=strlen(((struct Lexeme_s *)noeud_p->donnee_p)->data)+1;
+
+	if (!(sequence_p=malloc(taille))) ERROR_MSG("Impossible de ranger une séquence de lexèmes");
+	MEMOIRE_ALLOUER(MEM_PRETRAITEMENT, taille);
+	sequence_p->taille=taille;
+	sequence_p->ligne=ligne;
+	sequence_p->nb_lexemes=nb;
+	sequence_p->nb_parametres=nb_parametres;
+	sequence_p->parametres=(char **)(sequence_p->lexemes+(nb ? nb : 1));
+	texte_p=(char *)(sequence_p->parametres+nb_parametres);
+
+	sequence_p->nom=strcpy(texte_p, nom);
+	texte_p+=strlen(nom)+1;
+	for (i=0; i<nb_parametres; i++) {
+		sequence_p->parametres[i]=texte_p;
+		*texte_p='\\';
+		strcpy(texte_p+1, parametres[i]);
+		texte_p+=strlen(parametres[i])+2;
+	}
+	for (noeud_p=lexemes_p->debut_liste_p, i=0; noeud_p; noeud_p=noeud_p->suivant_p, i++) {
+		lexeme_p=(struct Lexeme_s *)noeud_p->donnee_p;
+		sequence_p->lexemes[i]=*lexeme_p;
+		if (lexeme_p->data) {
+			sequence_p->lexemes[i].data=strcpy(texte_p, lexeme_p->data);
+			texte_p+=strlen(lexeme_p->data)+1;
+		}
+	}
+	return sequence_p;
+}
+
+/**
+ * @param source source assemblé, qui doit rester valable jusqu'à la destruction du prétraitement
+ * @param inclusions_interdites TRUE pour refuser .include (aucun fichier n'est lu)
+ * @return pointeur sur le prétraitement créé
+ */
+struct Pretraitement_s *creer_pretraitement(const char *source, int inclusions_interdites)
+{
+	struct Pretraitement_s *pretraitement_p=calloc(1, sizeof(*pretraitement_p));
+	const char *barre_p=strrchr(source, '/');
+
+	if (!pretraitement_p) ERROR_MSG("Impossible de créer le prétraitement");
+	pretraitement_p->source=source;
+	pretraitement_p->inclusions_interdites=inclusions_interdites;
+	pretraitement_p->resultat=SUCCESS;
+	pretraitement_p->ligne_p=creer_liste(detruit_lexeme);
+	if (barre_p) {
+		if (!(pretraitement_p->repertoire=malloc(barre_p-source+1))) ERROR_MSG("Impossible de créer le prétraitement");
+		memcpy(pretraitement_p->repertoire, source, barre_p-source);
+		pretraitement_p->repertoire[barre_p-source]='\0';
+	}
+	return pretraitement_p;
+}
+
+/**
+ * @param pretraitement_p pointeur sur le prétraitement
+ * @return Rien
+ * @brief Abandonne la définition de macro en cours
+ */
+void abandonner_macro(struct Pretraitement_s *pretraitement_p)
+{
+	unsigned int i;
+
+	pretraitement_p->corps_p=detruire_liste(pretraitement_p->corps_p);
+	free(pretraitement_p->nom_macro);
+	pretraitement_p->nom_macro=NULL;
+	for (i=0; i<pretraitement_p->nb_parametres; i++) free(pretraitement_p->parametres[i]);
+	pretraitement_p->nb_parametres=0;
+}
+
+/**
+ * @param pretraitement_p pointeur sur le prétraitement, à la fin du source ou d'un fichier inclus
+ * @param fichier fichier qui se termine, NULL pour le source
+ * @param ligne ligne de la directive .macro dans ce fichier
+ * @return Rien
+ * @brief Signale et abandonne la définition de macro restée ouverte à la fin d'un fichier
+ */
+void verifier_fin_macro(struct Pretraitement_s *pretraitement_p, const char *fichier, unsigned int ligne)
+{
+	if (pretraitement_p->corps_p) {
+		diag_signaler(NULL, DIAG_ERREUR, fichier, ligne, "macro", "la macro %s n'est pas terminée par .endm", pretraitement_p->nom_macro);
+		pretraitement_p->resultat=FAILURE;
+		abandonner_macro(pretraitement_p);
+	}
+}
+
+/**
+ * @param pretraitement_p pointeur sur le prétraitement, à la fin du source
+ * @return SUCCESS si le prétraitement n'a signalé aucune erreur, FAILURE sinon
+ * @brief Vérifie que toutes les définitions de macros sont terminées
+ */
+int terminer_pretraitement(struct Pretraitement_s *pretraitement_p)
+{
+	verifier_fin_macro(pretraitement_p, NULL, pretraitement_p->ligne_macro);
+	return pretraitement_p->resultat;
+}
+
+/**
+ * @param pretraitement_p pointeur sur le prétraitement, NULL accepté
+ * @return NULL
+ */
+struct Pretraitement_s *detruire_pretraitement(struct Pretraitement_s *pretraitement_p)
+{
+	int i;
+
+	if (pretraitement_p) {
+		abandonner_macro(pretraitement_p);
+		detruire_liste(pretraitement_p->ligne_p);
+		detruire_table(pretraitement_p->inclusions_p);
+		detruire_table(pretraitement_p->macros_p);
+		for (i=0; i<=PRETRAITEMENT_PROFONDEUR_MAX; i++) free(pretraitement_p->vues[i]);
+		free(pretraitement_p->repertoire);
+		free(pretraitement_p);
+	}
+	return NULL;
+}
+
+/**
+ * @return pointeur sur le prétraitement installé pour le thread courant, NULL si aucun
+ */
+struct Pretraitement_s *pretraitement_courant(void)
+{
+	return pretraitement_thread_p;
+}
+
+/**
+ * @param pretraitement_p pointeur sur le prétraitement à utiliser par l'analyse lexicale du thread courant, NULL pour aucun
+ * @return pointeur sur le prétraitement précédemment installé
+ */
+struct Pretraitement_s *pretraitement_installer(struct Pretraitement_s *pretraitement_p)
+{
+	struct Pretraitement_s *precedent_p=pretraitement_thread_p;
+	pretraitement_thread_p=pretraitement_p;
+	return precedent_p;
+}
+
+/**
+ * @param pretraitement_p pointeur sur le prétraitement
+ * @param num_ligne ligne concernée
+ * @param code identifiant court du diagnostic
+ * @param format format du message à la façon de printf, avec au plus un argument chaine
+ * @param argument argument du message, NULL s'il n'en a pas
+ * @return TRUE : la ligne en erreur est consommée
+ */
+int erreur_pretraitement(struct Pretraitement_s *pretraitement_p, unsigned int num_ligne, const char *code, const char *format, const char *argument)
+{
+	diag_signaler(NULL, DIAG_ERREUR, NULL, num_ligne, code, format, argument);
+	pretraitement_p->resultat=FAILURE;
+	return TRUE;
+}
+
+/**
+ * @param pretraitement_p pointeur sur le prétraitement
+ * @param profondeur profondeur de la vue
+ * @param nb nombre de lexèmes à pouvoir y mettre
+ * @return tableau de la vue, agrandi au besoin
+ */
+struct Lexeme_s **reserver_vue(struct Pretraitement_s *pretraitement_p, unsigned int profondeur, size_t nb)
+{
+	if (nb>pretraitement_p->capacites[profondeur]) {
+		pretraitement_p->capacites[profondeur]=2*nb;
+		pretraitement_p->vues[profondeur]=realloc(pretraitement_p->vues[profondeur], 2*nb*sizeof(struct Lexeme_s *));
+		if (!pretraitement_p->vues[profondeur]) ERROR_MSG("Impossible d'agrandir une ligne de lexèmes");
+	}
+	return pretraitement_p->vues[profondeur];
+}
+
+/**
+ * @param liste_lexemes_p liste recevant la copie
+ * @param lexeme_p lexème à recopier
+ * @param num_ligne ligne donnée à la copie
+ * @param nb_etiquettes_p Le pointeur vers le compteur de nombre d'étiquettes
+ * @param nb_instructions_p Le pointeur vers le compteur de nombre d'instructions
+ * @return Rien
+ */
+void ajouter_copie_lexeme(struct Liste_s *liste_lexemes_p, const struct Lexeme_s *lexeme_p, unsigned int num_ligne,
+		unsigned int *nb_etiquettes_p, unsigned int *nb_instructions_p)
+{
+	struct Lexeme_s *copie_p=malloc(sizeof(*copie_p));
+
+	if (!copie_p) ERROR_MSG("Impossible de créer un lexème");
+	MEMOIRE_ALLOUER(MEM_LEXEMES, sizeof(*copie_p));
+	copie_p->nature=lexeme_p->nature;
+	copie_p->ligne=num_ligne;
+	copie_p->data=NULL;
+	if (lexeme_p->data) {
+		if (!(copie_p->data=malloc(strlen(lexeme_p->data)+1))) ERROR_MSG("Impossible de créer un lexème");
+		strcpy(copie_p->data, lexeme_p->data);
+		MEMOIRE_ALLOUER(MEM_LEXEMES, strlen(lexeme_p->data)+1);
+	}
+	if (lexeme_p->nature==L_ETIQUETTE) (*nb_etiquettes_p)++;
+	if (lexeme_p->nature==L_INSTRUCTION) (*nb_instructions_p)++;
+	ajouter_fin_liste(liste_lexemes_p, copie_p);
+}
+
+/**
+ * @param pretraitement_p pointeur sur le prétraitement
+ * @param profondeur profondeur de la vue à recopier
+ * @param debut premier lexème recopié
+ * @param fin lexème suivant le dernier recopié
+ * @param num_ligne ligne donnée aux copies
+ * @param liste_lexemes_p liste recevant les copies
+ * @param nb_etiquettes_p Le pointeur vers le compteur de nombre d'étiquettes
+ * @param nb_instructions_p Le pointeur vers le compteur de nombre d'instructions
+ * @return Rien
+ */
+void recopier_vue(struct Pretraitement_s *pretraitement_p, unsigned int profondeur, size_t debut, size_t fin, unsigned int num_ligne,
+		struct Liste_s *liste_lexemes_p, unsigned int *nb_etiquettes_p, unsigned int *nb_instructions_p)
+{
+	for (; debut<fin; debut++)
+		ajouter_copie_lexeme(liste_lexemes_p, pretraitement_p->vues[profondeur][debut], num_ligne, nb_etiquettes_p, nb_instructions_p);
+}
+
+/**
+ * @param pretraitement_p pointeur sur le prétraitement
+ * @param profondeur profondeur des lignes de la séquence
+ * @param sequence_p séquence à dérouler
+ * @param arguments lexèmes des arguments dans la vue de l'appel (profondeur-1), par paires début, fin
+ * @param num_ligne ligne donnée aux lexèmes produits
+ * @param liste_lexemes_p liste recevant les lexèmes
+ * @param nb_etiquettes_p Le pointeur vers le compteur de nombre d'étiquettes
+ * @param nb_instructions_p Le pointeur vers le compteur de nombre d'instructions
+ * @return Rien
+ * @brief Traite les lignes d'un fichier inclus ou du corps d'une macro, les paramètres étant remplacés par les arguments
+ */
+void derouler_sequence(struct Pretraitement_s *pretraitement_p, unsigned int profondeur, struct SequenceLexemes_s *sequence_p,
+		const size_t *arguments, unsigned int num_ligne, struct Liste_s *liste_lexemes_p,
+		unsigned int *nb_etiquettes_p, unsigned int *nb_instructions_p)
+{
+	struct Lexeme_s **appel=pretraitement_p->vues[profondeur-1];
+	struct Lexeme_s **vue;
+	struct Lexeme_s *lexeme_p;
+	size_t i, nb=0, taille;
+	unsigned int p;
+
+	for (i=0; i<sequence_p->nb_lexemes; i++) {
+		lexeme_p=sequence_p->lexemes+i;
+		for (p=0; p<sequence_p->nb_parametres; p++)
+			if ((lexeme_p->data) && (!strcmp(lexeme_p->data, sequence_p->parametres[p]))) break;
+
+		if (p<sequence_p->nb_parametres) {
+			taille=arguments[2*p+1]-arguments[2*p];
+			vue=reserver_vue(pretraitement_p, profondeur, nb+taille);
+			memcpy(vue+nb, appel+arguments[2*p], taille*sizeof(*vue));
+			nb+=taille;
+		}
+		else {
+			vue=reserver_vue(pretraitement_p, profondeur, nb+1);
+			vue[nb++]=lexeme_p;
+		}
+
+		if (lexeme_p->nature==L_FIN_LIGNE) {
+			if (!traiter_vue(pretraitement_p, profondeur, nb, num_ligne, liste_lexemes_p, NULL, nb_etiquettes_p, nb_instructions_p))
+				recopier_vue(pretraitement_p, profondeur, 0, nb, num_ligne, liste_lexemes_p, nb_etiquettes_p, nb_instructions_p);
+			nb=0;
+		}
+	}
+}
+
+/**
+ * @param pretraitement_p pointeur sur le prétraitement
+ * @param chemin chemin du fichier à analyser
+ * @return séquence des lexèmes du fichier, NULL s'il ne peut pas être lu
+ * @brief Projette le fichier en mémoire et en fait l'analyse lexicale, ligne par ligne comme lex_read_lines
+ */
+struct SequenceLexemes_s *analyser_inclusion(struct Pretraitement_s *pretraitement_p, const char *chemin)
+{
+	struct SequenceLexemes_s *sequence_p;
+	struct Liste_s *lexemes_p;
+	struct stat etat;
+	char line[STRLEN];
+	char res[2*STRLEN];
+	const char *contenu=NULL, *c_p, *fin_p;
+	unsigned int num_ligne=0, nb_etiquettes=0, nb_instructions=0;
+	size_t longueur;
+	int descripteur=open(chemin, O_RDONLY);
+
+	if (descripteur<0) return NULL;
+	if ((fstat(descripteur, &etat)) || ((etat.st_size) &&
+			((contenu=mmap(NULL, etat.st_size, PROT_READ, MAP_PRIVATE, descripteur, 0))==MAP_FAILED))) {
+		close(descripteur);
+		return NULL;
+	}
+	close(descripteur);
+
+	/* coupe les lignes trop longues comme le fait fgets dans lex_read_lines */
+	lexemes_p=creer_liste(detruit_lexeme);
+	for (c_p=contenu, fin_p=contenu+etat.st_size; c_p<fin_p; c_p+=longueur) {
+		for (longueur=0; (c_p+longueur<fin_p) && (longueur<STRLEN-2) && (c_p[longueur]!='\n'); longueur++);
+		memcpy(line, c_p, longueur);
+		line[longueur]='\0';
+		if ((c_p+longueur<fin_p) && (c_p[longueur]=='\n')) longueur++;
+		num_ligne++;
+		if (!*line) continue;
+		lex_standardise(line, res);
+		lex_read_line(res, lexemes_p, num_ligne, &nb_etiquettes, &nb_instructions);
+	}
+	if (contenu) munmap((void *)contenu, etat.st_size);
+
+	sequence_p=creer_sequence(chemin, 0, NULL, 0, lexemes_p);
+	detruire_liste(lexemes_p);
+	return sequence_p;
+}
+
+/**
+ * @param pretraitement_p pointeur sur le prétraitement
+ * @param nom nom du fichier tel qu'écrit dans la directive, entre guillemets
+ * @param num_ligne ligne de la directive
+ * @return séquence des lexèmes du fichier, analysé au premier besoin, NULL s'il ne peut pas être lu
+ */
+struct SequenceLexemes_s *inclure(struct Pretraitement_s *pretraitement_p, const char *nom, unsigned int num_ligne)
+{
+	struct SequenceLexemes_s *sequence_p=NULL;
+	char *chemin;
+	size_t longueur=strlen(nom);
+
+	if ((longueur<3) || (nom[0]!='"') || (nom[longueur-1]!='"')) {
+		erreur_pretraitement(pretraitement_p, num_ligne, "inclusion", ".include attend un nom de fichier entre guillemets", NULL);
+		return NULL;
+	}
+	if (pretraitement_p->inclusions_interdites) {
+		erreur_pretraitement(pretraitement_p, num_ligne, "inclusion", "%s ne peut pas être inclus : aucun fichier n'est lu dans ce contexte", nom);
+		return NULL;
+	}
+	if (!pretraitement_p->inclusions_p) pretraitement_p->inclusions_p=creer_table(0, clef_sequence, detruire_sequence);
+
+	/* un chemin relatif est d'abord cherché à côté du source, puis dans le répertoire courant */
+	if (!(chemin=malloc((pretraitement_p->repertoire ? strlen(pretraitement_p->repertoire) : 0)+longueur+1)))
+		ERROR_MSG("Impossible de créer le chemin d'un fichier inclus");
+	if ((pretraitement_p->repertoire) && (nom[1]!='/')) {
+		sprintf(chemin, "%s/%.*s", pretraitement_p->repertoire, (int)longueur-2, nom+1);
+		if (!(sequence_p=donnee_table(pretraitement_p->inclusions_p, chemin)))
+			if ((sequence_p=analyser_inclusion(pretraitement_p, chemin))) ajouter_table(pretraitement_p->inclusions_p, sequence_p);
+	}
+	if (!sequence_p) {
+		sprintf(chemin, "%.*s", (int)longueur-2, nom+1);
+		if (!(sequence_p=donnee_table(pretraitement_p->inclusions_p, chemin)))
+			if ((sequence_p=analyser_inclusion(pretraitement_p, chemin))) ajouter_table(pretraitement_p->inclusions_p, sequence_p);
+	}
+	free(chemin);
+	if (!sequence_p) erreur_pretraitement(pretraitement_p, num_ligne, "inclusion", "impossible d'inclure le fichier %s", nom);
+	return sequence_p;
+}
+
+/**
+ * @param pretraitement_p pointeur sur le prétraitement
+ * @param vue lexèmes de la ligne .macro
+ * @param debut indice du lexème suivant la directive
+ * @param nb nombre de lexèmes de la ligne
+ * @param num_ligne ligne de la directive
+ * @return TRUE : la ligne est consommée
+ * @brief Commence la définition d'une macro : .macro nom [p1[, p2...]]
+ */
+int debuter_macro(struct Pretraitement_s *pretraitement_p, struct Lexeme_s **vue, size_t debut, size_t nb, unsigned int num_ligne)
+{
+	size_t i;
+
+	if ((debut>=nb) || (vue[debut]->nature!=L_SYMBOLE))
+		return erreur_pretraitement(pretraitement_p, num_ligne, "macro", ".macro attend un nom de macro", NULL);
+
+	for (i=debut+1; (i<nb) && (vue[i]->nature!=L_FIN_LIGNE) && (vue[i]->nature!=L_COMMENTAIRE); i++) {
+		if (vue[i]->nature!=L_SYMBOLE)
+			return erreur_pretraitement(pretraitement_p, num_ligne, "macro", "%s n'est pas un nom de paramètre", vue[i]->data ? vue[i]->data : "?");
+		if (pretraitement_p->nb_parametres==PRETRAITEMENT_PARAMETRES_MAX) {
+			abandonner_macro(pretraitement_p);
+			return erreur_pretraitement(pretraitement_p, num_ligne, "macro", "la macro %s a trop de paramètres", vue[debut]->data);
+		}
+		if (!(pretraitement_p->parametres[pretraitement_p->nb_parametres]=malloc(strlen(vue[i]->data)+1)))
+			ERROR_MSG("Impossible de créer un paramètre de macro");
+		strcpy(pretraitement_p->parametres[pretraitement_p->nb_parametres++], vue[i]->data);
+		if ((i+1<nb) && (vue[i+1]->nature==L_VIRGULE)) i++;
+	}
+
+	/* les noms de macros sont comparés aux instructions, qui sont en majuscules */
+	if (!(pretraitement_p->nom_macro=malloc(strlen(vue[debut]->data)+1))) ERROR_MSG("Impossible de créer une macro");
+	strupr(strcpy(pretraitement_p->nom_macro, vue[debut]->data));
+	pretraitement_p->ligne_macro=num_ligne;
+	pretraitement_p->ligne_fichier_macro=vue[debut]->ligne;
+	pretraitement_p->imbrication=0;
+	pretraitement_p->corps_p=creer_liste(detruit_lexeme);
+	return TRUE;
+}
+
+/**
+ * @param pretraitement_p pointeur sur le prétraitement
+ * @param num_ligne ligne de la directive .endm
+ * @return TRUE : la ligne est consommée
+ * @brief Range la macro dont la définition se termine
+ */
+int terminer_macro(struct Pretraitement_s *pretraitement_p, unsigned int num_ligne)
+{
+	struct SequenceLexemes_s *sequence_p;
+
+	if (!pretraitement_p->macros_p) pretraitement_p->macros_p=creer_table(0, clef_sequence, detruire_sequence);
+	if ((sequence_p=donnee_table(pretraitement_p->macros_p, pretraitement_p->nom_macro))) {
+		diag_signaler(NULL, DIAG_ERREUR, NULL, pretraitement_p->ligne_macro, "macro", "la macro %s est déjà définie ligne %u",
+				pretraitement_p->nom_macro, sequence_p->ligne);
+		pretraitement_p->resultat=FAILURE;
+	}
+	else
+		ajouter_table(pretraitement_p->macros_p, creer_sequence(pretraitement_p->nom_macro, pretraitement_p->ligne_macro,
+				pretraitement_p->parametres, pretraitement_p->nb_parametres, pretraitement_p->corps_p));
+	abandonner_macro(pretraitement_p);
+	return TRUE;
+}
+
+/**
+ * @param pretraitement_p pointeur sur le prétraitement
+ * @param profondeur profondeur de la vue de l'appel
+ * @param macro_p macro appelée
+ * @param debut indice du premier lexème des arguments
+ * @param nb nombre de lexèmes de la ligne
+ * @param num_ligne ligne de l'appel
+ * @param liste_lexemes_p liste recevant les lexèmes
+ * @param nb_etiquettes_p Le pointeur vers le compteur de nombre d'étiquettes
+ * @param nb_instructions_p Le pointeur vers le compteur de nombre d'instructions
+ * @return TRUE : la ligne est consommée
+ * @brief Sépare les arguments de l'appel (virgules hors parenthèses) et déroule le corps de la macro
+ */
+int appeler_macro(struct Pretraitement_s *pretraitement_p, unsigned int profondeur, struct SequenceLexemes_s *macro_p,
+		size_t debut, size_t nb, unsigned int num_ligne, struct Liste_s *liste_lexemes_p,
+		unsigned int *nb_etiquettes_p, unsigned int *nb_instructions_p)
+{
+	struct Lexeme_s **vue=pretraitement_p->vues[profondeur];
+	size_t arguments[2*PRETRAITEMENT_PARAMETRES_MAX];
+	unsigned int nb_arguments=0;
+	int parentheses=0;
+	size_t i, fin;
+
+	for (fin=debut; (fin<nb) && (vue[fin]->nature!=L_FIN_LIGNE) && (vue[fin]->nature!=L_COMMENTAIRE); fin++);
+	for (i=debut; i<=fin; i++) {
+		if ((i<fin) && (vue[i]->nature==L_PARENTHESE_OUVRANTE)) parentheses++;
+		if ((i<fin) && (vue[i]->nature==L_PARENTHESE_FERMANTE)) parentheses--;
+		if ((debut<fin) && ((i==fin) || ((vue[i]->nature==L_VIRGULE) && (!parentheses)))) {
+			if (nb_arguments==macro_p->nb_parametres)
+				return erreur_pretraitement(pretraitement_p, num_ligne, "macro", "trop d'arguments pour la macro %s", macro_p->nom);
+			arguments[2*nb_arguments]=nb_arguments ? arguments[2*nb_arguments-1]+1 : debut;
+			arguments[2*nb_arguments+1]=i;
+			nb_arguments++;
+		}
+	}
+	/* les arguments absents sont vides */
+	for (; nb_arguments<macro_p->nb_parametres; nb_arguments++) arguments[2*nb_arguments]=arguments[2*nb_arguments+1]=0;
+
+	derouler_sequence(pretraitement_p, profondeur+1, macro_p, arguments, num_ligne, liste_lexemes_p, nb_etiquettes_p, nb_instructions_p);
+	return TRUE;
+}
+
+/**
+ * @param pretraitement_p pointeur sur le prétraitement
+ * @param profondeur profondeur de la vue de la ligne
+ * @param nb nombre de lexèmes de la ligne, fin de ligne comprise
+ * @param num_ligne ligne donnée aux lexèmes produits
+ * @param liste_lexemes_p liste recevant les lexèmes produits
+ * @param ligne_p liste propriétaire des lexèmes de la vue (ligne du source), NULL si la vue vient d'une séquence
+ * @param nb_etiquettes_p Le pointeur vers le compteur de nombre d'étiquettes
+ * @param nb_instructions_p Le pointeur vers le compteur de nombre d'instructions
+ * @return TRUE si la ligne a été consommée par le prétraitement, FALSE si c'est une ligne ordinaire à garder telle quelle
+ * @brief Traite une ligne : définition de macro en cours, directive de prétraitement ou appel de macro
+ *
+ * Les étiquettes en tête d'une ligne .include ou d'un appel restent en tête de la première ligne produite.
+ */
+int traiter_vue(struct Pretraitement_s *pretraitement_p, unsigned int profondeur, size_t nb, unsigned int num_ligne,
+		struct Liste_s *liste_lexemes_p, struct Liste_s *ligne_p, unsigned int *nb_etiquettes_p, unsigned int *nb_instructions_p)
+{
+	struct Lexeme_s **vue=pretraitement_p->vues[profondeur];
+	struct SequenceLexemes_s *sequence_p;
+	unsigned int nb_etiquettes_corps=0, nb_instructions_corps=0;
+	size_t debut, i;
+
+	for (debut=0; (debut<nb) && (vue[debut]->nature==L_ETIQUETTE); debut++);
+
+	/* une ligne du corps d'une macro est rangée sans être traitée, sauf le .endm qui la termine */
+	if (pretraitement_p->corps_p) {
+		if ((vue[debut]->nature==L_DIRECTIVE) && (!strcmp(vue[debut]->data, ".endm")) && (!pretraitement_p->imbrication))
+			return terminer_macro(pretraitement_p, num_ligne);
+		if ((vue[debut]->nature==L_DIRECTIVE) && (!strcmp(vue[debut]->data, ".endm"))) pretraitement_p->imbrication--;
+		if ((vue[debut]->nature==L_DIRECTIVE) && (!strcmp(vue[debut]->data, ".macro"))) pretraitement_p->imbrication++;
+		if (ligne_p)
+			concatener_liste(pretraitement_p->corps_p, ligne_p);
+		else
+			for (i=0; i<nb; i++) ajouter_copie_lexeme(pretraitement_p->corps_p, vue[i], vue[i]->ligne, &nb_etiquettes_corps, &nb_instructions_corps);
+		return TRUE;
+	}
+
+	if (vue[debut]->nature==L_DIRECTIVE) {
+		if (!strcmp(vue[debut]->data, ".macro")) {
+			if (debut) {
+				recopier_vue(pretraitement_p, profondeur, 0, debut, num_ligne, liste_lexemes_p, nb_etiquettes_p, nb_instructions_p);
+				ajouter_copie_lexeme(liste_lexemes_p, vue[nb-1], num_ligne, nb_etiquettes_p, nb_instructions_p);
+			}
+			return debuter_macro(pretraitement_p, vue, debut+1, nb, num_ligne);
+		}
+		if (!strcmp(vue[debut]->data, ".endm"))
+			return erreur_pretraitement(pretraitement_p, num_ligne, "macro", ".endm sans .macro", NULL);
+		if (!strcmp(vue[debut]->data, ".include")) {
+			if (profondeur==PRETRAITEMENT_PROFONDEUR_MAX)
+				return erreur_pretraitement(pretraitement_p, num_ligne, "inclusion", "inclusions trop imbriquées (inclusion récursive de %s ?)",
+						vue[debut+1]->data ? vue[debut+1]->data : "?");
+			if ((vue[debut+1]->nature!=L_CHAINE) || ((debut+2<nb) && (vue[debut+2]->nature!=L_FIN_LIGNE) && (vue[debut+2]->nature!=L_COMMENTAIRE)))
+				return erreur_pretraitement(pretraitement_p, num_ligne, "inclusion", ".include attend un nom de fichier entre guillemets", NULL);
+			recopier_vue(pretraitement_p, profondeur, 0, debut, num_ligne, liste_lexemes_p, nb_etiquettes_p, nb_instructions_p);
+			if ((sequence_p=inclure(pretraitement_p, vue[debut+1]->data, num_ligne))) {
+				derouler_sequence(pretraitement_p, profondeur+1, sequence_p, NULL, num_ligne, liste_lexemes_p, nb_etiquettes_p, nb_instructions_p);
+				/* une définition ouverte par le fichier inclus s'arrête avec lui, sans avaler la suite du source */
+				verifier_fin_macro(pretraitement_p, sequence_p->nom, pretraitement_p->ligne_fichier_macro);
+			}
+			return TRUE;
+		}
+	}
+
+	if ((vue[debut]->nature==L_INSTRUCTION) && (pretraitement_p->macros_p) &&
+			((sequence_p=donnee_table(pretraitement_p->macros_p, vue[debut]->data)))) {
+		if (profondeur==PRETRAITEMENT_PROFONDEUR_MAX)
+			return erreur_pretraitement(pretraitement_p, num_ligne, "macro", "appels de macros trop imbriqués (macro %s récursive ?)", sequence_p->nom);
+		recopier_vue(pretraitement_p, profondeur, 0, debut, num_ligne, liste_lexemes_p, nb_etiquettes_p, nb_instructions_p);
+		return appeler_macro(pretraitement_p, profondeur, sequence_p, debut+1, nb, num_ligne, liste_lexemes_p, nb_etiquettes_p, nb_instructions_p);
+	}
+	return FALSE;
+}
+
+/**
+ * @param ligne_p lexèmes d'une ligne
+ * @param macros_p macros définies, NULL si aucune
+ * @param en_definition TRUE si une macro est en cours de définition
+ * @return TRUE si la ligne doit passer par le prétraitement
+ * @brief Test rapide sur le premier lexème qui n'est pas une étiquette
+ */
+int ligne_a_pretraiter(struct Liste_s *ligne_p, struct Table_s *macros_p, int en_definition)
+{
+	struct NoeudListe_s *noeud_p;
+	struct Lexeme_s *lexeme_p=NULL;
+
+	if (en_definition) return TRUE;
+	for (noeud_p=ligne_p->debut_liste_p; noeud_p; noeud_p=noeud_p->suivant_p) {
+		lexeme_p=(struct Lexeme_s *)noeud_p->donnee_p;
+		if (lexeme_p->nature!=L_ETIQUETTE) break;
+	}
+	if (!noeud_p) return FALSE;
+	if (lexeme_p->nature==L_DIRECTIVE)
+		return (!strcmp(lexeme_p->data, ".include")) || (!strcmp(lexeme_p->data, ".macro")) || (!strcmp(lexeme_p->data, ".endm"));
+	return (lexeme_p->nature==L_INSTRUCTION) && (macros_p) && (donnee_table(macros_p, lexeme_p->data));
+}
+
+/**
+ * @param pretraitement_p pointeur sur le prétraitement, dont la liste ligne_p contient les lexèmes de la ligne
+ * @param liste_lexemes_p liste recevant les lexèmes de la ligne ou ceux qu'elle produit
+ * @param num_ligne numéro de la ligne dans le source
+ * @param nb_etiquettes_p Le pointeur vers le compteur de nombre d'étiquettes, déjà compté pour la ligne
+ * @param nb_instructions_p Le pointeur vers le compteur de nombre d'instructions, déjà compté pour la ligne
+ * @return Rien, ligne_p est vide au retour
+ * @brief Prétraite la ligne qui vient d'être analysée
+ */
+void pretraiter_ligne(struct Pretraitement_s *pretraitement_p, struct Liste_s *liste_lexemes_p, unsigned int num_ligne,
+		unsigned int *nb_etiquettes_p, unsigned int *nb_instructions_p)
+{
+	struct Liste_s *ligne_p=pretraitement_p->ligne_p;
+	struct NoeudListe_s *noeud_p;
+	struct Lexeme_s **vue;
+	size_t nb=0;
+
+	if (!ligne_a_pretraiter(ligne_p, pretraitement_p->macros_p, pretraitement_p->corps_p!=NULL)) {
+		concatener_liste(liste_lexemes_p, ligne_p);
+		return;
+	}
+
+	/* la ligne consommée ne compte plus : ce qu'elle produit est compté à la place */
+	vue=reserver_vue(pretraitement_p, 0, ligne_p->nbElements);
+	for (noeud_p=ligne_p->debut_liste_p; noeud_p; noeud_p=noeud_p->suivant_p) {
+		vue[nb]=(struct Lexeme_s *)noeud_p->donnee_p;
+		if (vue[nb]->nature==L_ETIQUETTE) (*nb_etiquettes_p)--;
+		if (vue[nb]->nature==L_INSTRUCTION) (*nb_instructions_p)--;
+		nb++;
+	}
+	if (!traiter_vue(pretraitement_p, 0, nb, num_ligne, liste_lexemes_p, ligne_p, nb_etiquettes_p, nb_instructions_p)) {
+		for (noeud_p=ligne_p->debut_liste_p; noeud_p; noeud_p=noeud_p->suivant_p) {
+			if (((struct Lexeme_s *)noeud_p->donnee_p)->nature==L_ETIQUETTE) (*nb_etiquettes_p)++;
+			if (((struct Lexeme_s *)noeud_p->donnee_p)->nature==L_INSTRUCTION) (*nb_instructions_p)++;
+		}
+		concatener_liste(liste_lexemes_p, ligne_p);
+	}
+	vider_liste(ligne_p);
+}
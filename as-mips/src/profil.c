@@ -0,0 +1,241 @@
+/**
+ * @file profil.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions du profilage de l'assemblage
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <global.h>
+#include <notify.h>
+#include <profil.h>
+
+__thread unsigned long profil_compteurs[NB_COMPTEURS];	/**< Compteurs du thread courant, pas encore cumulés */
+static __thread struct Profil_s *profil_thread_p=NULL;	/**< Profil installé pour le thread courant */
+
+static const char *NOMS_ETAPES[NB_ETAPES]={
+	"dictionnaires", "lexicale", "syntaxe", "codage", "resolution", "objet", "listage", "simulation", "liberation"
+};
+static const char *NOMS_COMPTEURS[NB_COMPTEURS]={
+	"lignes", "lexemes", "etiquettes", "instructions", "donnees", "recherches_table", "allocations", "sorties_cache",
+	"delais_remplis", "delais_nop", "attentes_evitees", "attentes_restantes",
+	"lucarne_move", "lucarne_neutre", "lucarne_nop", "lucarne_sw_lw", "lucarne_saut",
+	"instr_simulees"
+};
+
+/**
+ * @param horloge horloge à lire (CLOCK_MONOTONIC, CLOCK_THREAD_CPUTIME_ID...)
+ * @return temps de l'horloge en nanosecondes
+ */
+uint64_t lire_horloge(clockid_t horloge)
+{
+	struct timespec temps;
+
+	if (clock_gettime(horloge, &temps)) return 0;
+	return (uint64_t)temps.tv_sec*1000000000ULL + temps.tv_nsec;
+}
+
+/**
+ * @param fichier_source nom du fichier assemblé (pour le rapport)
+ * @return pointeur sur le profil créé
+ * @brief Crée un profil ; le temps total est compté à partir de sa création
+ */
+struct Profil_s *creer_profil(const char *fichier_source)
+{
+	struct Profil_s *profil_p=calloc(1, sizeof(*profil_p));
+
+	if (!profil_p) ERROR_MSG("Impossible de créer le profil");
+	profil_p->fichier_source=fichier_source;
+	profil_p->debut_total_mur=lire_horloge(CLOCK_MONOTONIC);
+	profil_p->debut_total_cpu=lire_horloge(CLOCK_PROCESS_CPUTIME_ID);
+	return profil_p;
+}
+
+/**
+ * @param profil_p pointeur sur le profil
+ * @return NULL
+ * @brief Détruit le profil (et le désinstalle s'il était installé pour le thread courant)
+ */
+struct Profil_s *detruire_profil(struct Profil_s *profil_p)
+{
+	if (profil_thread_p==profil_p) profil_thread_p=NULL;
+	free(profil_p);
+	return NULL;
+}
+
+/**
+ * @return pointeur sur le profil installé pour le thread courant, NULL si l'assemblage n'est pas profilé
+ */
+struct Profil_s *profil_courant(void)
+{
+	return profil_thread_p;
+}
+
+/**
+ * @param profil_p pointeur sur le profil à installer, NULL pour ne plus profiler
+ * @return pointeur sur le profil précédemment installé pour ce thread
+ * @brief Installe le profil du thread courant
+ */
+struct Profil_s *profil_installer(struct Profil_s *profil_p)
+{
+	struct Profil_s *precedent_p=profil_thread_p;
+	profil_thread_p=profil_p;
+	return precedent_p;
+}
+
+/**
+ * @param profil_p pointeur sur le profil, NULL si l'assemblage n'est pas profilé
+ * @param etape étape qui commence dans le thread courant
+ * @return Rien
+ */
+void profil_debut(struct Profil_s *profil_p, enum EtapeProfil_e etape)
+{
+	if (!profil_p) return;
+	profil_p->debut_mur[etape]=lire_horloge(CLOCK_MONOTONIC);
+	profil_p->debut_cpu[etape]=lire_horloge(CLOCK_THREAD_CPUTIME_ID);
+}
+
+/**
+ * @param profil_p pointeur sur le profil, NULL si l'assemblage n'est pas profilé
+ * @param etape étape qui se termine dans le thread courant (le même que pour profil_debut)
+ * @return Rien
+ * @brief Cumule la durée de l'étape ; une étape exécutée plusieurs fois voit ses durées additionnées
+ */
+void profil_fin(struct Profil_s *profil_p, enum EtapeProfil_e etape)
+{
+	if (!profil_p) return;
+	profil_p->mur[etape]+=lire_horloge(CLOCK_MONOTONIC)-profil_p->debut_mur[etape];
+	profil_p->cpu[etape]+=lire_horloge(CLOCK_THREAD_CPUTIME_ID)-profil_p->debut_cpu[etape];
+	profil_p->mesuree[etape]=TRUE;
+}
+
+/**
+ * @param profil_p pointeur sur le profil, NULL si l'assemblage n'est pas profilé
+ * @return Rien
+ * @brief Ajoute au profil les compteurs du thread courant puis les remet à zéro
+ *
+ * Peut être appelée en même temps par plusieurs threads.
+ */
+void profil_cumuler(struct Profil_s *profil_p)
+{
+	int i;
+
+	for (i=0; i<NB_COMPTEURS; i++) {
+		if (profil_p) __atomic_add_fetch(&profil_p->compteurs[i], profil_compteurs[i], __ATOMIC_RELAXED);
+		profil_compteurs[i]=0;
+	}
+}
+
+/**
+ * @param profil_p pointeur sur le profil, NULL si l'assemblage n'est pas profilé
+ * @param compteur compteur à fixer
+ * @param valeur valeur du compteur
+ * @return Rien
+ * @brief Fixe un compteur connu à la fin de l'assemblage (nombre de lignes, de lexèmes...)
+ */
+void profil_fixer(struct Profil_s *profil_p, enum CompteurProfil_e compteur, unsigned long valeur)
+{
+	if (profil_p) profil_p->compteurs[compteur]=valeur;
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param nanosecondes durée
+ * @return Rien
+ * @brief Ecrit une durée en millisecondes avec trois décimales
+ */
+void sortie_millisecondes(struct Sortie_s *sortie_p, uint64_t nanosecondes)
+{
+	sortie_decimal(sortie_p, nanosecondes/1000000, 0);
+	sortie_caractere(sortie_p, '.');
+	sortie_caractere(sortie_p, '0'+(nanosecondes/100000)%10);
+	sortie_caractere(sortie_p, '0'+(nanosecondes/10000)%10);
+	sortie_caractere(sortie_p, '0'+(nanosecondes/1000)%10);
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param nanosecondes durée
+ * @param largeur largeur de la colonne
+ * @return Rien
+ * @brief Ecrit une durée en millisecondes alignée à droite
+ */
+void colonne_millisecondes(struct Sortie_s *sortie_p, uint64_t nanosecondes, int largeur)
+{
+	int nb_chiffres=5;
+	uint64_t ms;
+
+	for (ms=nanosecondes/1000000; ms>=10; ms/=10) nb_chiffres++;
+	if (largeur>nb_chiffres) sortie_repeter(sortie_p, ' ', largeur-nb_chiffres);
+	sortie_millisecondes(sortie_p, nanosecondes);
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param profil_p pointeur sur le profil
+ * @param json TRUE pour écrire un objet JSON sur une ligne, FALSE pour un tableau lisible
+ * @return Rien
+ * @brief Ecrit le rapport de profilage ; seules les étapes exécutées y figurent
+ */
+void ecrire_profil(struct Sortie_s *sortie_p, struct Profil_s *profil_p, int json)
+{
+	uint64_t total_mur=lire_horloge(CLOCK_MONOTONIC)-profil_p->debut_total_mur;
+	uint64_t total_cpu=lire_horloge(CLOCK_PROCESS_CPUTIME_ID)-profil_p->debut_total_cpu;
+	int i, premier=TRUE;
+
+	if (json) {
+		sortie_chaine(sortie_p, "{\"fichier\":");
+		sortie_chaine_json(sortie_p, profil_p->fichier_source);
+		sortie_chaine(sortie_p, ",\"etapes\":{");
+		for (i=0; i<NB_ETAPES; i++) {
+			if (!profil_p->mesuree[i]) continue;
+			if (!premier) sortie_caractere(sortie_p, ',');
+			premier=FALSE;
+			sortie_caractere(sortie_p, '"');
+			sortie_chaine(sortie_p, NOMS_ETAPES[i]);
+			sortie_chaine(sortie_p, "\":{\"mur_ms\":");
+			sortie_millisecondes(sortie_p, profil_p->mur[i]);
+			sortie_chaine(sortie_p, ",\"cpu_ms\":");
+			sortie_millisecondes(sortie_p, profil_p->cpu[i]);
+			sortie_caractere(sortie_p, '}');
+		}
+		sortie_chaine(sortie_p, "},\"total\":{\"mur_ms\":");
+		sortie_millisecondes(sortie_p, total_mur);
+		sortie_chaine(sortie_p, ",\"cpu_ms\":");
+		sortie_millisecondes(sortie_p, total_cpu);
+		sortie_chaine(sortie_p, "},\"compteurs\":{");
+		for (i=0; i<NB_COMPTEURS; i++) {
+			if (i) sortie_caractere(sortie_p, ',');
+			sortie_caractere(sortie_p, '"');
+			sortie_chaine(sortie_p, NOMS_COMPTEURS[i]);
+			sortie_chaine(sortie_p, "\":");
+			sortie_decimal(sortie_p, profil_p->compteurs[i], 0);
+		}
+		sortie_chaine(sortie_p, "}}\n");
+		return;
+	}
+
+	sortie_chaine(sortie_p, "Profil de l'assemblage de ");
+	sortie_chaine(sortie_p, profil_p->fichier_source ? profil_p->fichier_source : "(entrée)");
+	sortie_chaine(sortie_p, "\n             étape      mur (ms)      cpu (ms)\n");
+	for (i=0; i<NB_ETAPES; i++) {
+		if (!profil_p->mesuree[i]) continue;
+		sortie_chaine_alignee(sortie_p, NOMS_ETAPES[i], 18);
+		colonne_millisecondes(sortie_p, profil_p->mur[i], 14);
+		colonne_millisecondes(sortie_p, profil_p->cpu[i], 14);
+		sortie_caractere(sortie_p, '\n');
+	}
+	sortie_chaine_alignee(sortie_p, "total", 18);
+	colonne_millisecondes(sortie_p, total_mur, 14);
+	colonne_millisecondes(sortie_p, total_cpu, 14);
+	sortie_chaine(sortie_p, "\n          compteur        valeur\n");
+	for (i=0; i<NB_COMPTEURS; i++) {
+		sortie_chaine_alignee(sortie_p, NOMS_COMPTEURS[i], 18);
+		sortie_decimal(sortie_p, profil_p->compteurs[i], 14);
+		sortie_caractere(sortie_p, '\n');
+	}
+}
@@ -0,0 +1,378 @@
+/**
+ * @file pseudo.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions de chargement et d'expansion des pseudo-instructions
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+
+#include <global.h>
+#include <notify.h>
+#include <str_utils.h>
+#include <memoire.h>
+#include <liste.h>
+#include <table.h>
+#include <dico.h>
+#include <lex.h>
+#include <syn.h>
+#include <expression.h>
+#include <pseudo.h>
+#include <dependances.h>
+
+const char *NOMS_CONDITIONS[]={"*", "s16", "u16", "h16"}; /* noms des conditions d'emploi, indicés par ConditionPseudo_e */
+
+/**
+ * @param chaine chaine à nettoyer, modifiée
+ * @return début de la chaine sans les blancs qui l'entourent
+ */
+char *sans_blancs(char *chaine)
+{
+	size_t longueur;
+
+	while (isspace((unsigned char)*chaine)) chaine++;
+	longueur=strlen(chaine);
+	while ((longueur>0) && (isspace((unsigned char)chaine[longueur-1]))) chaine[--longueur]='\0';
+	return chaine;
+}
+
+/**
+ * @param pseudo_p pointeur sur la définition de la pseudo-instruction
+ * @param texte texte de l'opérande, "\k)" pour la fin d'un %hi(\k)
+ * @param fin caractère attendu après le numéro ('\0' ou ')')
+ * @return indice de l'opérande de la pseudo-instruction désigné par \k
+ */
+int lire_parametre_modele(struct DefinitionInstruction_s *pseudo_p, char *texte, char fin)
+{
+	char *fin_p;
+	long indice;
+
+	if (texte[0]!='\\') ERROR_MSG("Opérande %s inattendu dans l'expansion de %s", texte, pseudo_p->nom);
+	errno=0;
+	indice=strtol(texte+1, &fin_p, 10);
+	if ((errno) || (fin_p==texte+1) || (*fin_p!=fin) || ((fin) && (fin_p[1])) || (indice<1) || (indice>(long)pseudo_p->nb_ops))
+		ERROR_MSG("Opérande %s invalide dans l'expansion de %s", texte, pseudo_p->nom);
+	return (int)indice-1;
+}
+
+/**
+ * @param pseudo_p pointeur sur la définition de la pseudo-instruction
+ * @param etape_p pointeur sur l'étape en cours d'analyse
+ * @param i indice de l'opérande dans l'instruction réelle de l'étape
+ * @param texte texte de l'opérande dans le modèle, sans blancs
+ * @return Rien
+ * @brief Analyse un opérande d'une instruction de l'expansion ; une erreur du dictionnaire est fatale
+ */
+void analyser_operande_modele(struct DefinitionInstruction_s *pseudo_p, struct EtapePseudo_s *etape_p, unsigned int i, char *texte)
+{
+	char champ=etape_p->definition_p->champs[i];
+	int indice;
+	char *fin_p;
+
+	if ((!strncmp(texte, "%hi(", 4)) || (!strncmp(texte, "%lo(", 4))) {
+		if (champ!='i') ERROR_MSG("%s ne s'applique qu'à un immédiat dans l'expansion de %s", texte, pseudo_p->nom);
+		indice=lire_parametre_modele(pseudo_p, texte+4, ')');
+		etape_p->derivee.champs[i]=(texte[1]=='h') ? 'H' : 'L';
+	} else if (texte[0]=='\\')
+		indice=lire_parametre_modele(pseudo_p, texte, '\0');
+	else {
+		etape_p->parametres[i]=PSEUDO_CONSTANTE;
+		if (texte[0]=='$')
+			etape_p->constantes[i].nature=L_REGISTRE;
+		else {
+			errno=0;
+			strtol(texte, &fin_p, 0);
+			if ((errno) || (fin_p==texte) || (*fin_p)) ERROR_MSG("Opérande %s invalide dans l'expansion de %s", texte, pseudo_p->nom);
+			etape_p->constantes[i].nature=L_NOMBRE;
+		}
+		etape_p->constantes[i].data=strdup(texte);
+		MEMOIRE_ALLOUER(MEM_DICTIONNAIRES, strlen(texte)+1);
+		return;
+	}
+
+	/* les registres de la pseudo-instruction vont dans les champs de registre, son dernier opérande N dans les autres */
+	if (((pseudo_p->type_ops==I_OP_N) && (indice==(int)pseudo_p->nb_ops-1)) != ((champ!='s') && (champ!='t') && (champ!='d')))
+		ERROR_MSG("L'opérande \\%d de %s ne convient pas au champ %c de %s", indice+1, pseudo_p->nom, champ, etape_p->definition_p->nom);
+	etape_p->parametres[i]=indice;
+}
+
+/**
+ * @param table_definition_p pointeur sur la table des instructions réelles déjà chargées
+ * @param pseudo_p pointeur sur la définition de la pseudo-instruction
+ * @param texte texte du modèle (instructions séparées par ';'), modifié
+ * @param expansion_p pointeur sur l'expansion à compléter
+ * @return Rien
+ * @brief Analyse le modèle d'une expansion ; une erreur du dictionnaire est fatale
+ */
+void analyser_modele_pseudo(struct Table_s *table_definition_p, struct DefinitionInstruction_s *pseudo_p, char *texte,
+		struct ExpansionPseudo_s *expansion_p)
+{
+	struct EtapePseudo_s *etape_p;
+	char *etape, *operande, *suite_etapes, *suite_operandes;
+	char mnemonique[STRLEN];
+	unsigned int i;
+	int n;
+
+	for (etape=strtok_r(texte, ";", &suite_etapes); etape; etape=strtok_r(NULL, ";", &suite_etapes)) {
+		etape=sans_blancs(etape);
+		if ((!*etape) || (1!=sscanf(etape, "%s%n", mnemonique, &n))) ERROR_MSG("Instruction vide dans l'expansion de %s", pseudo_p->nom);
+		if (expansion_p->nb_etapes==PSEUDO_ETAPES_MAX) ERROR_MSG("L'expansion de %s dépasse %d instructions", pseudo_p->nom, PSEUDO_ETAPES_MAX);
+		etape_p=expansion_p->etapes+expansion_p->nb_etapes++;
+
+		strupr(mnemonique);
+		etape_p->definition_p=(struct DefinitionInstruction_s *)donnee_table(table_definition_p, mnemonique);
+		if ((!etape_p->definition_p) || (etape_p->definition_p->expansions_p) || (etape_p->definition_p->type_ops==I_OP_B))
+			ERROR_MSG("%s n'est pas une instruction réelle de forme R ou N dans l'expansion de %s", mnemonique, pseudo_p->nom);
+		etape_p->derivee=*etape_p->definition_p;
+
+		i=0;
+		for (operande=strtok_r(etape+n, ",", &suite_operandes); operande; operande=strtok_r(NULL, ",", &suite_operandes)) {
+			if (i==etape_p->definition_p->nb_ops) ERROR_MSG("Trop d'opérandes pour %s dans l'expansion de %s", mnemonique, pseudo_p->nom);
+			analyser_operande_modele(pseudo_p, etape_p, i++, sans_blancs(operande));
+		}
+		if (i!=etape_p->definition_p->nb_ops) ERROR_MSG("Il manque des opérandes à %s dans l'expansion de %s", mnemonique, pseudo_p->nom);
+
+		if (strcmp(etape_p->derivee.champs, etape_p->definition_p->champs))
+			etape_p->definition_p=&etape_p->derivee;
+	}
+	if (!expansion_p->nb_etapes) ERROR_MSG("Expansion vide pour %s", pseudo_p->nom);
+}
+
+/**
+ * @param table_definition_p pointeur sur la table des instructions, qui reçoit les pseudo-instructions
+ * @param f_p dictionnaire ouvert en lecture, positionné après la dernière instruction réelle
+ * @return SUCCESS si les pseudo-instructions ont pu être chargées (un dictionnaire peut ne pas en avoir)
+ * @brief Charge les modèles d'expansion des pseudo-instructions qui suivent les instructions du dictionnaire
+ *
+ * La section commence par le nombre de modèles. Les modèles d'une même pseudo-instruction sont gardés dans
+ * l'ordre du dictionnaire ; l'un d'eux au moins doit être sans condition.
+ */
+int charge_def_pseudo_flux(struct Table_s *table_definition_p, FILE *f_p)
+{
+	struct DefinitionInstruction_s *pseudo_p, **pseudos;
+	struct ExpansionPseudo_s *expansion_p, **fin_pp;
+	char nom[STRLEN], condition[STRLEN], texte[STRLEN];
+	int nb_modeles, nb_operandes, nb_pseudos=0, i, j;
+	char car_nature;
+	int nouvelle;
+
+	if (1!=fscanf(f_p, "%d", &nb_modeles)) return SUCCESS; /* pas de pseudo-instructions */
+	if (nb_modeles<=0) return SUCCESS;
+	pseudos=calloc(nb_modeles, sizeof(*pseudos));
+
+	for (i=0; i<nb_modeles; i++) {
+		if (1!=fscanf(f_p, "%s", nom)) ERROR_MSG("La ligne du dictionnaire ne comprenait pas le nom de la pseudo-instruction en cours");
+		if (1!=fscanf(f_p, "%d", &nb_operandes)) ERROR_MSG("Pas de nombre d'opérandes pour la pseudo-instruction %s", nom);
+		if (1!=fscanf(f_p, "%c", &car_nature)) ERROR_MSG("Pas de caractère de type syntaxique pour %s", nom);
+		if (1!=fscanf(f_p, "%s", condition)) ERROR_MSG("Pas de condition pour la pseudo-instruction %s", nom);
+		if (!fgets(texte, sizeof(texte), f_p)) ERROR_MSG("Pas d'expansion pour la pseudo-instruction %s", nom);
+		if ((nb_operandes<1) || (nb_operandes>3) || ((car_nature!='R') && (car_nature!='N')))
+			ERROR_MSG("Forme %d%c non prise en charge pour la pseudo-instruction %s", nb_operandes, car_nature, nom);
+
+		nouvelle=!(pseudo_p=(struct DefinitionInstruction_s *)donnee_table(table_definition_p, nom));
+		if (!nouvelle) {
+			if (!pseudo_p->expansions_p) ERROR_MSG("%s est déjà une instruction réelle", nom);
+			if ((pseudo_p->nb_ops!=(unsigned int)nb_operandes) || (pseudo_p->type_ops!=(car_nature=='R' ? I_OP_R : I_OP_N)))
+				ERROR_MSG("Les expansions de %s n'ont pas toutes la même forme", nom);
+		} else {
+			pseudo_p=calloc(1, sizeof(*pseudo_p));
+			pseudo_p->nom=strdup(nom);
+			MEMOIRE_ALLOUER(MEM_DICTIONNAIRES, sizeof(*pseudo_p));
+			MEMOIRE_ALLOUER(MEM_DICTIONNAIRES, strlen(nom)+1);
+			pseudo_p->type_ops=(car_nature=='R') ? I_OP_R : I_OP_N;
+			pseudo_p->nb_ops=nb_operandes;
+			strcpy(pseudo_p->champs, "-");
+			pseudos[nb_pseudos++]=pseudo_p;
+		}
+
+		expansion_p=calloc(1, sizeof(*expansion_p));
+		MEMOIRE_ALLOUER(MEM_DICTIONNAIRES, sizeof(*expansion_p));
+		for (j=0; (j<(int)(sizeof(NOMS_CONDITIONS)/sizeof(*NOMS_CONDITIONS))) && (strcmp(condition, NOMS_CONDITIONS[j])); j++);
+		if (j==(int)(sizeof(NOMS_CONDITIONS)/sizeof(*NOMS_CONDITIONS))) ERROR_MSG("Condition %s inconnue pour %s", condition, nom);
+		expansion_p->condition=(enum ConditionPseudo_e)j;
+		analyser_modele_pseudo(table_definition_p, pseudo_p, texte, expansion_p);
+
+		for (fin_pp=&pseudo_p->expansions_p; *fin_pp; fin_pp=&(*fin_pp)->suivante_p);
+		*fin_pp=expansion_p;
+		if (nouvelle) ajouter_table(table_definition_p, pseudo_p); /* après l'analyse : une expansion ne peut pas se citer */
+	}
+
+	for (i=0; i<nb_pseudos; i++) {
+		for (expansion_p=pseudos[i]->expansions_p; (expansion_p) && (expansion_p->condition!=C_TOUJOURS); expansion_p=expansion_p->suivante_p);
+		if (!expansion_p) ERROR_MSG("La pseudo-instruction %s n'a pas d'expansion sans condition", pseudos[i]->nom);
+	}
+	free(pseudos);
+	return SUCCESS;
+}
+
+/**
+ * @param expansion_p pointeur sur la première expansion d'une pseudo-instruction, NULL accepté
+ * @return Rien
+ * @brief Libère les expansions d'une pseudo-instruction et les lexèmes constants de leurs modèles
+ */
+void detruire_expansions_pseudo(struct ExpansionPseudo_s *expansion_p)
+{
+	struct ExpansionPseudo_s *suivante_p;
+	unsigned int e, i;
+
+	for (; expansion_p; expansion_p=suivante_p) {
+		suivante_p=expansion_p->suivante_p;
+		for (e=0; e<expansion_p->nb_etapes; e++)
+			for (i=0; i<3; i++)
+				if (expansion_p->etapes[e].constantes[i].data) {
+					MEMOIRE_LIBERER(MEM_DICTIONNAIRES, strlen(expansion_p->etapes[e].constantes[i].data)+1);
+					free(expansion_p->etapes[e].constantes[i].data);
+				}
+		MEMOIRE_LIBERER(MEM_DICTIONNAIRES, sizeof(*expansion_p));
+		free(expansion_p);
+	}
+}
+
+/**
+ * @param lexeme_p pointeur sur le dernier opérande de la pseudo-instruction
+ * @param valeur_p pointeur recevant sa valeur
+ * @return TRUE si l'opérande est une constante connue dès l'analyse syntaxique
+ */
+int valeur_constante_pseudo(struct Lexeme_s *lexeme_p, long *valeur_p)
+{
+	if (lexeme_p->nature==L_NOMBRE) {
+		errno=0;
+		*valeur_p=strtol(lexeme_p->data, NULL, 0);
+		return !errno;
+	}
+	return expression_constante(lexeme_p, valeur_p);
+}
+
+/**
+ * @param pseudo_p pointeur sur la définition de la pseudo-instruction
+ * @param constante TRUE si son dernier opérande est une constante connue
+ * @param valeur valeur de cette constante
+ * @param nb_min nombre minimal d'instructions voulu (0 : aucun)
+ * @return expansion la plus courte d'au moins nb_min instructions dont la condition est vérifiée, ou à défaut la
+ * plus longue de celles dont la condition est vérifiée
+ */
+struct ExpansionPseudo_s *choisir_expansion_pseudo(struct DefinitionInstruction_s *pseudo_p, int constante, long valeur, unsigned int nb_min)
+{
+	struct ExpansionPseudo_s *expansion_p, *choisie_p=NULL, *plus_longue_p=NULL;
+	/* un mot de 32 bits écrit en hexadécimal (0xFFFF8000) a la valeur signée qu'il aura dans le registre */
+	long signee=((valeur>=0x80000000L) && (valeur<=(long)UINT32_MAX)) ? (long)(int32_t)valeur : valeur;
+
+	for (expansion_p=pseudo_p->expansions_p; expansion_p; expansion_p=expansion_p->suivante_p) {
+		if ((expansion_p->condition!=C_TOUJOURS) && (!constante)) continue;
+		if ((expansion_p->condition==C_SIGNE16) && ((signee<INT16_MIN) || (signee>INT16_MAX))) continue;
+		if ((expansion_p->condition==C_NON_SIGNE16) && ((valeur<0) || (valeur>UINT16_MAX))) continue;
+		if ((expansion_p->condition==C_HAUT16) && ((valeur<INT32_MIN) || (valeur>(long)UINT32_MAX) || (valeur & 0xFFFF))) continue;
+		if ((!plus_longue_p) || (expansion_p->nb_etapes>plus_longue_p->nb_etapes)) plus_longue_p=expansion_p;
+		if ((expansion_p->nb_etapes>=nb_min) && ((!choisie_p) || (expansion_p->nb_etapes<choisie_p->nb_etapes))) choisie_p=expansion_p;
+	}
+	return choisie_p ? choisie_p : plus_longue_p;
+}
+
+/**
+ * @param instruction_p pointeur sur une pseudo-instruction analysée
+ * @return TRUE si le choix de son expansion dépend d'étiquettes pas encore placées : son dernier opérande est une
+ * expression qui n'est pas encore constante (la différence de deux étiquettes par exemple) et l'une de ses
+ * expansions a une condition. Une pseudo-instruction dont une expansion contient un branchement ou un saut
+ * n'est pas variable : le remplissage des délais, qui précède la relaxation, doit pouvoir la compter.
+ */
+int pseudo_variable(struct Instruction_s *instruction_p)
+{
+	struct DefinitionInstruction_s *pseudo_p=instruction_p->definition_p;
+	struct Lexeme_s *dernier_p=instruction_p->operandes[pseudo_p->nb_ops-1];
+	struct ExpansionPseudo_s *expansion_p;
+	int conditionnelle=FALSE;
+	unsigned int e;
+
+	if ((dernier_p->nature!=L_EXPRESSION) || (expression_constante(dernier_p, NULL))) return FALSE;
+	for (expansion_p=pseudo_p->expansions_p; expansion_p; expansion_p=expansion_p->suivante_p) {
+		if (expansion_p->condition!=C_TOUJOURS) conditionnelle=TRUE;
+		for (e=0; e<expansion_p->nb_etapes; e++)
+			if (nature_instruction(expansion_p->etapes[e].definition_p) & EFFET_DELAI) return FALSE;
+	}
+	return conditionnelle;
+}
+
+/**
+ * @param pseudo_p pointeur sur la définition de la pseudo-instruction
+ * @return première de ses expansions les plus courtes, quelle que soit leur condition
+ */
+struct ExpansionPseudo_s *expansion_optimiste_pseudo(struct DefinitionInstruction_s *pseudo_p)
+{
+	struct ExpansionPseudo_s *expansion_p, *choisie_p=pseudo_p->expansions_p;
+
+	for (expansion_p=pseudo_p->expansions_p; expansion_p; expansion_p=expansion_p->suivante_p)
+		if (expansion_p->nb_etapes<choisie_p->nb_etapes) choisie_p=expansion_p;
+	return choisie_p;
+}
+
+/**
+ * @param reelle_p pointeur sur l'instruction à écrire
+ * @param etape_p pointeur sur l'étape de l'expansion
+ * @param operandes opérandes de la pseudo-instruction
+ * @return Rien
+ * @brief Ecrit la définition et les opérandes d'une instruction réelle d'une expansion (son code reste à calculer)
+ */
+void ecrire_etape_pseudo(struct Instruction_s *reelle_p, struct EtapePseudo_s *etape_p, struct Lexeme_s **operandes)
+{
+	unsigned int i;
+
+	reelle_p->definition_p=etape_p->definition_p;
+	reelle_p->code=0;
+	for (i=0; i<3; i++)
+		if (i>=etape_p->definition_p->nb_ops)
+			reelle_p->operandes[i]=NULL;
+		else if (etape_p->parametres[i]==PSEUDO_CONSTANTE)
+			reelle_p->operandes[i]=&etape_p->constantes[i];
+		else
+			reelle_p->operandes[i]=partager_expression(operandes[etape_p->parametres[i]]);
+}
+
+/**
+ * @param instruction_p pointeur sur une pseudo-instruction analysée, réutilisée pour la première instruction
+ * @param expansion_p expansion à employer, NULL pour la plus courte dont la condition est vérifiée
+ * @param liste_text_p pointeur sur la liste .text
+ * @return taille en octets des instructions ajoutées
+ * @brief Remplace une pseudo-instruction par les instructions réelles de son expansion, ajoutées à la liste .text
+ *
+ * Les instructions ajoutées pointent sur les lexèmes de la pseudo-instruction ou sur ceux du modèle : seules
+ * les instructions elles-mêmes sont allouées. Une expression reprise par plusieurs instructions est partagée.
+ */
+uint32_t developper_pseudo(struct Instruction_s *instruction_p, struct ExpansionPseudo_s *expansion_p, struct Liste_s *liste_text_p)
+{
+	struct DefinitionInstruction_s *pseudo_p=instruction_p->definition_p;
+	struct Instruction_s *reelle_p;
+	struct Lexeme_s *operandes[3];
+	unsigned int e, i;
+	long valeur=0;
+	int constante;
+
+	if (!expansion_p) {
+		constante=valeur_constante_pseudo(instruction_p->operandes[pseudo_p->nb_ops-1], &valeur);
+		expansion_p=choisir_expansion_pseudo(pseudo_p, constante, valeur, 0);
+	}
+
+	memcpy(operandes, instruction_p->operandes, sizeof(operandes));
+	for (e=0; e<expansion_p->nb_etapes; e++) {
+		if (e==0)
+			reelle_p=instruction_p;
+		else {
+			reelle_p=calloc(1, sizeof(*reelle_p));
+			MEMOIRE_ALLOUER(MEM_INSTRUCTIONS, sizeof(*reelle_p));
+			reelle_p->ligne=instruction_p->ligne;
+			reelle_p->decalage=instruction_p->decalage+4*e;
+			reelle_p->ordre_fixe=instruction_p->ordre_fixe;
+		}
+		ecrire_etape_pseudo(reelle_p, expansion_p->etapes+e, operandes);
+		ajouter_fin_liste(liste_text_p, reelle_p);
+	}
+
+	/* les opérandes de la pseudo-instruction ne lui appartiennent plus */
+	for (i=0; i<3; i++)
+		if ((operandes[i]) && (operandes[i]->nature==L_EXPRESSION))
+			detruire_expression((struct Expression_s *)operandes[i]);
+	return 4*expansion_p->nb_etapes;
+}
@@ -0,0 +1,375 @@
+/**
+ * @file relaxation.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions de relaxation de la section .text
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <global.h>
+#include <notify.h>
+#include <memoire.h>
+#include <liste.h>
+#include <table.h>
+#include <dico.h>
+#include <lex.h>
+#include <syn.h>
+#include <expression.h>
+#include <pseudo.h>
+#include <gen.h>
+#include <relaxation.h>
+
+/**
+ * @return pointeur sur un état de relaxation vide
+ */
+struct Relaxation_s *creer_relaxation(void)
+{
+	struct Relaxation_s *relaxation_p=calloc(1, sizeof(*relaxation_p));
+
+	if (!relaxation_p) ERROR_MSG("Impossible de créer l'état de la relaxation");
+	return relaxation_p;
+}
+
+/**
+ * @param operandes opérandes d'une instruction
+ * @return Rien
+ * @brief Rend les expressions des opérandes, qui sont partagées
+ */
+void rendre_operandes(struct Lexeme_s **operandes)
+{
+	int i;
+
+	for (i=0; i<3; i++) {
+		if ((operandes[i]) && (operandes[i]->nature==L_EXPRESSION))
+			detruire_expression((struct Expression_s *)operandes[i]);
+		operandes[i]=NULL;
+	}
+}
+
+/**
+ * @param relaxation_p pointeur sur l'état de relaxation, NULL accepté
+ * @return Rien
+ */
+void detruire_relaxation(struct Relaxation_s *relaxation_p)
+{
+	size_t k;
+
+	if (!relaxation_p) return;
+	for (k=0; k<relaxation_p->nb_pseudos; k++)
+		rendre_operandes(relaxation_p->pseudos[k].operandes);
+	free(relaxation_p->pseudos);
+	free(relaxation_p->etiquettes);
+	free(relaxation_p->croissance);
+	free(relaxation_p);
+}
+
+/**
+ * @param relaxation_p pointeur sur l'état de relaxation
+ * @param instruction_p pointeur sur la pseudo-instruction analysée, avant son expansion
+ * @param expansion_p expansion (optimiste) qui va lui être donnée
+ * @return pointeur sur la pseudo-instruction notée, dont il reste à renseigner le premier noeud
+ * @brief Note une pseudo-instruction variable ; ses opérandes sont partagés jusqu'à la fin de la relaxation
+ */
+struct PseudoVariable_s *noter_pseudo_variable(struct Relaxation_s *relaxation_p, struct Instruction_s *instruction_p,
+		struct ExpansionPseudo_s *expansion_p)
+{
+	struct PseudoVariable_s *pseudo_p;
+	int i;
+
+	if (relaxation_p->nb_pseudos==relaxation_p->capacite_pseudos) {
+		relaxation_p->capacite_pseudos=relaxation_p->capacite_pseudos ? 2*relaxation_p->capacite_pseudos : 64;
+		if (!(relaxation_p->pseudos=realloc(relaxation_p->pseudos, relaxation_p->capacite_pseudos*sizeof(*relaxation_p->pseudos))))
+			ERROR_MSG("Impossible d'agrandir la liste des pseudo-instructions à relaxer");
+	}
+	pseudo_p=relaxation_p->pseudos+relaxation_p->nb_pseudos++;
+	memset(pseudo_p, 0, sizeof(*pseudo_p));
+	pseudo_p->pseudo_p=instruction_p->definition_p;
+	for (i=0; i<3; i++)
+		pseudo_p->operandes[i]=partager_expression(instruction_p->operandes[i]);
+	pseudo_p->ligne=instruction_p->ligne;
+	pseudo_p->decalage=instruction_p->decalage;
+	pseudo_p->expansion_p=expansion_p;
+	pseudo_p->nb_noeuds=pseudo_p->nb_places=expansion_p->nb_etapes;
+	return pseudo_p;
+}
+
+/**
+ * @param relaxation_p pointeur sur l'état de relaxation
+ * @param decalage décalage avant relaxation
+ * @return nombre de pseudo-instructions variables placées avant ce décalage
+ */
+size_t rang_decalage(struct Relaxation_s *relaxation_p, uint32_t decalage)
+{
+	size_t debut=0, fin=relaxation_p->nb_pseudos, milieu;
+
+	while (debut<fin) {
+		milieu=debut+(fin-debut)/2;
+		if (relaxation_p->pseudos[milieu].decalage<decalage) debut=milieu+1;
+		else fin=milieu;
+	}
+	return debut;
+}
+
+/**
+ * @param relaxation_p pointeur sur l'état de relaxation
+ * @param rang nombre de pseudo-instructions considérées
+ * @return nombre d'octets gagnés par les rang premières pseudo-instructions
+ */
+uint32_t prefixe_croissance(struct Relaxation_s *relaxation_p, size_t rang)
+{
+	uint32_t somme=0;
+
+	for (; rang>0; rang&=rang-1)
+		somme+=relaxation_p->croissance[rang];
+	return somme;
+}
+
+/**
+ * @param relaxation_p pointeur sur l'état de relaxation
+ * @param k indice de la pseudo-instruction qui grandit
+ * @param octets nombre d'octets gagnés
+ * @return Rien
+ */
+void ajouter_croissance(struct Relaxation_s *relaxation_p, size_t k, uint32_t octets)
+{
+	size_t i;
+
+	for (i=k+1; i<=relaxation_p->nb_pseudos; i+=i&(~i+1))
+		relaxation_p->croissance[i]+=octets;
+}
+
+/**
+ * @param relaxation_p pointeur sur l'état de relaxation
+ * @param pseudo_p pointeur sur la pseudo-instruction variable
+ * @param table_etiquettes_p pointeur sur la table des étiquettes complète
+ * @return Rien
+ * @brief Range les étiquettes de .text dont dépend le dernier opérande d'une pseudo-instruction, avec leur rang
+ */
+void repertorier_etiquettes(struct Relaxation_s *relaxation_p, struct PseudoVariable_s *pseudo_p, struct Table_s *table_etiquettes_p)
+{
+	struct Expression_s *expression_p=(struct Expression_s *)pseudo_p->operandes[pseudo_p->pseudo_p->nb_ops-1];
+	struct EtiquetteRelaxee_s *etiquette_relaxee_p;
+	struct Etiquette_s *etiquette_p;
+	size_t i;
+
+	pseudo_p->premiere_etiquette=relaxation_p->nb_etiquettes;
+	for (i=0; i<expression_p->nb_termes; i++) {
+		if (expression_p->termes[i].nature!=E_SYMBOLE) continue;
+		etiquette_p=donnee_table(table_etiquettes_p, (char *)expression_p->termes[i].symbole);
+		if ((!etiquette_p) || (etiquette_p->section!=S_TEXT)) continue;
+
+		if (relaxation_p->nb_etiquettes==relaxation_p->capacite_etiquettes) {
+			relaxation_p->capacite_etiquettes=relaxation_p->capacite_etiquettes ? 2*relaxation_p->capacite_etiquettes : 64;
+			if (!(relaxation_p->etiquettes=realloc(relaxation_p->etiquettes, relaxation_p->capacite_etiquettes*sizeof(*relaxation_p->etiquettes))))
+				ERROR_MSG("Impossible d'agrandir la liste des étiquettes à relaxer");
+		}
+		etiquette_relaxee_p=relaxation_p->etiquettes+relaxation_p->nb_etiquettes++;
+		etiquette_relaxee_p->etiquette_p=etiquette_p;
+		etiquette_relaxee_p->decalage=etiquette_p->decalage;
+		etiquette_relaxee_p->rang=rang_decalage(relaxation_p, etiquette_p->decalage);
+		if ((!pseudo_p->nb_etiquettes) || (etiquette_relaxee_p->rang<pseudo_p->rang_min)) pseudo_p->rang_min=etiquette_relaxee_p->rang;
+		if ((!pseudo_p->nb_etiquettes) || (etiquette_relaxee_p->rang>pseudo_p->rang_max)) pseudo_p->rang_max=etiquette_relaxee_p->rang;
+		pseudo_p->nb_etiquettes++;
+	}
+}
+
+/**
+ * @param relaxation_p pointeur sur l'état de relaxation
+ * @param pseudo_p pointeur sur la pseudo-instruction variable
+ * @param table_etiquettes_p pointeur sur la table des étiquettes complète
+ * @param valeur_p pointeur recevant la valeur du dernier opérande
+ * @return TRUE si le dernier opérande est une constante avec les décalages relaxés courants, FALSE sinon
+ * @brief Evalue le dernier opérande en plaçant temporairement ses étiquettes à leur décalage relaxé
+ */
+int evaluer_pseudo_variable(struct Relaxation_s *relaxation_p, struct PseudoVariable_s *pseudo_p, struct Table_s *table_etiquettes_p, long *valeur_p)
+{
+	struct Expression_s *expression_p=(struct Expression_s *)pseudo_p->operandes[pseudo_p->pseudo_p->nb_ops-1];
+	struct EtiquetteRelaxee_s *etiquette_relaxee_p;
+	struct ValeurExpression_s valeur;
+	char msg_err[STRLEN];
+	size_t j;
+	int resultat;
+
+	for (j=0; j<pseudo_p->nb_etiquettes; j++) {
+		etiquette_relaxee_p=relaxation_p->etiquettes+pseudo_p->premiere_etiquette+j;
+		etiquette_relaxee_p->etiquette_p->decalage=etiquette_relaxee_p->decalage+prefixe_croissance(relaxation_p, etiquette_relaxee_p->rang);
+	}
+	resultat=evaluer_expression(expression_p, table_etiquettes_p, NULL, &valeur, msg_err);
+	for (j=0; j<pseudo_p->nb_etiquettes; j++) {
+		etiquette_relaxee_p=relaxation_p->etiquettes+pseudo_p->premiere_etiquette+j;
+		etiquette_relaxee_p->etiquette_p->decalage=etiquette_relaxee_p->decalage;
+	}
+
+	/* une erreur sera signalée au placement de l'instruction, l'expansion la plus sûre est alors gardée */
+	if ((resultat!=SUCCESS) || (valeur.symbole)) return FALSE;
+	*valeur_p=(expression_p->partie==P_TOUT) ? (long)(int32_t)valeur.valeur : (long)valeur.valeur;
+	return TRUE;
+}
+
+/**
+ * @param relaxation_p pointeur sur l'état de relaxation
+ * @param k indice de la pseudo-instruction variable
+ * @param table_etiquettes_p pointeur sur la table des étiquettes complète
+ * @return TRUE si son expansion a grandi, FALSE sinon
+ * @brief Choisit à nouveau l'expansion d'une pseudo-instruction, sans jamais la raccourcir
+ */
+int reexaminer_pseudo(struct Relaxation_s *relaxation_p, size_t k, struct Table_s *table_etiquettes_p)
+{
+	struct PseudoVariable_s *pseudo_p=relaxation_p->pseudos+k;
+	struct ExpansionPseudo_s *expansion_p;
+	long valeur=0;
+	int constante;
+
+	constante=evaluer_pseudo_variable(relaxation_p, pseudo_p, table_etiquettes_p, &valeur);
+	expansion_p=choisir_expansion_pseudo(pseudo_p->pseudo_p, constante, valeur, pseudo_p->nb_places);
+	if (expansion_p!=pseudo_p->expansion_p) {
+		pseudo_p->expansion_p=expansion_p;
+		pseudo_p->a_reecrire=TRUE;
+	}
+	if (expansion_p->nb_etapes<=pseudo_p->nb_places) return FALSE;
+
+	ajouter_croissance(relaxation_p, k, 4*(expansion_p->nb_etapes-pseudo_p->nb_places));
+	pseudo_p->nb_places=expansion_p->nb_etapes;
+	return TRUE;
+}
+
+/**
+ * @param pseudo_p pointeur sur la pseudo-instruction variable
+ * @param croissances indices croissants des pseudo-instructions qui ont grandi au dernier tour
+ * @param nb_croissances nombre de ces pseudo-instructions
+ * @return TRUE si l'une d'elles se trouve entre deux étiquettes de la pseudo-instruction, dont l'écart a donc changé
+ */
+int depend_croissance(struct PseudoVariable_s *pseudo_p, size_t *croissances, size_t nb_croissances)
+{
+	size_t debut=0, fin=nb_croissances, milieu;
+
+	if (pseudo_p->rang_min==pseudo_p->rang_max) return FALSE;
+	while (debut<fin) {
+		milieu=debut+(fin-debut)/2;
+		if (croissances[milieu]<pseudo_p->rang_min) debut=milieu+1;
+		else fin=milieu;
+	}
+	return (debut<nb_croissances) && (croissances[debut]<pseudo_p->rang_max);
+}
+
+/**
+ * @param relaxation_p pointeur sur l'état de relaxation
+ * @param analyse_p pointeur sur l'état de l'analyse syntaxique
+ * @param recoder TRUE si les instructions réécrites doivent être codées à nouveau
+ * @return SUCCESS si toutes les instructions réécrites ont pu être codées, FAILURE sinon
+ * @brief Réécrit les expansions qui ont changé, puis met à jour les décalages des instructions et des étiquettes
+ */
+int reecrire_pseudos(struct Relaxation_s *relaxation_p, struct AnalyseSyntaxe_s *analyse_p, int recoder)
+{
+	struct DefinitionInstruction_s *nop_p=NULL;
+	struct PseudoVariable_s *pseudo_p;
+	struct Instruction_s *instruction_p;
+	struct NoeudListe_s *noeud_p, *precedent_p;
+	struct Etiquette_s *etiquette_p;
+	size_t k, premiere_croissance=relaxation_p->nb_pseudos, i;
+	char msg_err[STRLEN];
+	unsigned int e;
+	uint32_t decalage;
+	int resultat=SUCCESS;
+
+	for (k=0; k<relaxation_p->nb_pseudos; k++) {
+		pseudo_p=relaxation_p->pseudos+k;
+		if (!pseudo_p->a_reecrire) continue;
+		if ((pseudo_p->nb_places>pseudo_p->nb_noeuds) && (premiere_croissance==relaxation_p->nb_pseudos)) premiere_croissance=k;
+
+		precedent_p=NULL;
+		noeud_p=pseudo_p->premier_p;
+		for (e=0; e<pseudo_p->nb_places; e++) {
+			if (e<pseudo_p->nb_noeuds) {
+				instruction_p=noeud_p->donnee_p;
+				rendre_operandes(instruction_p->operandes);
+			} else {
+				instruction_p=calloc(1, sizeof(*instruction_p));
+				MEMOIRE_ALLOUER(MEM_INSTRUCTIONS, sizeof(*instruction_p));
+				instruction_p->ligne=pseudo_p->ligne;
+				instruction_p->ordre_fixe=((struct Instruction_s *)pseudo_p->premier_p->donnee_p)->ordre_fixe;
+				noeud_p=inserer_apres_liste(analyse_p->liste_text_p, precedent_p, instruction_p);
+			}
+
+			if (e<pseudo_p->expansion_p->nb_etapes)
+				ecrire_etape_pseudo(instruction_p, pseudo_p->expansion_p->etapes+e, pseudo_p->operandes);
+			else {
+				/* une expansion ne raccourcit jamais : les places en trop sont remplies de NOP */
+				if ((!nop_p) && (!(nop_p=donnee_table(analyse_p->table_def_instructions_p, "NOP"))))
+					ERROR_MSG("L'instruction NOP n'est pas dans le dictionnaire");
+				instruction_p->definition_p=nop_p;
+				instruction_p->code=0;
+			}
+			if ((recoder) && (FAILURE==encoder_instruction(instruction_p, analyse_p->table_def_registres_p, msg_err)))
+				resultat=FAILURE;
+			precedent_p=noeud_p;
+			noeud_p=noeud_p->suivant_p;
+		}
+		pseudo_p->nb_noeuds=pseudo_p->nb_places;
+	}
+	if (premiere_croissance==relaxation_p->nb_pseudos) return resultat;
+
+	/* les instructions et les étiquettes qui suivent la première expansion agrandie sont décalées */
+	decalage=relaxation_p->pseudos[premiere_croissance].decalage;
+	for (noeud_p=relaxation_p->pseudos[premiere_croissance].premier_p; noeud_p; noeud_p=noeud_p->suivant_p) {
+		((struct Instruction_s *)noeud_p->donnee_p)->decalage=decalage;
+		decalage+=4;
+	}
+	for (i=0; i<analyse_p->table_etiquettes_p->nbEltsMax; i++)
+		if (((etiquette_p=analyse_p->table_etiquettes_p->table[i])) && (etiquette_p->section==S_TEXT))
+			etiquette_p->decalage+=prefixe_croissance(relaxation_p, rang_decalage(relaxation_p, etiquette_p->decalage));
+	analyse_p->decalage_text+=prefixe_croissance(relaxation_p, relaxation_p->nb_pseudos);
+	return resultat;
+}
+
+/**
+ * @param relaxation_p pointeur sur l'état de relaxation
+ * @param analyse_p pointeur sur l'état de l'analyse syntaxique, toutes les lignes ayant été analysées
+ * @param recoder TRUE si les instructions réécrites doivent être codées à nouveau (elles l'ont déjà été)
+ * @return SUCCESS si toutes les instructions réécrites ont pu être codées, FAILURE sinon
+ * @brief Choisit l'expansion définitive des pseudo-instructions variables par tours successifs
+ *
+ * Le premier tour examine toutes les pseudo-instructions variables, chacun des suivants seulement celles dont
+ * deux étiquettes encadrent une expansion qui a grandi au tour précédent.
+ */
+int relaxer_text(struct Relaxation_s *relaxation_p, struct AnalyseSyntaxe_s *analyse_p, int recoder)
+{
+	size_t *travail, *croissances;
+	size_t nb_travail, nb_croissances, t, k, nb_tours=0;
+	int resultat;
+
+	if (!relaxation_p->nb_pseudos) return SUCCESS;
+	relaxation_p->croissance=calloc(relaxation_p->nb_pseudos+1, sizeof(*relaxation_p->croissance));
+	travail=malloc(relaxation_p->nb_pseudos*sizeof(*travail));
+	croissances=malloc(relaxation_p->nb_pseudos*sizeof(*croissances));
+	if ((!relaxation_p->croissance) || (!travail) || (!croissances)) ERROR_MSG("Impossible de préparer la relaxation de .text");
+
+	for (k=0; k<relaxation_p->nb_pseudos; k++) {
+		repertorier_etiquettes(relaxation_p, relaxation_p->pseudos+k, analyse_p->table_etiquettes_p);
+		travail[k]=k;
+	}
+	nb_travail=relaxation_p->nb_pseudos;
+	while (nb_travail) {
+		nb_tours++;
+		nb_croissances=0;
+		for (t=0; t<nb_travail; t++)
+			if (reexaminer_pseudo(relaxation_p, travail[t], analyse_p->table_etiquettes_p))
+				croissances[nb_croissances++]=travail[t];
+
+		nb_travail=0;
+		if (nb_croissances)
+			for (k=0; k<relaxation_p->nb_pseudos; k++)
+				if (depend_croissance(relaxation_p->pseudos+k, croissances, nb_croissances))
+					travail[nb_travail++]=k;
+	}
+	INFO_MSG("Relaxation de .text : %zu pseudo-instruction(s) variable(s), %zu tour(s), %u octet(s) ajouté(s)",
+			relaxation_p->nb_pseudos, nb_tours, prefixe_croissance(relaxation_p, relaxation_p->nb_pseudos));
+
+	resultat=reecrire_pseudos(relaxation_p, analyse_p, recoder);
+	free(travail);
+	free(croissances);
+	return resultat;
+}
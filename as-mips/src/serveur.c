@@ -0,0 +1,391 @@
+/**
+ * @file serveur.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Mode serveur : assemble des requêtes reçues sur un socket Unix ou sur l'entrée standard
+ *
+ * Le serveur garde d'une requête à l'autre les dictionnaires, l'assemblage (ses listes vidées mais conservées),
+ * le collecteur de diagnostics et les tampons du listage, des diagnostics et de la réponse, qui ne font que
+ * grandir. Une requête ne paie donc que l'assemblage proprement dit. Les connexions sont servies l'une après
+ * l'autre ; une erreur fatale n'abandonne que la requête en cours.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <setjmp.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <global.h>
+#include <notify.h>
+#include <diag.h>
+#include <sortie.h>
+#include <profil.h>
+#include <assemblage.h>
+#include <serveur.h>
+
+/**
+ * @struct Requete_s
+ * @brief Requête d'assemblage reçue par le serveur
+ */
+struct Requete_s {
+	char *arguments[SERVEUR_ARGS_MAX+2];	/**< Ligne de commande, arguments[0] étant le nom du programme */
+	int nb_arguments;						/**< Nombre d'arguments, nom du programme compris */
+	char *repertoire;						/**< Répertoire de travail du client, NULL s'il n'est pas précisé */
+	char terminaux[2];						/**< '1' si la sortie standard, puis la sortie d'erreur, sont des terminaux */
+	char *texte;							/**< Texte du source, s'il est dans la requête */
+	size_t taille_texte;					/**< Taille du texte */
+	size_t capacite_texte;					/**< Capacité du tampon du texte */
+	int avec_texte;							/**< TRUE si le source est dans la requête */
+	int arret;								/**< TRUE si le serveur doit s'arrêter après cette requête */
+};
+
+/**
+ * @struct Serveur_s
+ * @brief Etat conservé par le serveur d'une requête à l'autre
+ */
+struct Serveur_s {
+	const struct Dictionnaires_s *dictionnaires_p;	/**< Dictionnaires chargés au démarrage */
+	struct Assemblage_s *assemblage_p;				/**< Assemblage réinitialisé après chaque requête */
+	struct Diag_s *diag_p;							/**< Diagnostics des requêtes, écrits dans erreurs_p */
+	struct Sortie_s *listage_p;						/**< Listage de la requête, en mémoire */
+	struct Sortie_s *erreurs_p;						/**< Diagnostics et profil de la requête, en mémoire */
+	struct Sortie_s *reponse_p;						/**< Réponse, sur le descripteur de la connexion */
+	struct Requete_s requete;						/**< Requête en cours */
+	char *champ;									/**< Tampon de lecture des champs */
+	size_t capacite_champ;							/**< Capacité du tampon des champs */
+	int repertoire_initial;							/**< Répertoire de travail du serveur, rétabli après chaque requête */
+	jmp_buf reprise;								/**< Point de reprise après une erreur fatale */
+};
+
+/**
+ * @param contexte_p pointeur sur le serveur
+ * @return Ne revient pas
+ * @brief Fonction fatale du collecteur du serveur : abandonne la requête en cours
+ */
+void reprendre_requete(void *contexte_p)
+{
+	longjmp(((struct Serveur_s *)contexte_p)->reprise, 1);
+}
+
+/**
+ * @param entree_p flux de la connexion
+ * @param nom nom du champ lu (SERVEUR_NOM_MAX caractères au plus)
+ * @param donnees_pp pointeur sur le tampon recevant les données, agrandi au besoin et terminé par un zéro
+ * @param capacite_p pointeur sur la capacité du tampon
+ * @param taille_p pointeur sur la taille des données lues
+ * @return SUCCESS si un champ complet a été lu, FAILURE en fin de flux ou si le champ est mal formé
+ */
+int lire_champ(FILE *entree_p, char *nom, char **donnees_pp, size_t *capacite_p, size_t *taille_p)
+{
+	char entete[SERVEUR_NOM_MAX+32];
+	char *fin_p;
+	char *espace_p;
+
+	if (!fgets(entete, sizeof(entete), entree_p)) return FAILURE;
+	if ((!(espace_p=strchr(entete, ' '))) || (espace_p-entete>SERVEUR_NOM_MAX)) return FAILURE;
+	*espace_p='\0';
+	strcpy(nom, entete);
+	*taille_p=strtoul(espace_p+1, &fin_p, 10);
+	if (*fin_p!='\n') return FAILURE;
+
+	if (*taille_p+1>*capacite_p) {
+		*capacite_p=*taille_p+1;
+		if (!(*donnees_pp=realloc(*donnees_pp, *capacite_p))) ERROR_MSG("Impossible d'agrandir le tampon de la requête");
+	}
+	if (fread(*donnees_pp, 1, *taille_p, entree_p)!=*taille_p) return FAILURE;
+	(*donnees_pp)[*taille_p]='\0';
+	return SUCCESS;
+}
+
+/**
+ * @param requete_p pointeur sur la requête
+ * @return Rien
+ * @brief Libère les arguments de la requête précédente (le tampon du texte est conservé)
+ */
+void vider_requete(struct Requete_s *requete_p)
+{
+	int i;
+
+	for (i=1; i<requete_p->nb_arguments; i++) free(requete_p->arguments[i]);
+	free(requete_p->repertoire);
+	requete_p->repertoire=NULL;
+	requete_p->arguments[0]="as-mips";
+	requete_p->nb_arguments=1;
+	requete_p->terminaux[0]=requete_p->terminaux[1]='0';
+	requete_p->taille_texte=0;
+	requete_p->avec_texte=FALSE;
+	requete_p->arret=FALSE;
+}
+
+/**
+ * @param serveur_p pointeur sur le serveur
+ * @param entree_p flux de la connexion
+ * @return SUCCESS si une requête complète a été lue, FAILURE en fin de flux ou si la requête est mal formée
+ */
+int lire_requete(struct Serveur_s *serveur_p, FILE *entree_p)
+{
+	struct Requete_s *requete_p=&serveur_p->requete;
+	char nom[SERVEUR_NOM_MAX+1];
+	char *echange_p;
+	size_t taille;
+	size_t capacite;
+
+	vider_requete(requete_p);
+	while (SUCCESS==lire_champ(entree_p, nom, &serveur_p->champ, &serveur_p->capacite_champ, &taille)) {
+		if (!strcmp(nom, SERVEUR_FIN))
+			return SUCCESS;
+		else if (!strcmp(nom, SERVEUR_ARG)) {
+			if (requete_p->nb_arguments>SERVEUR_ARGS_MAX) return FAILURE;
+			if (!(requete_p->arguments[requete_p->nb_arguments]=malloc(taille+1))) ERROR_MSG("Impossible de lire la requête");
+			memcpy(requete_p->arguments[requete_p->nb_arguments++], serveur_p->champ, taille+1);
+		} else if (!strcmp(nom, SERVEUR_REP)) {
+			free(requete_p->repertoire);
+			if (!(requete_p->repertoire=malloc(taille+1))) ERROR_MSG("Impossible de lire la requête");
+			memcpy(requete_p->repertoire, serveur_p->champ, taille+1);
+		} else if (!strcmp(nom, SERVEUR_TERMINAUX)) {
+			if (taille!=2) return FAILURE;
+			memcpy(requete_p->terminaux, serveur_p->champ, 2);
+		} else if (!strcmp(nom, SERVEUR_TEXTE)) {
+			/* le texte prend le tampon du champ, qui prend l'ancien tampon du texte : aucune copie */
+			echange_p=requete_p->texte;
+			requete_p->texte=serveur_p->champ;
+			serveur_p->champ=echange_p;
+			capacite=requete_p->capacite_texte;
+			requete_p->capacite_texte=serveur_p->capacite_champ;
+			serveur_p->capacite_champ=capacite;
+			requete_p->taille_texte=taille;
+			requete_p->avec_texte=TRUE;
+		} else if (!strcmp(nom, SERVEUR_ARRET))
+			requete_p->arret=TRUE;
+		else
+			return FAILURE;
+	}
+	return FAILURE;
+}
+
+/**
+ * @param sortie_p sortie de la réponse
+ * @param nom nom du champ
+ * @param donnees_p données du champ
+ * @param taille nombre d'octets des données
+ * @return Rien
+ */
+void envoyer_champ(struct Sortie_s *sortie_p, const char *nom, const char *donnees_p, size_t taille)
+{
+	sortie_chaine(sortie_p, nom);
+	sortie_caractere(sortie_p, ' ');
+	sortie_decimal(sortie_p, taille, 0);
+	sortie_caractere(sortie_p, '\n');
+	sortie_ecrire(sortie_p, donnees_p, taille);
+}
+
+/**
+ * @param ligne_p pointeur sur la ligne de commande de la requête
+ * @param avec_texte TRUE si le source est dans la requête
+ * @return un message décrivant ce qui ne va pas, NULL si la requête peut être assemblée
+ * @brief Vérifie qu'une requête décrit l'assemblage d'un seul source, comme la ligne de commande d'as-mips
+ */
+const char *verifier_requete(const struct LigneCommande_s *ligne_p, int avec_texte)
+{
+	if ((ligne_p->nb_threads) || (ligne_p->serveur)) return "-j et --serve ne sont pas admis dans une requête";
+	if (ligne_p->nb_sources>1) return "une requête n'assemble qu'un seul source";
+	if (analyses_demandees(ligne_p)) return "--estimate, --run, --run-limit, --cfg et --cfg-json ne sont pas admis dans une requête";
+	if ((!ligne_p->nb_sources) && (!avec_texte)) return "il manque le source";
+	if ((ligne_p->options.image.format!=SORTIE_ELF) && (!ligne_p->fichier_objet)) return "-O demande -o";
+	return NULL;
+}
+
+/**
+ * @param serveur_p pointeur sur le serveur
+ * @param ligne_p pointeur sur la ligne de commande de la requête, déjà vérifiée
+ * @param source nom du source
+ * @return le code de sortie qu'aurait eu as-mips
+ * @brief Assemble le source d'une requête, en reprenant ici après une erreur fatale
+ */
+int assembler_requete(struct Serveur_s *serveur_p, struct LigneCommande_s *ligne_p, char *source)
+{
+	struct Requete_s *requete_p=&serveur_p->requete;
+	struct Sortie_s *listage_p=ligne_p->listage ? serveur_p->listage_p : NULL;
+	int resultat=FAILURE;
+	FILE *fp;
+
+	serveur_p->diag_p->fn_fatale_p=reprendre_requete;
+	serveur_p->diag_p->contexte_fatal_p=serveur_p;
+	if (!setjmp(serveur_p->reprise)) {
+		ligne_p->options.pipeline=FALSE;
+		if (requete_p->avec_texte) {
+			fp=(requete_p->taille_texte) ? fmemopen(requete_p->texte, requete_p->taille_texte, "r") : fopen("/dev/null", "r");
+			if (!fp) ERROR_MSG("Impossible de lire le texte du source \"%s\"", source);
+			resultat=assembler_flux(serveur_p->assemblage_p, fp, source, ligne_p->fichier_objet, &ligne_p->options,
+					serveur_p->dictionnaires_p, listage_p);
+		} else
+			resultat=assembler_fichier(serveur_p->assemblage_p, source, ligne_p->fichier_objet, &ligne_p->options,
+					serveur_p->dictionnaires_p, listage_p);
+		if (!ligne_p->fichier_objet) resultat=SUCCESS;
+	}
+	serveur_p->diag_p->fn_fatale_p=NULL;
+	reinitialiser_assemblage(serveur_p->assemblage_p);
+	return (resultat==SUCCESS) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @param serveur_p pointeur sur le serveur
+ * @return Rien
+ * @brief Exécute la requête lue et envoie la réponse
+ */
+void traiter_requete(struct Serveur_s *serveur_p)
+{
+	struct Requete_s *requete_p=&serveur_p->requete;
+	struct Diag_s *diag_p=serveur_p->diag_p;
+	struct LigneCommande_s ligne;
+	struct Profil_s *profil_p=NULL;
+	const char *probleme=NULL;
+	char *source;
+	char statut[16];
+	int code=EXIT_FAILURE;
+
+	/* les tampons et le collecteur repartent à vide, mais gardent leur place */
+	serveur_p->listage_p->taille=0;
+	serveur_p->listage_p->couleur=(requete_p->terminaux[0]=='1');
+	serveur_p->erreurs_p->taille=0;
+	reinitialiser_diag(diag_p);
+	diag_p->format=(requete_p->terminaux[1]=='1') ? DIAG_COULEUR : DIAG_TEXTE;
+	diag_p->max_repetitions=DIAG_MAX_REPETITIONS;
+	diag_p->fichier_source=NULL;
+	diag_installer(diag_p);
+
+	requete_p->arguments[requete_p->nb_arguments]=NULL;
+	if (FAILURE==analyser_ligne_commande(requete_p->nb_arguments, requete_p->arguments, &ligne, diag_p))
+		probleme="option inconnue ou incomplète";
+	else
+		probleme=verifier_requete(&ligne, requete_p->avec_texte);
+
+	if (probleme)
+		diag_signaler(diag_p, DIAG_ERREUR, NULL, 0, "requete", "requête invalide : %s", probleme);
+	else if ((requete_p->repertoire) && (chdir(requete_p->repertoire)))
+		diag_signaler(diag_p, DIAG_ERREUR, requete_p->repertoire, 0, "requete", "répertoire de travail inaccessible");
+	else {
+		source=ligne.nb_sources ? ligne.sources[0] : "-";
+		diag_p->fichier_source=source;
+		if (ligne.profilage) profil_installer(profil_p=creer_profil(source));
+
+		code=assembler_requete(serveur_p, &ligne, source);
+
+		if (profil_p) {
+			profil_cumuler(profil_p);
+			profil_installer(NULL);
+			vider_diag(diag_p);
+			ecrire_profil(serveur_p->erreurs_p, profil_p, ligne.profilage_json);
+			profil_p=detruire_profil(profil_p);
+		}
+	}
+	vider_diag(diag_p);
+	diag_installer(NULL);
+	liberer_ligne_commande(&ligne);
+	if (fchdir(serveur_p->repertoire_initial)) WARNING_MSG("Impossible de revenir au répertoire du serveur");
+
+	sprintf(statut, "%d", code);
+	envoyer_champ(serveur_p->reponse_p, SERVEUR_SORTIE, serveur_p->listage_p->tampon, serveur_p->listage_p->taille);
+	envoyer_champ(serveur_p->reponse_p, SERVEUR_ERREURS, serveur_p->erreurs_p->tampon, serveur_p->erreurs_p->taille);
+	envoyer_champ(serveur_p->reponse_p, SERVEUR_STATUT, statut, strlen(statut));
+	envoyer_champ(serveur_p->reponse_p, SERVEUR_FIN, "", 0);
+	vider_sortie(serveur_p->reponse_p);
+}
+
+/**
+ * @param serveur_p pointeur sur le serveur
+ * @param entree_p flux des requêtes
+ * @param descripteur descripteur des réponses
+ * @return TRUE si une requête a demandé l'arrêt du serveur
+ * @brief Sert les requêtes d'une connexion jusqu'à sa fermeture
+ */
+int servir_connexion(struct Serveur_s *serveur_p, FILE *entree_p, int descripteur)
+{
+	serveur_p->reponse_p->descripteur=descripteur;
+	serveur_p->reponse_p->erreur=0;
+	while (SUCCESS==lire_requete(serveur_p, entree_p)) {
+		if (serveur_p->requete.arret) {
+			envoyer_champ(serveur_p->reponse_p, SERVEUR_STATUT, "0", 1);
+			envoyer_champ(serveur_p->reponse_p, SERVEUR_FIN, "", 0);
+			vider_sortie(serveur_p->reponse_p);
+			return TRUE;
+		}
+		traiter_requete(serveur_p);
+	}
+	return FALSE;
+}
+
+/**
+ * @param chemin_socket chemin du socket Unix, "-" pour lire les requêtes sur l'entrée standard et répondre sur la sortie standard
+ * @param dictionnaires_p pointeur sur les dictionnaires chargés
+ * @return SUCCESS si le serveur s'est arrêté normalement (fin de l'entrée standard ou requête ARRET)
+ * @brief Attend et exécute des requêtes d'assemblage
+ */
+int servir(const char *chemin_socket, const struct Dictionnaires_s *dictionnaires_p)
+{
+	struct Serveur_s serveur;
+	struct sockaddr_un adresse;
+	int ecoute, connexion;
+	FILE *entree_p;
+
+	memset(&serveur, 0, sizeof(serveur));
+	serveur.dictionnaires_p=dictionnaires_p;
+	serveur.assemblage_p=creer_assemblage();
+	serveur.diag_p=creer_diag(DIAG_TEXTE, -1);
+	serveur.listage_p=creer_sortie(-1, 0);
+	serveur.erreurs_p=creer_sortie(-1, 0);
+	serveur.reponse_p=creer_sortie(-1, 0);
+	serveur.diag_p->sortie_p=serveur.erreurs_p;
+	if ((serveur.repertoire_initial=open(".", O_RDONLY))<0) ERROR_MSG("Impossible d'ouvrir le répertoire de travail");
+
+	/* un client parti avant sa réponse ne doit pas arrêter le serveur */
+	signal(SIGPIPE, SIG_IGN);
+
+	if (!strcmp(chemin_socket, "-"))
+		servir_connexion(&serveur, stdin, STDOUT_FILENO);
+	else {
+		memset(&adresse, 0, sizeof(adresse));
+		adresse.sun_family=AF_UNIX;
+		if (strlen(chemin_socket)>=sizeof(adresse.sun_path)) ERROR_MSG("Chemin du socket \"%s\" trop long", chemin_socket);
+		strcpy(adresse.sun_path, chemin_socket);
+
+		/* un socket laissé par un serveur précédent est remplacé */
+		unlink(chemin_socket);
+		if (((ecoute=socket(AF_UNIX, SOCK_STREAM, 0))<0) || (bind(ecoute, (struct sockaddr *)&adresse, sizeof(adresse)))
+				|| (listen(ecoute, SERVEUR_ATTENTE)))
+			ERROR_MSG("Impossible d'écouter sur le socket \"%s\" : %s", chemin_socket, strerror(errno));
+
+		while (TRUE) {
+			if ((connexion=accept(ecoute, NULL, NULL))<0) {
+				if (errno==EINTR) continue;
+				ERROR_MSG("Impossible d'accepter une connexion : %s", strerror(errno));
+			}
+			if (!(entree_p=fdopen(connexion, "r"))) ERROR_MSG("Impossible de lire la connexion");
+			if (servir_connexion(&serveur, entree_p, connexion)) {
+				fclose(entree_p);
+				break;
+			}
+			fclose(entree_p);
+		}
+		close(ecoute);
+		unlink(chemin_socket);
+	}
+
+	vider_requete(&serveur.requete);
+	free(serveur.requete.texte);
+	free(serveur.champ);
+	close(serveur.repertoire_initial);
+	serveur.reponse_p->descripteur=-1;
+	serveur.reponse_p=detruire_sortie(serveur.reponse_p);
+	serveur.diag_p=detruire_diag(serveur.diag_p);
+	serveur.erreurs_p=detruire_sortie(serveur.erreurs_p);
+	serveur.listage_p=detruire_sortie(serveur.listage_p);
+	serveur.assemblage_p=detruire_assemblage(serveur.assemblage_p);
+	return SUCCESS;
+}
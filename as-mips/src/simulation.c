@@ -0,0 +1,643 @@
+/**
+ * @file simulation.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions du simulateur du jeu d'instructions
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <global.h>
+#include <notify.h>
+#include <liste.h>
+#include <table.h>
+#include <syn.h>
+#include <gen.h>
+#include <image.h>
+#include <sortie.h>
+#include <profil.h>
+#include <simulation.h>
+
+#ifdef __GNUC__
+#define SIMULATION_DIRECTE		/* enchaînement des opérations par goto calculé (extension GCC) */
+#endif
+
+#define MASQUE_PAGE		((1U << SIMULATION_BITS_PAGE)-1)
+#define MASQUE_TABLE	((1U << SIMULATION_BITS_TABLE)-1)
+#define REGISTRE_NUL	32		/* registre qui reçoit les écritures dans $zero */
+#define REGISTRE_V0		2
+#define REGISTRE_A0		4
+#define REGISTRE_A1		5
+#define REGISTRE_SP		29
+#define REGISTRE_RA		31
+
+static const char *NOMS_OPERATIONS[NB_OPERATIONS]={
+	"ADD", "ADDI", "ADDIU", "ADDU", "AND", "BEQ", "BGTZ", "BLEZ", "BNE", "DIV", "J", "JAL", "JR",
+	"LUI", "LW", "MFHI", "MFLO", "MULT", "NOP", "OR", "ORI", "ROTR", "SLL", "SLT", "SRL", "SUB",
+	"SW", "SYSCALL", "XOR", "(inconnue)", "(fin)", "(hors)"
+};
+
+/**
+ * @param memoire_p pointeur sur la mémoire simulée
+ * @param adresse adresse d'un octet de la page
+ * @param creer TRUE pour créer la page si elle n'existe pas encore
+ * @return début de la page, NULL si elle n'existe pas et ne doit pas être créée
+ */
+uint8_t *page_simulee(struct MemoireSimulee_s *memoire_p, uint32_t adresse, int creer)
+{
+	uint8_t ***table_pp=memoire_p->tables+(adresse >> (SIMULATION_BITS_TABLE+SIMULATION_BITS_PAGE));
+	uint8_t **page_pp;
+
+	if (!*table_pp) {
+		if (!creer) return NULL;
+		if (!(*table_pp=calloc(MASQUE_TABLE+1, sizeof(**table_pp)))) ERROR_MSG("Impossible de créer une table de pages simulée");
+	}
+	page_pp=*table_pp+((adresse >> SIMULATION_BITS_PAGE) & MASQUE_TABLE);
+	if (!*page_pp) {
+		if (!creer) return NULL;
+		if (!(*page_pp=calloc(MASQUE_PAGE+1, 1))) ERROR_MSG("Impossible de créer une page de la mémoire simulée");
+		memoire_p->nb_pages++;
+	}
+	return *page_pp;
+}
+
+/**
+ * @param memoire_p pointeur sur la mémoire simulée
+ * @param adresse adresse de l'octet
+ * @return octet lu, 0 dans une page jamais écrite
+ */
+uint8_t lire_octet_simule(struct MemoireSimulee_s *memoire_p, uint32_t adresse)
+{
+	uint8_t *page_p=page_simulee(memoire_p, adresse, FALSE);
+
+	return page_p ? page_p[adresse & MASQUE_PAGE] : 0;
+}
+
+/**
+ * @param memoire_p pointeur sur la mémoire simulée
+ * @param adresse adresse de l'octet
+ * @param octet valeur à écrire
+ * @return Rien
+ */
+void ecrire_octet_simule(struct MemoireSimulee_s *memoire_p, uint32_t adresse, uint8_t octet)
+{
+	page_simulee(memoire_p, adresse, TRUE)[adresse & MASQUE_PAGE]=octet;
+}
+
+/**
+ * @param memoire_p pointeur sur la mémoire simulée
+ * @param adresse adresse du mot, alignée sur 4
+ * @return mot lu dans l'ordre des octets de la cible, 0 dans une page jamais écrite
+ */
+uint32_t lire_mot_simule(struct MemoireSimulee_s *memoire_p, uint32_t adresse)
+{
+	uint8_t *octets_p=page_simulee(memoire_p, adresse, FALSE);
+
+	if (!octets_p) return 0;
+	octets_p+=adresse & MASQUE_PAGE;
+	if (memoire_p->gros_boutiste)
+		return ((uint32_t)octets_p[0] << 24) | ((uint32_t)octets_p[1] << 16) | ((uint32_t)octets_p[2] << 8) | octets_p[3];
+	return ((uint32_t)octets_p[3] << 24) | ((uint32_t)octets_p[2] << 16) | ((uint32_t)octets_p[1] << 8) | octets_p[0];
+}
+
+/**
+ * @param memoire_p pointeur sur la mémoire simulée
+ * @param adresse adresse du mot, alignée sur 4
+ * @param mot valeur à écrire dans l'ordre des octets de la cible
+ * @return Rien
+ */
+void ecrire_mot_simule(struct MemoireSimulee_s *memoire_p, uint32_t adresse, uint32_t mot)
+{
+	uint8_t *octets_p=page_simulee(memoire_p, adresse, TRUE)+(adresse & MASQUE_PAGE);
+	int i;
+
+	for (i=0; i<4; i++)
+		octets_p[memoire_p->gros_boutiste ? i : 3-i]=(uint8_t)(mot >> (24-8*i));
+}
+
+/**
+ * @param simulation_p pointeur sur la simulation
+ * @param adresse adresse visée par un saut
+ * @return indice de l'opération à cette adresse, celui de OP_FIN à la fin de .text, celui de OP_HORS ailleurs
+ */
+uint32_t indice_adresse(const struct Simulation_s *simulation_p, uint32_t adresse)
+{
+	uint32_t decalage=adresse-simulation_p->base_text;
+
+	if ((decalage & 3) || (decalage/4 > simulation_p->nb_operations)) return simulation_p->nb_operations+1;
+	return decalage/4;
+}
+
+/**
+ * @param simulation_p pointeur sur la simulation dont base_text et nb_operations sont connus
+ * @param mot code machine de l'instruction
+ * @param indice indice de l'instruction dans .text
+ * @param operation_p pointeur sur l'opération à remplir
+ * @return Rien
+ * @brief Décode un mot de .text : opération, registres, immédiat étendu et indice de la cible d'un saut
+ */
+void decoder_mot(const struct Simulation_s *simulation_p, uint32_t mot, uint32_t indice, struct OperationDecodee_s *operation_p)
+{
+	uint32_t rs=(mot >> 21) & 31, rt=(mot >> 16) & 31, rd=(mot >> 11) & 31, fonction=mot & 63;
+	int32_t immediat=(int32_t)(int16_t)(mot & 0xFFFF);
+	long cible;
+
+	operation_p->operation=OP_INCONNUE;
+	operation_p->rs=(uint8_t)rs;
+	operation_p->rt=(uint8_t)rt;
+	operation_p->rd=(uint8_t)(rd ? rd : REGISTRE_NUL);
+	operation_p->sa=(uint8_t)((mot >> 6) & 31);
+	operation_p->immediat=immediat;
+
+	switch (mot >> 26) {
+	case 0x00:
+		switch (fonction) {
+		case 0x20: operation_p->operation=OP_ADD; break;
+		case 0x21: operation_p->operation=OP_ADDU; break;
+		case 0x22: operation_p->operation=OP_SUB; break;
+		case 0x24: operation_p->operation=OP_AND; break;
+		case 0x25: operation_p->operation=OP_OR; break;
+		case 0x26: operation_p->operation=OP_XOR; break;
+		case 0x2A: operation_p->operation=OP_SLT; break;
+		case 0x00: operation_p->operation=mot ? OP_SLL : OP_NOP; break;
+		case 0x02: operation_p->operation=(rs==1) ? OP_ROTR : (!rs) ? OP_SRL : OP_INCONNUE; break;
+		case 0x08: operation_p->operation=OP_JR; break;
+		case 0x0C: operation_p->operation=OP_SYSCALL; break;
+		case 0x10: operation_p->operation=OP_MFHI; break;
+		case 0x12: operation_p->operation=OP_MFLO; break;
+		case 0x18: operation_p->operation=OP_MULT; break;
+		case 0x1A: operation_p->operation=OP_DIV; break;
+		}
+		return;
+	case 0x02:
+	case 0x03:
+		/* le saut garde les 4 bits de poids fort de l'adresse du délai ; JAL range l'adresse de retour dans immediat */
+		operation_p->operation=(mot >> 26)==0x02 ? OP_J : OP_JAL;
+		operation_p->cible=indice_adresse(simulation_p, ((simulation_p->base_text+4*(indice+1)) & 0xF0000000) | ((mot & 0x03FFFFFF) << 2));
+		operation_p->immediat=(int32_t)(simulation_p->base_text+4*(indice+2));
+		operation_p->rd=REGISTRE_RA;
+		return;
+	case 0x04: operation_p->operation=OP_BEQ; break;
+	case 0x05: operation_p->operation=OP_BNE; break;
+	case 0x06: operation_p->operation=OP_BLEZ; break;
+	case 0x07: operation_p->operation=OP_BGTZ; break;
+	case 0x08: operation_p->operation=OP_ADDI; break;
+	case 0x09: operation_p->operation=OP_ADDIU; break;
+	case 0x0D: operation_p->operation=OP_ORI; operation_p->immediat=(int32_t)(mot & 0xFFFF); break;
+	case 0x0F: operation_p->operation=OP_LUI; operation_p->immediat=(int32_t)((mot & 0xFFFF) << 16); break;
+	case 0x23: operation_p->operation=OP_LW; break;
+	case 0x2B: operation_p->operation=OP_SW; break;
+	default: return;
+	}
+	/* format I : rt est le registre écrit, sauf pour SW et les branchements qui le lisent */
+	if ((operation_p->operation!=OP_SW) && (operation_p->operation>OP_BNE || operation_p->operation<OP_BEQ))
+		operation_p->rd=(uint8_t)(rt ? rt : REGISTRE_NUL);
+	if ((operation_p->operation>=OP_BEQ) && (operation_p->operation<=OP_BNE)) {
+		cible=(long)indice+1+immediat;
+		operation_p->cible=((cible<0) || (cible>(long)simulation_p->nb_operations)) ? simulation_p->nb_operations+1 : (uint32_t)cible;
+	}
+}
+
+/**
+ * @param liste_text_p pointeur sur la liste des instructions codées
+ * @param liste_data_p pointeur sur la liste des données de .data
+ * @param liste_bss_p pointeur sur la liste des réservations de .bss
+ * @param table_etiquettes_p pointeur sur la table des étiquettes complète
+ * @param parametres_p placement des sections et ordre des octets, comme pour l'image
+ * @param nom_fichier nom du source, pour les diagnostics
+ * @return simulation prête à exécuter, NULL si les sections ne peuvent pas être placées
+ * @brief Place les sections, les copie dans la mémoire simulée et décode .text
+ */
+struct Simulation_s *creer_simulation(struct Liste_s *liste_text_p, struct Liste_s *liste_data_p, struct Liste_s *liste_bss_p,
+		struct Table_s *table_etiquettes_p, const struct ParametresImage_s *parametres_p, const char *nom_fichier)
+{
+	struct ParametresImage_s parametres=*parametres_p;
+	struct Simulation_s *simulation_p;
+	struct NoeudListe_s *noeud_p;
+	struct Instruction_s *instruction_p;
+	struct Etiquette_s *etiquette_p;
+	uint32_t tailles[4], i, mot;
+	uint8_t *contenus[4];
+	uint64_t fin, fin_max=0;
+	int s;
+
+	tailles[S_INIT]=0;
+	tailles[S_TEXT]=taille_section(liste_text_p, S_TEXT);
+	tailles[S_DATA]=taille_section(liste_data_p, S_DATA);
+	tailles[S_BSS]=taille_section(liste_bss_p, S_BSS);
+	if (FAILURE==placer_sections_image(&parametres, tailles, nom_fichier)) return NULL;
+	if (!(contenus[S_TEXT]=construire_section_text(liste_text_p, table_etiquettes_p, parametres.adresses_base, tailles[S_TEXT],
+			parametres.gros_boutiste)))
+		return NULL;
+
+	if (!(simulation_p=calloc(1, sizeof(*simulation_p)))) ERROR_MSG("Impossible de créer la simulation");
+	simulation_p->memoire.gros_boutiste=parametres.gros_boutiste;
+	simulation_p->base_text=parametres.adresses_base[S_TEXT];
+	simulation_p->nb_operations=tailles[S_TEXT]/4;
+	simulation_p->limite=SIMULATION_LIMITE;
+
+	/* .text et .data sont recopiées dans la mémoire ; .bss reste dans des pages jamais écrites, donc nulles */
+	contenus[S_DATA]=construire_section_donnees(liste_data_p, table_etiquettes_p, parametres.adresses_base, tailles[S_DATA], parametres.gros_boutiste);
+	for (s=S_TEXT; s<=S_BSS; s++) {
+		if (s!=S_BSS)
+			for (i=0; i<tailles[s]; i++) ecrire_octet_simule(&simulation_p->memoire, parametres.adresses_base[s]+i, contenus[s][i]);
+		fin=(uint64_t)parametres.adresses_base[s]+tailles[s];
+		if ((tailles[s]) && (fin>fin_max)) fin_max=fin;
+	}
+	free(contenus[S_TEXT]);
+	free(contenus[S_DATA]);
+
+	/* chaque instruction est décodée une seule fois ; deux sentinelles terminent .text */
+	if (!(simulation_p->operations=calloc(simulation_p->nb_operations+2, sizeof(*simulation_p->operations))))
+		ERROR_MSG("Impossible de créer les opérations décodées");
+	for (i=0; i<simulation_p->nb_operations; i++) {
+		mot=lire_mot_simule(&simulation_p->memoire, simulation_p->base_text+4*i);
+		decoder_mot(simulation_p, mot, i, simulation_p->operations+i);
+	}
+	simulation_p->operations[simulation_p->nb_operations].operation=OP_FIN;
+	simulation_p->operations[simulation_p->nb_operations+1].operation=OP_HORS;
+	for (noeud_p=liste_text_p->debut_liste_p; noeud_p; noeud_p=noeud_p->suivant_p) {
+		instruction_p=noeud_p->donnee_p;
+		if (instruction_p->decalage/4 < simulation_p->nb_operations)
+			simulation_p->operations[instruction_p->decalage/4].ligne=instruction_p->ligne;
+	}
+
+	etiquette_p=donnee_table(table_etiquettes_p, "main");
+	if ((etiquette_p) && (etiquette_p->section==S_TEXT) && (etiquette_p->decalage/4 < simulation_p->nb_operations))
+		simulation_p->depart=etiquette_p->decalage/4;
+	simulation_p->registres[REGISTRE_SP]=SIMULATION_PILE;
+	simulation_p->registres[REGISTRE_RA]=simulation_p->base_text+4*simulation_p->nb_operations;
+	simulation_p->tas=(uint32_t)((fin_max+ALIGNEMENT_SECTIONS_IMAGE-1) & ~(uint64_t)(ALIGNEMENT_SECTIONS_IMAGE-1));
+	return simulation_p;
+}
+
+/**
+ * @param simulation_p pointeur sur la simulation, NULL accepté
+ * @return NULL
+ */
+struct Simulation_s *detruire_simulation(struct Simulation_s *simulation_p)
+{
+	size_t t, p;
+
+	if (simulation_p) {
+		for (t=0; t<sizeof(simulation_p->memoire.tables)/sizeof(*simulation_p->memoire.tables); t++)
+			if (simulation_p->memoire.tables[t]) {
+				for (p=0; p<=MASQUE_TABLE; p++) free(simulation_p->memoire.tables[t][p]);
+				free(simulation_p->memoire.tables[t]);
+			}
+		free(simulation_p->operations);
+		free(simulation_p);
+	}
+	return NULL;
+}
+
+/**
+ * @param simulation_p pointeur sur la simulation
+ * @param operation_p pointeur sur l'opération en cause
+ * @param message explication de l'erreur
+ * @param adresse adresse en cause, écrite à la suite du message
+ * @return Rien
+ */
+void arreter_simulation(struct Simulation_s *simulation_p, const struct OperationDecodee_s *operation_p, const char *message, uint32_t adresse)
+{
+	simulation_p->arret=ARRET_ERREUR;
+	simulation_p->ligne_arret=operation_p->ligne;
+	sprintf(simulation_p->message, "%.80s 0x%08lx", message, (unsigned long)adresse);
+}
+
+/**
+ * @param simulation_p pointeur sur la simulation
+ * @param sortie_programme_p sortie standard du programme simulé
+ * @param operation_p pointeur sur l'opération SYSCALL
+ * @return TRUE si le programme continue, FALSE s'il s'arrête
+ * @brief Emule l'appel système demandé par $v0, avec les numéros de SPIM
+ */
+int appel_systeme(struct Simulation_s *simulation_p, struct Sortie_s *sortie_programme_p, const struct OperationDecodee_s *operation_p)
+{
+	uint32_t *registres=simulation_p->registres, a0=registres[REGISTRE_A0], i;
+	char nombre[16], *tampon;
+	uint8_t octet;
+	int caractere;
+
+	switch (registres[REGISTRE_V0]) {
+	case 1:
+		sprintf(nombre, "%ld", (long)(int32_t)a0);
+		sortie_chaine(sortie_programme_p, nombre);
+		break;
+	case 4:
+		for (i=a0; (octet=lire_octet_simule(&simulation_p->memoire, i)); i++) sortie_caractere(sortie_programme_p, (char)octet);
+		break;
+	case 5:
+		vider_sortie(sortie_programme_p);
+		registres[REGISTRE_V0]=fgets(nombre, sizeof(nombre), stdin) ? (uint32_t)strtol(nombre, NULL, 10) : 0;
+		break;
+	case 8:
+		vider_sortie(sortie_programme_p);
+		if ((int32_t)registres[REGISTRE_A1]<1) break;
+		if (!(tampon=malloc(registres[REGISTRE_A1]))) ERROR_MSG("Impossible de lire une chaîne pour le programme simulé");
+		if (!fgets(tampon, (int)registres[REGISTRE_A1], stdin)) tampon[0]='\0';
+		for (i=0; (i==0) || (tampon[i-1]); i++) ecrire_octet_simule(&simulation_p->memoire, a0+i, (uint8_t)tampon[i]);
+		free(tampon);
+		break;
+	case 9:
+		registres[REGISTRE_V0]=simulation_p->tas;
+		simulation_p->tas+=(a0+7) & ~7U;
+		break;
+	case 10:
+		simulation_p->arret=ARRET_EXIT;
+		simulation_p->code_sortie=0;
+		return FALSE;
+	case 11:
+		sortie_caractere(sortie_programme_p, (char)a0);
+		break;
+	case 12:
+		vider_sortie(sortie_programme_p);
+		caractere=getchar();
+		registres[REGISTRE_V0]=(caractere==EOF) ? (uint32_t)-1 : (uint32_t)caractere;
+		break;
+	case 17:
+		simulation_p->arret=ARRET_EXIT;
+		simulation_p->code_sortie=(int)(int32_t)a0;
+		return FALSE;
+	default:
+		arreter_simulation(simulation_p, operation_p, "appel système inconnu, $v0 =", registres[REGISTRE_V0]);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+#ifdef SIMULATION_DIRECTE
+#define TRAITEMENT(op)		T_##op:
+#define DISTRIBUER()		goto *operation_p->traitement
+#else
+#define TRAITEMENT(op)		case op:
+#define DISTRIBUER()		goto distribuer
+#endif
+
+/** Exécute l'opération d'indice ip, sauf si la limite est atteinte */
+#define ENCHAINER()		do { if (!--reste) goto limite; operation_p=operations+ip; operation_p->executions++; DISTRIBUER(); } while (0)
+/** Passe à l'instruction suivante */
+#define SUIVANTE()		do { ip=np; np=ip+1; ENCHAINER(); } while (0)
+/** Exécute le délai puis l'opération d'indice c */
+#define SAUTER(c)		do { saut_p=operation_p; ip=np; np=(c); ENCHAINER(); } while (0)
+
+/**
+ * @param simulation_p pointeur sur la simulation créée par creer_simulation
+ * @param sortie_programme_p sortie standard du programme simulé, vidée avant chaque lecture et à la fin
+ * @return Rien
+ * @brief Exécute le programme jusqu'à exit, la fin de .text, une erreur ou la limite d'instructions
+ */
+void executer_simulation(struct Simulation_s *simulation_p, struct Sortie_s *sortie_programme_p)
+{
+#ifdef SIMULATION_DIRECTE
+	static const void *TRAITEMENTS[NB_OPERATIONS]={
+		&&T_OP_ADD, &&T_OP_ADDI, &&T_OP_ADDIU, &&T_OP_ADDU, &&T_OP_AND, &&T_OP_BEQ, &&T_OP_BGTZ, &&T_OP_BLEZ, &&T_OP_BNE,
+		&&T_OP_DIV, &&T_OP_J, &&T_OP_JAL, &&T_OP_JR, &&T_OP_LUI, &&T_OP_LW, &&T_OP_MFHI, &&T_OP_MFLO, &&T_OP_MULT,
+		&&T_OP_NOP, &&T_OP_OR, &&T_OP_ORI, &&T_OP_ROTR, &&T_OP_SLL, &&T_OP_SLT, &&T_OP_SRL, &&T_OP_SUB, &&T_OP_SW,
+		&&T_OP_SYSCALL, &&T_OP_XOR, &&T_OP_INCONNUE, &&T_OP_FIN, &&T_OP_HORS
+	};
+#endif
+	struct OperationDecodee_s *operations=simulation_p->operations, *operation_p, *saut_p=NULL;
+	uint32_t *r=simulation_p->registres, ip, np, a, b, s;
+	unsigned long reste=simulation_p->limite ? simulation_p->limite+1 : 0;		/* 0 : la décrémentation ne revient pas à 0 */
+	int64_t produit;
+	uint32_t i;
+
+#ifdef SIMULATION_DIRECTE
+	for (i=0; i<=simulation_p->nb_operations+1; i++) operations[i].traitement=TRAITEMENTS[operations[i].operation];
+#endif
+	for (i=0; i<=simulation_p->nb_operations+1; i++) operations[i].executions=0;
+	ip=simulation_p->depart;
+	np=ip+1;
+	ENCHAINER();
+
+#ifndef SIMULATION_DIRECTE
+distribuer:
+	switch (operation_p->operation) {
+#endif
+	TRAITEMENT(OP_ADD)
+		a=r[operation_p->rs]; b=r[operation_p->rt]; s=a+b;
+		if ((a^s) & (b^s) & 0x80000000) goto depassement;
+		r[operation_p->rd]=s;
+		SUIVANTE();
+	TRAITEMENT(OP_ADDI)
+		a=r[operation_p->rs]; b=(uint32_t)operation_p->immediat; s=a+b;
+		if ((a^s) & (b^s) & 0x80000000) goto depassement;
+		r[operation_p->rd]=s;
+		SUIVANTE();
+	TRAITEMENT(OP_ADDIU)
+		r[operation_p->rd]=r[operation_p->rs]+(uint32_t)operation_p->immediat;
+		SUIVANTE();
+	TRAITEMENT(OP_ADDU)
+		r[operation_p->rd]=r[operation_p->rs]+r[operation_p->rt];
+		SUIVANTE();
+	TRAITEMENT(OP_AND)
+		r[operation_p->rd]=r[operation_p->rs] & r[operation_p->rt];
+		SUIVANTE();
+	TRAITEMENT(OP_BEQ)
+		if (r[operation_p->rs]==r[operation_p->rt]) SAUTER(operation_p->cible);
+		SUIVANTE();
+	TRAITEMENT(OP_BGTZ)
+		if ((int32_t)r[operation_p->rs]>0) SAUTER(operation_p->cible);
+		SUIVANTE();
+	TRAITEMENT(OP_BLEZ)
+		if ((int32_t)r[operation_p->rs]<=0) SAUTER(operation_p->cible);
+		SUIVANTE();
+	TRAITEMENT(OP_BNE)
+		if (r[operation_p->rs]!=r[operation_p->rt]) SAUTER(operation_p->cible);
+		SUIVANTE();
+	TRAITEMENT(OP_DIV)
+		/* le résultat d'une division par zéro n'est pas défini : HI et LO sont laissés tels quels */
+		a=r[operation_p->rs]; b=r[operation_p->rt];
+		if ((b==0xFFFFFFFF) && (a==0x80000000)) {
+			simulation_p->lo=a;
+			simulation_p->hi=0;
+		} else if (b) {
+			simulation_p->lo=(uint32_t)((int32_t)a/(int32_t)b);
+			simulation_p->hi=(uint32_t)((int32_t)a%(int32_t)b);
+		}
+		SUIVANTE();
+	TRAITEMENT(OP_J)
+		SAUTER(operation_p->cible);
+	TRAITEMENT(OP_JAL)
+		r[REGISTRE_RA]=(uint32_t)operation_p->immediat;
+		SAUTER(operation_p->cible);
+	TRAITEMENT(OP_JR)
+		SAUTER(indice_adresse(simulation_p, r[operation_p->rs]));
+	TRAITEMENT(OP_LUI)
+		r[operation_p->rd]=(uint32_t)operation_p->immediat;
+		SUIVANTE();
+	TRAITEMENT(OP_LW)
+		a=r[operation_p->rs]+(uint32_t)operation_p->immediat;
+		if (a & 3) {
+			arreter_simulation(simulation_p, operation_p, "lecture non alignée à l'adresse", a);
+			goto fin;
+		}
+		r[operation_p->rd]=lire_mot_simule(&simulation_p->memoire, a);
+		SUIVANTE();
+	TRAITEMENT(OP_MFHI)
+		r[operation_p->rd]=simulation_p->hi;
+		SUIVANTE();
+	TRAITEMENT(OP_MFLO)
+		r[operation_p->rd]=simulation_p->lo;
+		SUIVANTE();
+	TRAITEMENT(OP_MULT)
+		produit=(int64_t)(int32_t)r[operation_p->rs]*(int32_t)r[operation_p->rt];
+		simulation_p->hi=(uint32_t)((uint64_t)produit >> 32);
+		simulation_p->lo=(uint32_t)produit;
+		SUIVANTE();
+	TRAITEMENT(OP_NOP)
+		SUIVANTE();
+	TRAITEMENT(OP_OR)
+		r[operation_p->rd]=r[operation_p->rs] | r[operation_p->rt];
+		SUIVANTE();
+	TRAITEMENT(OP_ORI)
+		r[operation_p->rd]=r[operation_p->rs] | (uint32_t)operation_p->immediat;
+		SUIVANTE();
+	TRAITEMENT(OP_ROTR)
+		a=r[operation_p->rt];
+		r[operation_p->rd]=operation_p->sa ? (a >> operation_p->sa) | (a << (32-operation_p->sa)) : a;
+		SUIVANTE();
+	TRAITEMENT(OP_SLL)
+		r[operation_p->rd]=r[operation_p->rt] << operation_p->sa;
+		SUIVANTE();
+	TRAITEMENT(OP_SLT)
+		r[operation_p->rd]=(int32_t)r[operation_p->rs]<(int32_t)r[operation_p->rt];
+		SUIVANTE();
+	TRAITEMENT(OP_SRL)
+		r[operation_p->rd]=r[operation_p->rt] >> operation_p->sa;
+		SUIVANTE();
+	TRAITEMENT(OP_SUB)
+		a=r[operation_p->rs]; b=r[operation_p->rt]; s=a-b;
+		if ((a^b) & (a^s) & 0x80000000) goto depassement;
+		r[operation_p->rd]=s;
+		SUIVANTE();
+	TRAITEMENT(OP_SW)
+		a=r[operation_p->rs]+(uint32_t)operation_p->immediat;
+		if (a & 3) {
+			arreter_simulation(simulation_p, operation_p, "écriture non alignée à l'adresse", a);
+			goto fin;
+		}
+		ecrire_mot_simule(&simulation_p->memoire, a, r[operation_p->rt]);
+		SUIVANTE();
+	TRAITEMENT(OP_SYSCALL)
+		if (!appel_systeme(simulation_p, sortie_programme_p, operation_p)) goto fin;
+		SUIVANTE();
+	TRAITEMENT(OP_XOR)
+		r[operation_p->rd]=r[operation_p->rs] ^ r[operation_p->rt];
+		SUIVANTE();
+	TRAITEMENT(OP_INCONNUE)
+		arreter_simulation(simulation_p, operation_p, "instruction inconnue à l'adresse", simulation_p->base_text+4*ip);
+		goto fin;
+	TRAITEMENT(OP_FIN)
+		simulation_p->arret=ARRET_FIN_TEXT;
+		goto fin;
+	TRAITEMENT(OP_HORS)
+		arreter_simulation(simulation_p, saut_p ? saut_p : operation_p, "saut hors de .text depuis l'adresse",
+				saut_p ? simulation_p->base_text+4*(uint32_t)(saut_p-operations) : 0);
+		goto fin;
+#ifndef SIMULATION_DIRECTE
+	default:
+		goto fin;
+	}
+#endif
+
+depassement:
+	arreter_simulation(simulation_p, operation_p, "dépassement de capacité à l'adresse", simulation_p->base_text+4*ip);
+	goto fin;
+limite:
+	simulation_p->arret=ARRET_LIMITE;
+fin:
+	vider_sortie(sortie_programme_p);
+	for (simulation_p->executees=0, i=0; i<simulation_p->nb_operations; i++) simulation_p->executees+=operations[i].executions;
+	profil_compteurs[CPT_INSTRUCTIONS_SIMULEES]+=simulation_p->executees;
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param nombre nombre d'exécutions
+ * @param total nombre total d'instructions exécutées
+ * @return Rien
+ * @brief Ecrit un nombre d'exécutions et sa part du total
+ */
+void colonnes_executions(struct Sortie_s *sortie_p, unsigned long nombre, unsigned long total)
+{
+	char part[16];
+
+	sortie_decimal(sortie_p, nombre, 12);
+	sprintf(part, "%7.2f%%", total ? 100.0*nombre/total : 0.0);
+	sortie_chaine(sortie_p, part);
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param simulation_p pointeur sur la simulation exécutée
+ * @return Rien
+ * @brief Ecrit la cause de l'arrêt, le nombre d'instructions exécutées par opération et l'histogramme par ligne source
+ */
+void ecrire_simulation(struct Sortie_s *sortie_p, const struct Simulation_s *simulation_p)
+{
+	unsigned long par_operation[NB_OPERATIONS], *par_ligne, plus_grand=0;
+	unsigned int nb_lignes=0, l;
+	uint32_t i;
+	int o;
+
+	sortie_chaine(sortie_p, "Simulation : ");
+	switch (simulation_p->arret) {
+	case ARRET_EXIT:
+		sortie_chaine(sortie_p, "arrêt par exit, code ");
+		if (simulation_p->code_sortie<0) sortie_caractere(sortie_p, '-');
+		sortie_decimal(sortie_p, (unsigned long)(simulation_p->code_sortie<0 ? -(long)simulation_p->code_sortie : simulation_p->code_sortie), 0);
+		break;
+	case ARRET_FIN_TEXT:
+		sortie_chaine(sortie_p, "arrêt à la fin de .text");
+		break;
+	case ARRET_LIMITE:
+		sortie_chaine(sortie_p, "arrêt à la limite de ");
+		sortie_decimal(sortie_p, simulation_p->limite, 0);
+		sortie_chaine(sortie_p, " instructions");
+		break;
+	case ARRET_ERREUR:
+		sortie_chaine(sortie_p, "erreur ligne ");
+		sortie_decimal(sortie_p, simulation_p->ligne_arret, 0);
+		sortie_chaine(sortie_p, " : ");
+		sortie_chaine(sortie_p, simulation_p->message);
+		break;
+	}
+	sortie_chaine(sortie_p, "\ninstructions exécutées ");
+	sortie_decimal(sortie_p, simulation_p->executees, 0);
+	sortie_chaine(sortie_p, ", pages mémoire ");
+	sortie_decimal(sortie_p, simulation_p->memoire.nb_pages, 0);
+	sortie_chaine(sortie_p, "\n\nopération     exécutions       part\n");
+
+	memset(par_operation, 0, sizeof(par_operation));
+	for (i=0; i<simulation_p->nb_operations; i++) {
+		par_operation[simulation_p->operations[i].operation]+=simulation_p->operations[i].executions;
+		if (simulation_p->operations[i].ligne>=nb_lignes) nb_lignes=simulation_p->operations[i].ligne+1;
+	}
+	for (o=0; o<OP_FIN; o++)
+		if (par_operation[o]) {
+			sortie_chaine(sortie_p, NOMS_OPERATIONS[o]);
+			sortie_repeter(sortie_p, ' ', 12-strlen(NOMS_OPERATIONS[o]));
+			colonnes_executions(sortie_p, par_operation[o], simulation_p->executees);
+			sortie_caractere(sortie_p, '\n');
+		}
+
+	if (!(par_ligne=calloc(nb_lignes+1, sizeof(*par_ligne)))) ERROR_MSG("Impossible de créer l'histogramme des lignes");
+	for (i=0; i<simulation_p->nb_operations; i++) par_ligne[simulation_p->operations[i].ligne]+=simulation_p->operations[i].executions;
+	for (l=0; l<nb_lignes; l++) if (par_ligne[l]>plus_grand) plus_grand=par_ligne[l];
+	sortie_chaine(sortie_p, "\nligne         exécutions       part\n");
+	for (l=0; l<nb_lignes; l++)
+		if (par_ligne[l]) {
+			sortie_decimal(sortie_p, l, 5);
+			sortie_repeter(sortie_p, ' ', 7);
+			colonnes_executions(sortie_p, par_ligne[l], simulation_p->executees);
+			sortie_chaine(sortie_p, "  ");
+			sortie_repeter(sortie_p, '#', (size_t)((par_ligne[l]*40+plus_grand-1)/plus_grand));
+			sortie_caractere(sortie_p, '\n');
+		}
+	sortie_caractere(sortie_p, '\n');
+	free(par_ligne);
+}
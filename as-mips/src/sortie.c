@@ -0,0 +1,294 @@
+/**
+ * @file sortie.c
+ * @author BERTRAND Antoine TAURAND Sébastien
+ * @brief Definition des fonctions de la sortie tamponnée
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include <global.h>
+#include <notify.h>
+#include <sortie.h>
+
+static const char CHIFFRES_HEX[]="0123456789abcdef";
+
+/**
+ * @param descripteur descripteur de fichier de destination, -1 pour tout garder en mémoire
+ * @param capacite taille du tampon, 0 pour la taille par défaut
+ * @return pointeur sur la sortie créée
+ * @brief Crée une sortie tamponnée
+ *
+ * Une sortie en mémoire agrandit son tampon au lieu de le vider ; il suffit de lui donner un descripteur
+ * puis de la vider pour écrire tout ce qu'elle a reçu.
+ */
+struct Sortie_s *creer_sortie(int descripteur, size_t capacite)
+{
+	struct Sortie_s *sortie_p=calloc(1, sizeof(*sortie_p));
+
+	if (!sortie_p) ERROR_MSG("Impossible de créer une sortie");
+	sortie_p->capacite=capacite ? capacite : TAILLE_TAMPON_SORTIE;
+	if (!(sortie_p->tampon=malloc(sortie_p->capacite))) ERROR_MSG("Impossible de créer le tampon de sortie");
+	sortie_p->descripteur=descripteur;
+	return sortie_p;
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @return NULL
+ * @brief Ecrit ce qui reste dans le tampon puis détruit la sortie (le descripteur n'est pas fermé)
+ */
+struct Sortie_s *detruire_sortie(struct Sortie_s *sortie_p)
+{
+	if (sortie_p) {
+		vider_sortie(sortie_p);
+		free(sortie_p->tampon);
+		free(sortie_p);
+	}
+	return NULL;
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param donnees_p données à écrire
+ * @param nb nombre d'octets à écrire
+ * @return Rien
+ * @brief Ecrit directement sur le descripteur, en reprenant après une écriture partielle
+ */
+void ecrire_descripteur(struct Sortie_s *sortie_p, const char *donnees_p, size_t nb)
+{
+	ssize_t ecrits;
+
+	while ((nb) && (!sortie_p->erreur)) {
+		ecrits=write(sortie_p->descripteur, donnees_p, nb);
+		if (ecrits<0) {
+			if (errno!=EINTR) sortie_p->erreur=errno;
+			continue;
+		}
+		donnees_p+=ecrits;
+		nb-=ecrits;
+	}
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param nb nombre d'octets à ajouter au tampon
+ * @return Rien
+ * @brief Fait de la place pour nb octets : vide le tampon, ou l'agrandit pour une sortie en mémoire
+ */
+void liberer_place_sortie(struct Sortie_s *sortie_p, size_t nb)
+{
+	if (sortie_p->descripteur>=0) {
+		vider_sortie(sortie_p);
+		return;
+	}
+	while (sortie_p->taille+nb > sortie_p->capacite) sortie_p->capacite*=2;
+	if (!(sortie_p->tampon=realloc(sortie_p->tampon, sortie_p->capacite))) ERROR_MSG("Impossible d'agrandir le tampon de sortie");
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @return SUCCESS si toutes les écritures ont réussi jusqu'ici, FAILURE sinon (errno renseigné)
+ * @brief Transmet au système le contenu du tampon (rien pour une sortie en mémoire)
+ */
+int vider_sortie(struct Sortie_s *sortie_p)
+{
+	if (sortie_p->descripteur<0) return SUCCESS;
+	ecrire_descripteur(sortie_p, sortie_p->tampon, sortie_p->taille);
+	sortie_p->taille=0;
+	if (sortie_p->erreur) {
+		errno=sortie_p->erreur;
+		return FAILURE;
+	}
+	return SUCCESS;
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param nb nombre d'octets à réserver, au plus la capacité du tampon
+ * @return pointeur sur les nb octets réservés à la fin du tampon
+ * @brief Réserve de la place dans le tampon (en le vidant si besoin) pour y mettre en forme directement
+ */
+char *sortie_reserver(struct Sortie_s *sortie_p, size_t nb)
+{
+	char *place_p;
+
+	if (sortie_p->taille+nb > sortie_p->capacite) liberer_place_sortie(sortie_p, nb);
+	place_p=sortie_p->tampon+sortie_p->taille;
+	sortie_p->taille+=nb;
+	return place_p;
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param donnees_p données à écrire
+ * @param nb nombre d'octets
+ * @return Rien
+ * @brief Ecrit un bloc d'octets ; un bloc plus grand que le tampon est transmis sans recopie
+ */
+void sortie_ecrire(struct Sortie_s *sortie_p, const void *donnees_p, size_t nb)
+{
+	if (sortie_p->taille+nb > sortie_p->capacite) liberer_place_sortie(sortie_p, nb);
+	if (sortie_p->taille+nb <= sortie_p->capacite) {
+		memcpy(sortie_p->tampon+sortie_p->taille, donnees_p, nb);
+		sortie_p->taille+=nb;
+	} else
+		ecrire_descripteur(sortie_p, donnees_p, nb);
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param chaine chaine à écrire
+ * @return Rien
+ * @brief Ecrit une chaine de caractères
+ */
+void sortie_chaine(struct Sortie_s *sortie_p, const char *chaine)
+{
+	sortie_ecrire(sortie_p, chaine, strlen(chaine));
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param caractere caractère à écrire
+ * @return Rien
+ * @brief Ecrit un caractère
+ */
+void sortie_caractere(struct Sortie_s *sortie_p, char caractere)
+{
+	if (sortie_p->taille==sortie_p->capacite) liberer_place_sortie(sortie_p, 1);
+	sortie_p->tampon[sortie_p->taille++]=caractere;
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param caractere octet à répéter
+ * @param nb nombre de répétitions
+ * @return Rien
+ * @brief Ecrit nb fois le même octet, tampon par tampon (sert au remplissage des trous)
+ */
+void sortie_repeter(struct Sortie_s *sortie_p, char caractere, size_t nb)
+{
+	size_t morceau;
+
+	while (nb) {
+		if (sortie_p->taille==sortie_p->capacite) liberer_place_sortie(sortie_p, nb);
+		morceau=sortie_p->capacite-sortie_p->taille;
+		if (morceau>nb) morceau=nb;
+		memset(sortie_p->tampon+sortie_p->taille, caractere, morceau);
+		sortie_p->taille+=morceau;
+		nb-=morceau;
+	}
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param valeur valeur à écrire
+ * @param nb_chiffres nombre de chiffres hexadécimaux (1 à 8), complété par des zéros à gauche
+ * @return Rien
+ * @brief Ecrit un nombre en hexadécimal (minuscules)
+ */
+void sortie_hex(struct Sortie_s *sortie_p, uint32_t valeur, int nb_chiffres)
+{
+	char *place_p=sortie_reserver(sortie_p, nb_chiffres);
+
+	while (nb_chiffres--) {
+		place_p[nb_chiffres]=CHIFFRES_HEX[valeur & 0xF];
+		valeur>>=4;
+	}
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param valeur valeur à écrire
+ * @param largeur largeur minimale, complétée par des espaces à gauche
+ * @return Rien
+ * @brief Ecrit un nombre en décimal
+ */
+void sortie_decimal(struct Sortie_s *sortie_p, unsigned long valeur, int largeur)
+{
+	char chiffres[24];
+	int nb=0;
+
+	do {
+		chiffres[sizeof(chiffres)-1-nb++]='0'+(valeur%10);
+		valeur/=10;
+	} while (valeur);
+
+	if (largeur>nb) sortie_repeter(sortie_p, ' ', largeur-nb);
+	sortie_ecrire(sortie_p, chiffres+sizeof(chiffres)-nb, nb);
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param chaine chaine à écrire, NULL est écrit "(null)"
+ * @param largeur largeur minimale, complétée par des espaces à gauche (comme "%*s")
+ * @return Rien
+ * @brief Ecrit une chaine alignée à droite
+ */
+void sortie_chaine_alignee(struct Sortie_s *sortie_p, const char *chaine, int largeur)
+{
+	size_t longueur;
+
+	if (!chaine) chaine="(null)";
+	longueur=strlen(chaine);
+	if ((size_t)largeur>longueur) sortie_repeter(sortie_p, ' ', largeur-longueur);
+	sortie_ecrire(sortie_p, chaine, longueur);
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param chaine chaine à écrire, NULL est écrit comme une chaine vide
+ * @return Rien
+ * @brief Ecrit une chaine JSON (entre guillemets) en échappant les caractères qui doivent l'être
+ */
+void sortie_chaine_json(struct Sortie_s *sortie_p, const char *chaine)
+{
+	const char *debut_p=chaine;
+
+	sortie_caractere(sortie_p, '"');
+	for (; chaine && *chaine; chaine++)
+		if ((*chaine=='"') || (*chaine=='\\') || ((unsigned char)*chaine<0x20)) {
+			sortie_ecrire(sortie_p, debut_p, chaine-debut_p);
+			sortie_caractere(sortie_p, '\\');
+			if ((*chaine=='"') || (*chaine=='\\'))
+				sortie_caractere(sortie_p, *chaine);
+			else {
+				sortie_chaine(sortie_p, "u00");
+				sortie_hex(sortie_p, (unsigned char)*chaine, 2);
+			}
+			debut_p=chaine+1;
+		}
+	if (chaine) sortie_ecrire(sortie_p, debut_p, chaine-debut_p);
+	sortie_caractere(sortie_p, '"');
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie
+ * @param style style ANSI (STYLE_BOLD...)
+ * @param couleur couleur ANSI (COLOR_RED...), 0 pour revenir à la couleur par défaut
+ * @return Rien
+ * @brief Ecrit une séquence de couleur, seulement si la sortie est en couleur
+ */
+void sortie_style(struct Sortie_s *sortie_p, int style, int couleur)
+{
+	char *place_p;
+
+	if (!sortie_p->couleur) return;
+	place_p=sortie_reserver(sortie_p, 7);
+	place_p[0]=0x1B;
+	place_p[1]='[';
+	place_p[2]='0'+style%10;
+	place_p[3]=';';
+	place_p[4]='0'+(couleur/10)%10;
+	place_p[5]='0'+couleur%10;
+	place_p[6]='m';
+	if (couleur<10) { /* un seul chiffre : "\e[1;0m" */
+		place_p[4]=place_p[5];
+		place_p[5]='m';
+		sortie_p->taille--;
+	}
+}
@@ -20,6 +20,13 @@
 #include <dico.h>
 #include <lex.h>
 #include <syn.h>
+#include <sortie.h>
+#include <memoire.h>
+#include <expression.h>
+#include <pseudo.h>
+#include <relaxation.h>
+#include <delais.h>
+#include <lucarne.h>
 
 enum M_E_S_e {
 		MES_INIT,
@@ -78,144 +85,260 @@ char *clefEtiquette(void *donnee_p)
 	return (donnee_p ? ((struct Etiquette_s *)donnee_p)->lexeme_p->data : NULL);
 }
 
-void str_instruction(struct Instruction_s * instruction_p, struct Table_s *table_p)
+/**
+ * @param etiquette_p pointeur sur une étiquette, NULL accepté
+ * @return Rien
+ * @brief Libère une étiquette (fonction de destruction de la table des étiquettes) ; son lexème n'est pas libéré
+ */
+void detruit_etiquette(void *etiquette_p)
+{
+	if (etiquette_p) {
+		free(etiquette_p);
+		MEMOIRE_LIBERER(MEM_ETIQUETTES, sizeof(struct Etiquette_s));
+	}
+}
+
+/**
+ * @param instruction_p pointeur sur une instruction, NULL accepté
+ * @return Rien
+ * @brief Libère une instruction (fonction de destruction de la liste .text) ; ses lexèmes ne sont pas libérés, à
+ * l'exception de ses expressions
+ */
+void detruit_instruction(void *instruction_p)
+{
+	struct Lexeme_s **operandes;
+	int i;
+
+	if (instruction_p) {
+		operandes=((struct Instruction_s *)instruction_p)->operandes;
+		for (i=0 ; i<3 ; i++)
+			if ((operandes[i]) && (operandes[i]->nature==L_EXPRESSION))
+				detruire_expression((struct Expression_s *)operandes[i]);
+		free(instruction_p);
+		MEMOIRE_LIBERER(MEM_INSTRUCTIONS, sizeof(struct Instruction_s));
+	}
+}
+
+/**
+ * @param analyse_p pointeur sur l'état de l'analyse en cours
+ * @param instruction_p pointeur sur l'instruction analysée
+ * @return taille en octets des instructions ajoutées
+ * @brief Ajoute une instruction à la liste .text ; une pseudo-instruction y est remplacée par son expansion
+ *
+ * Une pseudo-instruction dont l'expansion dépend d'étiquettes reçoit son expansion la plus courte et est notée
+ * pour la relaxation de fin d'analyse.
+ */
+uint32_t ajouter_instruction_text(struct AnalyseSyntaxe_s *analyse_p, struct Instruction_s *instruction_p)
+{
+	struct Liste_s *liste_p=analyse_p->liste_text_p;
+	struct NoeudListe_s *fin_p=liste_p->fin_liste_p;
+	struct ExpansionPseudo_s *expansion_p;
+	struct PseudoVariable_s *pseudo_p;
+	uint32_t taille;
+
+	if (!instruction_p->definition_p->expansions_p) {
+		ajouter_fin_liste(liste_p, instruction_p);
+		return 4;
+	}
+	if (!pseudo_variable(instruction_p)) return developper_pseudo(instruction_p, NULL, liste_p);
+
+	expansion_p=expansion_optimiste_pseudo(instruction_p->definition_p);
+	if (!analyse_p->relaxation_p) analyse_p->relaxation_p=creer_relaxation();
+	pseudo_p=noter_pseudo_variable(analyse_p->relaxation_p, instruction_p, expansion_p);
+	taille=developper_pseudo(instruction_p, expansion_p, liste_p);
+	pseudo_p->premier_p=fin_p ? fin_p->suivant_p : liste_p->debut_liste_p;
+	return taille;
+}
+
+/**
+ * @param donnee_p pointeur sur une donnée, NULL accepté
+ * @return Rien
+ * @brief Libère une donnée (fonction de destruction des listes .data et .bss) ; son lexème n'est pas libéré
+ */
+void detruit_donnee(void *donnee_p)
+{
+	if (donnee_p) {
+		free(donnee_p);
+		MEMOIRE_LIBERER(MEM_DONNEES, sizeof(struct Donnee_s));
+	}
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie du listage
+ * @param nom nom du symbole
+ * @param etiquette_p pointeur sur l'étiquette du symbole, NULL si elle est inconnue
+ * @param inconnu texte suivant le nom d'un symbole inconnu
+ * @return Rien
+ * @brief Ecrit un nom de symbole (vert s'il est connu, rouge sinon) suivi de sa section
+ */
+void lister_symbole(struct Sortie_s *sortie_p, char *nom, struct Etiquette_s *etiquette_p, char *inconnu)
+{
+	sortie_chaine(sortie_p, " : symbole ");
+	sortie_style(sortie_p, STYLE_BOLD, etiquette_p ? COLOR_GREEN : COLOR_RED);
+	sortie_chaine(sortie_p, nom);
+	sortie_style(sortie_p, STYLE_BOLD, 0);
+	if (etiquette_p) {
+		sortie_chaine(sortie_p, " en section ");
+		sortie_chaine(sortie_p, NOMS_SECTIONS[etiquette_p->section]);
+	} else
+		sortie_chaine(sortie_p, inconnu);
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie du listage
+ * @param instruction_p pointeur sur l'instruction
+ * @param table_p pointeur sur la table des étiquettes
+ * @return Rien
+ * @brief Ecrit une ligne du listage des instructions : ligne, décalage, code, opérandes et symboles
+ */
+void str_instruction(struct Sortie_s *sortie_p, struct Instruction_s * instruction_p, struct Table_s *table_p)
 {
+	struct Etiquette_s *etiquette_p;
+	struct ValeurExpression_s valeur;
+	char msg_err[STRLEN];
 	int i;
 
-	printf("%5d %08x XXXXXXXX %8s %8s %8s %8s",
-			instruction_p->ligne,
-			instruction_p->decalage,
-			instruction_p->definition_p->nom,
-			instruction_p->operandes[0] ? instruction_p->operandes[0]->data : "    ",
-			instruction_p->operandes[1] ? instruction_p->operandes[1]->data : "    ",
-			instruction_p->operandes[2] ? instruction_p->operandes[2]->data : "    ");
+	sortie_decimal(sortie_p, instruction_p->ligne, 5);
+	sortie_caractere(sortie_p, ' ');
+	sortie_hex(sortie_p, instruction_p->decalage, 8);
+	sortie_caractere(sortie_p, ' ');
+	sortie_hex(sortie_p, instruction_p->code, 8);
+	sortie_caractere(sortie_p, ' ');
+	sortie_chaine_alignee(sortie_p, instruction_p->definition_p->nom, 8);
+	for (i=0 ; i<3 ; i++) {
+		sortie_caractere(sortie_p, ' ');
+		sortie_chaine_alignee(sortie_p, instruction_p->operandes[i] ? instruction_p->operandes[i]->data : "    ", 8);
+	}
 
 	for (i=0 ; i<3 ; i++)
 		if (instruction_p->operandes[i] && (instruction_p->operandes[i]->nature==L_SYMBOLE)){
-			if (!donnee_table(table_p, instruction_p->operandes[i]->data)){
-				printf("    0xXXXXXXXX : symbole %c[%d;%dm%s%c[%d;%dm inconnu dans la table des étiquettes",
-						0x1B, STYLE_BOLD, COLOR_RED,
-						instruction_p->operandes[i]->data,
-						0x1B, STYLE_BOLD, 0);
-			} else {
-				printf("    0x%08x : symbole %c[%d;%dm%s%c[%d;%dm en section %s",
-						((struct Etiquette_s *)donnee_table(table_p, instruction_p->operandes[i]->data))->decalage,
-						0x1B, STYLE_BOLD, COLOR_GREEN,
-						instruction_p->operandes[i]->data,
-						0x1B, STYLE_BOLD, 0,
-						NOMS_SECTIONS[((struct Etiquette_s *)donnee_table(table_p, instruction_p->operandes[i]->data))->section]);
+			sortie_chaine(sortie_p, "    0x");
+			if ((etiquette_p=donnee_table(table_p, instruction_p->operandes[i]->data)))
+				sortie_hex(sortie_p, etiquette_p->decalage, 8);
+			else
+				sortie_chaine(sortie_p, "XXXXXXXX");
+			lister_symbole(sortie_p, instruction_p->operandes[i]->data, etiquette_p, " inconnu dans la table des étiquettes");
+		}
+		else if (instruction_p->operandes[i] && (instruction_p->operandes[i]->nature==L_EXPRESSION)) {
+			sortie_chaine(sortie_p, "    0x");
+			if (FAILURE==evaluer_expression((struct Expression_s *)instruction_p->operandes[i], table_p, NULL, &valeur, msg_err))
+				sortie_chaine(sortie_p, "XXXXXXXX : expression invalide");
+			else {
+				sortie_hex(sortie_p, valeur.valeur, 8);
+				if (valeur.symbole)
+					lister_symbole(sortie_p, (char *)valeur.symbole, valeur.etiquette_p, " inconnu dans la table des étiquettes");
+				else
+					sortie_chaine(sortie_p, " : expression");
 			}
 		}
-	printf("\n");
+	sortie_caractere(sortie_p, '\n');
 }
 
 
 /* Fonction permettant d’afficher les éléments d’une donnée des setions .data ou .bss */
-void affiche_element_databss(struct Donnee_s *donnee_p, struct Table_s *table_p)
+void affiche_element_databss(struct Sortie_s *sortie_p, struct Donnee_s *donnee_p, struct Table_s *table_p)
 {
-	/* printf("nom directive %s  numero de ligne %d  decalage %d",donnee_p->lexeme_p->data, donnee_p->ligne, donnee_p->decalage); */
-	printf("%5d %08x ", donnee_p->ligne, donnee_p->decalage);
+	struct Etiquette_s *etiquette_p;
+
+	sortie_decimal(sortie_p, donnee_p->ligne, 5);
+	sortie_caractere(sortie_p, ' ');
+	sortie_hex(sortie_p, donnee_p->decalage, 8);
+	sortie_caractere(sortie_p, ' ');
 	switch(donnee_p->type) {
 	case D_BYTE:
-		printf("      %02x : byte", donnee_p->valeur.octetNS);
+		sortie_chaine(sortie_p, "      ");
+		sortie_hex(sortie_p, donnee_p->valeur.octetNS, 2);
+		sortie_chaine(sortie_p, " : byte");
 		break;
 	case D_WORD:
 		if (donnee_p->lexeme_p->nature==L_SYMBOLE) {
 			if (table_p) {
-				if (!donnee_table(table_p, donnee_p->lexeme_p->data)) {
-					printf("XXXXXXXX : symbole %c[%d;%dm%s%c[%d;%dm est inconnu dans la table des étiquettes",
-							0x1B, STYLE_BOLD, COLOR_RED,
-							donnee_p->lexeme_p->data,
-							0x1B, STYLE_BOLD, 0);
-				} else {
-					printf("%08x : symbole %c[%d;%dm%s%c[%d;%dm en section %s",
-							((struct Etiquette_s *)donnee_table(table_p, donnee_p->lexeme_p->data))->decalage,
-							0x1B, STYLE_BOLD, COLOR_GREEN,
-							donnee_p->lexeme_p->data,
-							0x1B, STYLE_BOLD, 0,
-							NOMS_SECTIONS[((struct Etiquette_s *)donnee_table(table_p, donnee_p->lexeme_p->data))->section]);
-				}
-			} else
-				printf("0xXXXXXXXX : symbole %s", donnee_p->lexeme_p->data);
+				if ((etiquette_p=donnee_table(table_p, donnee_p->lexeme_p->data)))
+					sortie_hex(sortie_p, etiquette_p->decalage, 8);
+				else
+					sortie_chaine(sortie_p, "XXXXXXXX");
+				lister_symbole(sortie_p, donnee_p->lexeme_p->data, etiquette_p, " est inconnu dans la table des étiquettes");
+			} else {
+				sortie_chaine(sortie_p, "0xXXXXXXXX : symbole ");
+				sortie_chaine(sortie_p, donnee_p->lexeme_p->data);
+			}
 		} else {
-			printf("%08x : word", donnee_p->valeur.motNS);
+			sortie_hex(sortie_p, donnee_p->valeur.motNS, 8);
+			sortie_chaine(sortie_p, " : word");
 		}
 		break;
 	case D_ASCIIZ:
-		printf("\"%s\" : asciiz", donnee_p->valeur.chaine);
+		sortie_caractere(sortie_p, '"');
+		sortie_chaine_alignee(sortie_p, donnee_p->valeur.chaine, 0);
+		sortie_chaine(sortie_p, "\" : asciiz");
 		break;
 	case D_SPACE:
-		printf("%08x : space (nombre d'octets réservés)", donnee_p->valeur.nbOctets);
+		sortie_hex(sortie_p, donnee_p->valeur.nbOctets, 8);
+		sortie_chaine(sortie_p, " : space (nombre d'octets réservés)");
 		break;
 	default:
-		printf("type non défini\n");
+		sortie_chaine(sortie_p, "type non défini\n");
 	}
 
-	printf("\n");
+	sortie_caractere(sortie_p, '\n');
+}
+
+/**
+ * @param sortie_p pointeur sur la sortie du listage
+ * @param nb_elements nombre d'éléments de la liste ou de la table, -1 si elle n'existe pas
+ * @param titre titre de la liste
+ * @return TRUE s'il y a des éléments à écrire
+ * @brief Ecrit le titre d'une liste du listage, ou le fait qu'elle n'existe pas ou est vide
+ */
+int lister_titre(struct Sortie_s *sortie_p, long nb_elements, char *titre)
+{
+	sortie_chaine(sortie_p, titre);
+	if (nb_elements<0)
+		sortie_chaine(sortie_p, " n'existe pas !\n");
+	else if (!nb_elements)
+		sortie_chaine(sortie_p, " est vide\n");
+	else
+		sortie_caractere(sortie_p, '\n');
+	return nb_elements>0;
 }
 
-void affiche_liste_donnee(struct Liste_s *liste_p, struct Table_s *table_p, char *titre_liste)
+void affiche_liste_donnee(struct Sortie_s *sortie_p, struct Liste_s *liste_p, struct Table_s *table_p, char *titre_liste)
 {
 	struct NoeudListe_s* noeud_liste_p=NULL;
-	if (!liste_p) {
-		printf("%s n'existe pas !\n", titre_liste);
-	} else {
-		if (!(liste_p->nbElements)) {
-			printf("%s est vide\n", titre_liste);
-		} else {
-			printf("%s\n", titre_liste);
-			for (noeud_liste_p=liste_p->debut_liste_p ; (noeud_liste_p) ; noeud_liste_p=noeud_liste_p->suivant_p) {
-				affiche_element_databss((struct Donnee_s *)noeud_liste_p->donnee_p, table_p);
-			}
-		}
-	}
-	printf("\n\n");
+
+	if (lister_titre(sortie_p, liste_p ? (long)liste_p->nbElements : -1, titre_liste))
+		for (noeud_liste_p=liste_p->debut_liste_p ; (noeud_liste_p) ; noeud_liste_p=noeud_liste_p->suivant_p)
+			affiche_element_databss(sortie_p, (struct Donnee_s *)noeud_liste_p->donnee_p, table_p);
+	sortie_chaine(sortie_p, "\n\n");
 }
 
 
-void affiche_liste_instructions(struct Liste_s *liste_p, struct Table_s *table_p, char *titre_liste)
+void affiche_liste_instructions(struct Sortie_s *sortie_p, struct Liste_s *liste_p, struct Table_s *table_p, char *titre_liste)
 {
 	struct NoeudListe_s* noeud_liste_p=NULL;
-	if (!liste_p) {
-		printf("%s n'existe pas !\n", titre_liste);
-	} else {
-		if (!(liste_p->nbElements)) {
-			printf("%s est vide\n", titre_liste);
-		} else {
-			printf("%s\n", titre_liste);
-			for (noeud_liste_p=liste_p->debut_liste_p ; (noeud_liste_p) ; noeud_liste_p=noeud_liste_p->suivant_p) {
-				str_instruction((struct Instruction_s *)noeud_liste_p->donnee_p, table_p);
-			}
-		}
-	}
-	printf("\n\n");
+
+	if (lister_titre(sortie_p, liste_p ? (long)liste_p->nbElements : -1, titre_liste))
+		for (noeud_liste_p=liste_p->debut_liste_p ; (noeud_liste_p) ; noeud_liste_p=noeud_liste_p->suivant_p)
+			str_instruction(sortie_p, (struct Instruction_s *)noeud_liste_p->donnee_p, table_p);
+	sortie_chaine(sortie_p, "\n\n");
 }
 
-void affiche_table_etiquette(struct Table_s *table_p, char *titre)
+void affiche_table_etiquette(struct Sortie_s *sortie_p, struct Table_s *table_p, char *titre)
 {
-	size_t i, j;
-
 	struct Etiquette_s *etiquette_p=NULL;
-	if (!table_p) {
-		printf("%s n'existe pas !\n", titre);
-	} else {
-		if (!(table_p->nbElts)) {
-			printf("%s est vide\n", titre);
-		} else {
-			printf("%s\n", titre);
-			if (table_p) {
-				j=0;
-				for (i=0; i<table_p->nbEltsMax; i++)
-					if (table_p->table[i]) {
-						j++;
-						etiquette_p=table_p->table[i];
-
-						printf("%08x section %8s  %32s\n",etiquette_p->decalage, NOMS_SECTIONS[etiquette_p->section], etiquette_p->lexeme_p->data);
-					}
+	size_t i;
+
+	if (lister_titre(sortie_p, table_p ? (long)table_p->nbElts : -1, titre))
+		for (i=0; i<table_p->nbEltsMax; i++)
+			if ((etiquette_p=table_p->table[i])) {
+				sortie_hex(sortie_p, etiquette_p->decalage, 8);
+				sortie_chaine(sortie_p, " section ");
+				sortie_chaine_alignee(sortie_p, NOMS_SECTIONS[etiquette_p->section], 8);
+				sortie_chaine(sortie_p, "  ");
+				sortie_chaine_alignee(sortie_p, etiquette_p->lexeme_p->data, 32);
+				sortie_caractere(sortie_p, '\n');
 			}
-		}
-	}
-	printf("\n\n");
+	sortie_chaine(sortie_p, "\n\n");
 }
 
 void mef_suivant(struct NoeudListe_s **noeud_lexeme_pp, struct Lexeme_s **lexeme_pp)
@@ -269,6 +392,7 @@ int enregistrer_etiquette(
 
 	struct Etiquette_s *etiquetteCourante_p=malloc(sizeof(*etiquetteCourante_p));
 	if (!etiquetteCourante_p) ERROR_MSG("Impossible de créer une nouvelle étiquette");
+	MEMOIRE_ALLOUER(MEM_ETIQUETTES, sizeof(*etiquetteCourante_p));
 
 	if ((section == S_DATA) && (suite_est_directive_word((*noeud_lexeme_pp)->suivant_p)))
 		aligner_decalage(decalage_p);
@@ -283,7 +407,7 @@ int enregistrer_etiquette(
 		return SUCCESS;
 	} else {
 		sprintf(msg_err, "est une étiquette déjà présente ligne %d", ((struct Etiquette_s *)donnee_table(tableEtiquettes_p, etiquetteCourante_p->lexeme_p->data))->ligne);
-		free(etiquetteCourante_p); etiquetteCourante_p=NULL;
+		detruit_etiquette(etiquetteCourante_p); etiquetteCourante_p=NULL;
 		return FAILURE;
 	}
 }
@@ -302,16 +426,17 @@ enum M_E_S_e etat_comm_eol(struct Lexeme_s *lexeme_p, char *msg_err, char *msg)
 	return etat;
 }
 
-enum M_E_S_e etat_sera_nombre_ou_symbole(
+enum M_E_S_e etat_sera_expression(
 		struct NoeudListe_s **noeud_lexeme_pp,
 		struct Lexeme_s **lexeme_pp,
+		int forme_base,
 		enum M_E_S_e etat_normal_suiv,
 		char *msg_err)
 {
 	enum M_E_S_e etat;
 	mef_suivant(noeud_lexeme_pp, lexeme_pp);
 	if (!(*lexeme_pp)) etat=MES_ERREUR;
-	else if (((*lexeme_pp)->nature==L_NOMBRE) || ((*lexeme_pp)->nature==L_SYMBOLE)) etat=etat_normal_suiv;
+	else if (est_debut_expression(*noeud_lexeme_pp, forme_base)) etat=etat_normal_suiv;
 	else {
 		etat=MES_ERREUR;
 		strcpy(msg_err, "n'est pas un nombre ou un symbole");
@@ -383,7 +508,7 @@ int mef_lire_nombre(
 	nombre=strtol(lexeme_p->data, NULL, 0); /* Convertit la chaine en nombre, avec base automatique */
 	if (errno) {
 		strcpy(msg_err, "n'a pas pu être évalué numériquement");
-		free((*donnee_pp));
+		detruit_donnee(*donnee_pp);
 		*donnee_pp=NULL;
 		return MES_ERREUR;
 	} else {
@@ -392,7 +517,7 @@ int mef_lire_nombre(
 			(((*donnee_pp)->type==D_SPACE) && (nombre<=0) && (nombre+*decalage_p>=UINT32_MAX))) {
 
 			strcpy(msg_err, "est au delà des valeurs permises");
-			free((*donnee_pp));
+			detruit_donnee(*donnee_pp);
 			*donnee_pp=NULL;
 			return MES_ERREUR;
 		} else {
@@ -418,20 +543,44 @@ int mef_lire_nombre(
 }
 
 /**
- * @return Rien, si ce n'est les données mises à jour par les pointeurs paramètres associés
- * @brief effectue l'analyse syntaxique de premier niveau d'une liste de lexemes
- *
- *
- *
+ * @return Rien, si ce n'est l'état d'analyse initialisé
+ * @brief Prépare l'état de l'analyse syntaxique avant le traitement de la première ligne
  */
-int analyser_syntaxe(
-		struct Liste_s *lignes_lexemes_p,			/**< Pointeur sur la liste des lexèmes */
+void debuter_analyse_syntaxe(
+		struct AnalyseSyntaxe_s *analyse_p,			/**< Pointeur sur l'état de l'analyse à initialiser */
 		struct Table_s *table_def_instructions_p,	/**< Pointeur sur la table "dico" des instructions */
 		struct Table_s *table_def_registres_p,		/**< Pointeur sur la table "dico" des registres */
 		struct Table_s *table_etiquettes_p,			/**< Pointeur sur la table des étiquettes */
 		struct Liste_s *liste_text_p,				/**< Pointeur sur la liste des instructions de la section .text */
 		struct Liste_s *liste_data_p,				/**< Pointeur sur la liste des données de la section .data */
 		struct Liste_s *liste_bss_p)				/**< Pointeur sur la liste des réservations des .space de la section .bss */
+{
+	analyse_p->table_def_instructions_p=table_def_instructions_p;
+	analyse_p->table_def_registres_p=table_def_registres_p;
+	analyse_p->table_etiquettes_p=table_etiquettes_p;
+	analyse_p->liste_text_p=liste_text_p;
+	analyse_p->liste_data_p=liste_data_p;
+	analyse_p->liste_bss_p=liste_bss_p;
+	analyse_p->decalage_text=0;
+	analyse_p->decalage_data=0;
+	analyse_p->decalage_bss=0;
+	analyse_p->section=S_INIT;
+	analyse_p->resultat=SUCCESS;
+	analyse_p->ordre_fixe=FALSE;
+	analyse_p->lucarne=FALSE;
+	analyse_p->relaxation_p=NULL;
+}
+
+/**
+ * @return SUCCESS si toutes les lignes analysées jusque là sont valides, FAILURE sinon
+ * @brief effectue l'analyse syntaxique de premier niveau d'une suite de lignes de lexèmes
+ *
+ * L'analyse s'arrête à la fin de la liste chaînée. Comme chaque ligne se termine par un lexème
+ * L_FIN_LIGNE, on peut reprendre l'analyse plus tard sur les lignes suivantes avec le même état.
+ */
+int analyser_lignes(
+		struct AnalyseSyntaxe_s *analyse_p,			/**< Pointeur sur l'état de l'analyse en cours */
+		struct NoeudListe_s *noeud_lexeme_p)		/**< Pointeur sur le noeud du premier lexème à analyser */
 {
 /**	@dot
  *	digraph Machine_Etat_Instruc {
@@ -455,7 +604,7 @@ int analyser_syntaxe(
  *		MES_I_B_REG -> MES_I_B_VIR [label = "VIR"]
  *		MES_I_B_REG -> MES_ERREUR [label = "sinon"]
  *
- *		MES_I_B_VIR -> MES_I_B_OFFS [label = "NB ou SYM"]
+ *		MES_I_B_VIR -> MES_I_B_OFFS [label = "EXPR"]
  *		MES_I_B_VIR -> MES_ERREUR [label = "sinon"]
  *
  *		MES_I_B_OFFS -> MES_I_B_PO [label = "PO"]
@@ -485,7 +634,7 @@ int analyser_syntaxe(
  *		MES_I_RN_2OP -> MES_I_RN_V21 [label = "VIR"]
  *		MES_I_RN_2OP -> MES_ERREUR [label = "sinon"]
  *
- *		MES_I_RN_V21 -> MES_I_N_OP [label = "N et (NB ou SYM)"]
+ *		MES_I_RN_V21 -> MES_I_N_OP [label = "N et EXPR"]
  *		MES_I_RN_V21 -> MES_I_R_1OP [label = "R et REG"]
  *		MES_I_RN_V21 -> MES_ERREUR [label = "sinon"]
  *
@@ -543,11 +692,13 @@ int analyser_syntaxe(
  *		MES_INIT -> MES_EOL [label = "EOL"]
  *		MES_INIT -> MES_ERREUR [label = "sinon"]
  *
- *		MES_OPTION -> MES_NOREORD [label = "SYM noreoder"]
- *		MES_OPTION -> MES_COMMENT [label = "COMMENT"]
- *		MES_OPTION -> MES_EOL [label = "EOL"]
+ *		MES_OPTION -> MES_NOREORD [label = "SYM reorder ou noreorder"]
  *		MES_OPTION -> MES_ERREUR [label = "sinon"]
  *
+ *		MES_NOREORD -> MES_COMMENT [label = "COMMENT"]
+ *		MES_NOREORD -> MES_EOL [label = "EOL"]
+ *		MES_NOREORD -> MES_ERREUR [label = "sinon"]
+ *
  *		MES_SECTION -> MES_COMMENT [label = "COMMENT"]
  *		MES_SECTION -> MES_EOL [label = "EOL"]
  *		MES_SECTION -> MES_ERREUR [label = "sinon"]
@@ -610,7 +761,7 @@ int analyser_syntaxe(
  *		MES_I_B_REG -> MES_I_B_VIR [label = "VIR"]
  *		MES_I_B_REG -> MES_ERREUR [label = "sinon"]
  *
- *		MES_I_B_VIR -> MES_I_B_OFFS [label = "NB ou SYM"]
+ *		MES_I_B_VIR -> MES_I_B_OFFS [label = "EXPR"]
  *		MES_I_B_VIR -> MES_ERREUR [label = "sinon"]
  *
  *		MES_I_B_OFFS -> MES_I_B_PO [label = "PO"]
@@ -632,45 +783,52 @@ int analyser_syntaxe(
  *  @enddot
  */
 
-	uint32_t decalage_text=0;
-	uint32_t decalage_data=0;
-	uint32_t decalage_bss=0;
+	struct Table_s *table_def_instructions_p=analyse_p->table_def_instructions_p;
+	struct Table_s *table_def_registres_p=analyse_p->table_def_registres_p;
+	struct Table_s *table_etiquettes_p=analyse_p->table_etiquettes_p;
 
 	uint32_t *decalage_p=NULL;
 	struct Liste_s *liste_p=NULL;
 
 	char msg_err[2*STRLEN];
 
-	struct NoeudListe_s *noeud_lexeme_p=NULL;
 	struct Lexeme_s *lexeme_p=NULL;
 
 	enum M_E_S_e etat=MES_INIT;
-	enum Section_e section=S_INIT;
+	enum Section_e section=analyse_p->section;
 	int resultat=SUCCESS;
 
 	struct DefinitionInstruction_s *def_p=NULL;
 	struct Instruction_s *instruction_p=NULL;
 	struct Donnee_s *donnee_p=NULL;
 
-	if (lignes_lexemes_p) {
+	/* reprend la section là où la précédente suite de lignes l'avait laissée */
+	if (section==S_TEXT) {
+		decalage_p=&analyse_p->decalage_text;
+		liste_p=analyse_p->liste_text_p;
+	} else if (section==S_DATA) {
+		decalage_p=&analyse_p->decalage_data;
+		liste_p=analyse_p->liste_data_p;
+	} else if (section==S_BSS) {
+		decalage_p=&analyse_p->decalage_bss;
+		liste_p=analyse_p->liste_bss_p;
+	}
+
+	if (noeud_lexeme_p) {
 		msg_err[0]='\0';
-		noeud_lexeme_p=lignes_lexemes_p->debut_liste_p;
-		if (noeud_lexeme_p)
-			lexeme_p=(struct Lexeme_s *)noeud_lexeme_p->donnee_p;
-		else
-			lexeme_p=NULL;
+		lexeme_p=(struct Lexeme_s *)noeud_lexeme_p->donnee_p;
 		while ((lexeme_p) && (etat != MES_FIN)) {
 			switch(etat) {
 			case MES_ERREUR:
 				if (lexeme_p) {
-					fprintf(stderr, "Erreur de syntaxe ligne %d, ", lexeme_p ? lexeme_p->ligne : 0);
-					fprintf(stderr, "%c[%d;%dm%s%c[%d;%dm ", 0x1B, STYLE_BOLD, COLOR_RED, (!(lexeme_p->data) ? "Fin_de_ligne" : lexeme_p->data),0x1B, STYLE_OFF, 0);
-					fprintf(stderr, "%s.\n", msg_err); msg_err[0]='\0';
+					diag_signaler(NULL, DIAG_ERREUR, NULL, lexeme_p->ligne, "syntaxe", "%s %s",
+							(!(lexeme_p->data) ? "Fin_de_ligne" : lexeme_p->data), msg_err);
+					msg_err[0]='\0';
 				} else ERROR_MSG("fin de liste de lexème inatendue");
 
-				free(instruction_p);
+				detruit_instruction(instruction_p);
 				instruction_p=NULL;
-				free(donnee_p);
+				detruit_donnee(donnee_p);
 				donnee_p=NULL;
 
 				while ((lexeme_p) && (lexeme_p->nature!=L_FIN_LIGNE))
@@ -687,7 +845,7 @@ int analyser_syntaxe(
 				else if ((lexeme_p->nature==L_DIRECTIVE) && ((!strcmp(lexeme_p->data, NOMS_SECTIONS[S_TEXT])) ||
 					(!strcmp(lexeme_p->data, NOMS_SECTIONS[S_DATA])) || (!strcmp(lexeme_p->data, NOMS_SECTIONS[S_BSS]))))
 					etat=MES_SECTION;
-				else if ((section==S_INIT) && (lexeme_p->nature==L_DIRECTIVE) && (!strcmp(lexeme_p->data, ".set"))) etat=MES_OPTION;
+				else if ((lexeme_p->nature==L_DIRECTIVE) && (!strcmp(lexeme_p->data, ".set"))) etat=MES_OPTION;
 				else if ((section!=S_INIT) && (lexeme_p->nature==L_ETIQUETTE)) etat=MES_ETIQUET;
 				else if ((((section==S_BSS) || (section==S_DATA)) && (lexeme_p->nature==L_DIRECTIVE) &&((!strcmp(lexeme_p->data, NOMS_DATA[D_SPACE])))) ||
 						(((section==S_DATA) && (lexeme_p->nature==L_DIRECTIVE) && ((!strcmp(lexeme_p->data, NOMS_DATA[D_BYTE])) ||
@@ -735,24 +893,38 @@ int analyser_syntaxe(
 			case MES_SECTION:
 				if (!strcmp(lexeme_p->data, NOMS_SECTIONS[S_TEXT])) {
 					section = S_TEXT;
-					decalage_p=&decalage_text;
-					liste_p=liste_text_p;
+					decalage_p=&analyse_p->decalage_text;
+					liste_p=analyse_p->liste_text_p;
 				} else if (!strcmp(lexeme_p->data, NOMS_SECTIONS[S_DATA])) {
 					section = S_DATA;
-					decalage_p=&decalage_data;
-					liste_p=liste_data_p;
+					decalage_p=&analyse_p->decalage_data;
+					liste_p=analyse_p->liste_data_p;
 				} else if (!strcmp(lexeme_p->data, NOMS_SECTIONS[S_BSS])) {
 					section = S_BSS;
-					decalage_p=&decalage_bss;
-					liste_p=liste_bss_p;
+					decalage_p=&analyse_p->decalage_bss;
+					liste_p=analyse_p->liste_bss_p;
 				} else ERROR_MSG("erreur automate : nom de section");
+				analyse_p->section=section;
 
 				mef_suivant(&noeud_lexeme_p, &lexeme_p);
 				etat=etat_comm_eol(lexeme_p, msg_err, "ne devrait pas être après la directive de changement de section");
 				break;
 			case MES_OPTION:
-				etat=MES_ERREUR;
-				strcpy(msg_err, "n'est pas encore traité (MES_OPTION)");
+				mef_suivant(&noeud_lexeme_p, &lexeme_p);
+				if ((lexeme_p) && (lexeme_p->nature==L_SYMBOLE) && (!strcmp(lexeme_p->data, "noreorder"))) {
+					analyse_p->ordre_fixe=TRUE;
+					etat=MES_NOREORD;
+				} else if ((lexeme_p) && (lexeme_p->nature==L_SYMBOLE) && (!strcmp(lexeme_p->data, "reorder"))) {
+					analyse_p->ordre_fixe=FALSE;
+					etat=MES_NOREORD;
+				} else {
+					etat=MES_ERREUR;
+					strcpy(msg_err, "n'est pas une option de .set (reorder ou noreorder)");
+				}
+				break;
+			case MES_NOREORD:
+				mef_suivant(&noeud_lexeme_p, &lexeme_p);
+				etat=etat_comm_eol(lexeme_p, msg_err, "est en trop après l'option de .set");
 				break;
 			case MES_ETIQUET:
 				if (SUCCESS!=enregistrer_etiquette(&noeud_lexeme_p, &lexeme_p, section, decalage_p, table_etiquettes_p, msg_err))
@@ -766,6 +938,7 @@ int analyser_syntaxe(
 			/*
 			case MES_DONNEE_B:
 				if (!(donnee_p=calloc(1, sizeof(*donnee_p)))) ERROR_MSG("Impossible de créer une donnée");
+				MEMOIRE_ALLOUER(MEM_DONNEES, sizeof(*donnee_p));
 				donnee_p->type=D_BYTE;
 				etat=mef_lire_nombre(etat, lexeme_p, &donnee_p, decalage_p, msg_err);
 				if (etat!=MES_ERREUR) mef_suivant(&noeud_lexeme_p, &lexeme_p);
@@ -782,6 +955,7 @@ int analyser_syntaxe(
 
 			case MES_DONNEE_A: /* XXX Créer une fonction mef_lire_chaine? */
 				if (!(donnee_p=calloc(1, sizeof(*donnee_p)))) ERROR_MSG("Impossible de créer une donnée");
+				MEMOIRE_ALLOUER(MEM_DONNEES, sizeof(*donnee_p));
 				donnee_p->decalage=*decalage_p;
 				donnee_p->type=D_ASCIIZ;
 				donnee_p->lexeme_p=lexeme_p;
@@ -812,6 +986,7 @@ int analyser_syntaxe(
 
 			case MES_DONNEE_W:
 				if (!(donnee_p=calloc(1, sizeof(*donnee_p)))) ERROR_MSG("Impossible de créer une donnée");
+				MEMOIRE_ALLOUER(MEM_DONNEES, sizeof(*donnee_p));
 				aligner_decalage(decalage_p);
 				donnee_p->type=D_WORD;
 				etat=mef_lire_nombre(etat, lexeme_p, &donnee_p, decalage_p, msg_err);
@@ -837,6 +1012,7 @@ int analyser_syntaxe(
 
 			case MES_DONNEE_B:
 				if (!(donnee_p=calloc(1, sizeof(*donnee_p)))) ERROR_MSG("Impossible de créer une donnée");
+				MEMOIRE_ALLOUER(MEM_DONNEES, sizeof(*donnee_p));
 				donnee_p->type=D_BYTE;
 				etat=mef_lire_nombre(etat, lexeme_p, &donnee_p, decalage_p, msg_err);
 				if (etat!=MES_ERREUR) mef_suivant(&noeud_lexeme_p, &lexeme_p);
@@ -861,6 +1037,7 @@ int analyser_syntaxe(
 
 			case MES_DONNEE_S:
 				if (!(donnee_p=calloc(1, sizeof(*donnee_p)))) ERROR_MSG("Impossible de créer une donnée");
+				MEMOIRE_ALLOUER(MEM_DONNEES, sizeof(*donnee_p));
 				donnee_p->type=D_SPACE;
 				etat=mef_lire_nombre(etat, lexeme_p, &donnee_p, decalage_p, msg_err);
 				if (etat!=MES_ERREUR) mef_suivant(&noeud_lexeme_p, &lexeme_p);
@@ -906,17 +1083,18 @@ int analyser_syntaxe(
 				} else {
 					INFO_MSG("Prise en compte de l'instruction %s à %d opérandes au décalage %d", def_p->nom, def_p->nb_ops, *decalage_p);
 					instruction_p=calloc(1,sizeof(*instruction_p));
+					MEMOIRE_ALLOUER(MEM_INSTRUCTIONS, sizeof(*instruction_p));
 					instruction_p->definition_p=def_p;
 					instruction_p->ligne=lexeme_p->ligne;
 					instruction_p->decalage=*decalage_p;
+					instruction_p->ordre_fixe=analyse_p->ordre_fixe;
 
 					mef_suivant(&noeud_lexeme_p, &lexeme_p);
 					if (!lexeme_p) etat=MES_ERREUR;
 					else {
 						if ((def_p->nb_ops==0) && ((lexeme_p->nature == L_FIN_LIGNE) || (lexeme_p->nature==L_COMMENTAIRE)))  {
-							ajouter_fin_liste(liste_p, instruction_p);
+							(*decalage_p)+=ajouter_instruction_text(analyse_p, instruction_p);
 							instruction_p=NULL; /* XXX il faudra tester l'insertion */
-							(*decalage_p)+=4;
 						}
 
 						if ((lexeme_p->nature!=L_REGISTRE) && (((def_p->type_ops==I_OP_R) && (def_p->nb_ops>0)) || ((def_p->type_ops==I_OP_N) && (def_p->nb_ops>1)) || (def_p->type_ops==I_OP_B))) {
@@ -951,7 +1129,7 @@ int analyser_syntaxe(
 				break;
 			case MES_I_RN_V21:
 				if (def_p->type_ops==I_OP_R) etat=etat_sera_registre(&noeud_lexeme_p, &lexeme_p, MES_I_R_1OP, msg_err);
-				else etat=etat_sera_nombre_ou_symbole(&noeud_lexeme_p, &lexeme_p, MES_I_N_OP, msg_err);
+				else etat=etat_sera_expression(&noeud_lexeme_p, &lexeme_p, FALSE, MES_I_N_OP, msg_err);
 				break;
 			case MES_I_R_1OP:
 				if (!donnee_table(table_def_registres_p, lexeme_p->data)) {
@@ -963,34 +1141,31 @@ int analyser_syntaxe(
 					mef_suivant(&noeud_lexeme_p, &lexeme_p);
 					etat=etat_comm_eol(lexeme_p, msg_err, "est en trop pour cette instruction");
 					if (etat!=MES_ERREUR) {
-						ajouter_fin_liste(liste_p, instruction_p);
+						(*decalage_p)+=ajouter_instruction_text(analyse_p, instruction_p);
 						instruction_p=NULL; /* XXX il faudra tester l'insertion */
-						(*decalage_p)+=4;
 					}
 				}
 				break;
 			case MES_I_N_OP:
-				instruction_p->operandes[def_p->nb_ops-1]=lexeme_p;
-
-				mef_suivant(&noeud_lexeme_p, &lexeme_p);
+				if (!(instruction_p->operandes[def_p->nb_ops-1]=lire_expression(&noeud_lexeme_p, &lexeme_p, FALSE, msg_err))) {
+					etat=MES_ERREUR;
+					break;
+				}
 				etat=etat_comm_eol(lexeme_p, msg_err, "est en trop pour cette instruction");
 				if (etat!=MES_ERREUR) {
-					ajouter_fin_liste(liste_p, instruction_p);
+					(*decalage_p)+=ajouter_instruction_text(analyse_p, instruction_p);
 					instruction_p=NULL; /* XXX il faudra tester l'insertion */
-					(*decalage_p)+=4;
 				}
 				break;
 			case MES_I_B_REG:
 				etat=etat_traitement_registre(&noeud_lexeme_p, &lexeme_p, table_def_registres_p, instruction_p, 0, L_VIRGULE, MES_I_B_VIR, msg_err, "à la place d'une virgule");
 				break;
 			case MES_I_B_VIR:
-				etat=etat_sera_nombre_ou_symbole(&noeud_lexeme_p, &lexeme_p, MES_I_B_OFFS, msg_err);
+				etat=etat_sera_expression(&noeud_lexeme_p, &lexeme_p, TRUE, MES_I_B_OFFS, msg_err);
 				break;
 			case MES_I_B_OFFS:
-				instruction_p->operandes[1]=lexeme_p;
-
-				mef_suivant(&noeud_lexeme_p, &lexeme_p);
-				if (!lexeme_p) etat=MES_ERREUR;
+				if (!(instruction_p->operandes[1]=lire_expression(&noeud_lexeme_p, &lexeme_p, TRUE, msg_err))) etat=MES_ERREUR;
+				else if (!lexeme_p) etat=MES_ERREUR;
 				else if (lexeme_p->nature==L_PARENTHESE_OUVRANTE) etat=MES_I_B_PO;
 				else {
 					etat=MES_ERREUR;
@@ -1007,9 +1182,8 @@ int analyser_syntaxe(
 				mef_suivant(&noeud_lexeme_p, &lexeme_p);
 				etat=etat_comm_eol(lexeme_p, msg_err, "est en trop pour cette instruction");
 				if (etat!=MES_ERREUR) {
-					ajouter_fin_liste(liste_p, instruction_p);
+					(*decalage_p)+=ajouter_instruction_text(analyse_p, instruction_p);
 					instruction_p=NULL; /* XXX il faudra tester l'insertion */
-					(*decalage_p)+=4;
 				}
 				break;
 			default:
@@ -1017,10 +1191,57 @@ int analyser_syntaxe(
 				strcpy(msg_err, "ne devrait pas être là");
 			}
 		}
-	} else
-		resultat=FAILURE;
+	}
 
-	return resultat;
+	if (resultat!=SUCCESS)
+		analyse_p->resultat=resultat;
+	return analyse_p->resultat;
+}
+
+/**
+ * @return SUCCESS si toute l'analyse et la relaxation se sont déroulées sans erreur, FAILURE sinon
+ * @brief Termine l'analyse syntaxique une fois toutes les lignes analysées : remplit les délais de branchement
+ * (mode reorder) puis relaxe la section .text
+ */
+int terminer_analyse_syntaxe(
+		struct AnalyseSyntaxe_s *analyse_p,			/**< Pointeur sur l'état de l'analyse en cours */
+		int recoder)								/**< TRUE si les instructions .text ont déjà été codées */
+{
+	if ((analyse_p->lucarne) && (FAILURE==optimiser_lucarne(analyse_p, recoder)))
+		analyse_p->resultat=FAILURE;
+	if (FAILURE==remplir_delais(analyse_p, recoder))
+		analyse_p->resultat=FAILURE;
+	if (analyse_p->relaxation_p) {
+		if (FAILURE==relaxer_text(analyse_p->relaxation_p, analyse_p, recoder))
+			analyse_p->resultat=FAILURE;
+		detruire_relaxation(analyse_p->relaxation_p);
+		analyse_p->relaxation_p=NULL;
+	}
+	return analyse_p->resultat;
+}
+
+/**
+ * @return SUCCESS si l'analyse s'est déroulée sans erreur, FAILURE sinon
+ * @brief effectue l'analyse syntaxique de premier niveau d'une liste de lexemes
+ */
+int analyser_syntaxe(
+		struct Liste_s *lignes_lexemes_p,			/**< Pointeur sur la liste des lexèmes */
+		struct Table_s *table_def_instructions_p,	/**< Pointeur sur la table "dico" des instructions */
+		struct Table_s *table_def_registres_p,		/**< Pointeur sur la table "dico" des registres */
+		struct Table_s *table_etiquettes_p,			/**< Pointeur sur la table des étiquettes */
+		struct Liste_s *liste_text_p,				/**< Pointeur sur la liste des instructions de la section .text */
+		struct Liste_s *liste_data_p,				/**< Pointeur sur la liste des données de la section .data */
+		struct Liste_s *liste_bss_p)				/**< Pointeur sur la liste des réservations des .space de la section .bss */
+{
+	struct AnalyseSyntaxe_s analyse;
+
+	if (!lignes_lexemes_p)
+		return FAILURE;
+
+	debuter_analyse_syntaxe(&analyse, table_def_instructions_p, table_def_registres_p, table_etiquettes_p,
+			liste_text_p, liste_data_p, liste_bss_p);
+	analyser_lignes(&analyse, lignes_lexemes_p->debut_liste_p);
+	return terminer_analyse_syntaxe(&analyse, FALSE);
 }
 
 /* les fonctions suivantes seront à supprimer */
@@ -14,6 +14,7 @@
 #include <global.h>
 #include <notify.h>
 #include <table.h>
+#include <memoire.h>
 
 /**
  * @param nombre
@@ -96,13 +97,16 @@ struct Table_s *creer_table(size_t nb_elts, fonctionClef *fn_clef_p, fonctionDes
 
     if (!table_p) ERROR_MSG("Impossible d'obtenir la mémoire pour la création de la structure de la table de hachage");
 
-    table_p->nbEltsMax = tailleTableHachageRecommandee(nb_elts);
+    /* au moins 2 éléments pour que le pas du double hachage (modulo nbEltsMax-1) soit toujours défini */
+    table_p->nbEltsMax = tailleTableHachageRecommandee(nb_elts > 2 ? nb_elts : 2);
     table_p->nbElts=0;
     table_p->fnClef_p=fn_clef_p;
     table_p->fnDestruction_p=fn_destruction_p;
 
     table_p->table = calloc(table_p->nbEltsMax, sizeof(*table_p->table));
     if (!table_p->table) ERROR_MSG("Impossible d'obtenir la mémoire pour la création de la table de hachage");
+    MEMOIRE_ALLOUER(MEM_TABLES, sizeof(*table_p));
+    MEMOIRE_ALLOUER(MEM_TABLES, table_p->nbEltsMax*sizeof(*table_p->table));
 
     return table_p;
 }
@@ -129,11 +133,45 @@ struct Table_s *detruire_table(struct Table_s *table_p) {
 			}
 
 		free(table_p->table);
+		MEMOIRE_LIBERER(MEM_TABLES, table_p->nbEltsMax*sizeof(*table_p->table));
 		free(table_p);
+		MEMOIRE_LIBERER(MEM_TABLES, sizeof(*table_p));
 	}
 	return NULL;
 }
 
+/**
+ * @param table_p pointeur sur une table de hachage générique
+ * @param nb_elts nombre d'élements minimal que la table devra pouvoir acceuillir
+ * @return Rien
+ * @brief Agrandit la table de hachage et y replace l'ensemble des éléments
+ *
+ * Les éléments eux-mêmes ne sont pas déplacés, seuls les pointeurs changent de case.
+ */
+void redimensionner_table(struct Table_s *table_p, size_t nb_elts)
+{
+	size_t i;
+	size_t nbEltsMaxAncien;
+	void **tableAncienne;
+
+	if (table_p) {
+		nbEltsMaxAncien = table_p->nbEltsMax;
+		tableAncienne = table_p->table;
+
+		table_p->nbEltsMax = tailleTableHachageRecommandee(nb_elts);
+		table_p->table = calloc(table_p->nbEltsMax, sizeof(*table_p->table));
+		if (!table_p->table) ERROR_MSG("Impossible d'obtenir la mémoire pour l'agrandissement de la table de hachage");
+		MEMOIRE_ALLOUER(MEM_TABLES, table_p->nbEltsMax*sizeof(*table_p->table));
+
+		for (i=0; i<nbEltsMaxAncien; i++)
+			if (tableAncienne[i])
+				table_p->table[index_table(table_p, table_p->fnClef_p ? table_p->fnClef_p(tableAncienne[i]) : (char *)tableAncienne[i])] = tableAncienne[i];
+
+		free(tableAncienne);
+		MEMOIRE_LIBERER(MEM_TABLES, nbEltsMaxAncien*sizeof(*tableAncienne));
+	}
+}
+
 /**
  * @param table_p pointeur sur une table de hachage générique
  * @return Rien
@@ -188,6 +226,7 @@ void *donnee_table(struct Table_s *table_p, char *clef)
 {
 	if (table_p && clef) {
 		size_t position = index_table(table_p, clef);
+		PROFIL_COMPTER(CPT_RECHERCHES_TABLE);
 		return table_p->table[position];
 	}
 	return NULL;
@@ -206,6 +245,10 @@ int ajouter_table(struct Table_s *table_p, void *donnee_p)
 {
 	char *clef = NULL;
 	if (table_p && donnee_p) {
+		/* garde le facteur de charge sous les 2/3 même si le nombre d'éléments prévu à la création est dépassé */
+		if (3*(table_p->nbElts+1) > 2*table_p->nbEltsMax)
+			redimensionner_table(table_p, 2*(table_p->nbElts+1));
+
 		clef = (table_p->fnClef_p ? table_p->fnClef_p(donnee_p) : donnee_p);
 		size_t position = index_table(table_p, clef);
 
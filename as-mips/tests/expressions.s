@@ -0,0 +1,16 @@
+# expressions dans le dernier opérande, écrites avec ou sans espaces autour des opérateurs
+.text
+main:
+    ADDI $t0, $zero, 7%3            # modulo collé : 1
+    ADDI $t1, $zero, 7 % 3
+    ADDI $t2, $zero, (7)%(3)
+    ADDI $t3, $zero, -7%4           # -3
+    ADDI $t4, $zero, 1<<4|3         # 19
+    ADDI $t5, $zero, (fin-main)>>2  # nombre d'instructions avant fin
+    LUI $t6, %hi(table)
+    LW $t7, %lo(table)($t6)
+fin:
+    JR $ra
+.data
+table: .word 1
+       .word 2
@@ -0,0 +1,9 @@
+# macros de pile, incluses par tests/inclusions.s avec un chemin relatif qui passe par un répertoire
+.macro empiler reg
+    ADDI $sp, $sp, -4
+    SW \reg, 0($sp)
+.endm
+.macro depiler reg
+    LW \reg, 0($sp)
+    ADDI $sp, $sp, 4
+.endm
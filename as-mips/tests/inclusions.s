@@ -0,0 +1,17 @@
+# inclusions par un chemin relatif avec un répertoire, par un chemin absolu et par un nom contenant '-'
+.include "inclus/pile.s"            # cherché à côté de ce source
+.include "/dev/null"                # chemin absolu, fichier vide
+.include "inclus-donnees.inc"       # le '-' reste dans le nom
+.set noreorder
+.text
+main:
+    empiler $ra
+    LUI $t1, %hi(compteur)
+    LW $t0, %lo(compteur)($t1)
+boucle:
+    ADDI $t0, $t0, -1
+    BGTZ $t0, boucle
+    NOP
+    depiler $ra
+    JR $ra
+    NOP